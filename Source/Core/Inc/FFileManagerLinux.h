@@ -267,7 +267,10 @@ public:
 	{
 		guard(FFileManagerLinux::GetGlobalTime);
 
-		return 0;
+		struct stat Buf;
+		if( stat(TCHAR_TO_ANSI(Filename), &Buf)!=0 )
+			return 0;
+		return (SQWORD)Buf.st_mtime;
 		
 		unguard;
 	}
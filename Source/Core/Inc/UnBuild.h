@@ -52,6 +52,11 @@
 #define STATS 1
 #endif
 
+// Whether to count every script token dispatched, for SCRIPTVM.
+#ifndef DO_SCRIPT_STATS
+#define DO_SCRIPT_STATS DO_GUARD_SLOW
+#endif
+
 // Whether to use Intel assembler code.
 #ifndef ASM
 #define ASM 1
@@ -256,6 +256,7 @@ REGISTER_NAME( 834, VideoChange)
 REGISTER_NAME( 835, SendText)
 REGISTER_NAME( 836, SendBinary)
 REGISTER_NAME( 837, ConnectFailure)
+REGISTER_NAME( 838, SendFile)
 
 /*-----------------------------------------------------------------------------
 	Special engine-generated probe messages.
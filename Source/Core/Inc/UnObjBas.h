@@ -574,11 +574,14 @@ public:
 	#define DECLARE_FUNCTION(func) void func( FFrame& TheStack, RESULT_DECL );
 	DECLARE_FUNCTION(execUndefined)
 	DECLARE_FUNCTION(execLocalVariable)
+	DECLARE_FUNCTION(execLocalDWordVariable)
 	DECLARE_FUNCTION(execInstanceVariable)
+	DECLARE_FUNCTION(execInstanceDWordVariable)
 	DECLARE_FUNCTION(execDefaultVariable)
 	DECLARE_FUNCTION(execArrayElement)
 	DECLARE_FUNCTION(execDynArrayElement)
 	DECLARE_FUNCTION(execBoolVariable)
+	DECLARE_FUNCTION(execQuickBoolVariable)
 	DECLARE_FUNCTION(execClassDefaultVariable)
 	DECLARE_FUNCTION(execEndFunctionParms)
 	DECLARE_FUNCTION(execNothing)
@@ -588,6 +591,7 @@ public:
 	DECLARE_FUNCTION(execCase)
 	DECLARE_FUNCTION(execJump)
 	DECLARE_FUNCTION(execJumpIfNot)
+	DECLARE_FUNCTION(execJumpIfNotBoolVariable)
 	DECLARE_FUNCTION(execAssert)
 	DECLARE_FUNCTION(execGotoLabel)
 	DECLARE_FUNCTION(execLet)
@@ -17,6 +17,15 @@ typedef void (UObject::*Native)( FFrame& TheStack, RESULT_DECL );
 extern CORE_API Native GNatives[];
 BYTE CORE_API GRegisterNative( INT iNative, const Native& Func );
 
+//
+// Quickening: the first time some tokens run, they are rewritten in place
+// as specialized tokens with the same operands, which skip the generic
+// token's dispatch or virtual property copy.  -NOQUICKEN disables it.
+//
+CORE_API extern UBOOL GScriptQuicken;
+CORE_API extern INT   GScriptQuickened;	// Tokens rewritten.
+CORE_API extern DWORD GScriptSteps;		// Tokens dispatched, with DO_SCRIPT_STATS.
+
 //
 // Registering a native function.
 //
@@ -114,6 +123,9 @@ inline FFrame::FFrame( UObject* InObject, UStruct* InNode, INT CodeOffset, void*
 inline void FFrame::Step( UObject* Context, RESULT_DECL )
 {
 	guardSlow(FFrame::Step);
+#if DO_SCRIPT_STATS
+	GScriptSteps++;
+#endif
 	INT B = *Code++;
 	(Context->*GNatives[B])( *this, Result );
 	unguardfSlow(( TEXT("(%s @ %s : %04X)"), Object->GetFullName(), Node->GetFullName(), Code - &Node->Script(0) ));
@@ -190,6 +202,239 @@ inline const TCHAR* FStateFrame::Describe()
 	return Node ? Node->GetFullName() : TEXT("None");
 }
 
+/*-----------------------------------------------------------------------------
+	Quickening.
+-----------------------------------------------------------------------------*/
+
+//
+// The token a quickened token was rewritten from.
+//
+inline BYTE UnquickenToken( BYTE Token )
+{
+	switch( Token )
+	{
+		case EX_LocalDWordVariable:		return EX_LocalVariable;
+		case EX_InstanceDWordVariable:	return EX_InstanceVariable;
+		case EX_QuickBoolVariable:		return EX_BoolVariable;
+		case EX_JumpIfNotBoolVariable:	return EX_JumpIfNot;
+		default:						return Token;
+	}
+}
+CORE_API void UnquickenScripts();
+CORE_API void BenchmarkScriptVM( FOutputDevice& Ar );
+
+//
+// Archive which walks script code as if saving it, without writing, so
+// SerializeExpr restores quickened tokens as it goes.
+//
+class FArchiveUnquicken : public FArchive
+{
+public:
+	FArchiveUnquicken()
+	{
+		ArIsSaving = 1;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	Function cache.
+-----------------------------------------------------------------------------*/
+
+//
+// Remembers which function a virtual call resolves to, so FindObjectField's
+// walk of the state and class hash chains is only done on a miss.  Entries
+// are keyed by the call site, or NULL for native event calls, by function
+// name, and by the class and state of the object called; a call site made on
+// several classes or states gets one entry for each.  Changing state needs
+// no invalidation, since the state is part of the key; relinking or
+// destroying any struct flushes everything.
+//
+class CORE_API FFunctionCache
+{
+public:
+	// Constants.
+	enum {NUM_SETS=512};
+	enum {NUM_WAYS=4};
+
+	// A cached lookup.
+	struct FEntry
+	{
+		const BYTE*	Site;
+		INT			Name;
+		UClass*		Class;
+		UState*		State;
+		UFunction*	Function;
+		INT			Generation;
+	};
+
+	// Variables.
+	FEntry		Entries[NUM_SETS][NUM_WAYS];
+	BYTE		NextWay[NUM_SETS];
+	INT			Hits, Misses;
+	static INT	Generation;			// Entries from other generations are stale.
+	static UBOOL Enabled;			// Whether lookups use the caches at all.
+
+	// Constructor.
+	FFunctionCache()
+	{
+		appMemzero( this, sizeof(*this) );
+	}
+
+	// Functions.
+	UFunction* Find( const BYTE* Site, FName Name, UClass* Class, UState* State )
+	{
+		if( !Enabled )
+			return NULL;
+		FEntry* Set = Entries[GetSet(Site,Name,Class)];
+		for( INT i=0; i<NUM_WAYS; i++ )
+		{
+			if
+			(	Set[i].Site==Site
+			&&	Set[i].Name==Name.GetIndex()
+			&&	Set[i].Class==Class
+			&&	Set[i].State==State
+			&&	Set[i].Generation==Generation )
+			{
+				Hits++;
+				return Set[i].Function;
+			}
+		}
+		Misses++;
+		return NULL;
+	}
+	void Add( const BYTE* Site, FName Name, UClass* Class, UState* State, UFunction* Function )
+	{
+		INT    iSet  = GetSet( Site, Name, Class );
+		FEntry& Entry = Entries[iSet][NextWay[iSet]];
+		NextWay[iSet] = (NextWay[iSet] + 1) % NUM_WAYS;
+		Entry.Site       = Site;
+		Entry.Name       = Name.GetIndex();
+		Entry.Class      = Class;
+		Entry.State      = State;
+		Entry.Function   = Function;
+		Entry.Generation = Generation;
+	}
+	static void Flush()
+	{
+		Generation++;
+	}
+	static void Benchmark( FOutputDevice& Ar );
+
+	// Implementation.
+	static INT GetSet( const BYTE* Site, FName Name, UClass* Class )
+	{
+		DWORD Hash = (DWORD)(SIZE_T)Site ^ (Name.GetIndex() * 0x9E3779B1) ^ ((DWORD)(SIZE_T)Class >> 4);
+		return (Hash ^ (Hash >> 9) ^ (Hash >> 18)) & (NUM_SETS-1);
+	}
+};
+
+//
+// Lookups from script call sites, and from native event calls.
+//
+CORE_API extern FFunctionCache GCallSiteCache;
+CORE_API extern FFunctionCache GEventCache;
+
+/*-----------------------------------------------------------------------------
+	Script profiler.
+-----------------------------------------------------------------------------*/
+
+//
+// A node in the profiler's call tree: a function or state's code, reached
+// along one path of calls.
+//
+struct FScriptProfileNode
+{
+	UStruct*	Code;			// Function or state whose code ran.
+	INT			Parent;			// Node of the caller.
+	INT			FirstChild;		// First callee node.
+	INT			NextSibling;	// Next callee of the same caller.
+	SQWORD		Calls;
+	SQWORD		Inclusive;		// Cycles including callees.
+	SQWORD		Exclusive;		// Cycles excluding callees.
+};
+
+//
+// Script time spent by the objects of one class.
+//
+struct FScriptClassProfile
+{
+	SQWORD		Calls;
+	SQWORD		Exclusive;
+};
+
+//
+// Records which script functions, and which classes' objects, take up script
+// time while SCRIPTPROF is running.  Calls are entered into a tree by call
+// path, from which per-function totals and flame graphs are produced.
+//
+class CORE_API FScriptProfiler
+{
+public:
+	// Constants.
+	enum {MAX_DEPTH=256};
+
+	// An active call.
+	struct FProfileFrame
+	{
+		INT		Node;
+		UClass*	Class;
+		DWORD	StartCycles;
+		DWORD	ChildCycles;
+	};
+
+	// Variables.
+	TArray<FScriptProfileNode>			Nodes;		// Nodes(0) is the root.
+	TMap<UClass*,FScriptClassProfile>	Classes;
+	FProfileFrame						Stack[MAX_DEPTH];
+	INT									Depth;
+	INT									Overflow;	// Calls too deep to record.
+	DOUBLE								StartTime, StopTime;
+
+	// Constructor.
+	FScriptProfiler();
+
+	// Recording.
+	void Enter( UObject* Object, UStruct* Code )
+	{
+		if( Depth>=MAX_DEPTH )
+		{
+			Overflow++;
+			return;
+		}
+		INT Parent = Depth ? Stack[Depth-1].Node : 0, i;
+		for( i=Nodes(Parent).FirstChild; i!=INDEX_NONE && Nodes(i).Code!=Code; i=Nodes(i).NextSibling );
+		if( i==INDEX_NONE )
+			i = AddNode( Parent, Code );
+		FProfileFrame& Frame = Stack[Depth++];
+		Frame.Node        = i;
+		Frame.Class       = Object->GetClass();
+		Frame.ChildCycles = 0;
+		Frame.StartCycles = appCycles();
+	}
+	void Exit()
+	{
+		DWORD EndCycles = appCycles();
+		if( Overflow )
+			Overflow--;
+		else if( Depth )
+			Record( EndCycles );
+	}
+
+	// Reporting.
+	void Dump( FOutputDevice& Ar );
+	UBOOL SaveFlameGraph( const TCHAR* Filename );
+	static UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar );
+
+	// Implementation.
+	INT AddNode( INT Parent, UStruct* Code );
+	void Record( DWORD EndCycles );
+};
+
+//
+// The running profiler, or NULL if not profiling.
+//
+CORE_API extern FScriptProfiler* GScriptProfiler;
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
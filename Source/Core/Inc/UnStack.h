@@ -78,6 +78,7 @@ enum EExprToken
 	EX_LocalVariable		= 0x00,	// A local variable.
 	EX_InstanceVariable		= 0x01,	// An object variable.
 	EX_DefaultVariable		= 0x02,	// Default variable for a concrete object.
+	EX_LocalDWordVariable	= 0x03,	// Quickened EX_LocalVariable of a 32-bit value.
 
 	// Tokens.
 	EX_Return				= 0x04,	// Return from function.
@@ -97,7 +98,7 @@ enum EExprToken
 	EX_ClassContext         = 0x12, // Class default metaobject context.
 	EX_MetaCast             = 0x13, // Metaclass cast.
 	EX_LetBool				= 0x14, // Let boolean variable.
-	//
+	EX_InstanceDWordVariable= 0x15,	// Quickened EX_InstanceVariable of a 32-bit value.
 	EX_EndFunctionParms		= 0x16,	// End of function call parameters.
 	EX_Self					= 0x17,	// Self object.
 	EX_Skip					= 0x18,	// Skippable expression.
@@ -119,6 +120,7 @@ enum EExprToken
 	EX_False				= 0x28,	// Bool False.
 	EX_NativeParm           = 0x29, // Native function parameter offset.
 	EX_NoObject				= 0x2A,	// NoObject.
+	EX_QuickBoolVariable	= 0x2B,	// Quickened EX_BoolVariable of a local or instance variable.
 	EX_IntConstByte			= 0x2C,	// Int constant that requires 1 byte.
 	EX_BoolVariable			= 0x2D,	// A bool variable which requires a bitmask.
 	EX_DynamicCast			= 0x2E,	// Safe dynamic class casting.
@@ -128,7 +130,7 @@ enum EExprToken
 	EX_StructCmpEq          = 0x32,	// Struct binary compare-for-equal.
 	EX_StructCmpNe          = 0x33,	// Struct binary compare-for-unequal.
 	EX_UnicodeStringConst   = 0x34, // Unicode string constant.
-	//
+	EX_JumpIfNotBoolVariable= 0x35,	// Quickened EX_JumpIfNot testing a local or instance bool.
 	EX_StructMember         = 0x36, // Struct member.
 	//
 	EX_GlobalFunction		= 0x38, // Call non-state version of a function.
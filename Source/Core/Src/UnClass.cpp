@@ -400,8 +400,10 @@ void UStruct::Link( FArchive& Ar, UBOOL Props )
 	{
 		if( (ItC->PropertyFlags & CPF_Net) && !GIsEditor )
 		{
+			// Walking the condition also restores any tokens quickened by
+			// running it, so conditions compare as compiled.
 			ItC->RepOwner = *ItC;
-			FArchive TempAr;
+			FArchiveUnquicken TempAr;
 			INT iCode = ItC->RepOffset;
 			ItC->GetOwnerClass()->SerializeExpr( iCode, TempAr );
 			Map.Set( *ItC, iCode );
@@ -586,6 +588,7 @@ void UStruct::SerializeTaggedProperties( FArchive& Ar, BYTE* Data, UClass* Defau
 void UStruct::Destroy()
 {
 	guard(UStruct::Destroy);
+	FFunctionCache::Flush();
 	Script.Empty();
 	Super::Destroy();
 	unguard;
@@ -725,7 +728,8 @@ void UState::Link( FArchive& Ar, UBOOL Props )
 	guard(UState::Link);
 	Super::Link( Ar, Props );
 
-	// Initialize hash.
+	// Initialize hash, and forget functions found through the old one.
+	FFunctionCache::Flush();
 	if( GetSuperState() )
 		appMemcpy( VfHash, GetSuperState()->VfHash, sizeof(VfHash) );
 	else
@@ -1100,9 +1104,12 @@ EExprToken UStruct::SerializeExpr( INT& iCode, FArchive& Ar )
 	#define XFER(T) {Ar << *(T*)&Script(iCode); iCode += sizeof(T); }
 	#endif
 
-	// Get expr token.
+	// Get expr token.  Quickened tokens are saved, and walked, as the
+	// tokens they were rewritten from.
+	if( Ar.IsSaving() )
+		Script(iCode) = UnquickenToken( Script(iCode) );
 	XFER(BYTE);
-	Expr = (EExprToken)Script(iCode-1);
+	Expr = (EExprToken)UnquickenToken( Script(iCode-1) );
 	if( Expr >= EX_MinConversion && Expr < EX_MaxConversion )
 	{
 		// A type conversion.
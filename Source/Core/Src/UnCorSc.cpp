@@ -18,6 +18,15 @@ Revision history:
 
 CORE_API void (UObject::*GNatives[EX_Max])( FFrame &Stack, RESULT_DECL );
 CORE_API INT GNativeDuplicate=0;
+CORE_API FScriptProfiler* GScriptProfiler=NULL;
+CORE_API UBOOL GScriptQuicken=1;
+CORE_API INT GScriptQuickened=0;
+CORE_API DWORD GScriptSteps=0;
+CORE_API FFunctionCache GCallSiteCache;
+CORE_API FFunctionCache GEventCache;
+INT FFunctionCache::Generation=1;
+UBOOL FFunctionCache::Enabled=1;
+static FScriptProfiler* GStoppedScriptProfiler=NULL;
 
 #define RUNAWAY_LIMIT 10000000
 #define RECURSE_LIMIT 250
@@ -201,6 +210,20 @@ void UObject::execUndefined( FFrame& Stack, RESULT_DECL  )
 // Variables //
 ///////////////
 
+//
+// Whether a variable's value can be copied as a single DWORD.
+//
+static inline UBOOL IsDWordProperty( UProperty* Property )
+{
+	return
+		Property->ArrayDim==1
+	&&	Property->ElementSize==sizeof(DWORD)
+	&&	(	Property->IsA(UIntProperty::StaticClass())
+		||	Property->IsA(UFloatProperty::StaticClass())
+		||	Property->IsA(UObjectProperty::StaticClass())
+		||	Property->IsA(UNameProperty::StaticClass()) );
+}
+
 void UObject::execLocalVariable( FFrame& Stack, RESULT_DECL )
 {
 	guardSlow(UObject::execLocalVariable);
@@ -211,11 +234,29 @@ void UObject::execLocalVariable( FFrame& Stack, RESULT_DECL )
 	GPropAddr = Stack.Locals + GProperty->Offset;
 	if( Result )
 		GProperty->CopyCompleteValue( Result, GPropAddr );
+	if( GScriptQuicken && IsDWordProperty(GProperty) )
+	{
+		Stack.Code[-1-(INT)sizeof(INT)] = EX_LocalDWordVariable;
+		GScriptQuickened++;
+	}
 
 	unguardexecSlow;
 }
 IMPLEMENT_FUNCTION( UObject, EX_LocalVariable, execLocalVariable );
 
+void UObject::execLocalDWordVariable( FFrame& Stack, RESULT_DECL )
+{
+	guardSlow(UObject::execLocalDWordVariable);
+
+	GProperty = (UProperty*)Stack.ReadObject();
+	GPropAddr = Stack.Locals + GProperty->Offset;
+	if( Result )
+		*(DWORD*)Result = *(DWORD*)GPropAddr;
+
+	unguardexecSlow;
+}
+IMPLEMENT_FUNCTION( UObject, EX_LocalDWordVariable, execLocalDWordVariable );
+
 void UObject::execInstanceVariable( FFrame& Stack, RESULT_DECL )
 {
 	guardSlow(UObject::execInstanceVariable);
@@ -224,11 +265,29 @@ void UObject::execInstanceVariable( FFrame& Stack, RESULT_DECL )
 	GPropAddr = (BYTE*)this + GProperty->Offset;
 	if( Result )
 		GProperty->CopyCompleteValue( Result, GPropAddr );
+	if( GScriptQuicken && IsDWordProperty(GProperty) )
+	{
+		Stack.Code[-1-(INT)sizeof(INT)] = EX_InstanceDWordVariable;
+		GScriptQuickened++;
+	}
 
 	unguardexecSlow;
 }
 IMPLEMENT_FUNCTION( UObject, EX_InstanceVariable, execInstanceVariable );
 
+void UObject::execInstanceDWordVariable( FFrame& Stack, RESULT_DECL )
+{
+	guardSlow(UObject::execInstanceDWordVariable);
+
+	GProperty = (UProperty*)Stack.ReadObject();
+	GPropAddr = (BYTE*)this + GProperty->Offset;
+	if( Result )
+		*(DWORD*)Result = *(DWORD*)GPropAddr;
+
+	unguardexecSlow;
+}
+IMPLEMENT_FUNCTION( UObject, EX_InstanceDWordVariable, execInstanceDWordVariable );
+
 void UObject::execDefaultVariable( FFrame& Stack, RESULT_DECL )
 {
 	guardSlow(UObject::execDefaultVariable);
@@ -358,11 +417,31 @@ void UObject::execBoolVariable( FFrame& Stack, RESULT_DECL )
 	// must take special precautions with bools.
 	if( Result )
 		*(BITFIELD*)Result = (GPropAddr && (*(BITFIELD*)GPropAddr & ((UBoolProperty*)GProperty)->BitMask)) ? 1 : 0;
+	if( GScriptQuicken && (B==EX_LocalVariable || B==EX_InstanceVariable) )
+	{
+		Stack.Code[-2-(INT)sizeof(INT)] = EX_QuickBoolVariable;
+		GScriptQuickened++;
+	}
 
 	unguardexecSlow;
 }
 IMPLEMENT_FUNCTION( UObject, EX_BoolVariable, execBoolVariable );
 
+void UObject::execQuickBoolVariable( FFrame& Stack, RESULT_DECL )
+{
+	guardSlow(UObject::execQuickBoolVariable);
+
+	// Get local or instance bool variable.
+	BYTE B    = *Stack.Code++;
+	GProperty = (UProperty*)Stack.ReadObject();
+	GPropAddr = (B==EX_LocalVariable ? Stack.Locals : (BYTE*)this) + GProperty->Offset;
+	if( Result )
+		*(BITFIELD*)Result = (*(BITFIELD*)GPropAddr & ((UBoolProperty*)GProperty)->BitMask) ? 1 : 0;
+
+	unguardexecSlow;
+}
+IMPLEMENT_FUNCTION( UObject, EX_QuickBoolVariable, execQuickBoolVariable );
+
 void UObject::execStructMember( FFrame& Stack, RESULT_DECL )
 {
 	guard(UObject::execStructMember);//!!
@@ -519,6 +598,16 @@ void UObject::execJumpIfNot( FFrame& Stack, RESULT_DECL )
 	// Get code offset.
 	INT wOffset = Stack.ReadWord();
 
+	// Fuse with the test if it's just a bool variable.
+	if
+	(	GScriptQuicken
+	&&	UnquickenToken(Stack.Code[0])==EX_BoolVariable
+	&&	(Stack.Code[1]==EX_LocalVariable || Stack.Code[1]==EX_InstanceVariable) )
+	{
+		Stack.Code[-1-(INT)sizeof(_WORD)] = EX_JumpIfNotBoolVariable;
+		GScriptQuickened++;
+	}
+
 	// Get boolean test value.
 	UBOOL Value=0;
 	Stack.Step( Stack.Object, &Value );
@@ -531,6 +620,28 @@ void UObject::execJumpIfNot( FFrame& Stack, RESULT_DECL )
 }
 IMPLEMENT_FUNCTION( UObject, EX_JumpIfNot, execJumpIfNot );
 
+void UObject::execJumpIfNotBoolVariable( FFrame& Stack, RESULT_DECL )
+{
+	guardSlow(UObject::execJumpIfNotBoolVariable);
+	CHECK_RUNAWAY;
+
+	// Get code offset.
+	INT wOffset = Stack.ReadWord();
+
+	// Get local or instance bool variable.
+	Stack.Code++;
+	BYTE B    = *Stack.Code++;
+	GProperty = (UProperty*)Stack.ReadObject();
+	GPropAddr = (B==EX_LocalVariable ? Stack.Locals : (BYTE*)this) + GProperty->Offset;
+
+	// Jump if false.
+	if( !(*(BITFIELD*)GPropAddr & ((UBoolProperty*)GProperty)->BitMask) )
+		Stack.Code = &Stack.Node->Script( wOffset );
+
+	unguardexecSlow;
+}
+IMPLEMENT_FUNCTION( UObject, EX_JumpIfNotBoolVariable, execJumpIfNotBoolVariable );
+
 void UObject::execAssert( FFrame& Stack, RESULT_DECL )
 {
 	guardSlow(UObject::execAssert);
@@ -662,8 +773,18 @@ void UObject::execVirtualFunction( FFrame& Stack, RESULT_DECL )
 {
 	guardSlow(UObject::execVirtualFunction);
 
-	// Call the virtual function.
-	CallFunction( Stack, Result, FindFunctionChecked(Stack.ReadName()) );
+	// Call the virtual function, looking it up if this site hasn't yet
+	// called it on this class in this state.
+	const BYTE* Site     = Stack.Code;
+	FName       Name     = Stack.ReadName();
+	UState*     State    = StateFrame ? StateFrame->StateNode : NULL;
+	UFunction*  Function = GCallSiteCache.Find( Site, Name, GetClass(), State );
+	if( !Function )
+	{
+		Function = FindFunctionChecked( Name );
+		GCallSiteCache.Add( Site, Name, GetClass(), State, Function );
+	}
+	CallFunction( Stack, Result, Function );
 
 	unguardexecSlow;
 }
@@ -685,7 +806,15 @@ void UObject::execGlobalFunction( FFrame& Stack, RESULT_DECL )
 	guardSlow(UObject::execGlobalFunction);
 
 	// Call global version of virtual function.
-	CallFunction( Stack, Result, FindFunctionChecked(Stack.ReadName(),1) );
+	const BYTE* Site     = Stack.Code;
+	FName       Name     = Stack.ReadName();
+	UFunction*  Function = GCallSiteCache.Find( Site, Name, GetClass(), NULL );
+	if( !Function )
+	{
+		Function = FindFunctionChecked( Name, 1 );
+		GCallSiteCache.Add( Site, Name, GetClass(), NULL, Function );
+	}
+	CallFunction( Stack, Result, Function );
 
 	unguardexecSlow;
 }
@@ -3621,6 +3750,8 @@ void UObject::CallFunction( FFrame& Stack, RESULT_DECL, UFunction* Function )
 #if DO_GUARD_SLOW
 	DWORD Cycles=0; clock(Cycles);
 #endif
+	if( GScriptProfiler )
+		GScriptProfiler->Enter( this, Function );
 	// Found it.
 	UBOOL SkipIt = 0;
 	if( Function->iNative )
@@ -3677,6 +3808,8 @@ void UObject::CallFunction( FFrame& Stack, RESULT_DECL, UFunction* Function )
 		for( UProperty* Destruct=Function->ConstructorLink; Destruct; Destruct=Destruct->ConstructorLinkNext )
 			Destruct->DestroyValue( NewStack.Locals + Destruct->Offset );
 	}
+	if( GScriptProfiler )
+		GScriptProfiler->Exit();
 #if DO_GUARD_SLOW
 	unclock(Cycles);
 	Function->Cycles += Cycles;
@@ -3737,6 +3870,8 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms, void* UnusedResult
 	// Start timer.
 	if( ++GScriptEntryTag == 1 )
 		clock(GScriptCycles);
+	if( GScriptProfiler )
+		GScriptProfiler->Enter( this, Function );
 
 	// Create a new local execution stack.
 	FFrame NewStack( this, Function, 0, appAlloca(Function->PropertiesSize) );
@@ -3755,6 +3890,8 @@ void UObject::ProcessEvent( UFunction* Function, void* Parms, void* UnusedResult
 			P->DestroyValue( NewStack.Locals + P->Offset );
 
 	// Stop timer.
+	if( GScriptProfiler )
+		GScriptProfiler->Exit();
 	if( --GScriptEntryTag == 0 )
 		unclock(GScriptCycles);
 
@@ -3775,6 +3912,482 @@ UBOOL UObject::ProcessRemoteFunction( UFunction* Function, void* Parms, FFrame*
 	return 0;
 }
 
+/*-----------------------------------------------------------------------------
+	Quickening.
+-----------------------------------------------------------------------------*/
+
+//
+// Rewrite every quickened token as the token it came from.
+//
+void UnquickenScripts()
+{
+	guard(UnquickenScripts);
+	FArchiveUnquicken Ar;
+	for( TObjectIterator<UStruct> It; It; ++It )
+	{
+		INT iCode = 0;
+		while( iCode < It->Script.Num() )
+			It->SerializeExpr( iCode, Ar );
+	}
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Script VM benchmark.
+-----------------------------------------------------------------------------*/
+
+// Object natives used by the benchmark workload.
+enum
+{
+	NATIVE_Not_PreBool		= 129,
+	NATIVE_Add_IntInt		= 146,
+	NATIVE_Subtract_IntInt	= 147,
+	NATIVE_Less_IntInt		= 150,
+};
+
+static void EmitWord( TArray<BYTE>& Script, _WORD Value )
+{
+	appMemcpy( &Script(Script.Add(sizeof(_WORD))), &Value, sizeof(_WORD) );
+}
+static void PatchWord( TArray<BYTE>& Script, INT Offset, _WORD Value )
+{
+	appMemcpy( &Script(Offset), &Value, sizeof(_WORD) );
+}
+static void EmitInt( TArray<BYTE>& Script, INT Value )
+{
+	appMemcpy( &Script(Script.Add(sizeof(INT))), &Value, sizeof(INT) );
+}
+static void EmitLocal( TArray<BYTE>& Script, UProperty* Property )
+{
+	Script.AddItem( EX_LocalVariable );
+	appMemcpy( &Script(Script.Add(sizeof(INT))), &Property, sizeof(INT) );
+}
+
+//
+// Assemble the benchmark workload, as the compiler would for:
+//
+//	Sum = 0; I = 0; bOdd = false;
+//	while( I < Count )
+//	{
+//		Sum = Sum + I;
+//		bOdd = !bOdd;
+//		if( bOdd )
+//			Sum = Sum - 1;
+//		I = I + 1;
+//	}
+//
+// It runs 21 tokens per pass, 5 more on odd passes, and 13 outside the loop.
+//
+static void AssembleVMBenchmark( TArray<BYTE>& S, UProperty* I, UProperty* Sum, UProperty* Odd, INT Count )
+{
+	S.Empty();
+	S.AddItem( EX_Let     );                          EmitLocal( S, Sum ); S.AddItem( EX_IntZero );
+	S.AddItem( EX_Let     );                          EmitLocal( S, I   ); S.AddItem( EX_IntZero );
+	S.AddItem( EX_LetBool ); S.AddItem( EX_BoolVariable ); EmitLocal( S, Odd ); S.AddItem( EX_False   );
+
+	INT Loop = S.Num();
+	S.AddItem( EX_JumpIfNot ); INT End = S.Num(); EmitWord( S, 0 );
+	S.AddItem( NATIVE_Less_IntInt ); EmitLocal( S, I ); S.AddItem( EX_IntConst ); EmitInt( S, Count ); S.AddItem( EX_EndFunctionParms );
+
+	S.AddItem( EX_Let ); EmitLocal( S, Sum );
+	S.AddItem( NATIVE_Add_IntInt ); EmitLocal( S, Sum ); EmitLocal( S, I ); S.AddItem( EX_EndFunctionParms );
+
+	S.AddItem( EX_LetBool ); S.AddItem( EX_BoolVariable ); EmitLocal( S, Odd );
+	S.AddItem( NATIVE_Not_PreBool ); S.AddItem( EX_BoolVariable ); EmitLocal( S, Odd ); S.AddItem( EX_EndFunctionParms );
+
+	S.AddItem( EX_JumpIfNot ); INT Skip = S.Num(); EmitWord( S, 0 );
+	S.AddItem( EX_BoolVariable ); EmitLocal( S, Odd );
+	S.AddItem( EX_Let ); EmitLocal( S, Sum );
+	S.AddItem( NATIVE_Subtract_IntInt ); EmitLocal( S, Sum ); S.AddItem( EX_IntOne ); S.AddItem( EX_EndFunctionParms );
+	PatchWord( S, Skip, S.Num() );
+
+	S.AddItem( EX_Let ); EmitLocal( S, I );
+	S.AddItem( NATIVE_Add_IntInt ); EmitLocal( S, I ); S.AddItem( EX_IntOne ); S.AddItem( EX_EndFunctionParms );
+	S.AddItem( EX_Jump ); EmitWord( S, Loop );
+	PatchWord( S, End, S.Num() );
+
+	S.AddItem( EX_Return ); S.AddItem( EX_Nothing );
+}
+
+//
+// Time a fixed script workload run with quickening off, then on, and log
+// the bytecodes per second of each.  Bytecodes are those of the workload
+// as compiled, so fused tokens count as the ones they replace.
+//
+void BenchmarkScriptVM( FOutputDevice& Ar )
+{
+	guard(BenchmarkScriptVM);
+	enum {NUM_PASSES=10000, NUM_RUNS=50};
+	DWORD NumTokens = (21*NUM_PASSES + 5*((NUM_PASSES+1)/2) + 13) * NUM_RUNS;
+	INT   Expected  = NUM_PASSES*(NUM_PASSES-1)/2 - (NUM_PASSES+1)/2;
+
+	// A transient function with three locals.
+	UFunction*     Function = new UFunction( (UFunction*)NULL );
+	UIntProperty*  I        = new(Function)UIntProperty ( EC_CppProperty, 0*sizeof(INT), TEXT(""), 0 );
+	UIntProperty*  Sum      = new(Function)UIntProperty ( EC_CppProperty, 1*sizeof(INT), TEXT(""), 0 );
+	UBoolProperty* Odd      = new(Function)UBoolProperty( EC_CppProperty, 2*sizeof(INT), TEXT(""), 0 );
+	I->ElementSize = Sum->ElementSize = Odd->ElementSize = sizeof(INT);
+	UObject* Object = UObject::StaticClass()->GetDefaultObject();
+
+	UBOOL SavedQuicken   = GScriptQuicken;
+	INT   SavedQuickened = GScriptQuickened;
+	DWORD SavedSteps     = GScriptSteps;
+	DOUBLE Times[2];
+	INT    Sums[2];
+	DWORD  Steps[2];
+	for( INT Quicken=0; Quicken<2; Quicken++ )
+	{
+		AssembleVMBenchmark( Function->Script, I, Sum, Odd, NUM_PASSES );
+		GScriptQuicken = Quicken;
+		GScriptSteps   = 0;
+		DOUBLE StartTime = appSeconds();
+		for( INT Run=0; Run<NUM_RUNS; Run++ )
+		{
+			INT  Locals[3] = {0,0,0};
+			BYTE Buffer[MAX_CONST_SIZE];
+			FFrame Stack( Object, Function, 0, Locals );
+			while( *Stack.Code != EX_Return )
+				Stack.Step( Stack.Object, Buffer );
+			Sums[Quicken] = Locals[1];
+		}
+		Times[Quicken] = appSeconds() - StartTime;
+		Steps[Quicken] = GScriptSteps;
+	}
+	GScriptQuicken   = SavedQuicken;
+	GScriptQuickened = SavedQuickened;
+	GScriptSteps     = SavedSteps;
+
+	Ar.Logf
+	(
+		TEXT("%i passes, %i runs, %u bytecodes: unquickened %.2f M/sec, quickened %.2f M/sec (%.2fx)"),
+		NUM_PASSES,
+		NUM_RUNS,
+		NumTokens,
+		NumTokens / Max(Times[0],0.000001) / 1000000.0,
+		NumTokens / Max(Times[1],0.000001) / 1000000.0,
+		Times[0] / Max(Times[1],0.000001)
+	);
+	if( Sums[0]!=Expected || Sums[1]!=Expected )
+		Ar.Logf( TEXT("WRONG RESULT: expected %i, unquickened %i, quickened %i"), Expected, Sums[0], Sums[1] );
+#if DO_SCRIPT_STATS
+	if( Steps[0]!=NumTokens )
+		Ar.Logf( TEXT("Dispatched %u bytecodes unquickened, expected %u"), Steps[0], NumTokens );
+	Ar.Logf( TEXT("Dispatched %u tokens quickened"), Steps[1] );
+#endif
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Function cache benchmark.
+-----------------------------------------------------------------------------*/
+
+//
+// Time resolving every function of the loaded classes as a virtual call
+// does, by searching the class as uncached calls do and through a call
+// site cache, so the call rates with and without the cache can be compared.
+//
+void FFunctionCache::Benchmark( FOutputDevice& Ar )
+{
+	guard(FFunctionCache::Benchmark);
+	enum {MAX_CALLS=4096, NUM_REPS=100};
+	struct FCall
+	{
+		UObject*	Object;
+		FName		Name;
+		const BYTE*	Site;
+	};
+
+	// One call site per function, made on its class's default object.
+	TArray<FCall> Calls;
+	for( TObjectIterator<UClass> It; It && Calls.Num()<MAX_CALLS; ++It )
+	{
+		if( !It->Defaults.Num() || It->Defaults.Num()!=It->GetPropertiesSize() )
+			continue;
+		for( TFieldIterator<UFunction> Fn(*It); Fn && Calls.Num()<MAX_CALLS; ++Fn )
+		{
+			if( Fn->GetOuter()!=*It )
+				continue;
+			FCall& Call = Calls(Calls.Add());
+			Call.Object = It->GetDefaultObject();
+			Call.Name   = Fn->GetFName();
+			Call.Site   = (const BYTE*)*Fn;
+		}
+	}
+	if( !Calls.Num() )
+	{
+		Ar.Logf( TEXT("No script functions loaded") );
+		return;
+	}
+
+	// Uncached, as every virtual call used to.
+	INT Rep, i, NumMismatched=0;
+	DOUBLE StartTime = appSeconds();
+	for( Rep=0; Rep<NUM_REPS; Rep++ )
+		for( i=0; i<Calls.Num(); i++ )
+			Calls(i).Object->FindObjectField( Calls(i).Name );
+	DOUBLE SearchTime = appSeconds() - StartTime;
+
+	// Through a cache of the same size as GCallSiteCache.
+	FFunctionCache* Cache = new FFunctionCache;
+	UBOOL SavedEnabled = Enabled;
+	Enabled = 1;
+	StartTime = appSeconds();
+	for( Rep=0; Rep<NUM_REPS; Rep++ )
+	{
+		for( i=0; i<Calls.Num(); i++ )
+		{
+			FCall&     Call     = Calls(i);
+			UFunction* Function = Cache->Find( Call.Site, Call.Name, Call.Object->GetClass(), NULL );
+			if( !Function )
+			{
+				Function = (UFunction*)Call.Object->FindObjectField( Call.Name );
+				Cache->Add( Call.Site, Call.Name, Call.Object->GetClass(), NULL, Function );
+			}
+		}
+	}
+	DOUBLE CacheTime = appSeconds() - StartTime;
+	Enabled = SavedEnabled;
+	for( i=0; i<Calls.Num(); i++ )
+		if( Cache->Find(Calls(i).Site, Calls(i).Name, Calls(i).Object->GetClass(), NULL)!=Calls(i).Object->FindObjectField(Calls(i).Name) )
+			NumMismatched++;
+
+	INT NumCalls = Calls.Num() * NUM_REPS;
+	Ar.Logf
+	(
+		TEXT("%i call sites, %i reps: uncached %.2f Mcalls/sec, cached %.2f Mcalls/sec (%.0f%% hits)%s"),
+		Calls.Num(),
+		NUM_REPS,
+		NumCalls / Max(SearchTime,0.000001) / 1000000.0,
+		NumCalls / Max(CacheTime, 0.000001) / 1000000.0,
+		100.0 * Cache->Hits / Max(Cache->Hits + Cache->Misses, 1),
+		NumMismatched ? *FString::Printf(TEXT(", %i MISMATCHED"),NumMismatched) : TEXT("")
+	);
+	delete Cache;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	Script profiler.
+-----------------------------------------------------------------------------*/
+
+FScriptProfiler::FScriptProfiler()
+:	Depth		( 0 )
+,	Overflow	( 0 )
+,	StartTime	( appSeconds() )
+,	StopTime	( 0.0 )
+{
+	AddNode( INDEX_NONE, NULL );
+}
+
+INT FScriptProfiler::AddNode( INT Parent, UStruct* Code )
+{
+	INT i = Nodes.Add();
+	FScriptProfileNode& Node = Nodes(i);
+	Node.Code        = Code;
+	Node.Parent      = Parent;
+	Node.FirstChild  = INDEX_NONE;
+	Node.NextSibling = INDEX_NONE;
+	Node.Calls       = Node.Inclusive = Node.Exclusive = 0;
+	if( Parent!=INDEX_NONE )
+	{
+		Node.NextSibling         = Nodes(Parent).FirstChild;
+		Nodes(Parent).FirstChild = i;
+	}
+	return i;
+}
+
+void FScriptProfiler::Record( DWORD EndCycles )
+{
+	FProfileFrame& Frame = Stack[--Depth];
+	DWORD Total = EndCycles - Frame.StartCycles;
+	DWORD Own   = Total - Frame.ChildCycles;
+	FScriptProfileNode& Node = Nodes(Frame.Node);
+	Node.Calls++;
+	Node.Inclusive += Total;
+	Node.Exclusive += Own;
+	FScriptClassProfile* Class = Classes.Find( Frame.Class );
+	if( !Class )
+	{
+		FScriptClassProfile New = {0,0};
+		Class = &Classes.Set( Frame.Class, New );
+	}
+	Class->Calls++;
+	Class->Exclusive += Own;
+	if( Depth )
+		Stack[Depth-1].ChildCycles += Total;
+}
+
+//
+// Name of the function or state a node ran, with the class defining it.
+//
+static FString ProfileNodeName( UStruct* Code )
+{
+	UClass* Class = Code->GetOwnerClass();
+	if( Code->IsA(UFunction::StaticClass()) )
+		return FString::Printf( TEXT("%s.%s"), Class->GetName(), Code->GetName() );
+	else
+		return FString::Printf( TEXT("%s.%s.StateCode"), Class->GetName(), Code->GetName() );
+}
+
+struct FScriptProfileTotal
+{
+	UObject*	Object;			// Function, state or class.
+	SQWORD		Calls;
+	SQWORD		Inclusive;
+	SQWORD		Exclusive;
+};
+static QSORT_RETURN CDECL CompareProfileTotals( const FScriptProfileTotal* A, const FScriptProfileTotal* B )
+{
+	return B->Exclusive>A->Exclusive ? 1 : B->Exclusive<A->Exclusive ? -1 : 0;
+}
+
+//
+// Log the functions and classes taking the most script time.
+//
+void FScriptProfiler::Dump( FOutputDevice& Ar )
+{
+	guard(FScriptProfiler::Dump);
+	DOUBLE Seconds = (StopTime!=0.0 ? StopTime : appSeconds()) - StartTime;
+	DOUBLE MSec    = GSecondsPerCycle * 1000.0;
+
+	// Sum nodes by function.  Inclusive time of recursive calls is only
+	// counted at the outermost call.
+	TArray<FScriptProfileTotal> Functions;
+	TMap<UStruct*,INT> FunctionMap;
+	SQWORD TotalCycles = 0;
+	for( INT i=1; i<Nodes.Num(); i++ )
+	{
+		FScriptProfileNode& Node = Nodes(i);
+		INT* Found = FunctionMap.Find( Node.Code );
+		if( !Found )
+		{
+			FunctionMap.Set( Node.Code, Functions.Num() );
+			FScriptProfileTotal New = {Node.Code,0,0,0};
+			Functions.AddItem( New );
+			Found = FunctionMap.Find( Node.Code );
+		}
+		FScriptProfileTotal& Total = Functions(*Found);
+		Total.Calls     += Node.Calls;
+		Total.Exclusive += Node.Exclusive;
+		INT Outer = Node.Parent;
+		while( Outer>0 && Nodes(Outer).Code!=Node.Code )
+			Outer = Nodes(Outer).Parent;
+		if( Outer<=0 )
+			Total.Inclusive += Node.Inclusive;
+		TotalCycles += Node.Exclusive;
+	}
+	if( Functions.Num() )
+		appQsort( &Functions(0), Functions.Num(), sizeof(FScriptProfileTotal), (QSORT_COMPARE)CompareProfileTotals );
+
+	Ar.Logf( TEXT("Script profile of %.1f seconds, %.1f msec of script:"), Seconds, MSec * TotalCycles );
+	Ar.Logf( TEXT("   %-48s %10s %12s %12s"), TEXT("Function"), TEXT("Calls"), TEXT("Incl msec"), TEXT("Excl msec") );
+	for( INT i=0; i<Functions.Num(); i++ )
+		Ar.Logf
+		(
+			TEXT("   %-48s %10i %12.2f %12.2f"),
+			*ProfileNodeName( (UStruct*)Functions(i).Object ),
+			(INT)Functions(i).Calls,
+			MSec * Functions(i).Inclusive,
+			MSec * Functions(i).Exclusive
+		);
+
+	// Classes of the objects running the script.
+	TArray<FScriptProfileTotal> ClassTotals;
+	for( TMap<UClass*,FScriptClassProfile>::TIterator It(Classes); It; ++It )
+	{
+		FScriptProfileTotal New = {It.Key(),It.Value().Calls,0,It.Value().Exclusive};
+		ClassTotals.AddItem( New );
+	}
+	if( ClassTotals.Num() )
+		appQsort( &ClassTotals(0), ClassTotals.Num(), sizeof(FScriptProfileTotal), (QSORT_COMPARE)CompareProfileTotals );
+	Ar.Logf( TEXT("   %-48s %10s %12s"), TEXT("Class"), TEXT("Calls"), TEXT("Excl msec") );
+	for( INT i=0; i<ClassTotals.Num(); i++ )
+		Ar.Logf
+		(
+			TEXT("   %-48s %10i %12.2f"),
+			ClassTotals(i).Object->GetName(),
+			(INT)ClassTotals(i).Calls,
+			MSec * ClassTotals(i).Exclusive
+		);
+	unguard;
+}
+
+//
+// Save the call tree as folded stacks, one line per call path with its
+// exclusive time in microseconds, as read by flame graph tools.
+//
+UBOOL FScriptProfiler::SaveFlameGraph( const TCHAR* Filename )
+{
+	guard(FScriptProfiler::SaveFlameGraph);
+	FString Result;
+	TArray<FString> Paths;
+	Paths.AddZeroed( Nodes.Num() );
+	for( INT i=1; i<Nodes.Num(); i++ )
+	{
+		// Parents are always added before their children.
+		FScriptProfileNode& Node = Nodes(i);
+		Paths(i) = Node.Parent>0 ? Paths(Node.Parent) + TEXT(";") + ProfileNodeName(Node.Code) : ProfileNodeName(Node.Code);
+		INT USec = appRound( GSecondsPerCycle * 1000000.0 * Node.Exclusive );
+		if( USec>0 )
+			Result += FString::Printf( TEXT("%s %i\r\n"), *Paths(i), USec );
+	}
+	return appSaveStringToFile( Result, Filename );
+	unguard;
+}
+
+//
+// SCRIPTPROF START, STOP, and DUMP [FILE=filename].
+//
+UBOOL FScriptProfiler::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
+{
+	guard(FScriptProfiler::Exec);
+	if( ParseCommand(&Cmd,TEXT("START")) )
+	{
+		if( GStoppedScriptProfiler )
+			delete GStoppedScriptProfiler;
+		GStoppedScriptProfiler = NULL;
+		if( GScriptProfiler )
+			delete GScriptProfiler;
+		GScriptProfiler = new FScriptProfiler;
+		Ar.Log( TEXT("Script profiling started") );
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("STOP")) )
+	{
+		if( GScriptProfiler )
+		{
+			GScriptProfiler->StopTime = appSeconds();
+			GStoppedScriptProfiler    = GScriptProfiler;
+			GScriptProfiler           = NULL;
+			Ar.Log( TEXT("Script profiling stopped") );
+		}
+		else Ar.Log( TEXT("Script profiling is not running") );
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("DUMP")) )
+	{
+		FScriptProfiler* Profiler = GScriptProfiler ? GScriptProfiler : GStoppedScriptProfiler;
+		TCHAR Filename[256];
+		if( !Profiler )
+			Ar.Log( TEXT("No script profile; use SCRIPTPROF START") );
+		else if( Parse(Cmd,TEXT("FILE="),Filename,ARRAY_COUNT(Filename)) )
+		{
+			if( Profiler->SaveFlameGraph(Filename) )
+				Ar.Logf( TEXT("Script profile saved to %s"), Filename );
+			else
+				Ar.Logf( TEXT("Couldn't save script profile to %s"), Filename );
+		}
+		else Profiler->Dump( Ar );
+		return 1;
+	}
+	else
+	{
+		Ar.Log( TEXT("Usage: SCRIPTPROF START|STOP|DUMP [FILE=filename]") );
+		return 1;
+	}
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -734,12 +734,17 @@ UFunction* UObject::FindFunctionChecked( FName InName, UBOOL Global )
 	guardSlow(UObject::FindFunctionChecked);
 	if( !GIsScriptable )
 		return NULL;
-	UFunction* Result = Cast<UFunction>( FindObjectField( InName, Global ) );
+	UState*    State  = (StateFrame && !Global) ? StateFrame->StateNode : NULL;
+	UFunction* Result = GEventCache.Find( NULL, InName, GetClass(), State );
+	if( Result )
+		return Result;
+	Result = Cast<UFunction>( FindObjectField( InName, Global ) );
 	if( !Result )
 	{
 		debugf(TEXT("DEBUG: FindFunctionChecked: InName='%s' (%d), Global=%d, GetFullName()='%s'"), *InName, InName.GetIndex(), Global, GetFullName());
 		appErrorf( TEXT("Failed to find function %s in %s"), *InName, GetFullName() );
 	}
+	GEventCache.Add( NULL, InName, GetClass(), State, Result );
 	return Result;
 	unguardfSlow(( TEXT("%s (function %s)"), GetFullName(), *InName ));
 }
@@ -1301,6 +1306,7 @@ void UObject::StaticInit()
 	// Development.
 	GCheckConflicts = ParseParam(appCmdLine(),TEXT("CONFLICTS"));
 	GNoGC           = ParseParam(appCmdLine(),TEXT("NOGC"));
+	GScriptQuicken  = !ParseParam(appCmdLine(),TEXT("NOQUICKEN"));
 
 	// Init hash.
 	for( INT i=0; i<ARRAY_COUNT(GObjHash); i++ )
@@ -1718,6 +1724,59 @@ UBOOL UObject::StaticExec( const TCHAR* Cmd, FOutputDevice& Ar )
 		return 1;
 	}
 #endif
+	else if( ParseCommand(&Str,TEXT("SCRIPTPROF")) )
+	{
+		return FScriptProfiler::Exec( Str, Ar );
+	}
+	else if( ParseCommand(&Str,TEXT("SCRIPTVM")) )
+	{
+		static DOUBLE LastTime = appSeconds();
+		if( ParseCommand(&Str,TEXT("BENCH")) )
+		{
+			BenchmarkScriptVM( Ar );
+			return 1;
+		}
+		else if( ParseCommand(&Str,TEXT("QUICKEN")) )
+			GScriptQuicken = 1;
+		else if( ParseCommand(&Str,TEXT("NOQUICKEN")) )
+		{
+			GScriptQuicken = 0;
+			UnquickenScripts();
+		}
+		DOUBLE Time = appSeconds();
+		Ar.Logf( TEXT("Quickening %s, %i tokens quickened"), GScriptQuicken ? TEXT("on") : TEXT("off"), GScriptQuickened );
+#if DO_SCRIPT_STATS
+		Ar.Logf( TEXT("%u tokens in %.1f seconds, %.0f per second"), GScriptSteps, Time-LastTime, GScriptSteps / Max(Time-LastTime,0.001) );
+#else
+		Ar.Logf( TEXT("Tokens are only counted with DO_SCRIPT_STATS; use SCRIPTVM BENCH") );
+#endif
+		GScriptSteps = 0;
+		LastTime     = Time;
+		return 1;
+	}
+	else if( ParseCommand(&Str,TEXT("FUNCCACHE")) )
+	{
+		if( ParseCommand(&Str,TEXT("BENCH")) )
+		{
+			FFunctionCache::Benchmark( Ar );
+			return 1;
+		}
+		else if( ParseCommand(&Str,TEXT("ON")) )
+		{
+			FFunctionCache::Enabled = 1;
+			FFunctionCache::Flush();
+		}
+		else if( ParseCommand(&Str,TEXT("OFF")) )
+		{
+			// To compare script performance in a match without the caches.
+			FFunctionCache::Enabled = 0;
+		}
+		Ar.Logf( TEXT("Function caches %s"), FFunctionCache::Enabled ? TEXT("on") : TEXT("off") );
+		Ar.Logf( TEXT("Call sites: %i hits, %i misses"), GCallSiteCache.Hits, GCallSiteCache.Misses );
+		Ar.Logf( TEXT("Events: %i hits, %i misses"), GEventCache.Hits, GEventCache.Misses );
+		GCallSiteCache.Hits = GCallSiteCache.Misses = GEventCache.Hits = GEventCache.Misses = 0;
+		return 1;
+	}
 	else if( ParseCommand(&Str,TEXT("DUMPNATIVES")) )
 	{
 		// Linux: Defined out because of error: "taking
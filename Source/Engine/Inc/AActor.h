@@ -12,6 +12,8 @@
 	virtual UBOOL ShouldDoScriptReplication() {return 1;}
 	void ProcessEvent( UFunction* Function, void* Parms, void* Result=NULL );
 	void ProcessState( FLOAT DeltaSeconds );
+	EGotoState GotoState( FName State );
+	INT GotoLabel( FName Label );
 	UBOOL ProcessRemoteFunction( UFunction* Function, void* Parms, FFrame* Stack );
 	void ProcessDemoRecFunction( UFunction* Function, void* Parms, FFrame* Stack );
 	void Serialize( FArchive& Ar );
@@ -53,11 +53,18 @@ ENGINE_API extern class FMemCache	GCache;
 #include "UnGame.h"				// Unreal game engine.
 #include "UnCamera.h"			// Viewport subsystem.
 #include "UnMesh.h"				// Mesh objects.
+#include "UnMeshLerp.h"			// Batched mesh frame interpolation.
 #include "UnActor.h"			// Actor inlines.
 #include "UnAudio.h"			// Audio code.
 #include "UnDynBsp.h"			// Dynamic Bsp objects.
 #include "UnScrTex.h"			// Scripted textures.
 #include "UnRenderIterator.h"	// Enhanced Actor Render Interface
+#include "UnStats.h"				// Sampled timing statistics.
+#include "UnPacing.h"			// Tick rate pacing.
+#include "UnNavGraph.h"			// Navigation search graph.
+#include "UnActorIndex.h"		// Per-class actor index.
+#include "UnBroadphase.h"		// Spatial actor lookup.
+#include "UnTickSchedule.h"		// Actor tick scheduling.
 
 /*-----------------------------------------------------------------------------
 	The End.
@@ -0,0 +1,52 @@
+/*=============================================================================
+	UnActorIndex.h: Per-class index of a level's actors.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FActorClassIndex.
+-----------------------------------------------------------------------------*/
+
+//
+// The actors of one class, as ascending indices into ULevel::Actors.
+//
+struct FActorClassList
+{
+	UClass*			Class;
+	TArray<INT>		Actors;
+};
+
+//
+// Which actors in the level belong to each class, so iterators over a class
+// visit only its actors and its subclasses' instead of the whole actor list.
+// Kept up to date by SpawnActor and DestroyActor, renumbered in place when
+// CompactActors closes the gaps they leave, and rebuilt whenever the actor
+// list is otherwise rearranged.
+//
+class ENGINE_API FActorClassIndex
+{
+public:
+	// Variables.
+	TArray<FActorClassList*>	Lists;
+	TMap<UClass*,INT>			ClassMap;		// Class to index into Lists.
+
+	// Stats.
+	INT NumQueries, NumScans, NumVisited, NumBuilds, NumCompacts;
+
+	// Constructor/destructor.
+	FActorClassIndex();
+	~FActorClassIndex();
+
+	// Functions.
+	void Build( ULevel* Level );
+	void AddActor( AActor* Actor, INT iActor );
+	void RemoveActor( AActor* Actor, INT iActor );
+	void Compact( const TArray<INT>& Removed );
+	UBOOL Gather( ULevel* Level, UClass* BaseClass, TArray<INT>& Result );
+	FString Describe() const;
+	void Benchmark( ULevel* Level, FOutputDevice& Ar );
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,83 @@
+/*=============================================================================
+	UnBroadphase.h: Spatial lookup of actors by location.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FActorBroadphase.
+-----------------------------------------------------------------------------*/
+
+//
+// Finds the actors near a point, for RadiusActors and VisibleActors.
+// Colliding cylinders are found through the level's collision hash.  All
+// other actors, including brushes whose collision box needn't contain their
+// location, are found in a coarse grid of actor locations kept here, which
+// SpawnActor, DestroyActor and the movement code keep up to date.
+//
+class ENGINE_API FActorBroadphase
+{
+public:
+	// Constants.
+	enum {BUCKET_BITS = 12  };
+	enum {NUM_BUCKETS = 1<<BUCKET_BITS};
+	enum {GRAN        = 512 };
+	enum {CELL_BITS   = 7   };
+	enum {NUM_CELLS   = 1<<CELL_BITS}; // Per axis, covering the world.
+	enum {OFS         = 32768};
+
+	// Linked list item.
+	struct FLink
+	{
+		AActor*	Actor;					// The actor, NULL if the link is free.
+		INT		Cell;					// Cell its location is in.
+		INT		Next;					// Next link in the bucket, or in the free list.
+	};
+
+	// Variables.
+	INT					Heads[NUM_BUCKETS];
+	TArray<FLink>		Links;
+	INT					FirstFree;
+	TMap<AActor*,INT>	LinkMap;		// Actor to its index in Links, if the link still holds it.
+	INT					NumActors;
+	INT					NumStale;		// Entries in LinkMap for removed actors.
+	FLOAT				MaxRadius;		// Largest CollisionRadius seen.
+
+	// Stats.
+	INT NumQueries, NumScans, NumCandidates, NumBuilds;
+
+	// Constructor.
+	FActorBroadphase();
+
+	// Functions.
+	void Build( ULevel* Level );
+	void AddActor( AActor* Actor );
+	void RemoveActor( AActor* Actor );
+	void MoveActor( AActor* Actor );
+	UBOOL Gather( ULevel* Level, FVector Location, FLOAT Radius, UBOOL bAddRadius, TArray<AActor*>& Result );
+	FString Describe() const;
+
+	// Implementation.
+	static UBOOL InHash( ULevel* Level, AActor* Actor )
+	{
+		return Level->Hash && Actor->bCollideActors && !Actor->Brush;
+	}
+	static void GetCell( FVector Location, INT& X, INT& Y, INT& Z )
+	{
+		X = Clamp<INT>( appFloor((Location.X + OFS) * (1.f/GRAN)), 0, NUM_CELLS-1 );
+		Y = Clamp<INT>( appFloor((Location.Y + OFS) * (1.f/GRAN)), 0, NUM_CELLS-1 );
+		Z = Clamp<INT>( appFloor((Location.Z + OFS) * (1.f/GRAN)), 0, NUM_CELLS-1 );
+	}
+	static INT GetCellIndex( INT X, INT Y, INT Z )
+	{
+		return X + (Y << CELL_BITS) + (Z << (CELL_BITS*2));
+	}
+	static INT GetBucket( INT Cell )
+	{
+		return ((DWORD)Cell * 0x9E3779B1) >> (32-BUCKET_BITS);
+	}
+	void Unlink( INT iLink );
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
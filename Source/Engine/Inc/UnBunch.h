@@ -16,6 +16,7 @@ public:
 	FOutBunch*		Next;
 	UChannel*		Channel;
 	DOUBLE			Time;
+	DOUBLE			FirstTime;
 	UBOOL			ReceivedAck;
 	INT				ChIndex;
 	INT				ChType;
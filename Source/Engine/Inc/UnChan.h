@@ -93,6 +93,135 @@ class ENGINE_API UControlChannel : public UChannel, public FOutputDevice
 	FString Describe();
 };
 
+/*-----------------------------------------------------------------------------
+	FRepSnapshot.
+-----------------------------------------------------------------------------*/
+
+enum {REPSNAPSHOT_MAX_BITS=4096}; // Largest property encoding shared.
+
+//
+// A property value encoded once for every channel sending it.
+//
+struct FRepEncoding
+{
+	INT				Serial;			// Baseline serial encoded, or 0.
+	INT				NumBits;		// Bits encoded, or -1 if too large to share.
+	TArray<BYTE>	Bits;			// The encoding.
+};
+
+//
+// Script replication conditions evaluated under one set of per-channel
+// flags (bNetOwner, bNetInitial, RemoteRole, ...).
+//
+struct FRepEvalSet
+{
+	DWORD			Key;			// The flags.
+	TArray<BYTE>	Eval;			// By RepOwner's RepIndex: 0=not evaluated, 2=false, 3=true.
+};
+
+//
+// Replication state of one actor shared by all the channels replicating it.
+//
+// When an actor was replicated to more than one channel last tick, the
+// first channel this tick brings Baseline up to date with the actor and
+// notes which properties changed.  Each channel remembers, per property,
+// the serial of the baseline its Recent value matches (RepSynced), so it
+// knows whether the property changed without comparing it.  Channels also
+// share script condition results evaluated under the same flags, and the
+// encoded bits of each value sent.  Properties whose encoding depends on
+// the connection (objects, names) or which ReplicateActor sets per channel
+// (Role, bNetOwner, ...) are never shared.
+//
+struct ENGINE_API FRepSnapshot
+{
+	// Variables.
+	UClass*					Class;			// Class of the actor.
+	DOUBLE					Time;			// Driver time of the current tick.
+	UBOOL					Refreshed;		// Whether Baseline was updated this tick.
+	INT						Serial;			// Number of updates to Baseline.
+	INT						Channels;		// Channels replicating the actor this tick.
+	INT						LastChannels;	// Channels in the previous tick it was replicated.
+	TArray<BYTE>			Baseline;		// Property values as of Serial.
+	TArray<BYTE>			Shareable;		// Per ClassReps index, whether sharing applies.
+	TArray<INT>				LastChanged;	// Per ClassReps index, Serial its value last changed.
+	TArray<FRepEncoding>	Encodings;		// Per ClassReps index.
+	TArray<FRepEvalSet>		Evals;			// Conditions evaluated this tick.
+
+	// Constructors.
+	FRepSnapshot( UClass* InClass );
+	~FRepSnapshot();
+
+	// Functions.
+	UBOOL Begin( AActor* Actor, DOUBLE InTime );
+	void Refresh( AActor* Actor );
+	TArray<BYTE>& GetEvals( DWORD Key );
+	FRepEncoding* GetEncoding( INT RepIndex, UPackageMap* Map );
+};
+
+/*-----------------------------------------------------------------------------
+	FRepBatch.
+-----------------------------------------------------------------------------*/
+
+//
+// A property update gathered for sending.
+//
+struct FRepItem
+{
+	UProperty*		Property;		// Property sent.
+	INT				Offset;			// Offset of the value in the actor.
+	INT				RepIndex;		// Index into ClassReps.
+	INT				FieldNetIndex;	// Field index sent.
+	INT				Element;		// Array element sent, or -1 if not an array.
+	INT				Value;			// Offset of the value copy in FRepBatch::Values, or -1.
+	FRepEncoding*	Encoding;		// Shared encoding sent instead, or NULL.
+};
+
+//
+// An actor update gathered for sending.
+//
+struct FRepJob
+{
+	class UActorChannel* Channel;	// Channel sent on.
+	FRepSnapshot*	Snapshot;		// Snapshot the item encodings belong to.
+	INT				FirstItem;		// First item in FRepBatch::Items.
+	INT				NumItems;		// Number of items.
+	INT				MaxIndex;		// Field index limit of the class.
+	BYTE			Initial;		// 0=no initial data, 1=persistent actor, 2=transient actor.
+	BYTE			bClose;			// Bunch flags.
+	BYTE			bReliable;
+	BYTE			bTemporary;		// Whether the actor is bNetTemporary.
+	FVector			Location;		// Spawn location of a transient actor.
+};
+
+//
+// The actor updates for one connection, gathered on the game thread so that
+// they can be encoded and sent without touching any actor, script or GMem.
+//
+struct ENGINE_API FRepBatch
+{
+	// Variables.
+	UNetConnection*		Connection;		// Connection sent to.
+	TArray<FRepJob>		Jobs;			// Actor updates, in priority order.
+	TArray<FRepItem>	Items;			// Property updates of all jobs.
+	TArray<BYTE>		Values;			// Copies of the property values sent.
+	INT					EstimatedBytes;	// Rough size of all jobs.
+	INT					Budget;			// Bytes the connection can take this tick.
+	INT					NumReps;		// Properties sent.
+	INT					Updated;		// Jobs sent.
+
+	// Constructors.
+	FRepBatch( UNetConnection* InConnection );
+	~FRepBatch();
+
+	// Functions.
+	UBOOL IsFull()
+	{
+		return EstimatedBytes>=Budget;
+	}
+	INT AddValue( UProperty* Property, BYTE* Src );
+	void Send();
+};
+
 /*-----------------------------------------------------------------------------
 	UActorChannel.
 -----------------------------------------------------------------------------*/
@@ -115,6 +244,7 @@ class ENGINE_API UActorChannel : public UChannel
 	TArray<BYTE> RepEval;	// Evaluated replication conditions.
 	TArray<INT>  Dirty;     // Properties that are dirty and need resending.
 	TArray<FPropertyRetirement> Retirement; // Property retransmission.
+	TArray<INT>  RepSynced; // Per ClassReps index, FRepSnapshot serial Recent matches.
 
 	// Constructor.
 	void StaticConstructor()
@@ -139,6 +269,8 @@ class ENGINE_API UActorChannel : public UChannel
 	AActor* GetActor() {return Actor;}
 	FString Describe();
 	void ReplicateActor();
+	UBOOL PrepareReplication( FRepBatch& Batch );
+	void SendReplication( FRepBatch& Batch, FRepJob& Job );
 	void SetChannelActor( AActor* InActor );
 };
 
@@ -157,9 +289,14 @@ class ENGINE_API UFileChannel : public UChannel
 	TCHAR		Filename[256];	 // Filename being transfered.
 	TCHAR		PrettyName[256]; // Pretty name of file.
 	TCHAR		Error[256];		 // Error.
-	FArchive*	FileAr;			 // File being transfered.
+	FArchive*	FileAr;			 // File being received.
+	FNetFileImage* Image;		 // File being sent.
 	INT			Transfered;		 // Bytes transfered.
+	INT			WireBytes;		 // Bytes sent or received over the connection.
 	INT			PackageIndex;	 // Index of package in Map.
+	UBOOL		Compressed;		 // Whether the compressed stream is used.
+	TArray<BYTE> PackedIn;		 // Compressed data received but not yet unpacked.
+	DOUBLE		StartTime;		 // When the transfer started.
 
 	// Constructor.
 	void StaticConstructor()
@@ -28,7 +28,6 @@ enum EConnectionState
 	USOCK_Open      = 3, // Connection is open.
 };
 
-#if DO_ENABLE_NET_TEST
 //
 // A lagged packet
 //
@@ -37,7 +36,96 @@ struct DelayedPacket
 	TArray<BYTE> Data;
 	DOUBLE SendTime;
 };
-#endif
+
+//
+// Simulated network conditions applied to a stream of outgoing packets:
+// latency, loss, duplication, reordering and a bandwidth cap.  Used by
+// UNetConnection for net testing and by the loopback driver as its link.
+//
+struct ENGINE_API FPacketSimulator
+{
+	// Settings.
+	INT				PktLoss;				// Percent of packets dropped.
+	INT				PktOrder;				// Percent of packets delivered out of order.
+	INT				PktDup;					// Percent of packets duplicated.
+	INT				PktLag;					// Milliseconds of latency.
+	INT				PktRate;				// Bandwidth cap in bytes per second, 0=unlimited.
+
+	// Internal.
+	DWORD			Seed;					// Random seed, so runs are repeatable.
+	DOUBLE			LinkTime;				// Time the simulated link becomes idle.
+	TArray<DelayedPacket> Delayed;			// Packets in flight, sorted by SendTime.
+
+	// Stats.
+	INT				NumSent, NumDropped, NumDuped, NumReordered;
+
+	// Constructor.
+	FPacketSimulator();
+
+	// Functions.
+	void Init( const TCHAR* Parms );
+	UBOOL IsActive() const
+	{
+		return PktLoss || PktOrder || PktDup || PktLag || PktRate;
+	}
+	void Send( const void* Data, INT Count, DOUBLE Time );
+	DelayedPacket* Peek( DOUBLE Time )
+	{
+		return Delayed.Num() && Delayed(0).SendTime<=Time ? &Delayed(0) : NULL;
+	}
+	void Pop()
+	{
+		Delayed.Remove( 0 );
+	}
+	FString Describe() const;
+private:
+	FLOAT Frand();
+	void Insert( const void* Data, INT Count, DOUBLE SendTime );
+};
+
+//
+// Adaptive send rate for a connection, below the CurrentNetSpeed the client
+// asked for.  Round trip time comes from acked packets and loss from naks.
+// The rate grows by about one packet per round trip while the path is
+// clear, and is cut at most once per round trip when queueing delay builds
+// up.  Loss without queueing delay is taken to be random and only counted.
+//
+struct ENGINE_API FNetRateControl
+{
+	// Estimates.
+	FLOAT			Rate;					// Send budget in bytes per second, 0 until first used.
+	FLOAT			SRTT, RTTVar;			// Smoothed round trip time and its variation.
+	FLOAT			MinRTT;					// Base round trip time of the path.
+	FLOAT			WindowMinRTT;			// Lowest round trip time in the current window.
+	DOUBLE			WindowStart;			// Start of the current MinRTT window.
+	DOUBLE			LastAck;				// Time of the last ack.
+	DOUBLE			LastDecrease;			// Time of the last rate cut.
+
+	// Stats.
+	INT				NumAcks, NumNaks, NumDecreases;
+	INT				NumDelivered;			// Reliable bunches acked.
+	DOUBLE			DeliverTime;			// Total seconds from first send to ack.
+	FLOAT			MaxDeliverTime;			// Slowest delivery.
+	INT				NumTicks, NumStalls;	// Ticks, and ticks that started over budget.
+
+	// Constructor.
+	FNetRateControl();
+
+	// Functions.
+	void Reset();
+	FLOAT GetRate( FLOAT MaxRate );
+	void ReceivedAck( DOUBLE Now, FLOAT RTT, INT MaxPacket, FLOAT MaxRate );
+	void ReceivedNak( DOUBLE Now, FLOAT MaxRate );
+	void Delivered( FLOAT Seconds );
+	void Ticked( UBOOL Stalled )
+	{
+		NumTicks++;
+		NumStalls += Stalled;
+	}
+	FString Describe( FLOAT MaxRate );
+private:
+	void Decrease( DOUBLE Now, FLOAT Beta, FLOAT MaxRate );
+};
 
 //
 // A network connection.
@@ -65,6 +153,7 @@ class ENGINE_API UNetConnection : public UPlayer
 	INT				Challenge;				// Server-generated challenge.
 	INT				NegotiatedVer;			// Negotiated version for new channels.
 	INT				UserFlags;				// User-specified flags.
+	UBOOL			CompressOut;			// Remote side has our packet model, so compress what we send.
 	FStringNoInit	RequestURL;				// URL requested by client
 
 	// Internal.
@@ -74,6 +163,7 @@ class ENGINE_API UNetConnection : public UPlayer
 	DOUBLE			LastRepTime;			// Time of last replication.
 	INT				QueuedBytes;			// Bytes assumed to be queued up.
 	INT				TickCount;				// Count of ticks.
+	FNetRateControl	RateControl;			// Adaptive send rate.
 
 	// Merge info.
 	FBitWriterMark  LastStart;				// Most recently sent bunch start.
@@ -105,6 +195,8 @@ class ENGINE_API UNetConnection : public UPlayer
 	DOUBLE			LastTime, FrameTime;	// Monitors frame time.
 	DOUBLE			CumulativeTime, AverageFrameTime;
 	INT				CountedFrames;
+	INT				CompRawBytes;			// Bytes before packet compression.
+	INT				CompSentBytes;			// Bytes after packet compression.
 
 	// Packet.
 	FBitWriter		Out;					// Outgoing packet.
@@ -113,6 +205,9 @@ class ENGINE_API UNetConnection : public UPlayer
 	INT				InPacketId;				// Full incoming packet index.
 	INT				OutPacketId;			// Most recently sent packet.
 	INT 			OutAckPacketId;			// Most recently acked outgoing packet.
+	UBOOL			DeferSends;				// Queue packets instead of sending them, while off the game thread.
+	TArray<BYTE>	DeferredData;			// Packets queued while DeferSends.
+	TArray<INT>		DeferredSizes;			// Their sizes.
 
 	// Channel table.
 	UChannel*  Channels     [ MAX_CHANNELS ];
@@ -125,11 +220,7 @@ class ENGINE_API UNetConnection : public UPlayer
 
 #if DO_ENABLE_NET_TEST
 	// For development.
-	INT				PktLoss;
-	INT				PktOrder;
-	INT				PktDup;
-	INT				PktLag;
-	TArray<DelayedPacket> Delayed;
+	FPacketSimulator PacketSim;
 #endif
 
 	// Constructors and destructors.
@@ -166,6 +257,8 @@ class ENGINE_API UNetConnection : public UPlayer
 	void SendPackageMap();
 	void PreSend( INT SizeBits );
 	void PostSend();
+	void SendPacket( void* Data, INT Count );
+	void SendDeferred();
 	void ReceivedRawPacket( void* Data, INT Count );//!! "looks like an FArchive"
 	INT SendRawBunch( FOutBunch& Bunch, UBOOL InAllowMerge );
 	UNetDriver* GetDriver() {return Driver;}
@@ -174,6 +267,8 @@ class ENGINE_API UNetConnection : public UPlayer
 	void ReceivedPacket( FBitReader& Reader );
 	void ReceivedNak( INT NakPacketId );
 	void ReceiveFile( INT PackageIndex );
+	FString DescribeCompression();
+	FLOAT GetSendRate();
 	void SlowAssertValid()
 	{
 #if DO_GUARD_SLOW
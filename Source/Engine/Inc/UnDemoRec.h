@@ -9,6 +9,81 @@ Revision history:
 class UDemoRecDriver;
 class UDemoRecConnection;
 
+/*-----------------------------------------------------------------------------
+	Demo index.
+-----------------------------------------------------------------------------*/
+
+//
+// Demo files are a series of packet records: FrameNum, Time, Count, Data.
+// Demos recorded with keyframes (DEMOREC <name> KEYFRAMES) instead start
+// with DEMO_FILE_TAG and their DEMO_VERSION, contain keyframe records whose
+// Count is DEMO_KEYFRAME, and end with a table of keyframes, its offset and
+// DEMO_INDEX_TAG.  Readers only accept keyframe records from files with a
+// version, so plain recordings stay readable by older engines.  At a
+// keyframe every actor channel except the viewer's is closed, so everything
+// after it reopens with full state; seeking needs that, but sequential
+// playback sees every actor respawn, which is why keyframes are opt-in.
+//
+enum {DEMO_FILE_TAG  = 0x4D454455};
+enum {DEMO_VERSION   = 1         };
+enum {DEMO_KEYFRAME  = -1        };
+enum {DEMO_INDEX_TAG = 0x58444E49};
+
+//
+// An entry in a demo's keyframe index.
+//
+struct FDemoKeyframe
+{
+	DOUBLE	Time;
+	INT		FrameNum;
+	INT		Offset;
+	friend FArchive& operator<<( FArchive& Ar, FDemoKeyframe& K )
+	{
+		return Ar << K.Time << K.FrameNum << K.Offset;
+	}
+};
+
+//
+// Connection state recorded at a keyframe, for resuming playback there.
+//
+struct FDemoKeyframeState
+{
+	INT			PacketId;			// Next packet id.
+	TArray<INT>	Reliable;			// Channel index and reliable sequence pairs.
+	TArray<INT>	KeptChannels;		// Channels left open across the keyframe.
+	friend FArchive& operator<<( FArchive& Ar, FDemoKeyframeState& S )
+	{
+		return Ar << S.PacketId << S.Reliable << S.KeptChannels;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	Timedemo benchmark.
+-----------------------------------------------------------------------------*/
+
+//
+// Per-frame timings gathered while playing a demo with ?benchmark.  Frame
+// time is split into game tick (excluding script and net), script, render
+// and net (demo reading and replication), all in milliseconds.
+//
+struct ENGINE_API FDemoBenchmark
+{
+	// Variables.
+	FString			CSVFilename;		// Where to write per-frame timings, if anywhere.
+	DOUBLE			StartTime;			// When sampling began.
+	DOUBLE			LastTime;			// When the last frame ended.
+	INT				ScriptCycles;		// Script time of the last level tick.
+	INT				NetCycles;			// Net time of the last level tick.
+	FTimeSamples	Frame, Game, Script, Render, Net;
+
+	// Constructor.
+	FDemoBenchmark( const TCHAR* InCSVFilename );
+
+	// Functions.
+	void Sample( INT GameCycles, INT RenderCycles );
+	void Report( const TCHAR* DemoFilename, FOutputDevice& Ar );
+};
+
 /*-----------------------------------------------------------------------------
 	UDemoRecConnection.
 -----------------------------------------------------------------------------*/
@@ -56,6 +131,14 @@ class ENGINE_API UDemoRecDriver : public UNetDriver
 	UBOOL			TimeBased;
 	UBOOL			NoFrameCap;
 	INT				FrameNum;
+	INT				DemoVersion;		// 0 for plain demos, else DEMO_VERSION.
+	FLOAT			KeyframeInterval;
+	DOUBLE			LastKeyframeTime;
+	DOUBLE			SeekTime;
+	INT				DemoEnd;
+	TArray<FDemoKeyframe> Keyframes;
+	FDemoBenchmark*	Benchmark;
+	UBOOL			QuitWhenDone;
 
 	// Constructors.
 	void StaticConstructor();
@@ -67,6 +150,7 @@ class ENGINE_API UDemoRecDriver : public UNetDriver
 	UBOOL InitConnect( FNetworkNotify* InNotify, FURL& ConnectURL, FString& Error );
 	UBOOL InitListen( FNetworkNotify* InNotify, FURL& ConnectURL, FString& Error );
 	void TickDispatch( FLOAT DeltaTime );
+	void TickFlush();
 
 	// FExec interface.
 	INT Exec( const TCHAR* Cmd, FOutputDevice& Ar=*GLog );
@@ -75,6 +159,10 @@ class ENGINE_API UDemoRecDriver : public UNetDriver
 	UBOOL InitBase( UBOOL Connect, FNetworkNotify* InNotify, FURL& ConnectURL, FString& Error );
 	ULevel* GetLevel();
 	void SpawnDemoRecSpectator( UNetConnection* Connection );
+	void WriteKeyframe();
+	UBOOL SeekTo( DOUBLE Target );
+	static INT ReadIndex( FArchive& Ar, TArray<FDemoKeyframe>& Keyframes, INT& Version );
+	void TickBenchmark( INT GameCycles, INT RenderCycles );
 };
 
 /*-----------------------------------------------------------------------------
@@ -51,6 +51,7 @@ public:
 	virtual FCheckResult* ActorLineCheck( FMemStack& Mem, FVector End, FVector Start, FVector Extent, BYTE ExtraNodeFlags )=0;
 	virtual FCheckResult* ActorPointCheck( FMemStack& Mem, FVector Location, FVector Extent, DWORD ExtraNodeFlags )=0;
 	virtual FCheckResult* ActorRadiusCheck( FMemStack& Mem, FVector Location, FLOAT Radius, DWORD ExtraNodeFlags )=0;
+	virtual FCheckResult* ActorOverlapRadiusCheck( FMemStack& Mem, FVector Location, FLOAT Radius )=0;
 	virtual FCheckResult* ActorEncroachmentCheck( FMemStack& Mem, AActor* Actor, FVector Location, FRotator Rotation, DWORD ExtraNodeFlags )=0;
 	virtual void CheckActorNotReferenced( AActor* Actor )=0;
 };
@@ -155,6 +156,10 @@ class ENGINE_API ULevel : public ULevelBase
 	UBOOL InTick, Ticked;
 	INT iFirstDynamicActor, NetTag;
 	BYTE ZoneDist[64][64];
+	class FNavGraph* NavGraph;
+	class FActorClassIndex* ClassIndex;
+	class FActorBroadphase* Broadphase;
+	class FTickScheduler* TickScheduler;
 
 	// Temporary stats.
 	INT NetTickCycles, NetDiffCycles, ActorTickCycles, AudioTickCycles, FindPathCycles, MoveCycles, NumMoves, NumReps, NumPV, GetRelevantCycles, NumRPC, SeePlayer, Spawning, Unused;
@@ -173,7 +178,7 @@ class ENGINE_API ULevel : public ULevelBase
 	virtual void Tick( ELevelTick TickType, FLOAT DeltaSeconds );
 	virtual void TickNetClient( FLOAT DeltaSeconds );
 	virtual void TickNetServer( FLOAT DeltaSeconds );
-	virtual INT ServerTickClient( UNetConnection* Conn, FLOAT DeltaSeconds );
+	virtual void ServerTickClient( UNetConnection* Conn, FLOAT DeltaSeconds, struct FRepBatch& Batch );
 	virtual void ReconcileActors();
 	virtual void RememberActors();
 	virtual UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar=*GLog );
@@ -205,6 +210,11 @@ class ENGINE_API ULevel : public ULevelBase
 	virtual INT TickDemoPlayback( FLOAT DeltaSeconds );
 	virtual void UpdateTime( ALevelInfo* Info );
 	virtual void WelcomePlayer( UNetConnection* Connection, TCHAR* Optional=TEXT("") );
+	virtual class FNavGraph& GetNavGraph( UBOOL bNewSearch=0 );
+	virtual class FActorClassIndex* GetClassIndex();
+	virtual void FlushClassIndex();
+	virtual class FActorBroadphase* GetBroadphase();
+	virtual class FTickScheduler* GetTickScheduler();
 
 	// FNetworkNotify interface.
 	EAcceptConnection NotifyAcceptingConnection();
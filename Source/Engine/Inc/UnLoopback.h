@@ -0,0 +1,84 @@
+/*=============================================================================
+	UnLoopback.h: In-memory loopback network driver.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+class ULoopbackNetDriver;
+class ULoopbackConnection;
+
+/*-----------------------------------------------------------------------------
+	ULoopbackConnection.
+-----------------------------------------------------------------------------*/
+
+//
+// One end of an in-process connection.  Packets sent are placed on Link, a
+// simulated network path which the peer's driver drains in TickDispatch.
+//
+class ENGINE_API ULoopbackConnection : public UNetConnection
+{
+	DECLARE_CLASS(ULoopbackConnection,UNetConnection,CLASS_Transient)
+	NO_DEFAULT_CONSTRUCTOR(ULoopbackConnection)
+
+	// Variables.
+	ULoopbackConnection*	Peer;			// Other end of the connection, NULL until accepted.
+	FPacketSimulator		Link;			// Outgoing packets in flight to Peer.
+
+	// Constructors.
+	ULoopbackConnection( UNetDriver* InDriver, const FURL& InURL, EConnectionState InState );
+
+	// UObject interface.
+	void Destroy();
+
+	// UNetConnection interface.
+	FString LowLevelGetRemoteAddress();
+	FString LowLevelDescribe();
+	void LowLevelSend( void* Data, INT Count );
+
+	// ULoopbackConnection interface.
+	void ReceiveFromPeer();
+};
+
+/*-----------------------------------------------------------------------------
+	ULoopbackNetDriver.
+-----------------------------------------------------------------------------*/
+
+//
+// Network driver which connects levels in the same process through memory
+// queues, for repeatable replication tests and benchmarks.  Select it with
+// NetworkDevice=Engine.LoopbackNetDriver.
+//
+class ENGINE_API ULoopbackNetDriver : public UNetDriver
+{
+	DECLARE_CLASS(ULoopbackNetDriver,UNetDriver,CLASS_Transient|CLASS_Config)
+
+	// Variables.
+	INT				Port;					// Listening port, or 0 for a client.
+	INT				PktLoss;				// Default link loss percent.
+	INT				PktOrder;				// Default link reorder percent.
+	INT				PktDup;					// Default link duplicate percent.
+	INT				PktLag;					// Default link latency in msec.
+	INT				PktRate;				// Default link bandwidth in bytes/sec.
+	TArray<ULoopbackConnection*> PendingConnects;	// Clients awaiting acceptance.
+
+	// Constructors.
+	void StaticConstructor();
+	ULoopbackNetDriver();
+
+	// UNetDriver interface.
+	void LowLevelDestroy();
+	FString LowLevelGetNetworkNumber();
+	UBOOL InitConnect( FNetworkNotify* InNotify, FURL& ConnectURL, FString& Error );
+	UBOOL InitListen( FNetworkNotify* InNotify, FURL& ListenURL, FString& Error );
+	void TickDispatch( FLOAT DeltaTime );
+
+	// FExec interface.
+	UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar=*GLog );
+
+	// ULoopbackNetDriver interface.
+	void InitLink( FPacketSimulator& Link, const FURL& URL );
+	static ULoopbackNetDriver* FindListener( INT Port );
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,105 @@
+/*=============================================================================
+	UnMeshLerp.h: Batched and level-of-detail mesh frame sampling.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FMeshLerp.
+-----------------------------------------------------------------------------*/
+
+//
+// Unpacks, interpolates and transforms mesh vertices for GetFrame, a batch
+// at a time.  Each batch is staged as separate X, Y and Z arrays so the
+// unpack, lerp and transform loops run four vertices per SSE2 instruction
+// on x86, and are plain float loops elsewhere.  The Dreamcast does one
+// whole vertex at a time, as GetFrame always did.  The cached vertices and
+// the results keep their FVector layout.
+//
+class ENGINE_API FMeshLerp
+{
+public:
+	// Constants.
+	enum {BATCH=64};	// Vertices staged at once.
+
+	// Functions.
+	static void Process
+	(
+		const FMeshVert*	Verts1,		// Start frame, or NULL to start from Cached.
+		const FMeshVert*	Verts2,		// Frame to interpolate toward, or NULL.
+		FLOAT				Alpha,
+		INT					Num,
+		FVector*			Cached,		// Updated unless both frames are NULL.
+		const FVector&		Origin,
+		const FCoords&		Coords,
+		FVector*			Result,		// Transformed vertices, or NULL.
+		INT					Stride		// Bytes between results.
+	);
+	static void Unpack( const FMeshVert* Verts, INT Num, FVector* Cached, const FVector& Origin, const FCoords& Coords, FVector* Result, INT Stride )
+	{
+		Process( Verts, NULL, 0.f, Num, Cached, Origin, Coords, Result, Stride );
+	}
+	static void Lerp( const FMeshVert* Verts1, const FMeshVert* Verts2, FLOAT Alpha, INT Num, FVector* Cached, const FVector& Origin, const FCoords& Coords, FVector* Result, INT Stride )
+	{
+		Process( Verts1, Verts2, Alpha, Num, Cached, Origin, Coords, Result, Stride );
+	}
+	static void Tween( const FMeshVert* Verts, FLOAT Alpha, INT Num, FVector* Cached, const FVector& Origin, const FCoords& Coords, FVector* Result, INT Stride )
+	{
+		Process( NULL, Verts, Alpha, Num, Cached, Origin, Coords, Result, Stride );
+	}
+	static void Transform( INT Num, FVector* Cached, const FVector& Origin, const FCoords& Coords, FVector* Result, INT Stride )
+	{
+		Process( NULL, NULL, 0.f, Num, Cached, Origin, Coords, Result, Stride );
+	}
+	static void Benchmark( FOutputDevice& Ar );
+};
+
+/*-----------------------------------------------------------------------------
+	FMeshAnimLOD.
+-----------------------------------------------------------------------------*/
+
+//
+// Level of detail for mesh animation.  A mesh further than Distance from
+// the viewer, allowing for its DrawScale, reuses the frame cached in its
+// CID_TweenAnim item, only transforming it, and is resampled less often the
+// further it is, down to every MaxInterval seconds at twice Distance.
+// Meshes that aren't drawn aren't sampled at all, since only rendering
+// calls GetFrame; so nothing is decoded on a dedicated server.
+//
+struct ENGINE_API FMeshAnimLOD
+{
+	// Variables.
+	UBOOL	Enabled;
+	FLOAT	Distance;						// Sampled every frame when nearer.
+	FLOAT	MaxInterval;					// Seconds between samples when furthest.
+
+	// Stats.
+	INT		FrameDecoded, FrameReused;		// Vertices, this frame.
+	DOUBLE	TotalDecoded, TotalReused;		// Vertices, since last reported.
+
+	// Constructor.
+	FMeshAnimLOD();
+
+	// Functions.
+	UBOOL NeedsSample( AActor* Owner, const FVector& ViewLocation, FLOAT SampleTime );
+	void ResetFrame()
+	{
+		FrameDecoded = FrameReused = 0;
+	}
+	void Decoded( INT NumVerts )
+	{
+		FrameDecoded += NumVerts;
+		TotalDecoded += NumVerts;
+	}
+	void Reused( INT NumVerts )
+	{
+		FrameReused += NumVerts;
+		TotalReused += NumVerts;
+	}
+	UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar );
+};
+
+ENGINE_API extern FMeshAnimLOD GMeshAnimLOD;
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
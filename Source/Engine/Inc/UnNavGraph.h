@@ -0,0 +1,221 @@
+/*=============================================================================
+	UnNavGraph.h: Compact navigation graph for route searches.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FNavGraph.
+-----------------------------------------------------------------------------*/
+
+enum {NAV_UNVISITED  = 10000000}; // Weight of a node not reached by the current search.
+enum {NAV_MAX_FLOWS  = 16      }; // Flow fields kept per level.
+#define NAV_FLOW_LIFETIME 1.0     /* Seconds a flow field is trusted for. */
+
+//
+// A navigation point in the graph.  Edges of a node are stored contiguously
+// in the graph's edge arrays.
+//
+struct FNavNode
+{
+	ANavigationPoint*	Nav;				// The navigation point.
+	FVector				Location;			// Its location.
+	INT					FirstIn, NumIn;		// Upstream paths, leading into this node.
+	INT					FirstOut, NumOut;	// Paths leading out of this node.
+	BYTE				bPlayerOnly;		// Only players may route through it.
+	BYTE				bInventorySpot;		// It's an AInventorySpot.
+};
+
+//
+// A reach spec as seen from one of its ends.
+//
+struct FNavEdge
+{
+	INT		Node;							// Node at the other end.
+	INT		Distance;						// Length of the path.
+	INT		CollisionRadius;				// Largest radius supported.
+	INT		CollisionHeight;				// Largest height supported.
+	INT		ReachFlags;						// Movement needed, see EReachSpecFlags.
+
+	UBOOL Supports( INT iRadius, INT iHeight, INT MoveFlags ) const
+	{
+		return CollisionRadius>=iRadius && CollisionHeight>=iHeight && (ReachFlags & MoveFlags)==ReachFlags;
+	}
+};
+
+//
+// An open node in a search, ordered by Key.
+//
+struct FNavOpen
+{
+	INT		Key;
+	INT		Node;
+};
+
+//
+// Weights and next hops from every node to one goal node, for pawns of one
+// size and movement ability.  Built by a full search from the goal and
+// shared by every pawn routing to the goal with matching special costs.
+//
+struct FNavFlowField
+{
+	INT				Goal;				// Node the field leads to.
+	INT				Radius, Height;		// Collision size it was built for.
+	INT				MoveFlags;			// Movement it was built for.
+	UBOOL			bPlayer;			// Whether PlayerOnly nodes were used.
+	TArray<INT>		SpecialCosts;		// SpecialCost of each special node it was built with.
+	TArray<INT>		Weight;				// Weight to the goal, or NAV_UNVISITED.
+	TArray<INT>		Next;				// Next node toward the goal.
+	DOUBLE			Time;				// Level time it was built.
+	DOUBLE			LastUsed;			// Level time it was last used.
+};
+
+//
+// A search toward a goal that had no flow field yet.  A field is only built
+// when another search toward the same goal follows within
+// NAV_FLOW_LIFETIME, so one-off goals never pay for a full search.
+//
+struct FNavFlowRequest
+{
+	INT				Goal;
+	INT				Radius, Height;
+	INT				MoveFlags;
+	UBOOL			bPlayer;
+	DOUBLE			Time;
+};
+
+//
+// The level's navigation network flattened into arrays, built once from the
+// NavigationPointList and ReachSpecs and rebuilt if they change.  Searches
+// keep their state here rather than in the navigation points, stamped with
+// a search generation so nothing needs to be cleared between searches, and
+// node costs are only evaluated for the nodes a search reaches.
+//
+class ENGINE_API FNavGraph
+{
+public:
+	// Graph.
+	TArray<FNavNode>	Nodes;
+	TArray<FNavEdge>	InEdges;
+	TArray<FNavEdge>	OutEdges;
+	TMap<AActor*,INT>	NodeMap;			// Navigation point to node index.
+	ANavigationPoint*	FirstNav;			// NavigationPointList it was built from.
+	INT					NumSpecs;			// ReachSpecs.Num() it was built from.
+	TArray<INT>			SpecialNodes;		// Nodes with bSpecialCost.
+
+	// Flow fields.
+	TArray<FNavFlowField*> Flows;
+	TArray<FNavFlowRequest> FlowRequests;	// Recent goals without a field.
+	FNavFlowField*		Flow;				// Field the current search is using.
+	INT					FlowSeed;			// Weight of its goal in the current search.
+
+	// Search state, valid where the stamp matches Generation.
+	DWORD				Generation;
+	TArray<DWORD>		Visited;
+	TArray<DWORD>		Closed;				// Stamped when expanded.
+	TArray<INT>			Weight;				// Best weight found so far.
+	TArray<INT>			Previous;			// Node the best weight came from.
+	TArray<INT>			StartNode;			// First node of the route, for forward searches.
+	TArray<DWORD>		CostStamp;
+	TArray<INT>			Cost;				// Cost of passing through the node.
+	TArray<DWORD>		EndStamp;
+	TArray<INT>			EndWeight;			// Extra weight of an end point.
+	TArray<FNavOpen>	Open;				// Binary heap of open nodes.
+	APawn*				Searcher;			// Pawn searching, for SpecialCost.
+	UBOOL				bPresetCosts;		// Use costs preset in the navigation points by script.
+	FVector				Goal;				// Where the end points are, for the search heuristic.
+	INT					GoalSlack;			// Farthest end point from Goal.
+	FLOAT				HeuristicScale;		// Lowest ratio of path length to distance spanned.
+	TArray<INT>			EndPoints;			// Nodes marked as end points.
+	TArray<INT>			CostOverrides;		// Nodes whose cost was set for this search only.
+
+	// Stats.
+	INT					NumSearches, NumExpanded, NumSpecialCosts, NumBuilds;
+	INT					NumFlowHits, NumFlowBuilds, NumFlowExpanded;
+
+	// Constructor/destructor.
+	FNavGraph();
+	~FNavGraph();
+
+	// Building.
+	UBOOL IsValid( ULevel* Level ) const;
+	void Build( ULevel* Level );
+	INT FindNode( AActor* Actor ) const
+	{
+		const INT* Index = Actor ? NodeMap.Find( Actor ) : NULL;
+		return Index ? *Index : INDEX_NONE;
+	}
+
+	// Search state.
+	void BeginSearch( APawn* InSearcher, UBOOL bClearPaths );
+	INT GetWeight( INT i ) const
+	{
+		return Visited(i)==Generation ? Weight(i) : NAV_UNVISITED;
+	}
+	void SetWeight( INT i, INT InWeight, INT InPrevious=INDEX_NONE )
+	{
+		Visited (i) = Generation;
+		Weight  (i) = InWeight;
+		Previous(i) = InPrevious;
+	}
+	void SetWeight( AActor* Actor, INT InWeight )
+	{
+		INT i = FindNode( Actor );
+		if( i!=INDEX_NONE )
+			SetWeight( i, InWeight );
+	}
+	INT GetCost( INT i );
+	void SetCost( INT i, INT InCost )
+	{
+		CostStamp(i) = Generation;
+		Cost     (i) = InCost;
+		CostOverrides.AddItem( i );
+	}
+	UBOOL Close( INT i )
+	{
+		if( Closed(i)==Generation )
+			return 0;
+		Closed(i) = Generation;
+		return 1;
+	}
+	UBOOL IsEndPoint( INT i ) const
+	{
+		return EndStamp(i)==Generation;
+	}
+	INT GetEndWeight( INT i ) const
+	{
+		return EndStamp(i)==Generation ? EndWeight(i) : 0;
+	}
+	void MarkEndPoint( INT i, INT InWeight );
+	INT Heuristic( INT i ) const;
+
+	// Open list.
+	void PushOpen( INT Key, INT Node );
+	INT PopOpen();
+
+	// Flow fields.
+	INT GetFlowSpecialCost( INT i );
+	FNavFlowField* GetFlowField( INT GoalNode, INT iRadius, INT iHeight, INT MoveFlags, DOUBLE Time );
+	void BuildFlowField( FNavFlowField* Field, DOUBLE Time );
+	INT FindFlowEndPoint( FNavFlowField* Field, INT Seed );
+	INT GetRouteWeight( INT i ) const
+	{
+		if( Visited(i)==Generation )
+			return Weight(i);
+		else if( Flow && Flow->Weight(i)!=NAV_UNVISITED )
+			return FlowSeed + Flow->Weight(i);
+		else
+			return NAV_UNVISITED;
+	}
+	void FlushFlows();
+
+	// Results.
+	void LinkRoute( INT i );
+	void LinkRouteReversed( INT i );
+
+	// Stats.
+	FString Describe() const;
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
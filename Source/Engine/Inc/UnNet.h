@@ -65,13 +65,18 @@ enum EChannelType
 	Includes.
 -----------------------------------------------------------------------------*/
 
+#include "UnNetPool.h"		// Packet assembly workers.
 #include "UnNetDrv.h"		// Network driver class.
 #include "UnBunch.h"		// Bunch class.
+#include "UnNetComp.h"		// Packet compression.
+#include "UnNetFile.h"		// Package download images.
 #include "UnConn.h"			// Connection class.
 #include "UnChan.h"			// Channel class.
 #include "UnPenLev.h"		// Pending levels.
 #include "UnDemoPenLev.h"	// Demo playback pending level
 #include "UnDemoRec.h"		// Demo recording classes.
+#include "UnSimConn.h"		// Simulated client connections.
+#include "UnLoopback.h"		// In-memory loopback driver.
 
 /*-----------------------------------------------------------------------------
 	The End.
@@ -0,0 +1,50 @@
+/*=============================================================================
+	UnNetComp.h: Static-model packet compression.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FNetPacketModel.
+-----------------------------------------------------------------------------*/
+
+enum {NETMODEL_MAX_BITS   = 24  }; // Longest code allowed in a model.
+enum {NETMODEL_MAX_PACKET = 1024}; // Largest packet that is compressed.
+
+//
+// A canonical Huffman code trained offline on recorded game traffic.
+// Unlike FCodecHuffman no table is sent with the data, so it is cheap
+// enough to apply to every packet.  Both sides must load the same model,
+// which is verified through Checksum during the HELLO/CHALLENGE exchange.
+//
+// A compressed packet is the coded bitstream, a 1 bit, zero padding and
+// a trailing zero byte.  Raw packets always end in a nonzero byte, so the
+// two can be told apart without a header.
+//
+struct ENGINE_API FNetPacketModel
+{
+	// Variables.
+	UBOOL	Loaded;							// Whether a model is loaded.
+	DWORD	Checksum;						// CRC of the code lengths.
+	BYTE	Len[256];						// Code length per byte value.
+	DWORD	RevCode[256];					// Bit-reversed code per byte value, ready to pack.
+	INT		First[NETMODEL_MAX_BITS+1];		// First canonical code of each length.
+	INT		Count[NETMODEL_MAX_BITS+1];		// Number of codes of each length.
+	INT		Offset[NETMODEL_MAX_BITS+1];	// Index into Symbols of each length.
+	BYTE	Symbols[256];					// Byte values sorted by code.
+
+	// Constructor.
+	FNetPacketModel();
+
+	// Functions.
+	void Build( const DWORD* Counts );
+	UBOOL Load( const TCHAR* Filename );
+	static UBOOL Save( const TCHAR* Filename, const DWORD* Counts );
+	INT Encode( const BYTE* In, INT InCount, BYTE* Out );
+	INT Decode( const BYTE* In, INT InCount, BYTE* Out, INT MaxOut );
+};
+
+ENGINE_API extern FNetPacketModel GNetPacketModel;
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
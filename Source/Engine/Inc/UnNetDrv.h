@@ -27,6 +27,8 @@ class ENGINE_API UPackageMapLevel : public UPackageMap
 	UNetDriver.
 -----------------------------------------------------------------------------*/
 
+struct FRepSnapshot;
+
 //
 // Base class of a network driver attached to an active or pending level.
 //
@@ -51,6 +53,17 @@ class ENGINE_API UNetDriver : public USubsystem
 	INT							LanServerMaxTickRate;
 	UBOOL						AllowDownloads;
 	UBOOL						ProfileStats;
+	UBOOL						CompressPackets;
+	FStringNoInit				PacketModel;
+	UBOOL						CompressDownloads;
+	INT							MaxDownloadRate;
+	FLOAT						DownloadAllowance;
+	FLOAT						DownloadShare;
+	INT							NumDownloads;
+	TMap<AActor*,FRepSnapshot*>	RepSnapshots;
+	INT							NetThreads;
+	FNetWorkerPool*				Workers;
+	UBOOL						AdaptiveRate;
 	UProperty*					RoleProperty;
 	UProperty*					RemoteRoleProperty;
 	INT							SendCycles, RecvCycles;
@@ -73,6 +86,8 @@ class ENGINE_API UNetDriver : public USubsystem
 	virtual void TickDispatch( FLOAT DeltaTime );
 	virtual UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar=*GLog );
 	virtual void NotifyActorDestroyed( AActor* Actor );
+	FRepSnapshot* GetRepSnapshot( AActor* Actor );
+	FNetWorkerPool* GetWorkers();
 };
 
 /*-----------------------------------------------------------------------------
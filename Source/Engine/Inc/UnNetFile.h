@@ -0,0 +1,58 @@
+/*=============================================================================
+	UnNetFile.h: Shared file images for package downloads.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FNetFileImage.
+-----------------------------------------------------------------------------*/
+
+enum {NETFILE_CHUNK      = 0x10000   }; // Raw bytes per compressed chunk.
+enum {NETFILE_PACKED_TAG = 0x5A434E55}; // Starts a compressed stream; no package does.
+enum {NETFILE_MIN_BUNCH  = 64        }; // Smallest file bunch worth sending.
+enum {NETFILE_REQUEST_PACKED = 0x01  }; // Request flag: the client can take a compressed stream.
+
+//
+// A file being served to clients, shared by every file channel sending it.
+// The file is mapped into memory once (or loaded, where mapping isn't
+// available) and bunches are written straight out of it.
+//
+// Clients which ask for it are sent a compressed stream instead, which is
+// built one chunk at a time as downloads reach it and kept for the clients
+// after them.  The stream is NETFILE_PACKED_TAG followed by chunks of INT
+// RawSize, INT PackedSize and the data, which is stored as-is when
+// PackedSize==RawSize.
+//
+struct ENGINE_API FNetFileImage
+{
+	// Variables.
+	FString			Filename;		// File on disk.
+	SQWORD			FileTime;		// Its time when loaded.
+	INT				Size;			// Raw size.
+	BYTE*			Data;			// Raw contents.
+	UBOOL			Mapped;			// Whether Data is a memory mapping.
+	INT				RefCount;		// File channels using it.
+	TArray<BYTE>	Packed;			// Compressed stream built so far.
+	INT				PackedRaw;		// Raw bytes covered by Packed.
+
+	// Functions.
+	static FNetFileImage* Acquire( const TCHAR* Filename );
+	void Release();
+	UBOOL PackedComplete()
+	{
+		return PackedRaw>=Size;
+	}
+	void PackNextChunk();
+	static UBOOL IsPacked( const BYTE* Data, INT Count );
+	static INT Unpack( TArray<BYTE>& In, FArchive& Out );
+
+private:
+	FNetFileImage();
+	~FNetFileImage();
+	UBOOL Load();
+	void Unload();
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,58 @@
+/*=============================================================================
+	UnNetPool.h: Worker threads for server packet assembly.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FNetWorkerPool.
+-----------------------------------------------------------------------------*/
+
+// A task run once for each index in FNetWorkerPool::Run.
+typedef void (*FNetWorkerTask)( void* Context, INT Index );
+
+//
+// A fixed set of worker threads which, together with the calling thread,
+// run a task over a range of indices and return when all are done.  Tasks
+// must only touch state owned by their index: no UObject creation, script,
+// logging or GMem.  While a task runs, GMalloc is serialized behind the
+// pool's lock and GError only records the message, which Run raises on the
+// calling thread once every worker has finished.
+//
+class ENGINE_API FNetWorkerPool
+{
+public:
+	// Constructors.
+	FNetWorkerPool( INT InNumThreads );
+	~FNetWorkerPool();
+
+	// Functions.
+	INT NumThreads()
+	{
+		return Threads.Num();
+	}
+	void Run( FNetWorkerTask Task, void* Context, INT Count );
+	static INT DefaultThreads();
+
+private:
+	// Variables.
+	TArray<void*>	Threads;		// Platform thread handles.
+	void*			Wake;			// Semaphore workers wait on.
+	void*			Done;			// Semaphore signalled as workers finish.
+	void*			Lock;			// Guards GMalloc and Error during Run.
+	FNetWorkerTask	Task;			// Task being run.
+	void*			Context;		// Its context.
+	INT				Count;			// Indices to run.
+	volatile INT	Next;			// Next index to run.
+	volatile UBOOL	Exiting;		// Whether workers should exit.
+	TCHAR			Error[1024];	// Error raised by a task on a worker.
+
+	// Functions.
+	void Work();
+	friend struct FNetWorkerThread;
+	friend class FNetWorkerMalloc;
+	friend class FNetWorkerError;
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,48 @@
+/*=============================================================================
+	UnPacing.h: Main loop tick rate pacing.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FTickPacer.
+-----------------------------------------------------------------------------*/
+
+enum {TICKPACE_BUCKETS=9}; // Lateness histogram buckets.
+
+//
+// Holds the main loop to the engine's maximum tick rate.
+//
+// Mode 0 sleeps for whatever is left of the tick, which on most kernels
+// oversleeps by a scheduler quantum.  Mode 1 keeps absolute deadlines one
+// period apart, sleeps until just before the next one and spins the rest
+// of the way, so the rate holds without drift.  Either way each tick's
+// lateness against its deadline is kept in a histogram for TICKSTATS.
+//
+struct ENGINE_API FTickPacer
+{
+	// Variables.
+	INT		Mode;						// 0=plain sleep, 1=absolute deadlines.
+	FLOAT	SpinTime;					// Seconds before a deadline to stop sleeping.
+	DOUBLE	Deadline;					// When the next tick is due, or 0.
+	DOUBLE	StatsStart;					// When stats were last reset.
+	INT		Ticks;						// Ticks paced.
+	INT		Missed;						// Ticks whose work ran past the deadline.
+	DOUBLE	TotalLate;					// Msec late, summed.
+	FLOAT	MaxLate;					// Msec late, worst.
+	INT		Histogram[TICKPACE_BUCKETS];// Ticks by lateness.
+
+	// Constructor.
+	FTickPacer();
+
+	// Functions.
+	void Init();
+	void Wait( FLOAT MaxTickRate, DOUBLE TickStart );
+	void ResetStats();
+	UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar );
+};
+
+ENGINE_API extern FTickPacer GTickPacer;
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -96,6 +96,39 @@ class ENGINE_API URenderDevice : public USubsystem
 	virtual void vtblPad7() {}
 };
 
+/*------------------------------------------------------------------------------------
+	UNullRenderDevice.
+------------------------------------------------------------------------------------*/
+
+//
+// A rendering device which draws nothing, for timedemo benchmarks of the
+// rest of the engine and for running a client on machines without a
+// display.  Select it with GameRenderDevice=Engine.NullRenderDevice.
+//
+class ENGINE_API UNullRenderDevice : public URenderDevice
+{
+	DECLARE_CLASS(UNullRenderDevice,URenderDevice,CLASS_Config)
+
+	// URenderDevice interface.
+	UBOOL Init( UViewport* InViewport, INT NewX, INT NewY, INT NewColorBytes, UBOOL Fullscreen );
+	UBOOL SetRes( INT NewX, INT NewY, INT NewColorBytes, UBOOL Fullscreen );
+	void Exit();
+	void Flush( UBOOL AllowPrecache );
+	void Lock( FPlane FlashScale, FPlane FlashFog, FPlane ScreenClear, DWORD RenderLockFlags, BYTE* HitData, INT* HitSize );
+	void Unlock( UBOOL Blit );
+	void DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo& Surface, FSurfaceFacet& Facet );
+	void DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo& Info, FTransTexture** Pts, int NumPts, DWORD PolyFlags, FSpanBuffer* Span );
+	void DrawTile( FSceneNode* Frame, FTextureInfo& Info, FLOAT X, FLOAT Y, FLOAT XL, FLOAT YL, FLOAT U, FLOAT V, FLOAT UL, FLOAT VL, class FSpanBuffer* Span, FLOAT Z, FPlane Color, FPlane Fog, DWORD PolyFlags );
+	void Draw3DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector OrigP, FVector OrigQ );
+	void Draw2DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 );
+	void Draw2DPoint( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FLOAT X1, FLOAT Y1, FLOAT X2, FLOAT Y2, FLOAT Z );
+	void ClearZ( FSceneNode* Frame );
+	void PushHit( const BYTE* Data, INT Count );
+	void PopHit( INT Count, UBOOL bForce );
+	void GetStats( TCHAR* Result );
+	void ReadPixels( FColor* Pixels );
+};
+
 /*------------------------------------------------------------------------------------
 	The End.
 ------------------------------------------------------------------------------------*/
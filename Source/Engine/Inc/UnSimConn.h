@@ -0,0 +1,98 @@
+/*=============================================================================
+	UnSimConn.h: Simulated client connections for server load testing.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+class USimClientConnection;
+
+/*-----------------------------------------------------------------------------
+	USimClientConnection.
+-----------------------------------------------------------------------------*/
+
+//
+// A headless client living inside the server process.  The server side is a
+// regular UNetConnection; the client side builds raw packets (handshake text
+// and acks) and feeds them through ReceivedRawPacket, so the server sees
+// exactly the traffic a remote client would produce.
+//
+class ENGINE_API USimClientConnection : public UNetConnection
+{
+	DECLARE_CLASS(USimClientConnection,UNetConnection,CLASS_Transient)
+	NO_DEFAULT_CONSTRUCTOR(USimClientConnection)
+
+	// Client handshake stages.
+	enum ESimStage
+	{
+		SIM_Hello	= 0,	// Need to send HELLO.
+		SIM_Login	= 1,	// Waiting for challenge, then LOGIN and JOIN.
+		SIM_Joining	= 2,	// Waiting for the server to spawn our player.
+		SIM_Playing	= 3,	// In game, driving the viewpoint.
+	};
+
+	// Variables.
+	INT				SimIndex;				// Index of this client in the load test.
+	UBOOL			Scripted;				// Follow navigation points in order instead of randomly.
+	BYTE			Stage;					// Current ESimStage.
+	INT				ClientPacketId;			// Next client-side outgoing packet id.
+	INT				ClientReliable;			// Last client-side control channel sequence.
+	TArray<INT>		ClientAcks;				// Server packets awaiting acknowledgement.
+	TArray<FString>	ClientText;				// Control channel text awaiting send.
+	ANavigationPoint* ViewPoint;			// Current viewpoint anchor.
+	FLOAT			ViewTime;				// Seconds until the next viewpoint change.
+	INT				ReceivedBytes;			// Total bytes the server sent to this client.
+	INT				ReceivedPackets;		// Total packets the server sent to this client.
+
+	// Constructors.
+	USimClientConnection( UNetDriver* InDriver, INT InSimIndex, UBOOL InScripted );
+
+	// UNetConnection interface.
+	FString LowLevelGetRemoteAddress();
+	FString LowLevelDescribe();
+	void LowLevelSend( void* Data, INT Count );
+	void Tick();
+
+	// USimClientConnection interface.
+	void ClientTick( FLOAT DeltaSeconds );
+	void ClientSendText( const TCHAR* Text );
+	void ClientFlush();
+	void ClientMoveView( FLOAT DeltaSeconds );
+};
+
+/*-----------------------------------------------------------------------------
+	FNetLoadTest.
+-----------------------------------------------------------------------------*/
+
+//
+// Drives a set of simulated clients against the level's net driver and
+// gathers server tick statistics while they are connected.
+//
+struct ENGINE_API FNetLoadTest
+{
+	// Variables.
+	UBOOL			Active;
+	INT				NumClients;
+	FLOAT			Duration;
+	DOUBLE			StartTime;
+	DOUBLE			LastTickTime;
+	FTimeSamples	FrameTimes;				// Wall time between server net ticks.
+	FTimeSamples	ActorTimes;				// Actor tick time per frame.
+	FTimeSamples	NetTimes;				// Server net tick time per frame.
+	INT				ActorsReplicated;		// Actor channel updates sent.
+	INT				PropertiesReplicated;	// Properties replicated.
+
+	// Constructor.
+	FNetLoadTest();
+
+	// Functions.
+	void Start( ULevel* Level, INT Count, UBOOL Scripted, FLOAT Seconds, FOutputDevice& Ar );
+	void Stop( ULevel* Level, FOutputDevice& Ar );
+	void Tick( ULevel* Level, INT Updated );
+	void Report( ULevel* Level, FOutputDevice& Ar );
+	UBOOL Exec( ULevel* Level, const TCHAR* Cmd, FOutputDevice& Ar );
+};
+
+ENGINE_API extern FNetLoadTest GNetLoad;
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,90 @@
+/*=============================================================================
+	UnStats.h: Sampled timing statistics for benchmarks.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FTimeSamples.
+-----------------------------------------------------------------------------*/
+
+//
+// Compare two samples for appQsort.
+//
+inline INT CDECL CompareTimeSamples( const void* A, const void* B )
+{
+	FLOAT Diff = *(const FLOAT*)A - *(const FLOAT*)B;
+	return Diff<0.f ? -1 : Diff>0.f ? 1 : 0;
+}
+
+//
+// A series of timing samples in milliseconds, with percentile queries.
+//
+struct FTimeSamples
+{
+	// Variables.
+	TArray<FLOAT>	Samples;
+	FLOAT			Total;
+	UBOOL			Sorted;
+
+	// Constructor.
+	FTimeSamples()
+	:	Total	( 0.f )
+	,	Sorted	( 1 )
+	{}
+
+	// Functions.
+	void Add( FLOAT Msec )
+	{
+		Samples.AddItem( Msec );
+		Total  += Msec;
+		Sorted  = 0;
+	}
+	void Empty()
+	{
+		Samples.Empty();
+		Total  = 0.f;
+		Sorted = 1;
+	}
+	INT Num() const
+	{
+		return Samples.Num();
+	}
+	void Sort()
+	{
+		if( !Sorted && Samples.Num() )
+			appQsort( &Samples(0), Samples.Num(), sizeof(FLOAT), CompareTimeSamples );
+		Sorted = 1;
+	}
+	FLOAT Average() const
+	{
+		return Samples.Num() ? Total / Samples.Num() : 0.f;
+	}
+	FLOAT Percentile( FLOAT Percent )
+	{
+		if( !Samples.Num() )
+			return 0.f;
+		Sort();
+		INT Index = Clamp( appFloor(Percent * 0.01f * (Samples.Num()-1) + 0.5f), 0, Samples.Num()-1 );
+		return Samples(Index);
+	}
+	FLOAT Min()
+	{
+		return Percentile( 0.f );
+	}
+	FLOAT Max()
+	{
+		return Percentile( 100.f );
+	}
+	FString Describe()
+	{
+		return FString::Printf
+		(
+			TEXT("min=%.2f avg=%.2f p50=%.2f p95=%.2f p99=%.2f max=%.2f (%i samples)"),
+			Min(), Average(), Percentile(50.f), Percentile(95.f), Percentile(99.f), Max(), Num()
+		);
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
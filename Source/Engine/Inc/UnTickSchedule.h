@@ -0,0 +1,66 @@
+/*=============================================================================
+	UnTickSchedule.h: Scheduling of actor ticks.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FTickScheduler.
+-----------------------------------------------------------------------------*/
+
+//
+// An actor's place in the tick schedule, kept in AActor::OtherTag.
+//
+enum ETickSchedule
+{
+	TICKSCHED_None		= 0,	// Not scheduled: static, or scheduler not built yet.
+	TICKSCHED_Active	= 1,	// In the active list, ticked every frame.
+	TICKSCHED_Dormant	= 2,	// Asleep, at Dormant(OtherTag-TICKSCHED_Dormant).
+};
+
+//
+// The dynamic actors a level ticks each frame.  An actor with no physics,
+// animation, timer, lifespan, state code or script Tick does nothing when
+// ticked, so it is put to sleep instead and left out of the tick loop until
+// one of those is set up for it.  The natives that do so wake it directly;
+// a few dormant actors are rechecked each frame to catch changes made by
+// script assignment.
+//
+class ENGINE_API FTickScheduler
+{
+public:
+	// Variables.
+	TArray<AActor*>	Active;				// Awake actors, in tick order.
+	TArray<AActor*>	Dormant;			// Sleeping actors.
+	INT				iRecheck;			// Next dormant entry to recheck.
+	UBOOL			bTickedActors;		// Actors have been ticked this frame.
+
+	// Stats.
+	INT				NumTicked, NumSkipped;	// Last frame.
+	INT				NumSleeps, NumWakes, NumRechecks;
+
+	// Constructor.
+	FTickScheduler();
+
+	// Functions.
+	void Build( ULevel* Level );
+	void AddActor( AActor* Actor );
+	void RemoveActor( AActor* Actor );
+	void Wake( AActor* Actor );
+	INT TickActors( ULevel* Level, FLOAT DeltaSeconds, ELevelTick TickType );
+	void Purge();
+	FString Describe() const;
+	static UBOOL CanSleep( AActor* Actor );
+	static UBOOL IsDormant( AActor* Actor )
+	{
+		return Actor->OtherTag>=TICKSCHED_Dormant;
+	}
+
+	// Implementation.
+	void Sleep( AActor* Actor );
+	void Unsleep( AActor* Actor );
+	void Recheck();
+};
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -146,6 +146,7 @@ struct CFLodHeader
 	FName	CachedSeq;	
 	INT     CachedLodVerts;
 	FLOAT   TweenIndicator;
+	FLOAT	CachedTime;		// Level time last sampled.
 };	
 
 void ULodMesh::GetFrame
@@ -203,14 +204,32 @@ void ULodMesh::GetFrame
 		FrameHdr->CachedSeq   = NAME_None;
 		FrameHdr->CachedFrame = 0.0;
 		FrameHdr->CachedLodVerts = 0;
+		FrameHdr->CachedTime = 0.0;
 	}
 
 	// Get stuff.
 	FLOAT    DrawScale      = AnimOwner->bParticles ? 1.0 : Owner->DrawScale;
 	FVector* CachedVerts    = (FVector*)((BYTE*)Mem + sizeof(CFLodHeader));
+	FVector  ViewLocation   = Coords.Origin;
 	Coords                  = Coords * (Owner->Location + Owner->PrePivot) * Owner->Rotation * RotOrigin * FScale(Scale * DrawScale,0.0,SHEER_None);
 	const FMeshAnimSeq* Seq = GetAnimSeq( AnimOwner->AnimSequence );
 
+	// Reuse the cached frame of a distant mesh until it's due a resample,
+	// unless it now needs more vertices than were cached.
+	if
+	(	WasCached
+	&&	VertexNum<=FrameHdr->CachedLodVerts
+	&&	!GMeshAnimLOD.NeedsSample( Owner, ViewLocation, FrameHdr->CachedTime ) )
+	{
+		LODRequest = VertexNum - SpecialVerts;
+		FMeshLerp::Transform( VertexNum, CachedVerts, Origin, Coords, ResultVerts, Size );
+		GMeshAnimLOD.Reused( VertexNum );
+		Item->Unlock();
+		return;
+	}
+	FrameHdr->CachedTime = Owner->Level ? Owner->Level->TimeSeconds : 0.0;
+	GMeshAnimLOD.Decoded( VertexNum );
+
 
 	if( AnimOwner->AnimFrame>=0.0  || !WasCached )
 	{
@@ -234,30 +253,12 @@ void ULodMesh::GetFrame
 		if ( Alpha <= 0.0f)
 		{
 			// Initialize a single frame.
-			FMeshVert* MeshVertex1 = &Verts( iFrameOffset1 );
-
-			for( INT i=0; i<VertexNum; i++ )
-			{
-				// Expand new vector from stored compact integers.
-				CachedVerts[i] = FVector( MeshVertex1[i].X, MeshVertex1[i].Y, MeshVertex1[i].Z );
-				// Transform all points into screenspace.
-				*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-				*(BYTE**)&ResultVerts += Size;
-			}	
+			FMeshLerp::Unpack( &Verts(iFrameOffset1), VertexNum, CachedVerts, Origin, Coords, ResultVerts, Size );
 		}
 		else
 		{	
 			// Interpolate two frames.
-			FMeshVert* MeshVertex1 = &Verts( iFrameOffset1 );
-			FMeshVert* MeshVertex2 = &Verts( iFrameOffset2 );
-			for( INT i=0; i<VertexNum; i++ )
-			{
-				FVector V1( MeshVertex1[i].X, MeshVertex1[i].Y, MeshVertex1[i].Z );
-				FVector V2( MeshVertex2[i].X, MeshVertex2[i].Y, MeshVertex2[i].Z );
-				CachedVerts[i] = V1 + (V2-V1)*Alpha;
-				*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-				*(BYTE**)&ResultVerts += Size;
-			}
+			FMeshLerp::Lerp( &Verts(iFrameOffset1), &Verts(iFrameOffset2), Alpha, VertexNum, CachedVerts, Origin, Coords, ResultVerts, Size );
 		}	
 	}
 	else // Tween: cache present, and starting from Animframe < 0.0
@@ -297,11 +298,7 @@ void ULodMesh::GetFrame
 			// now is the time to fill it out to the requested number.
 			if (VertexNum < VertsRequested )
 			{
-				FMeshVert* MeshVertex = &Verts( iFrameOffset );
-				for( INT i=VertexNum; i<VertsRequested; i++ )
-				{
-					CachedVerts[i]= FVector( MeshVertex[i].X, MeshVertex[i].Y, MeshVertex[i].Z );
-				}
+				FMeshLerp::Unpack( &Verts(iFrameOffset+VertexNum), VertsRequested-VertexNum, CachedVerts+VertexNum, Origin, Coords, NULL, 0 );
 				VertexNum = VertsRequested;
 				LODRequest = VertexNum - SpecialVerts; 
 				FrameHdr->CachedLodVerts = VertexNum;   
@@ -311,23 +308,12 @@ void ULodMesh::GetFrame
 		// Special case Alpha 0.
 		if (Alpha <= 0.0f)
 		{
-			for( INT i=0; i<VertexNum; i++ )
-			{
-				*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-				*(BYTE**)&ResultVerts += Size;
-			}
+			FMeshLerp::Transform( VertexNum, CachedVerts, Origin, Coords, ResultVerts, Size );
 		}
 		else
 		{
 			// Tween all points between cached value and new one.
-			FMeshVert* MeshVertex = &Verts( iFrameOffset );
-			for( INT i=0; i<VertexNum; i++ )
-			{
-				FVector V2( MeshVertex[i].X, MeshVertex[i].Y, MeshVertex[i].Z );
-				CachedVerts[i] += (V2 - CachedVerts[i]) * Alpha;
-				*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-				*(BYTE**)&ResultVerts += Size;
-			}
+			FMeshLerp::Tween( &Verts(iFrameOffset), Alpha, VertexNum, CachedVerts, Origin, Coords, ResultVerts, Size );
 		}
 		// Update cached frame.
 		FrameHdr->CachedFrame = AnimOwner->AnimFrame;
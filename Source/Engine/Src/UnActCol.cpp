@@ -31,6 +31,7 @@ public:
 	FCheckResult* ActorLineCheck( FMemStack& Mem, FVector End, FVector Start, FVector Extent, BYTE ExtraNodeFlags );
 	FCheckResult* ActorPointCheck( FMemStack& Mem, FVector Location, FVector Extent, DWORD ExtraNodeFlags );
 	FCheckResult* ActorRadiusCheck( FMemStack& Mem, FVector Location, FLOAT Radius, DWORD ExtraNodeFlags );
+	FCheckResult* ActorOverlapRadiusCheck( FMemStack& Mem, FVector Location, FLOAT Radius );
 	FCheckResult* ActorEncroachmentCheck( FMemStack& Mem, AActor* Actor, FVector Location, FRotator Rotation, DWORD ExtraNodeFlags );
 	void CheckActorNotReferenced( AActor* Actor );
 
@@ -59,6 +60,7 @@ public:
 		INT				 iLocation; // Based hash location.
 	} *Hash[NUM_BUCKETS], *Available;
 	TArray<FCollisionLink*> LinksToFree;
+	FLOAT MaxZPad; // Largest amount a cylinder's radius exceeds its height.
 
 	// Statics.
 	static UBOOL Inited;
@@ -113,6 +115,7 @@ static INT GActorsAdded=0, GFragsAdded=0, GUsed=0, GChecks=0;
 FCollisionHash::FCollisionHash()
 : Available( NULL )
 , LinksToFree(  )
+, MaxZPad( 0.f )
 {
 	guard(FCollisionHash::FCollisionHash);
 
@@ -215,6 +218,7 @@ void FCollisionHash::AddActor( AActor *Actor )
 	// Add actor in all the specified places.
 	INT X0,Y0,Z0,X1,Y1,Z1;
 	GetActorExtent( Actor, X0, X1, Y0, Y1, Z0, Z1 );
+	MaxZPad = Max( MaxZPad, Actor->CollisionRadius - Actor->CollisionHeight );
 	for( INT X=X0; X<=X1; X++ )
 	{
 		for( INT Y=Y0; Y<=Y1; Y++ )
@@ -413,6 +417,54 @@ FCheckResult* FCollisionHash::ActorRadiusCheck
 	unguard;
 }
 
+//
+// Make a list of all actors whose location is closer to a point than a given
+// radius plus their own collision radius, as RadiusActors tests them.
+//
+FCheckResult* FCollisionHash::ActorOverlapRadiusCheck
+(
+	FMemStack&		Mem,
+	FVector			Location,
+	FLOAT			Radius
+)
+{
+	guard(FCollisionHash::ActorOverlapRadiusCheck);
+	FCheckResult* Result=NULL;
+
+	// An actor is hashed over its collision box, so one in range has a cell
+	// within Radius of the point, except vertically for squat cylinders.
+	INT X0,Y0,Z0,X1,Y1,Z1;
+	GetHashIndices( Location - FVector(Radius,Radius,Radius+MaxZPad), X0, Y0, Z0 );
+	GetHashIndices( Location + FVector(Radius,Radius,Radius+MaxZPad), X1, Y1, Z1 );
+	CollisionTag++;
+
+	// Check all actors in this neighborhood.
+	for( INT X=X0; X<=X1; X++ ) for( INT Y=Y0; Y<=Y1; Y++ ) for( INT Z=Z0; Z<=Z1; Z++ )
+	{
+		INT iLocation;
+		for( FCollisionLink* Link = GetHashLink( X, Y, Z, iLocation ); Link; Link=Link->Next )
+		{
+			// Skip if we've already checked this actor.
+			if
+			(	Link->Actor->CollisionTag != CollisionTag 
+			&&	Link->iLocation           == iLocation )
+			{
+				// Collision test.
+				Link->Actor->CollisionTag = CollisionTag;
+				if( (Link->Actor->Location - Location).SizeSquared() < Square(Radius + Link->Actor->CollisionRadius) )
+				{
+					FCheckResult* New = new(Mem)FCheckResult;
+					New->Actor = Link->Actor;
+					New->GetNext() = Result;
+					Result = New;
+				}
+			}
+		}
+	}
+	return Result;
+	unguard;
+}
+
 //
 // Check for encroached actors.
 //
@@ -525,6 +525,10 @@ void AActor::PostNetReceive()
 	Exchange ( CollisionHeight, SavedHeight    );
 	if( bCollideActors )
 		GetLevel()->Hash->AddActor( this );
+	if( GetLevel()->Broadphase )
+		GetLevel()->Broadphase->MoveActor( this );
+	if( GetLevel()->TickScheduler )
+		GetLevel()->TickScheduler->Wake( this );
 	if( IsA(AMover::StaticClass()) )
 	{
 		AMover* Mover = Cast<AMover>( this );
@@ -797,6 +801,8 @@ void AActor::SetCollisionSize( FLOAT NewRadius, FLOAT NewHeight )
 	// Touch this actor.
 	if( bCollideActors && GetLevel()->Hash )
 		GetLevel()->Hash->AddActor( this );
+	if( GetLevel()->Broadphase )
+		GetLevel()->Broadphase->MoveActor( this );
 
 	unguard;
 }
@@ -0,0 +1,249 @@
+/*=============================================================================
+	UnActorIndex.cpp: Per-class index of a level's actors.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	FActorClassIndex.
+-----------------------------------------------------------------------------*/
+
+static QSORT_RETURN CDECL CompareActorIndices( const INT* A, const INT* B )
+{
+	return *A - *B;
+}
+
+FActorClassIndex::FActorClassIndex()
+:	NumQueries	( 0 )
+,	NumScans	( 0 )
+,	NumVisited	( 0 )
+,	NumBuilds	( 0 )
+,	NumCompacts	( 0 )
+{}
+FActorClassIndex::~FActorClassIndex()
+{
+	for( INT i=0; i<Lists.Num(); i++ )
+		delete Lists(i);
+}
+
+void FActorClassIndex::Build( ULevel* Level )
+{
+	guard(FActorClassIndex::Build);
+	for( INT i=0; i<Lists.Num(); i++ )
+		delete Lists(i);
+	Lists.Empty();
+	ClassMap.Empty();
+	for( INT iActor=0; iActor<Level->Actors.Num(); iActor++ )
+		if( Level->Actors(iActor) )
+			AddActor( Level->Actors(iActor), iActor );
+	NumBuilds++;
+	unguard;
+}
+
+//
+// Note an actor placed at Actors(iActor).  Spawned actors always go at the
+// end of the list, so this is normally an append.
+//
+void FActorClassIndex::AddActor( AActor* Actor, INT iActor )
+{
+	guardSlow(FActorClassIndex::AddActor);
+	UClass* Class = Actor->GetClass();
+	INT*    Found = ClassMap.Find( Class );
+	FActorClassList* List;
+	if( Found )
+		List = Lists(*Found);
+	else
+	{
+		ClassMap.Set( Class, Lists.Num() );
+		List = new FActorClassList;
+		List->Class = Class;
+		Lists.AddItem( List );
+	}
+	INT i = List->Actors.Num();
+	while( i>0 && List->Actors(i-1)>iActor )
+		i--;
+	List->Actors.Insert( i );
+	List->Actors(i) = iActor;
+	unguardSlow;
+}
+
+void FActorClassIndex::RemoveActor( AActor* Actor, INT iActor )
+{
+	guardSlow(FActorClassIndex::RemoveActor);
+	INT* Found = ClassMap.Find( Actor->GetClass() );
+	if( !Found )
+		return;
+	TArray<INT>& Actors = Lists(*Found)->Actors;
+	INT Min=0, Max=Actors.Num()-1;
+	while( Min<=Max )
+	{
+		INT Mid = (Min+Max)/2;
+		if( Actors(Mid)<iActor )
+			Min = Mid+1;
+		else if( Actors(Mid)>iActor )
+			Max = Mid-1;
+		else
+		{
+			Actors.Remove( Mid );
+			break;
+		}
+	}
+	unguardSlow;
+}
+
+//
+// Renumber the lists after the actor list slots in Removed, ascending, have
+// been taken out and everything after them moved down.  Compaction keeps
+// the actors' order, so the lists stay sorted.
+//
+void FActorClassIndex::Compact( const TArray<INT>& Removed )
+{
+	guard(FActorClassIndex::Compact);
+	for( INT l=0; l<Lists.Num(); l++ )
+	{
+		TArray<INT>& Actors = Lists(l)->Actors;
+		INT r=0, c=0;
+		for( INT i=0; i<Actors.Num(); i++ )
+		{
+			while( r<Removed.Num() && Removed(r)<Actors(i) )
+				r++;
+			if( r<Removed.Num() && Removed(r)==Actors(i) )
+				continue;
+			Actors(c++) = Actors(i) - r;
+		}
+		if( c<Actors.Num() )
+			Actors.Remove( c, Actors.Num()-c );
+	}
+	NumCompacts++;
+	unguard;
+}
+
+//
+// Collect the indices of the actors that are BaseClass or a subclass of it,
+// in actor list order.  Returns 0 if they are a large part of the level, in
+// which case scanning the actor list is cheaper.
+//
+UBOOL FActorClassIndex::Gather( ULevel* Level, UClass* BaseClass, TArray<INT>& Result )
+{
+	guardSlow(FActorClassIndex::Gather);
+	if( BaseClass!=AActor::StaticClass() )
+	{
+		INT NumMatched=0;
+		for( INT i=0; i<Lists.Num(); i++ )
+		{
+			FActorClassList* List = Lists(i);
+			if( List->Actors.Num() && List->Class->IsChildOf(BaseClass) )
+			{
+				INT Start = Result.Add( List->Actors.Num() );
+				appMemcpy( &Result(Start), &List->Actors(0), List->Actors.Num()*sizeof(INT) );
+				if( Result.Num()*2>Level->Actors.Num() )
+					break;
+				NumMatched++;
+			}
+		}
+		if( Result.Num()*2<=Level->Actors.Num() )
+		{
+			if( NumMatched>1 )
+				appQsort( &Result(0), Result.Num(), sizeof(INT), (QSORT_COMPARE)CompareActorIndices );
+			NumQueries++;
+			NumVisited += Result.Num();
+			return 1;
+		}
+	}
+	Result.Empty();
+	NumScans++;
+	return 0;
+	unguardSlow;
+}
+
+FString FActorClassIndex::Describe() const
+{
+	guard(FActorClassIndex::Describe);
+	return FString::Printf
+	(
+		TEXT("%i classes, built %i times, compacted %i times, %i indexed iterations visiting %.1f actors each, %i full scans"),
+		Lists.Num(),
+		NumBuilds,
+		NumCompacts,
+		NumQueries,
+		NumQueries ? (FLOAT)NumVisited / NumQueries : 0.f,
+		NumScans
+	);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FActorClassIndex benchmark.
+-----------------------------------------------------------------------------*/
+
+static QSORT_RETURN CDECL CompareClassLists( const FActorClassList** A, const FActorClassList** B )
+{
+	return (*A)->Actors.Num() - (*B)->Actors.Num();
+}
+
+//
+// Time iterating over a spread of the level's classes, from the rarest to
+// the most common, by scanning the actor list and through the index.
+//
+void FActorClassIndex::Benchmark( ULevel* Level, FOutputDevice& Ar )
+{
+	guard(FActorClassIndex::Benchmark);
+	enum {NUM_REPS=100, NUM_CLASSES=8};
+	INT SavedQueries=NumQueries, SavedScans=NumScans, SavedVisited=NumVisited;
+
+	TArray<FActorClassList*> Sorted;
+	for( INT i=0; i<Lists.Num(); i++ )
+		if( Lists(i)->Actors.Num() )
+			Sorted.AddItem( Lists(i) );
+	if( !Sorted.Num() )
+		return;
+	appQsort( &Sorted(0), Sorted.Num(), sizeof(FActorClassList*), (QSORT_COMPARE)CompareClassLists );
+
+	Ar.Logf( TEXT("Iterating %i actor slots, %i reps:"), Level->Actors.Num(), NUM_REPS );
+	INT NumClasses = Min<INT>( Sorted.Num(), NUM_CLASSES );
+	for( INT c=0; c<NumClasses; c++ )
+	{
+		UClass* Class = Sorted(NumClasses>1 ? c*(Sorted.Num()-1)/(NumClasses-1) : 0)->Class;
+		DWORD ScanCycles=0, IndexCycles=0;
+		INT NumFound=0, Rep, i;
+		clock(ScanCycles);
+		for( Rep=0; Rep<NUM_REPS; Rep++ )
+			for( i=0; i<Level->Actors.Num(); i++ )
+				if( Level->Actors(i) && Level->Actors(i)->IsA(Class) )
+					NumFound++;
+		unclock(ScanCycles);
+		clock(IndexCycles);
+		for( Rep=0; Rep<NUM_REPS; Rep++ )
+		{
+			TArray<INT> Found;
+			if( Gather(Level, Class, Found) )
+			{
+				for( i=0; i<Found.Num(); i++ )
+					if( Level->Actors(Found(i)) && Level->Actors(Found(i))->IsA(Class) )
+						NumFound--;
+			}
+			else
+			{
+				for( i=0; i<Level->Actors.Num(); i++ )
+					if( Level->Actors(i) && Level->Actors(i)->IsA(Class) )
+						NumFound--;
+			}
+		}
+		unclock(IndexCycles);
+		Ar.Logf
+		(
+			TEXT("   %-24s scan %.4f msec, index %.4f msec%s"),
+			Class->GetName(),
+			GSecondsPerCycle * 1000.f * ScanCycles / NUM_REPS,
+			GSecondsPerCycle * 1000.f * IndexCycles / NUM_REPS,
+			NumFound ? TEXT(" MISMATCH") : TEXT("")
+		);
+	}
+	NumQueries=SavedQueries; NumScans=SavedScans; NumVisited=SavedVisited;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
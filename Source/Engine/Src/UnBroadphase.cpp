@@ -0,0 +1,213 @@
+/*=============================================================================
+	UnBroadphase.cpp: Spatial lookup of actors by location.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	FActorBroadphase.
+-----------------------------------------------------------------------------*/
+
+FActorBroadphase::FActorBroadphase()
+:	FirstFree		( INDEX_NONE )
+,	NumActors		( 0 )
+,	NumStale		( 0 )
+,	MaxRadius		( 0.f )
+,	NumQueries		( 0 )
+,	NumScans		( 0 )
+,	NumCandidates	( 0 )
+,	NumBuilds		( 0 )
+{
+	for( INT i=0; i<NUM_BUCKETS; i++ )
+		Heads[i] = INDEX_NONE;
+}
+
+void FActorBroadphase::Build( ULevel* Level )
+{
+	guard(FActorBroadphase::Build);
+	for( INT i=0; i<NUM_BUCKETS; i++ )
+		Heads[i] = INDEX_NONE;
+	Links.Empty();
+	LinkMap.Empty();
+	FirstFree = INDEX_NONE;
+	MaxRadius = 0.f;
+	NumActors = NumStale = 0;
+	for( INT iActor=0; iActor<Level->Actors.Num(); iActor++ )
+	{
+		AActor* Actor = Level->Actors(iActor);
+		if( Actor && !Actor->bDeleteMe )
+			AddActor( Actor );
+	}
+	NumBuilds++;
+	unguard;
+}
+
+void FActorBroadphase::AddActor( AActor* Actor )
+{
+	guardSlow(FActorBroadphase::AddActor);
+	INT* Found = LinkMap.Find( Actor );
+	if( Found && Links(*Found).Actor==Actor )
+	{
+		MoveActor( Actor );
+		return;
+	}
+	INT iLink = FirstFree;
+	if( iLink!=INDEX_NONE )
+		FirstFree = Links(iLink).Next;
+	else
+		iLink = Links.Add();
+	INT X, Y, Z;
+	GetCell( Actor->Location, X, Y, Z );
+	FLink& Link  = Links(iLink);
+	Link.Actor   = Actor;
+	Link.Cell    = GetCellIndex( X, Y, Z );
+	INT& Head    = Heads[GetBucket(Link.Cell)];
+	Link.Next    = Head;
+	Head         = iLink;
+	LinkMap.Set( Actor, iLink );
+	MaxRadius    = Max( MaxRadius, Actor->CollisionRadius );
+	NumActors++;
+	unguardSlow;
+}
+
+void FActorBroadphase::RemoveActor( AActor* Actor )
+{
+	guardSlow(FActorBroadphase::RemoveActor);
+	INT* Found = LinkMap.Find( Actor );
+	if( !Found || Links(*Found).Actor!=Actor )
+		return;
+	INT iLink = *Found;
+	Unlink( iLink );
+	Links(iLink).Actor = NULL;
+	Links(iLink).Next  = FirstFree;
+	FirstFree          = iLink;
+	NumActors--;
+
+	// TMap removal rehashes, so leave the entry to be ignored and only
+	// rebuild the map once stale entries outnumber live ones.
+	if( ++NumStale > NumActors+1024 )
+	{
+		LinkMap.Empty();
+		for( INT i=0; i<Links.Num(); i++ )
+			if( Links(i).Actor )
+				LinkMap.Set( Links(i).Actor, i );
+		NumStale = 0;
+	}
+	unguardSlow;
+}
+
+//
+// Note that an actor's location or collision size changed.
+//
+void FActorBroadphase::MoveActor( AActor* Actor )
+{
+	guardSlow(FActorBroadphase::MoveActor);
+	INT* Found = LinkMap.Find( Actor );
+	if( !Found || Links(*Found).Actor!=Actor )
+		return;
+	MaxRadius = Max( MaxRadius, Actor->CollisionRadius );
+	INT X, Y, Z;
+	GetCell( Actor->Location, X, Y, Z );
+	INT Cell = GetCellIndex( X, Y, Z );
+	FLink& Link = Links(*Found);
+	if( Link.Cell != Cell )
+	{
+		Unlink( *Found );
+		Link.Cell = Cell;
+		INT& Head = Heads[GetBucket(Cell)];
+		Link.Next = Head;
+		Head      = *Found;
+	}
+	unguardSlow;
+}
+
+//
+// Take a link out of its bucket.
+//
+void FActorBroadphase::Unlink( INT iLink )
+{
+	guardSlow(FActorBroadphase::Unlink);
+	INT* Prev = &Heads[GetBucket(Links(iLink).Cell)];
+	while( *Prev!=iLink )
+	{
+		check(*Prev!=INDEX_NONE);
+		Prev = &Links(*Prev).Next;
+	}
+	*Prev = Links(iLink).Next;
+	unguardSlow;
+}
+
+//
+// Collect the actors whose location is within Radius of Location, plus their
+// collision radius if bAddRadius.  Returns 0 if the query covers so much of
+// the world that scanning the actor list is cheaper.
+//
+UBOOL FActorBroadphase::Gather( ULevel* Level, FVector Location, FLOAT Radius, UBOOL bAddRadius, TArray<AActor*>& Result )
+{
+	guardSlow(FActorBroadphase::Gather);
+
+	// Cells any actor in range can be in.  The collision hash is finer
+	// grained, so allow for it visiting several times as many.
+	FLOAT Reach = Radius + (bAddRadius ? MaxRadius : 0.f);
+	INT X0, Y0, Z0, X1, Y1, Z1;
+	GetCell( Location - FVector(Reach,Reach,Reach), X0, Y0, Z0 );
+	GetCell( Location + FVector(Reach,Reach,Reach), X1, Y1, Z1 );
+	if( 8*(X1-X0+1)*(Y1-Y0+1)*(Z1-Z0+1) > Level->Actors.Num() )
+	{
+		NumScans++;
+		return 0;
+	}
+
+	// Colliding cylinders, from the collision hash.
+	if( Level->Hash )
+	{
+		FMemMark Mark(GMem);
+		FCheckResult* Hit = bAddRadius
+			? Level->Hash->ActorOverlapRadiusCheck( GMem, Location, Radius )
+			: Level->Hash->ActorRadiusCheck( GMem, Location, Radius, 0 );
+		for( ; Hit; Hit=Hit->GetNext() )
+			if( InHash(Level,Hit->Actor) && !Hit->Actor->bDeleteMe )
+				Result.AddItem( Hit->Actor );
+		Mark.Pop();
+	}
+
+	// Everything else, from the grid.
+	for( INT X=X0; X<=X1; X++ ) for( INT Y=Y0; Y<=Y1; Y++ ) for( INT Z=Z0; Z<=Z1; Z++ )
+	{
+		INT Cell = GetCellIndex( X, Y, Z );
+		for( INT iLink=Heads[GetBucket(Cell)]; iLink!=INDEX_NONE; iLink=Links(iLink).Next )
+		{
+			AActor* Actor = Links(iLink).Actor;
+			if
+			(	Links(iLink).Cell==Cell
+			&&	!InHash(Level,Actor)
+			&&	!Actor->bDeleteMe
+			&&	(Actor->Location - Location).SizeSquared() < Square(Radius + (bAddRadius ? Actor->CollisionRadius : 0.f)) )
+				Result.AddItem( Actor );
+		}
+	}
+	NumQueries++;
+	NumCandidates += Result.Num();
+	return 1;
+	unguardSlow;
+}
+
+FString FActorBroadphase::Describe() const
+{
+	guard(FActorBroadphase::Describe);
+	return FString::Printf
+	(
+		TEXT("%i actors, built %i times, %i spatial queries finding %.1f actors each, %i full scans"),
+		NumActors,
+		NumBuilds,
+		NumQueries,
+		NumQueries ? (FLOAT)NumCandidates / NumQueries : 0.f,
+		NumScans
+	);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -44,11 +44,13 @@ FArchive& FInBunch::operator<<( class FName& N )
 // It is ok to either send or discard an FOutbunch after construction.
 //
 FOutBunch::FOutBunch()
-: FBitWriter( 0 )
+:	FBitWriter	( 0 )
+,	FirstTime	( -1.0 )
 {}
 FOutBunch::FOutBunch( UChannel* InChannel, UBOOL bInClose )
 :	FBitWriter	( InChannel->Connection->MaxPacket*8-MAX_BUNCH_HEADER_BITS-MAX_PACKET_TRAILER_BITS-MAX_PACKET_HEADER_BITS )
 ,	Channel		( InChannel )
+,	FirstTime	( -1.0 )
 ,	ChIndex     ( InChannel->ChIndex )
 ,	ChType      ( InChannel->ChType )
 ,	bOpen		( 0 )
@@ -193,6 +193,63 @@ void URenderDevice::Draw3DLine
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	UNullRenderDevice.
+-----------------------------------------------------------------------------*/
+
+UBOOL UNullRenderDevice::Init( UViewport* InViewport, INT NewX, INT NewY, INT NewColorBytes, UBOOL Fullscreen )
+{
+	guard(UNullRenderDevice::Init);
+	Viewport          = InViewport;
+	SpanBased         = 0;
+	SupportsFogMaps   = 0;
+	HighDetailActors  = 1;
+	debugf( NAME_Init, TEXT("Null render device: nothing will be drawn") );
+	return 1;
+	unguard;
+}
+UBOOL UNullRenderDevice::SetRes( INT NewX, INT NewY, INT NewColorBytes, UBOOL Fullscreen )
+{
+	return 1;
+}
+void UNullRenderDevice::Exit()
+{}
+void UNullRenderDevice::Flush( UBOOL AllowPrecache )
+{}
+void UNullRenderDevice::Lock( FPlane FlashScale, FPlane FlashFog, FPlane ScreenClear, DWORD RenderLockFlags, BYTE* HitData, INT* HitSize )
+{}
+void UNullRenderDevice::Unlock( UBOOL Blit )
+{}
+void UNullRenderDevice::DrawComplexSurface( FSceneNode* Frame, FSurfaceInfo& Surface, FSurfaceFacet& Facet )
+{}
+void UNullRenderDevice::DrawGouraudPolygon( FSceneNode* Frame, FTextureInfo& Info, FTransTexture** Pts, int NumPts, DWORD PolyFlags, FSpanBuffer* Span )
+{}
+void UNullRenderDevice::DrawTile( FSceneNode* Frame, FTextureInfo& Info, FLOAT X, FLOAT Y, FLOAT XL, FLOAT YL, FLOAT U, FLOAT V, FLOAT UL, FLOAT VL, class FSpanBuffer* Span, FLOAT Z, FPlane Color, FPlane Fog, DWORD PolyFlags )
+{}
+void UNullRenderDevice::Draw3DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector OrigP, FVector OrigQ )
+{}
+void UNullRenderDevice::Draw2DLine( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FVector P1, FVector P2 )
+{}
+void UNullRenderDevice::Draw2DPoint( FSceneNode* Frame, FPlane Color, DWORD LineFlags, FLOAT X1, FLOAT Y1, FLOAT X2, FLOAT Y2, FLOAT Z )
+{}
+void UNullRenderDevice::ClearZ( FSceneNode* Frame )
+{}
+void UNullRenderDevice::PushHit( const BYTE* Data, INT Count )
+{}
+void UNullRenderDevice::PopHit( INT Count, UBOOL bForce )
+{}
+void UNullRenderDevice::GetStats( TCHAR* Result )
+{
+	if( Result )
+		*Result = 0;
+}
+void UNullRenderDevice::ReadPixels( FColor* Pixels )
+{
+	guard(UNullRenderDevice::ReadPixels);
+	appMemzero( Pixels, Viewport->SizeX * Viewport->SizeY * sizeof(FColor) );
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	UViewport object implementation.
 -----------------------------------------------------------------------------*/
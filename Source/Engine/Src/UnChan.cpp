@@ -118,6 +118,8 @@ void UChannel::ReceivedAcks()
 	while( OutRec && OutRec->ReceivedAck )
 	{
 		DoClose |= OutRec->bClose;
+		if( OutRec->FirstTime>=0.0 )
+			Connection->RateControl.Delivered( Connection->Driver->Time - OutRec->FirstTime );
 		FOutBunch* Release = OutRec;
 		OutRec = OutRec->Next;
 		delete Release;
@@ -526,6 +528,199 @@ FString UControlChannel::Describe()
 
 IMPLEMENT_CLASS(UControlChannel);
 
+/*-----------------------------------------------------------------------------
+	FRepSnapshot.
+-----------------------------------------------------------------------------*/
+
+//
+// Whether every channel sends the same bits for a property's value.
+//
+static UBOOL IsShareableRep( UProperty* Property )
+{
+	static FName NAME_bNetInitial(TEXT("bNetInitial")), NAME_bNetOwner(TEXT("bNetOwner")), NAME_bSimulatedPawn(TEXT("bSimulatedPawn"));
+	static FName NAME_bDemoRecording(TEXT("bDemoRecording")), NAME_bClientDemoRecording(TEXT("bClientDemoRecording"));
+	FName Name = Property->GetFName();
+	if
+	(	Name==NAME_Role
+	||	Name==NAME_RemoteRole
+	||	Name==NAME_bNetInitial
+	||	Name==NAME_bNetOwner
+	||	Name==NAME_bSimulatedPawn
+	||	Name==NAME_bDemoRecording
+	||	Name==NAME_bClientDemoRecording )
+		return 0;
+	UStructProperty* StructProperty = Cast<UStructProperty>(Property);
+	if( StructProperty )
+	{
+		FName StructName = StructProperty->Struct->GetFName();
+		return StructName==NAME_Vector || StructName==NAME_Rotator || StructName==NAME_Plane;
+	}
+	return
+	(	Property->IsA(UByteProperty::StaticClass())
+	||	Property->IsA(UIntProperty::StaticClass())
+	||	Property->IsA(UBoolProperty::StaticClass())
+	||	Property->IsA(UFloatProperty::StaticClass())
+	||	Property->IsA(UStrProperty::StaticClass()) );
+}
+
+FRepSnapshot::FRepSnapshot( UClass* InClass )
+:	Class			( InClass )
+,	Time			( -1.0 )
+,	Refreshed		( 0 )
+,	Serial			( 0 )
+,	Channels		( 0 )
+,	LastChannels	( 0 )
+{
+	guard(FRepSnapshot::FRepSnapshot);
+	INT Size = Class->Defaults.Num();
+	Baseline.Add( Size );
+	UObject::InitProperties( &Baseline(0), Size, Class, NULL, 0 );
+	Shareable.Add( Class->ClassReps.Num() );
+	for( INT i=0; i<Class->ClassReps.Num(); i++ )
+		Shareable(i) = IsShareableRep( Class->ClassReps(i).Property );
+	LastChanged.AddZeroed( Class->ClassReps.Num() );
+	Encodings.AddZeroed( Class->ClassReps.Num() );
+	unguard;
+}
+FRepSnapshot::~FRepSnapshot()
+{
+	guard(FRepSnapshot::~FRepSnapshot);
+	UObject::ExitProperties( &Baseline(0), Class );
+	unguard;
+}
+
+//
+// Count a channel replicating the actor and return whether sharing is
+// worthwhile this tick, bringing Baseline up to date if so.
+//
+UBOOL FRepSnapshot::Begin( AActor* Actor, DOUBLE InTime )
+{
+	guard(FRepSnapshot::Begin);
+	if( InTime!=Time )
+	{
+		LastChannels = Channels;
+		Channels     = 0;
+		Time         = InTime;
+		Refreshed    = 0;
+	}
+	Channels++;
+	if( LastChannels<2 )
+		return 0;
+	if( !Refreshed )
+		Refresh( Actor );
+	return 1;
+	unguard;
+}
+void FRepSnapshot::Refresh( AActor* Actor )
+{
+	guard(FRepSnapshot::Refresh);
+	Serial++;
+	for( INT i=0; i<Class->ClassReps.Num(); i++ )
+	{
+		if( Shareable(i) )
+		{
+			FRepRecord& Rep    = Class->ClassReps(i);
+			INT         Offset = Rep.Property->Offset + Rep.Index*Rep.Property->ElementSize;
+			if( !Rep.Property->Identical( &Baseline(Offset), (BYTE*)Actor + Offset ) )
+			{
+				Rep.Property->CopySingleValue( &Baseline(Offset), (BYTE*)Actor + Offset );
+				LastChanged(i) = Serial;
+			}
+		}
+	}
+	Evals.Empty();
+	Refreshed = 1;
+	unguard;
+}
+TArray<BYTE>& FRepSnapshot::GetEvals( DWORD Key )
+{
+	guard(FRepSnapshot::GetEvals);
+	for( INT i=0; i<Evals.Num(); i++ )
+		if( Evals(i).Key==Key )
+			return Evals(i).Eval;
+	FRepEvalSet* Set = new(Evals)FRepEvalSet;
+	Set->Key = Key;
+	Set->Eval.AddZeroed( Class->ClassReps.Num() );
+	return Set->Eval;
+	unguard;
+}
+
+//
+// Get the encoding of a shareable property's baseline value, or NULL if
+// it is too large to keep.
+//
+FRepEncoding* FRepSnapshot::GetEncoding( INT RepIndex, UPackageMap* Map )
+{
+	guard(FRepSnapshot::GetEncoding);
+	FRepEncoding& Encoding = Encodings(RepIndex);
+	if( Encoding.Serial!=Serial )
+	{
+		FRepRecord& Rep    = Class->ClassReps(RepIndex);
+		INT         Offset = Rep.Property->Offset + Rep.Index*Rep.Property->ElementSize;
+		FBitWriter  Writer( REPSNAPSHOT_MAX_BITS );
+		Rep.Property->NetSerializeItem( Writer, Map, &Baseline(Offset) );
+		Encoding.Serial  = Serial;
+		Encoding.NumBits = Writer.IsError() ? -1 : Writer.GetNumBits();
+		Encoding.Bits.Empty();
+		if( Encoding.NumBits>0 )
+		{
+			Encoding.Bits.Add( Writer.GetNumBytes() );
+			appMemcpy( &Encoding.Bits(0), Writer.GetData(), Writer.GetNumBytes() );
+		}
+	}
+	return Encoding.NumBits>=0 ? &Encoding : NULL;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FRepBatch.
+-----------------------------------------------------------------------------*/
+
+FRepBatch::FRepBatch( UNetConnection* InConnection )
+:	Connection		( InConnection )
+,	EstimatedBytes	( 0 )
+,	NumReps			( 0 )
+,	Updated			( 0 )
+{
+	// Allow one packet past saturation, like a serial update would.
+	Budget = Max( -(Connection->QueuedBytes + Connection->Out.GetNumBytes()), 0 ) + Connection->MaxPacket;
+}
+FRepBatch::~FRepBatch()
+{
+	guard(FRepBatch::~FRepBatch);
+	for( INT i=0; i<Items.Num(); i++ )
+		if( Items(i).Value>=0 && (Items(i).Property->PropertyFlags & CPF_NeedCtorLink) )
+			Items(i).Property->DestroyValue( &Values(Items(i).Value) );
+	unguard;
+}
+
+//
+// Copy a property value to send, returning its offset in Values.
+//
+INT FRepBatch::AddValue( UProperty* Property, BYTE* Src )
+{
+	guardSlow(FRepBatch::AddValue);
+	INT Offset = Values.Add( Align(Property->ElementSize,8) );
+	appMemzero( &Values(Offset), Property->ElementSize );
+	Property->CopySingleValue( &Values(Offset), Src );
+	return Offset;
+	unguardSlow;
+}
+
+//
+// Send jobs in priority order until the connection is saturated.
+//
+void FRepBatch::Send()
+{
+	guard(FRepBatch::Send);
+	for( INT i=0; i<Jobs.Num() && Connection->IsNetReady(0); i++ )
+	{
+		Jobs(i).Channel->SendReplication( *this, Jobs(i) );
+		Updated++;
+	}
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	UActorChannel.
 -----------------------------------------------------------------------------*/
@@ -665,6 +860,7 @@ void UActorChannel::SetChannelActor( AActor* InActor )
 		INT Size = ActorClass->Defaults.Num();
 		Recent.Add( Size );
 		UObject::InitProperties( &Recent(0), Size, ActorClass, NULL, 0 );
+		RepSynced.AddZeroed( ActorClass->ClassReps.Num() );
 
 		// Init config properties, to force replicate them.
 		for( UProperty* It=ActorClass->ConfigLink; It; It=It->ConfigLinkNext )
@@ -912,15 +1108,41 @@ void UActorChannel::ReplicateActor()
 {
 	guard(UActorChannel::ReplicateActor);
 	check(Actor);
+	ULevel*   ActorLevel = Actor->GetLevel();
+	FRepBatch Batch( Connection );
+	if( PrepareReplication( Batch ) )
+		SendReplication( Batch, Batch.Jobs(0) );
+	ActorLevel->NumReps += Batch.NumReps;
+	unguardf(( TEXT("(Actor %s)"), Actor ? Actor->GetName() : TEXT("None")));
+}
+
+//
+// Work out what to send of this channel's actor and add it to Batch.  This
+// does everything that touches the actor or runs script; SendReplication
+// does the rest.  Returns 0 if the channel is saturated.
+//
+UBOOL UActorChannel::PrepareReplication( FRepBatch& Batch )
+{
+	guard(UActorChannel::PrepareReplication);
+	check(Actor);
 	check(!Closing);
 	//debugf(TEXT("Replicate %s:"),ActorClass->GetName());
 
-	// Create an outgoing bunch, and skip this actor if the channel is saturated.
-	FOutBunch Bunch( this, 0 );
-	if( Bunch.IsError() )
-		return;
-
-	// Send initial stuff.
+	// Skip this actor if the channel is saturated.
+	if( NumOutRec>=RELIABLE_BUFFER-1 )
+		return 0;
+	FRepJob* Job    = new(Batch.Jobs)FRepJob;
+	Job->Channel    = this;
+	Job->Snapshot   = NULL;
+	Job->FirstItem  = Batch.Items.Num();
+	Job->NumItems   = 0;
+	Job->Initial    = 0;
+	Job->bClose     = 0;
+	Job->bReliable  = 0;
+	Job->bTemporary = Actor->bNetTemporary;
+	Job->Location   = Actor->Location;
+
+	// Set up initial stuff.
 	guard(SetupInitial);
 	if( OpenPacketId!=INDEX_NONE )
 	{
@@ -939,14 +1161,15 @@ void UActorChannel::ReplicateActor()
 	else
 	{
 		Actor->bNetInitial = 1;
-		Bunch.bClose    =  Actor->bNetTemporary;
-		Bunch.bReliable = !Actor->bNetTemporary;
+		Job->bClose    =  Actor->bNetTemporary;
+		Job->bReliable = !Actor->bNetTemporary;
 	}
 	unguard;
 
 	// Get class network info cache.
 	FClassNetCache* ClassCache = Connection->PackageMap->GetClassNetCache(Actor->GetClass());
 	check(ClassCache);
+	Job->MaxIndex = ClassCache->GetMaxIndex();
 
 	// Owned by connection's player?
 	Actor->bNetOwner = 0;
@@ -965,20 +1188,12 @@ void UActorChannel::ReplicateActor()
 	// If initial, send init data.
 	if( Actor->bNetInitial && OpenedLocally )
 	{
-		guard(SendInitialActorData);
-		if( Actor->bStatic || Actor->bNoDelete )
-		{
-			// Persitent actor.
-			Bunch << Actor;
-		}
-		else
-		{
-			// Transient actor.
-			Bunch << ActorClass << Actor->Location;
-			if( Recent.Num() )
-				((AActor*)&Recent(0))->Location = Actor->Location;
-		}
-		unguard;
+		Job->Initial = (Actor->bStatic || Actor->bNoDelete) ? 1 : 2;
+		Batch.EstimatedBytes += Job->Initial==1 ? 4 : 16;
+
+		// A transient actor's spawn carries its location, so don't send it again as a change.
+		if( Job->Initial==2 && Recent.Num() )
+			((AActor*)&Recent(0))->Location = Actor->Location;
 	}
 
 	// Save out the actor's RemoteRole, and downgrade it if necessary.
@@ -987,11 +1202,27 @@ void UActorChannel::ReplicateActor()
 		Actor->RemoteRole=ROLE_SimulatedProxy;
 	Actor->bSimulatedPawn = Actor->bIsPawn && Actor->RemoteRole==ROLE_SimulatedProxy;
 
+	// Share work with the other channels replicating this actor this tick.
+	FRepSnapshot* Snapshot   = Recent.Num() ? Connection->Driver->GetRepSnapshot( Actor ) : NULL;
+	TArray<BYTE>* SharedEval = NULL;
+	if( Snapshot )
+	{
+		DWORD Key
+		=	(Actor->bNetInitial          << 0)
+		|	(Actor->bNetOwner            << 1)
+		|	(Actor->bSimulatedPawn       << 2)
+		|	(Actor->bDemoRecording       << 3)
+		|	(Actor->bClientDemoRecording << 4)
+		|	(Actor->RemoteRole           << 8)
+		|	(Actor->Role                 << 16);
+		SharedEval = &Snapshot->GetEvals( Key );
+	}
+	Job->Snapshot = Snapshot;
+
 	// Get memory for retirement list.
 	FMemMark Mark(GMem);
 	appMemzero( &RepEval(0), RepEval.Num() );
 	INT* Reps = New<INT>( GMem, Retirement.Num() ), *LastRep;
-	UBOOL		FilledUp = 0;
 
 	// Figure out which properties to replicate.
 	guard(FigureOutWhatNeedsReplicating);
@@ -1017,22 +1248,42 @@ void UActorChannel::ReplicateActor()
 					{
 						Src = NULL;
 					}
-					if( !It->Identical(CompareBin+Offset,Src) )
+					INT   RepIndex = It->RepIndex + Index;
+					UBOOL Changed;
+					if( Snapshot && Snapshot->Shareable(RepIndex) )
+					{
+						// Skip the comparison if Recent matches a baseline.
+						if( RepSynced(RepIndex) )
+							Changed = Snapshot->LastChanged(RepIndex) > RepSynced(RepIndex);
+						else if( (Changed=!It->Identical(CompareBin+Offset,&Snapshot->Baseline(Offset)))==0 )
+							RepSynced(RepIndex) = Snapshot->Serial;
+					}
+					else Changed = !It->Identical(CompareBin+Offset,Src);
+					if( Changed )
 					{
 						if( !(Eval & 2) )
 						{
-							DWORD Val=0;
-							FFrame( Actor, It->RepOwner->GetOwnerClass(), It->RepOwner->RepOffset, NULL ).Step( Actor, &Val );
-							Eval = Val | 2;
+							BYTE* Shared = SharedEval ? &(*SharedEval)(It->RepOwner->RepIndex) : NULL;
+							if( Shared && *Shared )
+							{
+								Eval = *Shared;
+							}
+							else
+							{
+								DWORD Val=0;
+								FFrame( Actor, It->RepOwner->GetOwnerClass(), It->RepOwner->RepOffset, NULL ).Step( Actor, &Val );
+								Eval = Val | 2;
+								if( Shared )
+									*Shared = Eval;
+							}
 						}
 						if( Eval & 1 )
-							*LastRep++ = It->RepIndex+Index;
+							*LastRep++ = RepIndex;
 					}
 				}
 			}
 		}
 	}
-	check(!Bunch.IsError());
 	unguard;
 
 	// Add dirty properties to list.
@@ -1049,15 +1300,14 @@ void UActorChannel::ReplicateActor()
 	}
 	unguard;
 
-	// Replicate those properties.
-	guard(ReplicateThem);
+	// Capture those properties as they are to be sent to this connection.
+	guard(GatherThem);
 	for( INT* iPtr=Reps; iPtr<LastRep; iPtr++ )
 	{
 		// Get info.
 		FRepRecord* Rep    = &ActorClass->ClassReps(*iPtr);
 		UProperty*	It     = Rep->Property;
 		INT         Index  = Rep->Index;
-		INT         Offset = It->Offset + Index*It->ElementSize;
 
 		// Figure out field to replicate.
 		FFieldNetCache* FieldCache
@@ -1068,35 +1318,103 @@ void UActorChannel::ReplicateActor()
 		:	ClassCache->GetFromField(It);
 		check(FieldCache);
 
+		// Reuse the baseline's encoding if it has one, otherwise copy the value.
+		FRepItem* Item      = new(Batch.Items)FRepItem;
+		Item->Property      = It;
+		Item->Offset        = It->Offset + Index*It->ElementSize;
+		Item->RepIndex      = *iPtr;
+		Item->FieldNetIndex = FieldCache->FieldNetIndex;
+		Item->Element       = It->ArrayDim!=1 ? Index : -1;
+		Item->Encoding      = Snapshot && Snapshot->Shareable(*iPtr) ? Snapshot->GetEncoding( *iPtr, Connection->PackageMap ) : NULL;
+		Item->Value         = Item->Encoding ? -1 : Batch.AddValue( It, (BYTE*)Actor + Item->Offset );
+		Batch.EstimatedBytes += 2 + (Item->Encoding ? (Item->Encoding->NumBits+7)/8 : It->ElementSize);
+		Job->NumItems++;
+	}
+	unguard;
+
+	// Reset temporary net info.
+	Actor->bNetOwner  = 0;
+	Actor->RemoteRole = ActualRemoteRole;
+
+	Mark.Pop();
+	return 1;
+	unguardf(( TEXT("(Actor %s)"), Actor ? Actor->GetName() : TEXT("None")));
+}
+
+//
+// Encode and send an update gathered by PrepareReplication.  This only
+// touches the channel, its connection and Batch, so batches for different
+// connections may be sent from different threads.
+//
+void UActorChannel::SendReplication( FRepBatch& Batch, FRepJob& Job )
+{
+	guard(UActorChannel::SendReplication);
+	if( Closing || !Actor )
+		return;
+
+	// Create an outgoing bunch, and skip this actor if the channel is saturated.
+	FOutBunch Bunch( this, 0 );
+	if( Bunch.IsError() )
+		return;
+	Bunch.bClose    = Job.bClose;
+	Bunch.bReliable = Job.bReliable;
+
+	// If initial, send init data.
+	guard(SendInitialActorData);
+	if( Job.Initial==1 )
+	{
+		// Persitent actor.
+		Bunch << Actor;
+	}
+	else if( Job.Initial==2 )
+	{
+		// Transient actor.
+		Bunch << ActorClass << Job.Location;
+	}
+	unguard;
+
+	// Replicate the properties.
+	INT   Sent     = 0;
+	UBOOL FilledUp = 0;
+	guard(ReplicateThem);
+	for( ; Sent<Job.NumItems; Sent++ )
+	{
+		FRepItem&  Item = Batch.Items(Job.FirstItem + Sent);
+		UProperty* It   = Item.Property;
+
 		// Send property name and optional array index.
-		Bunch.WriteInt( FieldCache->FieldNetIndex, ClassCache->GetMaxIndex() );
-		if( It->ArrayDim != 1 )
+		Bunch.WriteInt( Item.FieldNetIndex, Job.MaxIndex );
+		if( Item.Element>=0 )
 		{
-			BYTE Element = Index;
+			BYTE Element = Item.Element;
 			Bunch << Element;
 		}
 
-		// Send property.
+		// Send property, reusing the baseline's encoding if it has one.
 		FBitWriterMark Mark( Bunch );
-		UBOOL Mapped = It->NetSerializeItem( Bunch, Connection->PackageMap, (BYTE*)Actor + Offset );
-		//debugf(TEXT("   Send %s %i"),It->GetName(),Mapped);
+		BYTE*          Value  = Item.Encoding ? &Job.Snapshot->Baseline(Item.Offset) : &Batch.Values(Item.Value);
+		UBOOL          Mapped = 1;
+		if( !Item.Encoding )
+			Mapped = It->NetSerializeItem( Bunch, Connection->PackageMap, Value );
+		else if( Item.Encoding->NumBits )
+			Bunch.SerializeBits( &Item.Encoding->Bits(0), Item.Encoding->NumBits );
 		if( !Bunch.IsError() )
 		{
 			// Update recent value.
 			if( Recent.Num() )
 			{
 				if( Mapped )
-					It->CopySingleValue( &Recent(Offset), (BYTE*)Actor + Offset );
+					It->CopySingleValue( &Recent(Item.Offset), Value );
 				else
-					appMemzero( &Recent(Offset), It->ElementSize );
+					appMemzero( &Recent(Item.Offset), It->ElementSize );
+				RepSynced(Item.RepIndex) = Item.Encoding ? Job.Snapshot->Serial : 0;
 			}
-			Actor->GetLevel()->NumReps++;
+			Batch.NumReps++;
 		}
 		else
 		{
 			// Stop the changes because we overflowed.
 			Mark.Pop( Bunch );
-			LastRep  = iPtr;
 			FilledUp = 1;
 			break;
 		}
@@ -1108,14 +1426,15 @@ void UActorChannel::ReplicateActor()
 	{
 		guard(DoSendBunch);
 		INT PacketId = SendBunch( &Bunch, 1 );
-		for( INT* Rep=Reps; Rep<LastRep; Rep++ )
+		for( INT i=0; i<Sent; i++ )
 		{
-			Dirty.RemoveItem(*Rep);
-			FPropertyRetirement& Retire = Retirement(*Rep);
+			INT Rep = Batch.Items(Job.FirstItem + i).RepIndex;
+			Dirty.RemoveItem(Rep);
+			FPropertyRetirement& Retire = Retirement(Rep);
 			Retire.OutPacketId = PacketId;
 			Retire.Reliable    = Bunch.bReliable;
 		}
-		if( Actor->bNetTemporary )
+		if( Job.bTemporary )
 		{
 			Connection->SentTemporaries.AddItem( Actor );
 		}
@@ -1126,12 +1445,7 @@ void UActorChannel::ReplicateActor()
 	if( !FilledUp )
 		LastUpdateTime = Connection->Driver->Time;
 
-	// Reset temporary net info.
-	Actor->bNetOwner  = 0;
-	Actor->RemoteRole = ActualRemoteRole;
-
-	Mark.Pop();
-	unguardf(( TEXT("(Actor %s)"), Actor ? Actor->GetName() : TEXT("None")));;
+	unguardf(( TEXT("(Actor %s)"), Actor ? Actor->GetName() : TEXT("None")));
 }
 
 //
@@ -1160,8 +1474,12 @@ void UFileChannel::Init( UNetConnection* InConnection, INT InChannelIndex, INT I
 	guard(UFileChannel::UFileChannel);
 	Super::Init( InConnection, InChannelIndex, InOpenedLocally );
 	FileAr			= NULL;
+	Image			= NULL;
 	Transfered		= 0;
+	WireBytes		= 0;
 	PackageIndex	= INDEX_NONE;
+	Compressed		= 0;
+	StartTime		= appSeconds();
 	unguard;
 }
 void UFileChannel::ReceivedBunch( FInBunch& Bunch )
@@ -1175,14 +1493,22 @@ void UFileChannel::ReceivedBunch( FInBunch& Bunch )
 		checkSlow(Bunch.GetNumBytes());
 
 		// Receiving spooled file data.
-		if( Transfered==0 )
+		INT Skip = 0;
+		if( WireBytes==0 )
 		{
 			// Open temporary file initially.
 			debugf( NAME_DevNet, TEXT("Receiving package '%s'"), Info.Parent->GetName() );
 			GFileManager->MakeDirectory( *GSys->CachePath, 0 );
 			appCreateTempFilename( *GSys->CachePath, Filename );
 			FileAr = GFileManager->CreateFileWriter( Filename );
+
+			// See whether the server sent the compressed stream we asked for.
+			Compressed = Connection->Driver->CompressDownloads && FNetFileImage::IsPacked( Bunch.GetData(), Bunch.GetNumBytes() );
+			if( Compressed )
+				Skip = 4;
+			StartTime = appSeconds();
 		}
+		WireBytes += Bunch.GetNumBytes();
 
 		// Receive.
 		if( !FileAr )
@@ -1193,8 +1519,22 @@ void UFileChannel::ReceivedBunch( FInBunch& Bunch )
 		}
 		else
 		{
-			FileAr->Serialize( Bunch.GetData(), Bunch.GetNumBytes() );
-			if( FileAr->IsError() )
+			INT Count = Bunch.GetNumBytes();
+			if( Compressed )
+			{
+				// Unpack whichever chunks are now complete.
+				INT Start = PackedIn.Add( Count-Skip );
+				appMemcpy( &PackedIn(Start), Bunch.GetData()+Skip, Count-Skip );
+				Count = FNetFileImage::Unpack( PackedIn, *FileAr );
+			}
+			else FileAr->Serialize( Bunch.GetData(), Count );
+			if( Count<0 )
+			{
+				// Corrupt stream.
+				appSprintf( Error, LocalizeError("NetSize") );
+				Close();
+			}
+			else if( FileAr->IsError() )
 			{
 				// Write failed.
 				appSprintf( Error, LocalizeError("NetWrite"), Filename );
@@ -1203,7 +1543,7 @@ void UFileChannel::ReceivedBunch( FInBunch& Bunch )
 			else
 			{
 				// Successful.
-				Transfered += Bunch.GetNumBytes();
+				Transfered += Count;
 				TCHAR Msg1[256], Msg2[256];
 				appSprintf( Msg1, LocalizeProgress("ReceiveFile"), PrettyName );
 				appSprintf( Msg2, LocalizeProgress("ReceiveSize"), Info.FileSize/1024, 100.f*Transfered/Info.FileSize );
@@ -1213,9 +1553,12 @@ void UFileChannel::ReceivedBunch( FInBunch& Bunch )
 	}
 	else
 	{
-		// Request to send a file.
+		// Request to send a file.  Older clients don't send flags.
 		FGuid Guid;
+		BYTE  Flags=0;
 		Bunch << Guid;
+		if( !Bunch.IsError() && !Bunch.AtEnd() )
+			Bunch << Flags;
 		if( !Bunch.IsError() )
 		{
 			for( INT i=0; i<Connection->PackageMap->List.Num(); i++ )
@@ -1227,12 +1570,14 @@ void UFileChannel::ReceivedBunch( FInBunch& Bunch )
 					if( Connection->Driver->Notify->NotifySendingFile( Connection, Guid ) )
 					{
 						check(Info.Linker);
-						FileAr = GFileManager->CreateFileReader( *Info.URL );
-						if( FileAr )
+						Image = FNetFileImage::Acquire( *Info.URL );
+						if( Image )
 						{
 							// Accepted! Now initiate file sending.
 							debugf( NAME_DevNet, LocalizeProgress("NetSend"), Filename );
 							PackageIndex = i;
+							Compressed   = (Flags & NETFILE_REQUEST_PACKED) && Connection->Driver->CompressDownloads;
+							StartTime    = appSeconds();
 							return;
 						}
 					}
@@ -1252,30 +1597,50 @@ void UFileChannel::Tick()
 	guard(UFileChannel::Tick);
 	UChannel::Tick();
 	Connection->TimeSensitive = 1;
+	if( !Image || OpenedLocally )
+		return;
+
+	// Take this channel's share of the server's download budget.
+	UNetDriver* Driver  = Connection->Driver;
+	UBOOL       Limited = Driver->MaxDownloadRate>0;
+	FLOAT       Budget  = Min( Driver->DownloadShare, Driver->DownloadAllowance );
+	Driver->NumDownloads++;
+
 	INT Size;
-	while( FileAr && !OpenedLocally && IsNetReady(1) && (Size=MaxSendBytes())!=0 )
+	while( Image && IsNetReady(1) && (!Limited || Budget>0) )
 	{
-		// Sending.
-		INT Remaining = Connection->PackageMap->List(PackageIndex).FileSize-Transfered;
-		FOutBunch Bunch( this, Size>=Remaining );
+		// Top off the current packet, only starting a new one when it's nearly full.
+		if( MaxSendBytes()<NETFILE_MIN_BUNCH )
+			Connection->FlushNet();
+		if( (Size=MaxSendBytes())==0 )
+			break;
+		if( Limited )
+			Size = Min( Size, Max( appFloor(Budget), (INT)NETFILE_MIN_BUNCH ) );
+
+		// Sending, straight out of the shared image.
+		if( Compressed )
+			while( !Image->PackedComplete() && Image->Packed.Num()<WireBytes+Size )
+				Image->PackNextChunk();
+		BYTE* Data      = Compressed ? &Image->Packed(0) : Image->Data;
+		INT   Remaining = (Compressed ? Image->Packed.Num() : Image->Size) - WireBytes;
+		FOutBunch Bunch( this, Size>=Remaining && (!Compressed || Image->PackedComplete()) );
 		Size = Min( Size, Remaining );
-		BYTE* Buffer = (BYTE*)appAlloca( Size );
-		FileAr->Serialize( Buffer, Size );
-		if( FileAr->IsError() )
-		{
-			//!!
-		}
-		Transfered += Size;
-		Bunch.Serialize( Buffer, Size );
+		Bunch.Serialize( Data+WireBytes, Size );
 		Bunch.bReliable = 1;
 		check(!Bunch.IsError());
 		SendBunch( &Bunch, 0 );
-		Connection->FlushNet();
+		WireBytes  += Size;
+		Transfered += Size;
+		Budget     -= Size;
+		if( Limited )
+			Driver->DownloadAllowance -= Size;
 		if( Bunch.bClose )
 		{
 			// Finished.
-			delete FileAr;
-			FileAr = NULL;
+			DOUBLE Seconds = Max( appSeconds()-StartTime, 0.001 );
+			debugf( NAME_DevNet, TEXT("Sent '%s' to %s: %i bytes in %i (%i%%) in %.1f sec, %.1f KB/sec"), Filename, *Connection->LowLevelGetRemoteAddress(), Image->Size, WireBytes, Image->Size ? 100*WireBytes/Image->Size : 100, Seconds, WireBytes/1024.0/Seconds );
+			Image->Release();
+			Image = NULL;
 		}
 	}
 	unguard;
@@ -1324,11 +1689,11 @@ void UFileChannel::Destroy()
 			Connection->Driver->Notify->NotifyReceivedFile( Connection, PackageIndex, Error );
 		}
 	}
-	else if( FileAr )
+	else if( Image )
 	{
 		//warning: If !OpenedLocally, PackageIndex may be INDEX_NONE if requested invalid file.
-		delete FileAr;
-		FileAr = NULL;
+		Image->Release();
+		Image = NULL;
 	}
 	Super::Destroy();
 	unguard;
@@ -1336,14 +1701,16 @@ void UFileChannel::Destroy()
 FString UFileChannel::Describe()
 {
 	guard(UFileChannel::Describe);
-	FPackageInfo& Info = Connection->PackageMap->List( PackageIndex );
+	INT FileSize = Connection->PackageMap->List.IsValidIndex(PackageIndex) ? Connection->PackageMap->List(PackageIndex).FileSize : 0;
 	return FString::Printf
 	(
-		TEXT("File='%s', %s=%i/%i "),
+		TEXT("File='%s', %s=%i/%i%s, %.1f KB/sec "),
 		Filename,
 		OpenedLocally ? TEXT("Received") : TEXT("Sent"),
 		Transfered,
-		Info.FileSize
+		FileSize,
+		Compressed ? *FString::Printf(TEXT(" (%i on the wire)"),WireBytes) : TEXT(""),
+		WireBytes/1024.0/Max(appSeconds()-StartTime,0.001)
 	) + UChannel::Describe();
 	unguard;
 }
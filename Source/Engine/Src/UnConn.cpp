@@ -9,6 +9,269 @@
 #include "EnginePrivate.h"
 #include "UnNet.h"
 
+/*-----------------------------------------------------------------------------
+	FPacketSimulator implementation.
+-----------------------------------------------------------------------------*/
+
+FPacketSimulator::FPacketSimulator()
+:	PktLoss			( 0 )
+,	PktOrder		( 0 )
+,	PktDup			( 0 )
+,	PktLag			( 0 )
+,	PktRate			( 0 )
+,	Seed			( 0x12345678 )
+,	LinkTime		( 0.0 )
+,	NumSent			( 0 )
+,	NumDropped		( 0 )
+,	NumDuped		( 0 )
+,	NumReordered	( 0 )
+{}
+
+//
+// Parse settings of the form PktLoss=n PktOrder=n PktDup=n PktLag=n PktRate=n PktSeed=n.
+//
+void FPacketSimulator::Init( const TCHAR* Parms )
+{
+	guard(FPacketSimulator::Init);
+	Parse( Parms, TEXT("PktLoss="),  PktLoss  );
+	Parse( Parms, TEXT("PktOrder="), PktOrder );
+	Parse( Parms, TEXT("PktDup="),   PktDup   );
+	Parse( Parms, TEXT("PktLag="),   PktLag   );
+	Parse( Parms, TEXT("PktRate="),  PktRate  );
+	Parse( Parms, TEXT("PktSeed="),  Seed     );
+	unguard;
+}
+
+//
+// Private random number generator, independent of appFrand so that a
+// given seed always produces the same sequence of drops and delays.
+//
+FLOAT FPacketSimulator::Frand()
+{
+	Seed = Seed * 196314165 + 907633515;
+	return (Seed >> 8) * (1.0 / 16777216.0);
+}
+
+//
+// Queue a packet for delivery at SendTime, keeping the queue sorted.
+//
+void FPacketSimulator::Insert( const void* Data, INT Count, DOUBLE SendTime )
+{
+	guard(FPacketSimulator::Insert);
+	INT i;
+	for( i=Delayed.Num(); i>0 && Delayed(i-1).SendTime>SendTime; i-- );
+	DelayedPacket& B = *(new(Delayed,i)DelayedPacket);
+	B.Data.Add( Count );
+	appMemcpy( &B.Data(0), Data, Count );
+	B.SendTime = SendTime;
+	unguard;
+}
+
+//
+// Send a packet through the simulated link.
+//
+void FPacketSimulator::Send( const void* Data, INT Count, DOUBLE Time )
+{
+	guard(FPacketSimulator::Send);
+	NumSent++;
+
+	// Bandwidth: packets serialize onto the link, and the link's queue
+	// overflows after a second's worth of backlog.
+	DOUBLE SendTime = Time;
+	if( PktRate>0 )
+	{
+		if( LinkTime-Time > 1.0 )
+		{
+			NumDropped++;
+			return;
+		}
+		LinkTime = ::Max( LinkTime, Time ) + (DOUBLE)Count / PktRate;
+		SendTime = LinkTime;
+	}
+
+	// Loss.
+	if( PktLoss && Frand()*100.0<PktLoss )
+	{
+		NumDropped++;
+		return;
+	}
+
+	// Latency and reordering.
+	SendTime += PktLag / 1000.0;
+	if( PktOrder && Frand()*100.0<PktOrder )
+	{
+		SendTime += (10 + Frand() * ::Max(PktLag,100)) / 1000.0;
+		NumReordered++;
+	}
+	Insert( Data, Count, SendTime );
+
+	// Duplication.
+	if( PktDup && Frand()*100.0<PktDup )
+	{
+		Insert( Data, Count, SendTime );
+		NumDuped++;
+	}
+	unguard;
+}
+
+FString FPacketSimulator::Describe() const
+{
+	guard(FPacketSimulator::Describe);
+	return FString::Printf
+	(
+		TEXT("lag=%i loss=%i order=%i dup=%i rate=%i sent=%i dropped=%i reordered=%i duped=%i inflight=%i"),
+		PktLag, PktLoss, PktOrder, PktDup, PktRate, NumSent, NumDropped, NumReordered, NumDuped, Delayed.Num()
+	);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FNetRateControl implementation.
+-----------------------------------------------------------------------------*/
+
+#define RATE_MIN_FRACTION	0.125f	// Lowest rate as a fraction of CurrentNetSpeed.
+#define RATE_MIN_BYTES		1000.f	// Lowest rate in bytes per second.
+#define RATE_DELAY_BETA		0.85f	// Rate cut when queueing delay builds up.
+#define RATE_LOSS_BETA		0.7f	// Rate cut on loss with queueing delay.
+#define RATE_DELAY_SLACK	0.05f	// Queueing delay, in seconds, tolerated above MinRTT.
+#define RATE_MINRTT_WINDOW	10.0	// Seconds MinRTT is measured over.
+
+FNetRateControl::FNetRateControl()
+{
+	Reset();
+}
+void FNetRateControl::Reset()
+{
+	Rate			= 0.f;
+	SRTT			= 0.f;
+	RTTVar			= 0.f;
+	MinRTT			= 0.f;
+	WindowMinRTT	= 0.f;
+	WindowStart		= 0.0;
+	LastAck			= 0.0;
+	LastDecrease	= 0.0;
+	NumAcks			= 0;
+	NumNaks			= 0;
+	NumDecreases	= 0;
+	NumDelivered	= 0;
+	DeliverTime		= 0.0;
+	MaxDeliverTime	= 0.f;
+	NumTicks		= 0;
+	NumStalls		= 0;
+}
+
+//
+// Return the send budget, starting at and never exceeding MaxRate.
+//
+FLOAT FNetRateControl::GetRate( FLOAT MaxRate )
+{
+	if( Rate<=0.f )
+		Rate = MaxRate;
+	Rate = Clamp( Rate, Min( MaxRate, Max(MaxRate*RATE_MIN_FRACTION,RATE_MIN_BYTES) ), MaxRate );
+	return Rate;
+}
+
+//
+// A packet sent RTT seconds ago was acked.
+//
+void FNetRateControl::ReceivedAck( DOUBLE Now, FLOAT RTT, INT MaxPacket, FLOAT MaxRate )
+{
+	guardSlow(FNetRateControl::ReceivedAck);
+	NumAcks++;
+	RTT = Max( RTT, 0.001f );
+	if( SRTT==0.f )
+	{
+		SRTT         = RTT;
+		RTTVar       = RTT/2;
+		MinRTT       = RTT;
+		WindowMinRTT = RTT;
+		WindowStart  = Now;
+		LastAck      = Now;
+	}
+	else
+	{
+		RTTVar = 0.75f*RTTVar + 0.25f*Abs(SRTT-RTT);
+		SRTT   = 0.875f*SRTT  + 0.125f*RTT;
+	}
+
+	// Base delay is the lowest round trip over a window, so it can rise if the route changes.
+	MinRTT       = Min( MinRTT,       RTT );
+	WindowMinRTT = Min( WindowMinRTT, RTT );
+	if( Now-WindowStart>RATE_MINRTT_WINDOW )
+	{
+		MinRTT       = WindowMinRTT;
+		WindowMinRTT = RTT;
+		WindowStart  = Now;
+	}
+
+	// Back off while packets queue up along the path, else grow by a packet per round trip.
+	GetRate( MaxRate );
+	if( SRTT > MinRTT + Max( RATE_DELAY_SLACK, 2*RTTVar ) )
+		Decrease( Now, RATE_DELAY_BETA, MaxRate );
+	else
+		Rate += MaxPacket * Min<FLOAT>( Now-LastAck, SRTT ) / (SRTT*SRTT);
+	LastAck = Now;
+	GetRate( MaxRate );
+	unguardSlow;
+}
+
+//
+// A packet was lost.
+//
+void FNetRateControl::ReceivedNak( DOUBLE Now, FLOAT MaxRate )
+{
+	guardSlow(FNetRateControl::ReceivedNak);
+	NumNaks++;
+	if( SRTT>0.f && SRTT > MinRTT + RATE_DELAY_SLACK/2 )
+		Decrease( Now, RATE_LOSS_BETA, MaxRate );
+	unguardSlow;
+}
+
+//
+// Cut the rate, at most once per round trip so a burst of loss counts once.
+//
+void FNetRateControl::Decrease( DOUBLE Now, FLOAT Beta, FLOAT MaxRate )
+{
+	if( Now-LastDecrease>=SRTT )
+	{
+		Rate         = GetRate(MaxRate) * Beta;
+		LastDecrease = Now;
+		NumDecreases++;
+		GetRate( MaxRate );
+	}
+}
+
+//
+// A reliable bunch first sent Seconds ago was acked.
+//
+void FNetRateControl::Delivered( FLOAT Seconds )
+{
+	NumDelivered++;
+	DeliverTime   += Seconds;
+	MaxDeliverTime = Max( MaxDeliverTime, Seconds );
+}
+
+FString FNetRateControl::Describe( FLOAT MaxRate )
+{
+	guard(FNetRateControl::Describe);
+	return FString::Printf
+	(
+		TEXT("rate=%i/%i rtt=%i+-%i min=%i acks=%i naks=%i cuts=%i deliver=%i avg %i max stall=%.1f%%"),
+		(INT)GetRate(MaxRate),
+		(INT)MaxRate,
+		(INT)(SRTT*1000),
+		(INT)(RTTVar*1000),
+		(INT)(MinRTT*1000),
+		NumAcks,
+		NumNaks,
+		NumDecreases,
+		NumDelivered ? (INT)(DeliverTime*1000/NumDelivered) : 0,
+		(INT)(MaxDeliverTime*1000),
+		NumTicks ? 100.0*NumStalls/NumTicks : 0.0
+	);
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	UNetConnection implementation.
 -----------------------------------------------------------------------------*/
@@ -42,10 +305,7 @@ UNetConnection::UNetConnection( UNetDriver* InDriver, const FURL& InURL )
 
 	// Command-line parameters.
 #if DO_ENABLE_NET_TEST
-	Parse(appCmdLine(),TEXT("PktLoss="), PktLoss);
-	Parse(appCmdLine(),TEXT("PktOrder="),PktOrder);
-	Parse(appCmdLine(),TEXT("PktDup="),  PktDup);
-	Parse(appCmdLine(),TEXT("PktLag="),  PktLag);
+	PacketSim.Init( appCmdLine() );
 #endif
 
 	// Other parameters.
@@ -173,6 +433,19 @@ void UNetConnection::ReceivedRawPacket( void* InData, INT Count )
 	debugfSlow( NAME_DevNetTraffic, TEXT("%03i: Received %i"), (INT)(appSeconds()*1000)%1000, Count );
 	InByteAcc += Count + PacketOverhead;
 	InPktAcc++;
+
+	// Expand compressed packets, which end in a zero byte.
+	BYTE Expanded[NETMODEL_MAX_PACKET];
+	if( Count>1 && Data[Count-1]==0 && Driver->CompressPackets )
+	{
+		Count = GNetPacketModel.Decode( Data, Count, Expanded, ARRAY_COUNT(Expanded) );
+		if( Count<0 )
+		{
+			debugfSlow( NAME_DevNet, TEXT("Malformed compressed packet") );
+			return;
+		}
+		Data = Expanded;
+	}
 	if( Count>0 )
 	{
 		BYTE LastByte = Data[Count-1];
@@ -216,43 +489,29 @@ void UNetConnection::FlushNet()
 			Out.WriteBit( 0 );
 		check(!Out.IsError());
 
-		// Send now.
-#if DO_ENABLE_NET_TEST
-		if( PktOrder )
-		{
-			DelayedPacket& B = *(new(Delayed)DelayedPacket);
-			B.Data.Add( Out.GetNumBytes() );
-			appMemcpy( &B.Data(0), Out.GetData(), Out.GetNumBytes() );
-
-			for( INT i=Delayed.Num()-1; i>=0; i-- )
-			{
-				if( appFrand()>0.50 )
-				{
-					if( !PktLoss || appFrand()*100.0>PktLoss )
-						LowLevelSend( (char*)&Delayed(i).Data(0), Delayed(i).Data.Num() );
-					Delayed.Remove( i );
-				}
-			}
-		}
-		else if( PktLag )
+		// Compress if the remote side can take it and it helps.
+		BYTE* SendData  = Out.GetData();
+		INT   SendCount = Out.GetNumBytes();
+		BYTE  Packed[NETMODEL_MAX_PACKET];
+		if( CompressOut )
 		{
-			if( !PktLoss || appFrand()*100.0>PktLoss )
+			INT PackedCount = GNetPacketModel.Encode( SendData, SendCount, Packed );
+			CompRawBytes += SendCount;
+			if( PackedCount )
 			{
-				DelayedPacket& B = *(new(Delayed)DelayedPacket);
-				B.Data.Add( Out.GetNumBytes() );
-				appMemcpy( &B.Data(0), Out.GetData(), Out.GetNumBytes() );
-				B.SendTime = appSeconds() + DOUBLE(PktLag) / 1000.0;
+				SendData  = Packed;
+				SendCount = PackedCount;
 			}
+			CompSentBytes += SendCount;
 		}
-		else if( !PktLoss || appFrand()*100.0>=PktLoss )
+
+		// Send now, or leave it for the game thread.
+		if( DeferSends )
 		{
-#endif
-			LowLevelSend( Out.GetData(), Out.GetNumBytes() );
-#if DO_ENABLE_NET_TEST
-			if( PktDup && appFrand()*100.0<PktDup )
-				LowLevelSend( (char*)Out.GetData(), Out.GetNumBytes() );
+			appMemcpy( &DeferredData(DeferredData.Add(SendCount)), SendData, SendCount );
+			DeferredSizes.AddItem( SendCount );
 		}
-#endif
+		else SendPacket( SendData, SendCount );
 
 		// Update stuff.
 		INT Index = OutPacketId & (ARRAY_COUNT(OutLagPacketId)-1);
@@ -261,8 +520,8 @@ void UNetConnection::FlushNet()
 		OutPacketId++;
 		OutPktAcc++;
 		LastSendTime = Driver->Time;
-		QueuedBytes += Out.GetNumBytes() + PacketOverhead;
-		OutByteAcc  += Out.GetNumBytes() + PacketOverhead;
+		QueuedBytes += SendCount + PacketOverhead;
+		OutByteAcc  += SendCount + PacketOverhead;
 		InitOut();
 	}
 
@@ -273,6 +532,32 @@ void UNetConnection::FlushNet()
 
 	unguard;
 }
+FString UNetConnection::DescribeCompression()
+{
+	guard(UNetConnection::DescribeCompression);
+	if( !CompressOut )
+		return TEXT("uncompressed");
+	return FString::Printf
+	(
+		TEXT("%i bytes compressed to %i (%.1f%%)"),
+		CompRawBytes,
+		CompSentBytes,
+		CompRawBytes ? 100.0 * CompSentBytes / CompRawBytes : 100.0
+	);
+	unguard;
+}
+
+//
+// Bytes per second this connection may send.
+//
+FLOAT UNetConnection::GetSendRate()
+{
+	guardSlow(UNetConnection::GetSendRate);
+	if( Driver->AdaptiveRate && !InternalAck )
+		return RateControl.GetRate( CurrentNetSpeed );
+	return CurrentNetSpeed;
+	unguardSlow;
+}
 void UNetConnection::Serialize( const TCHAR* Data, EName MsgType )
 {
 	guard(UNetConnection::Serialize);
@@ -381,6 +666,7 @@ void UNetConnection::ReceivedPacket( FBitReader& Reader )
 				for( INT NakPacketId=OutAckPacketId+1; NakPacketId<AckPacketId; NakPacketId++,OutLossAcc++ )
 				{
 					debugfSlow( NAME_DevNetTraffic, TEXT("   Received virtual nak %i (%.1f)"), NakPacketId, (Reader.GetPosBits()-StartPos)/8.0 );
+					RateControl.ReceivedNak( Driver->Time, CurrentNetSpeed );
 					ReceivedNak( NakPacketId );
 				}
 				OutAckPacketId = AckPacketId;
@@ -401,6 +687,7 @@ void UNetConnection::ReceivedPacket( FBitReader& Reader )
 					LagAcc += Driver->Time - OutLagTime[Index] - (FrameTime/2);
 					LagCount++;
 //				}
+				RateControl.ReceivedAck( Driver->Time, Driver->Time - OutLagTime[Index] - (FrameTime/2), MaxPacket, CurrentNetSpeed );
 			}
 
 			// Forward the ack to the channel.
@@ -544,6 +831,35 @@ void UNetConnection::ReceivedPacket( FBitReader& Reader )
 	All raw sending functions.
 -----------------------------------------------------------------------------*/
 
+//
+// Send a finished packet through the lag simulator or the socket.
+//
+void UNetConnection::SendPacket( void* Data, INT Count )
+{
+	guard(UNetConnection::SendPacket);
+#if DO_ENABLE_NET_TEST
+	if( PacketSim.IsActive() )
+		PacketSim.Send( Data, Count, appSeconds() );
+	else
+#endif
+	LowLevelSend( Data, Count );
+	unguard;
+}
+
+//
+// Send the packets queued while DeferSends was set.
+//
+void UNetConnection::SendDeferred()
+{
+	guard(UNetConnection::SendDeferred);
+	check(!DeferSends);
+	for( INT i=0, Pos=0; i<DeferredSizes.Num(); Pos+=DeferredSizes(i++) )
+		SendPacket( &DeferredData(Pos), DeferredSizes(i) );
+	DeferredData.Empty();
+	DeferredSizes.Empty();
+	unguard;
+}
+
 //
 // Called before sending anything.
 //
@@ -654,6 +970,8 @@ INT UNetConnection::SendRawBunch( FOutBunch& Bunch, UBOOL InAllowMerge )
 	AllowMerge      = InAllowMerge;
 	Bunch.PacketId  = OutPacketId;
 	Bunch.Time      = Driver->Time;
+	if( Bunch.FirstTime<0.0 )
+		Bunch.FirstTime = Driver->Time;
 
 	// Remember start position, and write data.
 	LastStart = FBitWriterMark( Out );
@@ -720,17 +1038,10 @@ void UNetConnection::Tick()
 
 	// Lag simulation.
 #if DO_ENABLE_NET_TEST
-	if( PktLag )
+	for( DelayedPacket* Packet=PacketSim.Peek(appSeconds()); Packet; Packet=PacketSim.Peek(appSeconds()) )
 	{
-		for( INT i=0; i < Delayed.Num(); i++ )
-		{
-			if( appSeconds() > Delayed(i).SendTime )
-			{
-				LowLevelSend( (char*)&Delayed(i).Data(0), Delayed(i).Data.Num() );
-				Delayed.Remove( i );
-				i--;
-			}
-		}
+		LowLevelSend( &Packet->Data(0), Packet->Data.Num() );
+		PacketSim.Pop();
 	}
 #endif
 
@@ -817,7 +1128,8 @@ void UNetConnection::Tick()
 	LastTickTime        = Driver->Time;
 
 	// Update queued byte count.
-	FLOAT DeltaBytes = CurrentNetSpeed * DeltaTime;
+	RateControl.Ticked( QueuedBytes>0 );
+	FLOAT DeltaBytes = GetSendRate() * DeltaTime;
 	QueuedBytes     -= (INT) DeltaBytes;
 	FLOAT AllowedLag = 2.0 * DeltaBytes;
 	if( QueuedBytes < -AllowedLag )
@@ -913,6 +1225,11 @@ void UNetConnection::ReceiveFile( INT PackageIndex )
 	// Send file request.
 	FOutBunch Bunch( Ch, 0 );
 	Bunch << Info.Guid;
+	if( Driver->CompressDownloads )
+	{
+		BYTE Flags = NETFILE_REQUEST_PACKED;
+		Bunch << Flags;
+	}
 	Bunch.bReliable = 1;
 	check(!Bunch.IsError());
 	Ch->SendBunch( &Bunch, 0 );
@@ -172,9 +172,20 @@ UBOOL UDemoRecDriver::InitConnect( FNetworkNotify* InNotify, FURL& ConnectURL, F
 		Error = FString::Printf( TEXT("Couldn't open demo file %s for reading"), *DemoFilename );//!!localize!!
 		return 0;
 	}
+	DemoEnd  = ReadIndex( *FileAr, Keyframes, DemoVersion );
+	SeekTime = 0.0;
 	ClientThirdPerson	= ConnectURL.HasOption(TEXT("3rdperson"));
 	TimeBased			= ConnectURL.HasOption(TEXT("timebased"));
 	NoFrameCap          = ConnectURL.HasOption(TEXT("noframecap"));
+	QuitWhenDone        = ConnectURL.HasOption(TEXT("quit"));
+
+	// Benchmarks play every recorded frame as fast as possible.
+	if( ConnectURL.HasOption(TEXT("benchmark")) )
+	{
+		NoFrameCap = 1;
+		TimeBased  = 0;
+		Benchmark  = new FDemoBenchmark( ConnectURL.GetOption(TEXT("csv="),TEXT("")) );
+	}
 
 	return 1;
 	unguard;
@@ -195,12 +206,22 @@ UBOOL UDemoRecDriver::InitListen( FNetworkNotify* InNotify, FURL& ConnectURL, FS
 
 	FileAr = GFileManager->CreateFileWriter( *DemoFilename );
 	ClientConnections.AddItem( Connection );
+	LastKeyframeTime = 0.0;
+	Keyframes.Empty();
 	if( !FileAr )
 	{
 		Error = FString::Printf( TEXT("Couldn't open demo file %s for writing"), *DemoFilename );//localize!!
 		return 0;
 	}
 
+	// Only demos recorded for seeking carry a version and keyframes.
+	DemoVersion = ConnectURL.HasOption(TEXT("keyframes")) ? DEMO_VERSION : 0;
+	if( DemoVersion )
+	{
+		INT Tag = DEMO_FILE_TAG;
+		*FileAr << Tag << DemoVersion;
+	}
+
 	// Build package map.
 	UGameEngine* GameEngine = CastChecked<UGameEngine>( GetLevel()->Engine );
 	if( GetLevel()->GetLevelInfo()->NetMode == NM_Client )
@@ -224,6 +245,8 @@ void UDemoRecDriver::StaticConstructor()
 {
 	guard(UDemoRecDriver::StaticConstructor);
 	new(GetClass(),TEXT("DemoSpectatorClass"), RF_Public)UStrProperty(CPP_PROPERTY(DemoSpectatorClass), TEXT("Client"), CPF_Config);
+	new(GetClass(),TEXT("KeyframeInterval"),   RF_Public)UFloatProperty(CPP_PROPERTY(KeyframeInterval), TEXT("Client"), CPF_Config);
+	KeyframeInterval = 10.0;
 	unguard;
 }
 void UDemoRecDriver::LowLevelDestroy()
@@ -232,15 +255,31 @@ void UDemoRecDriver::LowLevelDestroy()
 
 	debugf( TEXT("Closing down demo driver.") );
 
-	// Shut down file.
+	// Shut down file, appending the keyframe index to recordings.
 	guard(CloseFile);
 	if( FileAr )
-	{	
+	{
+		if( FileAr->IsSaving() && DemoVersion )
+		{
+			INT   IndexOffset = FileAr->Tell();
+			DWORD Tag         = DEMO_INDEX_TAG;
+			*FileAr << Keyframes << IndexOffset << Tag;
+		}
 		delete FileAr;
 		FileAr = NULL;
 	}
 	unguard;
 
+	// Report benchmark results.
+	if( Benchmark )
+	{
+		Benchmark->Report( *DemoFilename, *GLog );
+		delete Benchmark;
+		Benchmark = NULL;
+	}
+	if( QuitWhenDone )
+		appRequestExit( 0 );
+
 	unguard;
 }
 void UDemoRecDriver::TickDispatch( FLOAT DeltaTime )
@@ -249,22 +288,33 @@ void UDemoRecDriver::TickDispatch( FLOAT DeltaTime )
 	Super::TickDispatch( DeltaTime );
 	FrameNum++;
 
+	// Write a keyframe every so often while recording for seeking.
+	if
+	(	!ServerConnection
+	&&	DemoVersion
+	&&	KeyframeInterval>0.0
+	&&	Time-LastKeyframeTime>=KeyframeInterval
+	&&	ClientConnections.Num()
+	&&	ClientConnections(0)->State==USOCK_Open )
+		WriteKeyframe();
+
 	BYTE Data[PACKETSIZE + 8];
 
 	if(  ServerConnection && 
 		(ServerConnection->State==USOCK_Pending || ServerConnection->State==USOCK_Open) )
 	{	
 		// Read data from the demo file
-		DWORD PacketBytes;
+		clock(RecvCycles);
+		INT PacketBytes;
 		INT PlayedThisTick = 0;
 		for( ; ; )
 		{
 			// At end of file?
-			if( FileAr->AtEnd() || FileAr->IsError() )
+			if( FileAr->Tell()>=DemoEnd || FileAr->IsError() )
 			{
 			AtEnd:
 				ServerConnection->State = USOCK_Closed;
-				return;
+				break;
 			}
 	
 			INT ServerFrameNum;
@@ -272,21 +322,46 @@ void UDemoRecDriver::TickDispatch( FLOAT DeltaTime )
 
 			*FileAr << ServerFrameNum;
 			*FileAr << ServerPacketTime;
-			if((!TimeBased && ServerFrameNum > FrameNum) || (TimeBased && ServerPacketTime > Time))
+			if( SeekTime>0.0 )
+			{
+				// Fast-forwarding from a keyframe to the seek target.
+				if( ServerPacketTime > SeekTime )
+				{
+					FileAr->Seek(FileAr->Tell() - sizeof(ServerFrameNum) - sizeof(ServerPacketTime));
+					FrameNum = ServerFrameNum - 1;
+					Time     = SeekTime;
+					SeekTime = 0.0;
+					break;
+				}
+			}
+			else if((!TimeBased && ServerFrameNum > FrameNum) || (TimeBased && ServerPacketTime > Time))
 			{
 				FileAr->Seek(FileAr->Tell() - sizeof(ServerFrameNum) - sizeof(ServerPacketTime));
 				break;
 			}
-			if(!NoFrameCap && !TimeBased && ServerPacketTime > Time)
+			else if(!NoFrameCap && !TimeBased && ServerPacketTime > Time)
 			{
-				// Busy-wait until it's time to play the frame.
-				// WARNING: use appSleep() if appSeconds() isn't using CPU timestamp!
-				// appSleep(ServerPacketTime - Time);
-				DOUBLE t = appSeconds() + (ServerPacketTime - Time);
-				while(appSeconds() < t);			
+				// Too early to play this frame; try it again next tick
+				// rather than stalling the client.
+				FileAr->Seek(FileAr->Tell() - sizeof(ServerFrameNum) - sizeof(ServerPacketTime));
+				FrameNum--;
+				break;
 			}
 			*FileAr << PacketBytes;
 
+			// Keyframes only matter when seeking.
+			if( PacketBytes==DEMO_KEYFRAME && DemoVersion )
+			{
+				FDemoKeyframeState State;
+				*FileAr << State;
+				continue;
+			}
+			if( PacketBytes<0 || PacketBytes>PACKETSIZE+8 )
+			{
+				debugf( NAME_DevNet, TEXT("Bad demo file packet size %i"), PacketBytes );
+				goto AtEnd;
+			}
+
 			// Read data from file.
 			FileAr->Serialize( Data, PacketBytes );
 			if( FileAr->IsError() )
@@ -307,9 +382,36 @@ void UDemoRecDriver::TickDispatch( FLOAT DeltaTime )
 			if(ServerConnection->State == USOCK_Pending)
 				break;
 		}
+		unclock(RecvCycles);
 	}
 	unguard;
 }
+void UDemoRecDriver::TickFlush()
+{
+	guard(UDemoRecDriver::TickFlush);
+	Super::TickFlush();
+
+	// Note this level tick's script and net time before another level's
+	// tick resets them.
+	if( Benchmark )
+	{
+		Benchmark->ScriptCycles = GScriptCycles;
+		Benchmark->NetCycles    = RecvCycles + GetLevel()->NetTickCycles;
+	}
+	unguard;
+}
+
+//
+// Sample one frame's timings, called by the game engine once the frame has
+// been rendered.
+//
+void UDemoRecDriver::TickBenchmark( INT GameCycles, INT RenderCycles )
+{
+	guard(UDemoRecDriver::TickBenchmark);
+	if( Benchmark && ServerConnection && ServerConnection->State==USOCK_Open && SeekTime==0.0 )
+		Benchmark->Sample( GameCycles, RenderCycles );
+	unguard;
+}
 FString UDemoRecDriver::LowLevelGetNetworkNumber()
 {
 	guard(UDemoRecDriver::LowLevelGetNetworkNumber);
@@ -327,6 +429,24 @@ INT UDemoRecDriver::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
 			Ar.Logf( TEXT("Demo recording currently active: %s"), *DemoFilename );//!!localize!!
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,TEXT("DEMOSEEK")) )
+	{
+		if( !ServerConnection )
+			Ar.Logf( TEXT("Can't seek while recording") );
+		else if( !Keyframes.Num() )
+			Ar.Logf( TEXT("Demo %s has no keyframe index; record it with DEMOREC <name> KEYFRAMES"), *DemoFilename );
+		else if( SeekTo( appAtof(Cmd) ) )
+			Ar.Logf( TEXT("Seeking to %.1f seconds"), appAtof(Cmd) );
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("DEMOBENCH")) )
+	{
+		if( Benchmark )
+			Benchmark->Report( *DemoFilename, Ar );
+		else
+			Ar.Logf( TEXT("No demo benchmark running") );
+		return 1;
+	}
 	else if( ParseCommand(&Cmd,TEXT("STOPDEMO")) )
 	{
 		Ar.Logf( TEXT("Demo %s stopped (%d frames)"), *DemoFilename, FrameNum );//!!localize!!
@@ -350,6 +470,155 @@ ULevel* UDemoRecDriver::GetLevel()
 	unguard;
 
 }
+
+//
+// Read a demo's version and, for versioned demos, the keyframe index from
+// the end.  Leaves Ar at the first packet record and returns the file
+// offset where packet records end.
+//
+INT UDemoRecDriver::ReadIndex( FArchive& Ar, TArray<FDemoKeyframe>& Keyframes, INT& Version )
+{
+	guard(UDemoRecDriver::ReadIndex);
+	INT End   = Ar.TotalSize();
+	INT Start = 0;
+	Keyframes.Empty();
+	Version = 0;
+
+	// Plain demos start straight off with a packet record.
+	if( End>=8 )
+	{
+		INT Tag=0, FileVersion=0;
+		Ar << Tag << FileVersion;
+		if( Tag==DEMO_FILE_TAG && FileVersion>0 && FileVersion<=DEMO_VERSION && !Ar.IsError() )
+		{
+			Version = FileVersion;
+			Start   = 8;
+		}
+	}
+	if( Version && End>=Start+8 )
+	{
+		INT   IndexOffset=0;
+		DWORD Tag=0;
+		Ar.Seek( End-8 );
+		Ar << IndexOffset << Tag;
+		if( Tag==DEMO_INDEX_TAG && IndexOffset>=Start && IndexOffset<End-8 && !Ar.IsError() )
+		{
+			Ar.Seek( IndexOffset );
+			Ar << Keyframes;
+			if( Ar.IsError() )
+				Keyframes.Empty();
+			else
+				End = IndexOffset;
+		}
+	}
+	Ar.Seek( Start );
+	return End;
+	unguard;
+}
+
+//
+// Close every actor channel except the viewer's own, so that each actor
+// reopens with its full state, and note where that happened.
+//
+void UDemoRecDriver::WriteKeyframe()
+{
+	guard(UDemoRecDriver::WriteKeyframe);
+	UNetConnection* Connection = ClientConnections(0);
+	FDemoKeyframeState State;
+	for( INT i=Connection->OpenChannels.Num()-1; i>=0; i-- )
+	{
+		UActorChannel* Channel = Cast<UActorChannel>( Connection->OpenChannels(i) );
+		if( !Channel || Channel->Closing || !Channel->Actor )
+			continue;
+		APlayerPawn* Pawn = Cast<APlayerPawn>( Channel->Actor );
+		if( Channel->Actor==Connection->Actor || (Pawn && Cast<UViewport>(Pawn->Player)) )
+		{
+			// Keep the viewer's channel, but resend all of its properties.
+			for( INT j=0; j<Channel->Retirement.Num(); j++ )
+				Channel->Dirty.AddUniqueItem( j );
+			State.KeptChannels.AddItem( Channel->ChIndex );
+		}
+		else Channel->Close();
+	}
+	Connection->FlushNet();
+
+	// Save the sequence state playback resumes with.
+	State.PacketId = Connection->OutPacketId;
+	for( INT i=0; i<UNetConnection::MAX_CHANNELS; i++ )
+	{
+		if( Connection->OutReliable[i] )
+		{
+			State.Reliable.AddItem( i );
+			State.Reliable.AddItem( Connection->OutReliable[i] );
+		}
+	}
+	FDemoKeyframe& Keyframe = *new(Keyframes)FDemoKeyframe;
+	Keyframe.Time     = Time;
+	Keyframe.FrameNum = FrameNum;
+	Keyframe.Offset   = FileAr->Tell();
+	INT Marker = DEMO_KEYFRAME;
+	*FileAr << FrameNum << Time << Marker << State;
+	LastKeyframeTime = Time;
+
+	unguard;
+}
+
+//
+// Jump playback to the last keyframe at or before Target, then fast-forward.
+//
+UBOOL UDemoRecDriver::SeekTo( DOUBLE Target )
+{
+	guard(UDemoRecDriver::SeekTo);
+	check(ServerConnection);
+	if( !Keyframes.Num() || ServerConnection->State!=USOCK_Open )
+		return 0;
+
+	// Binary search the index.
+	INT Lo=0, Hi=Keyframes.Num()-1;
+	while( Lo<Hi )
+	{
+		INT Mid = (Lo+Hi+1)/2;
+		if( Keyframes(Mid).Time<=Target )
+			Lo = Mid;
+		else
+			Hi = Mid-1;
+	}
+	FDemoKeyframe& Keyframe = Keyframes(Lo);
+
+	// Read the keyframe record.
+	INT    ServerFrameNum, Marker;
+	DOUBLE ServerPacketTime;
+	FDemoKeyframeState State;
+	FileAr->Seek( Keyframe.Offset );
+	*FileAr << ServerFrameNum << ServerPacketTime << Marker;
+	if( Marker!=DEMO_KEYFRAME )
+	{
+		debugf( NAME_DevNet, TEXT("Demo keyframe %i is corrupt"), Lo );
+		return 0;
+	}
+	*FileAr << State;
+
+	// Drop every actor the recorder closed at the keyframe.
+	for( INT i=ServerConnection->OpenChannels.Num()-1; i>=0; i-- )
+	{
+		UChannel* Channel = ServerConnection->OpenChannels(i);
+		if( Channel->ChType==CHTYPE_Actor && State.KeptChannels.FindItemIndex(Channel->ChIndex)==INDEX_NONE )
+			delete Channel;
+	}
+
+	// Resume the sequence where the recorder was.
+	appMemzero( ServerConnection->InReliable, sizeof(ServerConnection->InReliable) );
+	for( INT i=0; i+1<State.Reliable.Num(); i+=2 )
+		if( State.Reliable(i)>=0 && State.Reliable(i)<UNetConnection::MAX_CHANNELS )
+			ServerConnection->InReliable[State.Reliable(i)] = State.Reliable(i+1);
+	ServerConnection->InPacketId = State.PacketId - 1;
+	FrameNum = ServerFrameNum;
+	Time     = ServerPacketTime;
+	SeekTime = Max( Target, ServerPacketTime + 0.001 );
+
+	return 1;
+	unguard;
+}
 void UDemoRecDriver::SpawnDemoRecSpectator( UNetConnection* Connection )
 {
 	guard(UDemoRecDriver::SpawnDemoRecSpectator);
@@ -361,6 +630,71 @@ void UDemoRecDriver::SpawnDemoRecSpectator( UNetConnection* Connection )
 }
 IMPLEMENT_CLASS(UDemoRecDriver);
 
+/*-----------------------------------------------------------------------------
+	FDemoBenchmark.
+-----------------------------------------------------------------------------*/
+
+FDemoBenchmark::FDemoBenchmark( const TCHAR* InCSVFilename )
+:	CSVFilename		( InCSVFilename )
+,	StartTime		( 0.0 )
+,	LastTime		( 0.0 )
+,	ScriptCycles	( 0 )
+,	NetCycles		( 0 )
+{}
+
+//
+// Record the frame that just ended.  The first call only starts the clock.
+//
+void FDemoBenchmark::Sample( INT GameCycles, INT RenderCycles )
+{
+	guard(FDemoBenchmark::Sample);
+	DOUBLE Now = appSeconds();
+	if( LastTime>0.0 )
+	{
+		FLOAT Msec      = GSecondsPerCycle * 1000.f;
+		FLOAT ScriptMs  = ScriptCycles * Msec;
+		FLOAT NetMs     = NetCycles * Msec;
+		Frame .Add( (Now - LastTime) * 1000.f );
+		Game  .Add( Max( GameCycles * Msec - ScriptMs - NetMs, 0.f ) );
+		Script.Add( ScriptMs );
+		Render.Add( RenderCycles * Msec );
+		Net   .Add( NetMs );
+	}
+	else StartTime = Now;
+	LastTime = Now;
+	unguard;
+}
+
+//
+// Log the frame time distribution and write the per-frame CSV.
+//
+void FDemoBenchmark::Report( const TCHAR* DemoFilename, FOutputDevice& Ar )
+{
+	guard(FDemoBenchmark::Report);
+
+	if( CSVFilename!=TEXT("") && Frame.Num() )
+	{
+		FString CSV = TEXT("Frame,FrameMs,GameMs,ScriptMs,RenderMs,NetMs\r\n");
+		for( INT i=0; i<Frame.Num(); i++ )
+			CSV += FString::Printf( TEXT("%i,%.3f,%.3f,%.3f,%.3f,%.3f\r\n"), i, Frame.Samples(i), Game.Samples(i), Script.Samples(i), Render.Samples(i), Net.Samples(i) );
+		if( appSaveStringToFile( CSV, *CSVFilename ) )
+			Ar.Logf( TEXT("Wrote per-frame timings to %s"), *CSVFilename );
+		else
+			Ar.Logf( TEXT("Couldn't write %s"), *CSVFilename );
+	}
+
+	DOUBLE Seconds = LastTime - StartTime;
+	Ar.Logf( TEXT("Benchmark %s: %i frames in %.2f seconds, %.2f fps"), DemoFilename, Frame.Num(), Seconds, Seconds>0.0 ? Frame.Num() / Seconds : 0.0 );
+
+	// Describe copies, since finding percentiles sorts the samples.
+	FTimeSamples Series[5] = { Frame, Game, Script, Render, Net };
+	const TCHAR* Names[5]  = { TEXT("Frame "), TEXT("Game  "), TEXT("Script"), TEXT("Render"), TEXT("Net   ") };
+	for( INT i=0; i<5; i++ )
+		Ar.Logf( TEXT("   %s %s"), Names[i], *Series[i].Describe() );
+
+	unguard;
+}
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
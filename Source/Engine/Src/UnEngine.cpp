@@ -16,6 +16,7 @@
 IMPLEMENT_CLASS(UEngine);
 IMPLEMENT_CLASS(URenderBase);
 IMPLEMENT_CLASS(URenderDevice);
+IMPLEMENT_CLASS(UNullRenderDevice);
 IMPLEMENT_CLASS(URenderIterator);
 
 /*-----------------------------------------------------------------------------
@@ -219,6 +220,8 @@ UBOOL UEngine::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
 	if( GSys    && GSys->Exec		(Cmd,Ar) ) return 1;
 	if( UObject::StaticExec			(Cmd,Ar) ) return 1;
 	if( GCache.Exec					(Cmd,Ar) ) return 1;
+	if( GTickPacer.Exec				(Cmd,Ar) ) return 1;
+	if( GMeshAnimLOD.Exec			(Cmd,Ar) ) return 1;
 	if( GExec   && GExec->Exec      (Cmd,Ar) ) return 1;
 	if( Client  && Client->Exec		(Cmd,Ar) ) return 1;
 	if( Render  && Render->Exec		(Cmd,Ar) ) return 1;
@@ -231,6 +234,11 @@ UBOOL UEngine::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
 		Ar.Log( TEXT("Flushed engine caches") );
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,TEXT("MESHLERP")) )
+	{
+		FMeshLerp::Benchmark( Ar );
+		return 1;
+	}
 	else if( ParseCommand(&Cmd,TEXT("CRACKURL")) )
 	{
 		FURL URL(NULL,Cmd,TRAVEL_Absolute);
@@ -345,6 +353,7 @@ class UServerCommandlet : public UCommandlet
 		UClass* EngineClass = UObject::StaticLoadClass( UEngine::StaticClass(), NULL, TEXT("ini:Engine.Engine.GameEngine"), NULL, LOAD_NoFail | LOAD_DisallowFiles, NULL );
 		UEngine* Engine = ConstructObject<UEngine>( EngineClass );
 		Engine->Init();
+		GTickPacer.Init();
 
 		// Main loop.
 		GIsRunning = 1;
@@ -369,12 +378,7 @@ class UServerCommandlet : public UCommandlet
 
 			// Enforce optional maximum tick rate.
 			guard(EnforceTickRate);
-			FLOAT MaxTickRate = Engine->GetMaxTickRate();
-			if( MaxTickRate>0.0 )
-			{
-				FLOAT Delta = (1.0/MaxTickRate) - (appSeconds()-OldTime);
-				appSleep( Max(0.f,Delta) );
-			}
+			GTickPacer.Wait( Engine->GetMaxTickRate(), OldTime );
 			unguard;
 		}
 		GIsRunning = 0;
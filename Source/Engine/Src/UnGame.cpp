@@ -1089,6 +1089,7 @@ ULevel* UGameEngine::LoadMap( const FURL& URL, UPendingLevel* Pending, const TMa
 	GLevel->Actors.Add( Actors.Num() );
 	for( i=0; i<Actors.Num(); i++ )
 		GLevel->Actors(i) = Actors(i);
+	GLevel->FlushClassIndex();
 	unguard;
 
 	// Cleanup profiling.
@@ -1580,6 +1581,10 @@ void UGameEngine::Tick( FLOAT DeltaSeconds )
 	ClientCycles=LocalClientCycles;
 	unguard;
 
+	// Sample demo benchmark timings.
+	if( GLevel && Cast<UDemoRecDriver>(GLevel->DemoRecDriver) )
+		((UDemoRecDriver*)GLevel->DemoRecDriver)->TickBenchmark( GameCycles, ClientCycles );
+
 	unclock(LocalTickCycles);
 	TickCycles=LocalTickCycles;
 	GTicks++;
@@ -70,6 +70,10 @@ AActor* ULevel::SpawnActor
 	INT iActor = Actors.Add();
     AActor* Actor = Actors(iActor) = (AActor*)StaticConstructObject( Class, GetOuter(), InName, 0, Template );
 	Actor->SetFlags( RF_Transactional );
+	if( ClassIndex )
+		ClassIndex->AddActor( Actor, iActor );
+	if( TickScheduler )
+		TickScheduler->AddActor( Actor );
 
 	// Set base actor properties.
 	Actor->Tag		= Class->GetFName();
@@ -93,6 +97,8 @@ AActor* ULevel::SpawnActor
 	Actor->Rotation = Rotation;
 	if( Actor->bCollideActors && Hash  )
 		Hash->AddActor( Actor );
+	if( Broadphase )
+		Broadphase->AddActor( Actor );
 
 	// Init the actor's zone.
 	Actor->Region = FPointRegion(GetLevelInfo());
@@ -321,6 +327,12 @@ UBOOL ULevel::DestroyActor( AActor* ThisActor, UBOOL bNetForce )
 	// Remove the actor from the actor list.
 	guard(Unlist);
 	check(Actors(iActor)==ThisActor);
+	if( ClassIndex )
+		ClassIndex->RemoveActor( ThisActor, iActor );
+	if( Broadphase )
+		Broadphase->RemoveActor( ThisActor );
+	if( TickScheduler )
+		TickScheduler->RemoveActor( ThisActor );
 	Actors(iActor) = NULL;
 	ThisActor->bDeleteMe = 1;
 	unguard;
@@ -358,19 +370,26 @@ UBOOL ULevel::DestroyActor( AActor* ThisActor, UBOOL bNetForce )
 void ULevel::CompactActors()
 {
 	guard(ULevel::CompactActors);
+	TArray<INT> Removed;
 	INT c = iFirstDynamicActor;
 	for( INT i=iFirstDynamicActor; i<Actors.Num(); i++ )
 	{
-		if( Actors(i) )
+		if( Actors(i) && !Actors(i)->bDeleteMe )
+			Actors(c++) = Actors(i);
+		else
 		{
-			if( !Actors(i)->bDeleteMe )
-				Actors(c++) = Actors(i);
-			else
+			if( Actors(i) )
 				debugf( TEXT("Undeleted %s"), Actors(i)->GetFullName() );
+			if( ClassIndex )
+				Removed.AddItem( i );
 		}
 	}
 	if( c != Actors.Num() )
+	{
 		Actors.Remove( c, Actors.Num()-c );
+		if( ClassIndex )
+			ClassIndex->Compact( Removed );
+	}
 	unguard;
 }
 
@@ -419,6 +438,8 @@ void ULevel::CleanupDestroyed( UBOOL bForce )
 		return;
 
 	guard(FinishDestroyedActors);
+	if( TickScheduler )
+		TickScheduler->Purge();
 	while( FirstDeleted!=NULL )
 	{
 		// Physically destroy the actor-to-delete.
@@ -787,6 +808,8 @@ UBOOL ULevel::FarMoveActor( AActor* Actor, FVector DestLocation,  UBOOL test, UB
 
 	if( Actor->bCollideActors && Hash ) //&& !test
 		Hash->AddActor( Actor );
+	if( Broadphase )
+		Broadphase->MoveActor( Actor );
 
 	// Set the zone after moving, so that if a ZoneChange or ActorEntered/ActorEntered message
 	// tries to move the actor, the hashing will be correct.
@@ -994,6 +1017,8 @@ UBOOL ULevel::MoveActor
 	Actor->Rotation  = NewRotation;
 	if( Actor->bCollideActors && Hash )
 		Hash->AddActor( Actor );
+	if( Broadphase )
+		Broadphase->MoveActor( Actor );
 
 	// Handle bump and touch notifications.
 	if( !bTest )
@@ -57,8 +57,8 @@ UBOOL AActor::Tick( FLOAT DeltaSeconds, ELevelTick TickType )
 	&&	(Level->NetMode == NM_Standalone) )
 		return 1;
 
-	// Handle owner-first updating.
-	if( Owner && (INT)Owner->bTicked!=GetLevel()->Ticked )
+	// Handle owner-first updating.  Dormant owners aren't ticked at all.
+	if( Owner && (INT)Owner->bTicked!=GetLevel()->Ticked && !FTickScheduler::IsDormant(Owner) )
 	{
 		GetLevel()->NewlySpawned = new(GEngineMem)FActorLink(this,GetLevel()->NewlySpawned);
 		return 0;
@@ -475,7 +475,10 @@ UBOOL ActorCanSee( AActor* Actor, APlayerPawn* RealViewer, AActor* Viewer, FVect
 	unguardSlow;
 }
 
-INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
+//
+// Gather the actor updates to send to a client into Batch.
+//
+void ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds, FRepBatch& Batch )
 {
 	guard(ULevel::ServerTickClient);
 	check(Connection);
@@ -483,7 +486,6 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 	DOUBLE CullTime=0.0, TraceTime=0.0, RepTime=0.0; INT CullCount=0, RepCount=0;
 
 	// Handle not ready channels.
-	INT Updated=0;
 	if( Connection->Actor && Connection->IsNetReady(0) && Connection->State==USOCK_Open )
 	{
 		// Get list of visible/relevant actors.
@@ -558,9 +560,9 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 		Sort( PriorityActors, ConsiderCount );
 		unguard;
 
-		// Update all relevant actors in sorted order.
+		// Gather updates of all relevant actors in sorted order, up to what the connection can take.
 		guard(UpdateRelevant);
-		for( INT j=0; j<ConsiderCount && Connection->IsNetReady(0); j++ )
+		for( INT j=0; j<ConsiderCount && !Batch.IsFull(); j++ )
 		{
 			AActor*        Actor       = PriorityActors[j]->Actor;
 			UActorChannel* Channel     = PriorityActors[j]->Channel;
@@ -582,13 +584,12 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 				{
 					if( CanSee )
 						Channel->RelevantTime = NetDriver->Time;
-					if( Channel->IsNetReady(0) )
+					if( Channel->NumOutRec<RELIABLE_BUFFER-1 )
 					{
 						RepTime-=appSeconds();
 						RepCount++;
-						Channel->ReplicateActor();
+						Channel->PrepareReplication( Batch );
 						RepTime+=appSeconds();
-						Updated++;
 					}
 				}
 			}
@@ -600,7 +601,6 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 	}
 	if( NetDriver->ProfileStats )
 		debugf(TEXT("Cull=%01.4f (%03i) Trace=%01.4f Rep=%01.4f (%03i)"),CullTime*1000,CullCount,TraceTime*1000,RepTime*1000,RepCount);
-	return Updated;
 	unguard;
 }
 
@@ -608,17 +608,59 @@ INT ULevel::ServerTickClient( UNetConnection* Connection, FLOAT DeltaSeconds )
 	Network server tick.
 -----------------------------------------------------------------------------*/
 
+//
+// Send one client's gathered updates; run by the net worker threads.
+//
+static void SendRepBatch( void* Context, INT Index )
+{
+	((FRepBatch*)Context)[Index].Send();
+}
+
 void ULevel::TickNetServer( FLOAT DeltaSeconds )
 {
 	guard(ULevel::TickNetServer);
 
-	// Update all clients.
+	// Gather what to send to each client.  This runs script and touches
+	// actors, so it stays on the game thread.
 	clock(NetTickCycles);
-	INT Updated=0;
+	TArray<FRepBatch> Batches;
 	for( INT i=NetDriver->ClientConnections.Num()-1; i>=0; i-- )
-		Updated += ServerTickClient( NetDriver->ClientConnections(i), DeltaSeconds );
+	{
+		UNetConnection* Connection = NetDriver->ClientConnections(i);
+		ServerTickClient( Connection, DeltaSeconds, *new(Batches)FRepBatch(Connection) );
+	}
+
+	// Encode and send it, one connection per thread if there are enough of
+	// them.  Packets are queued and passed to the socket afterwards, since
+	// the drivers' send paths share state.
+	guard(SendBatches);
+	if( Batches.Num()>1 && NetDriver->GetWorkers()->NumThreads() )
+	{
+		for( INT i=0; i<Batches.Num(); i++ )
+			Batches(i).Connection->DeferSends = 1;
+		NetDriver->GetWorkers()->Run( SendRepBatch, &Batches(0), Batches.Num() );
+		for( INT i=0; i<Batches.Num(); i++ )
+		{
+			Batches(i).Connection->DeferSends = 0;
+			Batches(i).Connection->SendDeferred();
+		}
+	}
+	else for( INT i=0; i<Batches.Num(); i++ )
+		Batches(i).Send();
+	unguard;
+	INT Updated=0;
+	for( INT i=0; i<Batches.Num(); i++ )
+	{
+		Updated += Batches(i).Updated;
+		NumReps += Batches(i).NumReps;
+	}
+	Batches.Empty();
 	unclock(NetTickCycles);
 
+	// Load test statistics.
+	if( GNetLoad.Active )
+		GNetLoad.Tick( this, Updated );
+
 	// Log message.
 	if( (INT)(TimeSeconds-DeltaSeconds)!=(INT)(TimeSeconds) )
 		debugf( NAME_Title, LocalizeProgress("RunningNet"), *GetLevelInfo()->Title, *URL.Map, NetDriver->ClientConnections.Num() );
@@ -818,7 +860,10 @@ void ULevel::Tick( ELevelTick TickType, FLOAT DeltaSeconds )
 		guard(TickAllActors);
 		NewlySpawned = NULL;
 		INT Updated  = 0;
-		for( INT iActor=iFirstDynamicActor; iActor<Actors.Num(); iActor++ )
+		FTickScheduler* Scheduler = GetTickScheduler();
+		if( Scheduler )
+			Updated = Scheduler->TickActors( this, DeltaSeconds, TickType );
+		else for( INT iActor=iFirstDynamicActor; iActor<Actors.Num(); iActor++ )
 			if( Actors( iActor ) )
 				Updated += Actors( iActor )->Tick(DeltaSeconds,TickType);
 		while( NewlySpawned && Updated )
@@ -877,6 +922,8 @@ void ULevel::Tick( ELevelTick TickType, FLOAT DeltaSeconds )
 	// Finish up.
 	Ticked = !Ticked;
 	InTick = 0;
+	if( TickScheduler )
+		TickScheduler->bTickedActors = 0;
 	Mark.Pop();
 	EngineMark.Pop();
 	CleanupDestroyed( 0 );
@@ -231,6 +231,26 @@ void ULevel::Destroy()
 		delete BrushTracker;
 		BrushTracker = NULL; /* Required because brushes may clean themselves up. */
 	}
+	if( NavGraph )
+	{
+		delete NavGraph;
+		NavGraph = NULL;
+	}
+	if( ClassIndex )
+	{
+		delete ClassIndex;
+		ClassIndex = NULL;
+	}
+	if( Broadphase )
+	{
+		delete Broadphase;
+		Broadphase = NULL;
+	}
+	if( TickScheduler )
+	{
+		delete TickScheduler;
+		TickScheduler = NULL;
+	}
 
 	Super::Destroy();
 	unguard;
@@ -366,6 +386,8 @@ UBOOL ULevel::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
 		{
 			if( URL.Map.Right(4)!=TEXT(".dem") )
 				URL.Map += TEXT(".dem");
+			if( ParseCommand( &Cmd, TEXT("KEYFRAMES") ) )
+				URL.AddOption( TEXT("keyframes") );
 			debugf( TEXT("Attempting to record demo %s"), *URL.Map );
 			UClass* DemoDriverClass = StaticLoadClass( UNetDriver::StaticClass(), NULL, TEXT("ini:Engine.Engine.DemoRecordingDevice"), NULL, LOAD_NoFail, NULL );
 			DemoRecDriver           = ConstructObject<UNetDriver>( DemoDriverClass );
@@ -406,10 +428,137 @@ UBOOL ULevel::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
 		else Ar.Log( TEXT("You must specify a filename") );//!!localize!!
 		return 1;
 	}
+	else if( ParseCommand( &Cmd, TEXT("NAVSTAT") ) )
+	{
+		FNavGraph& Graph = GetNavGraph();
+		if( ParseCommand( &Cmd, TEXT("RESET") ) )
+			Graph.NumSearches = Graph.NumExpanded = Graph.NumSpecialCosts = Graph.NumFlowHits = Graph.NumFlowBuilds = Graph.NumFlowExpanded = 0;
+		Ar.Logf( TEXT("Navigation: %s"), *Graph.Describe() );
+		return 1;
+	}
+	else if( ParseCommand( &Cmd, TEXT("TICKSCHED") ) )
+	{
+		FTickScheduler* Scheduler = GetTickScheduler();
+		if( Scheduler )
+			Ar.Logf( TEXT("Tick schedule: %s"), *Scheduler->Describe() );
+		else
+			Ar.Log( TEXT("Tick scheduling is not used in the editor") );
+		return 1;
+	}
+	else if( ParseCommand( &Cmd, TEXT("ACTORINDEX") ) )
+	{
+		FActorClassIndex* Index = GetClassIndex();
+		if( !Index )
+			Ar.Log( TEXT("Actor index is not used in the editor") );
+		else if( ParseCommand( &Cmd, TEXT("BENCH") ) )
+			Index->Benchmark( this, Ar );
+		else
+		{
+			Ar.Logf( TEXT("Actor index: %s"), *Index->Describe() );
+			Ar.Logf( TEXT("Broadphase: %s"), *GetBroadphase()->Describe() );
+		}
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	ULevel navigation.
+-----------------------------------------------------------------------------*/
+
+//
+// The navigation graph route searches run on, built on first use.  It is
+// only rebuilt when a new search starts, since rebuilding discards the
+// state of the search in progress.
+//
+FNavGraph& ULevel::GetNavGraph( UBOOL bNewSearch )
+{
+	guard(ULevel::GetNavGraph);
+	if( !NavGraph )
+	{
+		NavGraph = new FNavGraph;
+		NavGraph->Build( this );
+	}
+	else if( bNewSearch && !NavGraph->IsValid(this) )
+		NavGraph->Build( this );
+	return *NavGraph;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	ULevel actor class index.
+-----------------------------------------------------------------------------*/
+
+//
+// The per-class actor index used by actor iterators, built on first use.
+// Returns NULL in the editor, which rearranges the actor list freely.
+//
+FActorClassIndex* ULevel::GetClassIndex()
+{
+	guardSlow(ULevel::GetClassIndex);
+	if( GIsEditor )
+		return NULL;
+	if( !ClassIndex )
+	{
+		ClassIndex = new FActorClassIndex;
+		ClassIndex->Build( this );
+	}
+	return ClassIndex;
+	unguardSlow;
+}
+
+//
+// Reindex after the actor list has been rearranged.
+//
+void ULevel::FlushClassIndex()
+{
+	guard(ULevel::FlushClassIndex);
+	if( ClassIndex )
+		ClassIndex->Build( this );
+	unguard;
+}
+
+//
+// The spatial actor lookup used by radius iterators, built on first use.
+// Returns NULL in the editor, like the class index.
+//
+FActorBroadphase* ULevel::GetBroadphase()
+{
+	guardSlow(ULevel::GetBroadphase);
+	if( GIsEditor )
+		return NULL;
+	if( !Broadphase )
+	{
+		Broadphase = new FActorBroadphase;
+		Broadphase->Build( this );
+	}
+	return Broadphase;
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	ULevel tick scheduling.
+-----------------------------------------------------------------------------*/
+
+//
+// The scheduler that decides which actors are ticked, built on first use.
+// Returns NULL in the editor, which ticks every actor.
+//
+FTickScheduler* ULevel::GetTickScheduler()
+{
+	guardSlow(ULevel::GetTickScheduler);
+	if( GIsEditor )
+		return NULL;
+	if( !TickScheduler )
+	{
+		TickScheduler = new FTickScheduler;
+		TickScheduler->Build( this );
+	}
+	return TickScheduler;
+	unguardSlow;
+}
+
 /*-----------------------------------------------------------------------------
 	ULevel networking related functions.
 -----------------------------------------------------------------------------*/
@@ -648,10 +797,17 @@ void ULevel::NotifyReceivedText( UNetConnection* Connection, const TCHAR* Text )
 			}
 			Connection->NegotiatedVer = Min<INT>( RemoteVer, ENGINE_VERSION );
 
+			// Compress packets if the client has the same model.
+			DWORD RemoteModel=0;
+			Connection->CompressOut = Parse(Text,TEXT("COMPRESS="),RemoteModel) && NetDriver->CompressPackets && RemoteModel==GNetPacketModel.Checksum;
+
 			// Get byte limit.
 			INT Stats = GetLevelInfo()->Game->bWorldLog;
 			Connection->Challenge = appCycles();
-			Connection->Logf( TEXT("CHALLENGE VER=%i CHALLENGE=%i STATS=%i"), Connection->NegotiatedVer, Connection->Challenge, Stats );
+			if( Connection->CompressOut )
+				Connection->Logf( TEXT("CHALLENGE VER=%i CHALLENGE=%i STATS=%i COMPRESS=%u"), Connection->NegotiatedVer, Connection->Challenge, Stats, GNetPacketModel.Checksum );
+			else
+				Connection->Logf( TEXT("CHALLENGE VER=%i CHALLENGE=%i STATS=%i"), Connection->NegotiatedVer, Connection->Challenge, Stats );
 			Connection->FlushNet();
 		}
 		else if( ParseCommand(&Text,TEXT("NETSPEED")) )
@@ -779,9 +935,11 @@ void ULevel::GetStats( TCHAR* Result )
 	appSprintf
 	(
 		Result,
-		TEXT("Script=%05.1f Actor=%04.1f Path=%04.1f See=%04.1f Spawn=%04.1f Audio=%04.1f Un=%04.1f Move=%04.1f (%i) Net=%04.1f"),
+		TEXT("Script=%05.1f Actor=%04.1f (%i/%i) Path=%04.1f See=%04.1f Spawn=%04.1f Audio=%04.1f Un=%04.1f Move=%04.1f (%i) Net=%04.1f"),
 		GSecondsPerCycle*1000 * GScriptCycles,
 		GSecondsPerCycle*1000 * ActorTickCycles,
+		TickScheduler ? TickScheduler->NumTicked  : 0,
+		TickScheduler ? TickScheduler->NumSkipped : 0,
 		GSecondsPerCycle*1000 * FindPathCycles,
 		GSecondsPerCycle*1000 * SeePlayer,
 		GSecondsPerCycle*1000 * Spawning,
@@ -0,0 +1,265 @@
+/*=============================================================================
+	UnLoopback.cpp: In-memory loopback network driver.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+#include "UnNet.h"
+
+// Packet size and per-packet overhead, matching a UDP connection.
+#define LOOPBACK_MAX_PACKET (512)
+#define LOOPBACK_OVERHEAD   (28)
+
+// Listening loopback drivers in this process.
+static TArray<ULoopbackNetDriver*> GLoopbackListeners;
+
+/*-----------------------------------------------------------------------------
+	ULoopbackConnection.
+-----------------------------------------------------------------------------*/
+
+ULoopbackConnection::ULoopbackConnection( UNetDriver* InDriver, const FURL& InURL, EConnectionState InState )
+:	UNetConnection	( InDriver, InURL )
+,	Peer			( NULL )
+{
+	guard(ULoopbackConnection::ULoopbackConnection);
+	State			= InState;
+	MaxPacket		= LOOPBACK_MAX_PACKET;
+	PacketOverhead	= LOOPBACK_OVERHEAD;
+	InitOut();
+	unguard;
+}
+void ULoopbackConnection::Destroy()
+{
+	guard(ULoopbackConnection::Destroy);
+
+	// Unlink from the other side; packets still in flight are lost.
+	if( Peer )
+		Peer->Peer = NULL;
+	Peer = NULL;
+	for( INT i=0; i<GLoopbackListeners.Num(); i++ )
+		GLoopbackListeners(i)->PendingConnects.RemoveItem( this );
+
+	Super::Destroy();
+	unguard;
+}
+FString ULoopbackConnection::LowLevelGetRemoteAddress()
+{
+	guard(ULoopbackConnection::LowLevelGetRemoteAddress);
+	return FString::Printf( TEXT("loopback:%s"), Peer ? Peer->GetName() : TEXT("none") );
+	unguard;
+}
+FString ULoopbackConnection::LowLevelDescribe()
+{
+	guard(ULoopbackConnection::LowLevelDescribe);
+	return FString::Printf
+	(
+		TEXT("%s %s state: %s link: %s"),
+		*URL.Host,
+		*LowLevelGetRemoteAddress(),
+			State==USOCK_Pending	?	TEXT("Pending")
+		:	State==USOCK_Open		?	TEXT("Open")
+		:	State==USOCK_Closed		?	TEXT("Closed")
+		:								TEXT("Invalid"),
+		*Link.Describe()
+	);
+	unguard;
+}
+void ULoopbackConnection::LowLevelSend( void* Data, INT Count )
+{
+	guard(ULoopbackConnection::LowLevelSend);
+	clock(Driver->SendCycles);
+	Link.Send( Data, Count, appSeconds() );
+	unclock(Driver->SendCycles);
+	unguard;
+}
+
+//
+// Receive every packet from the peer's link whose delivery time has come.
+//
+void ULoopbackConnection::ReceiveFromPeer()
+{
+	guard(ULoopbackConnection::ReceiveFromPeer);
+	if( !Peer )
+		return;
+	clock(Driver->RecvCycles);
+	DOUBLE Now = appSeconds();
+	for( DelayedPacket* Packet=Peer->Link.Peek(Now); Packet && Peer && State!=USOCK_Closed; Packet=Peer ? Peer->Link.Peek(Now) : NULL )
+	{
+		// Copy out first, since receiving may send and grow the peer's queue.
+		BYTE Data[LOOPBACK_MAX_PACKET];
+		INT  Size = ::Min( Packet->Data.Num(), LOOPBACK_MAX_PACKET );
+		appMemcpy( Data, &Packet->Data(0), Size );
+		Peer->Link.Pop();
+		ReceivedRawPacket( Data, Size );
+	}
+	unclock(Driver->RecvCycles);
+	unguard;
+}
+IMPLEMENT_CLASS(ULoopbackConnection);
+
+/*-----------------------------------------------------------------------------
+	ULoopbackNetDriver.
+-----------------------------------------------------------------------------*/
+
+ULoopbackNetDriver::ULoopbackNetDriver()
+{}
+void ULoopbackNetDriver::StaticConstructor()
+{
+	guard(ULoopbackNetDriver::StaticConstructor);
+
+	// Default link conditions, loaded from .ini.
+	new(GetClass(),TEXT("PktLoss"),  RF_Public)UIntProperty(CPP_PROPERTY(PktLoss ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("PktOrder"), RF_Public)UIntProperty(CPP_PROPERTY(PktOrder), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("PktDup"),   RF_Public)UIntProperty(CPP_PROPERTY(PktDup  ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("PktLag"),   RF_Public)UIntProperty(CPP_PROPERTY(PktLag  ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("PktRate"),  RF_Public)UIntProperty(CPP_PROPERTY(PktRate ), TEXT("Client"), CPF_Config );
+
+	unguard;
+}
+void ULoopbackNetDriver::LowLevelDestroy()
+{
+	guard(ULoopbackNetDriver::LowLevelDestroy);
+	GLoopbackListeners.RemoveItem( this );
+	PendingConnects.Empty();
+	unguard;
+}
+FString ULoopbackNetDriver::LowLevelGetNetworkNumber()
+{
+	guard(ULoopbackNetDriver::LowLevelGetNetworkNumber);
+	return TEXT("127.0.0.1");
+	unguard;
+}
+
+//
+// Set up a link's conditions from the driver defaults and any URL options
+// such as ?PktLag=100.
+//
+void ULoopbackNetDriver::InitLink( FPacketSimulator& Link, const FURL& URL )
+{
+	guard(ULoopbackNetDriver::InitLink);
+	Link.PktLoss  = PktLoss;
+	Link.PktOrder = PktOrder;
+	Link.PktDup   = PktDup;
+	Link.PktLag   = PktLag;
+	Link.PktRate  = PktRate;
+	for( INT i=0; i<URL.Op.Num(); i++ )
+		Link.Init( *URL.Op(i) );
+	unguard;
+}
+ULoopbackNetDriver* ULoopbackNetDriver::FindListener( INT Port )
+{
+	guard(ULoopbackNetDriver::FindListener);
+	for( INT i=0; i<GLoopbackListeners.Num(); i++ )
+		if( GLoopbackListeners(i)->Port==Port )
+			return GLoopbackListeners(i);
+	return NULL;
+	unguard;
+}
+UBOOL ULoopbackNetDriver::InitConnect( FNetworkNotify* InNotify, FURL& ConnectURL, FString& Error )
+{
+	guard(ULoopbackNetDriver::InitConnect);
+	if( !Super::InitConnect( InNotify, ConnectURL, Error ) )
+		return 0;
+
+	// Find the server in this process.
+	ULoopbackNetDriver* Listener = FindListener( ConnectURL.Port );
+	if( !Listener )
+	{
+		Error = FString::Printf( TEXT("No loopback server on port %i"), ConnectURL.Port );
+		return 0;
+	}
+
+	// Create new connection; the listener accepts it in its next TickDispatch.
+	Port = 0;
+	ServerConnection = new ULoopbackConnection( this, ConnectURL, USOCK_Pending );
+	InitLink( ((ULoopbackConnection*)ServerConnection)->Link, ConnectURL );
+	Listener->PendingConnects.AddItem( (ULoopbackConnection*)ServerConnection );
+	debugf( NAME_DevNet, TEXT("Loopback client to port %i, rate %i"), ConnectURL.Port, ServerConnection->CurrentNetSpeed );
+
+	// Create channel zero.
+	ServerConnection->CreateChannel( CHTYPE_Control, 1, 0 );
+
+	return 1;
+	unguard;
+}
+UBOOL ULoopbackNetDriver::InitListen( FNetworkNotify* InNotify, FURL& LocalURL, FString& Error )
+{
+	guard(ULoopbackNetDriver::InitListen);
+	if( !Super::InitListen( InNotify, LocalURL, Error ) )
+		return 0;
+
+	Parse( appCmdLine(), TEXT("PORT="), LocalURL.Port );
+	if( FindListener(LocalURL.Port) )
+	{
+		Error = FString::Printf( TEXT("Loopback port %i already in use"), LocalURL.Port );
+		return 0;
+	}
+	Port          = LocalURL.Port;
+	LocalURL.Host = LowLevelGetNetworkNumber();
+	GLoopbackListeners.AddItem( this );
+	debugf( NAME_DevNet, TEXT("LoopbackNetDriver on port %i"), Port );
+
+	return 1;
+	unguard;
+}
+void ULoopbackNetDriver::TickDispatch( FLOAT DeltaTime )
+{
+	guard(ULoopbackNetDriver::TickDispatch);
+	Super::TickDispatch( DeltaTime );
+
+	// Accept pending clients.
+	while( PendingConnects.Num() && Notify->NotifyAcceptingConnection()==ACCEPTC_Accept )
+	{
+		ULoopbackConnection* Remote = PendingConnects(0);
+		PendingConnects.Remove( 0 );
+
+		ULoopbackConnection* Connection = new ULoopbackConnection( this, FURL(), USOCK_Open );
+		Connection->URL.Host = FString::Printf( TEXT("loopback%i"), ClientConnections.Num() );
+		InitLink( Connection->Link, Remote->URL );
+		Connection->Link.Seed += ClientConnections.Num();
+		Connection->Peer = Remote;
+		Remote->Peer     = Connection;
+		Notify->NotifyAcceptedConnection( Connection );
+		ClientConnections.AddItem( Connection );
+	}
+
+	// Deliver packets that have arrived.
+	if( ServerConnection )
+		((ULoopbackConnection*)ServerConnection)->ReceiveFromPeer();
+	for( INT i=0; i<ClientConnections.Num(); i++ )
+		if( Cast<ULoopbackConnection>(ClientConnections(i)) )
+			((ULoopbackConnection*)ClientConnections(i))->ReceiveFromPeer();
+
+	unguard;
+}
+
+//
+// LOOPBACK [PktLag=n] [PktLoss=n] [PktOrder=n] [PktDup=n] [PktRate=n]:
+// change link conditions on all of this driver's connections and show stats.
+//
+UBOOL ULoopbackNetDriver::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
+{
+	guard(ULoopbackNetDriver::Exec);
+	if( ParseCommand(&Cmd,TEXT("LOOPBACK")) )
+	{
+		if( ServerConnection )
+		{
+			((ULoopbackConnection*)ServerConnection)->Link.Init( Cmd );
+			Ar.Logf( TEXT("   Server %s"), *ServerConnection->LowLevelDescribe() );
+		}
+		for( INT i=0; i<ClientConnections.Num(); i++ )
+		{
+			if( Cast<ULoopbackConnection>(ClientConnections(i)) )
+				((ULoopbackConnection*)ClientConnections(i))->Link.Init( Cmd );
+			Ar.Logf( TEXT("   Client %s"), *ClientConnections(i)->LowLevelDescribe() );
+		}
+		return 1;
+	}
+	else return Super::Exec( Cmd, Ar );
+	unguard;
+}
+IMPLEMENT_CLASS(ULoopbackNetDriver);
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
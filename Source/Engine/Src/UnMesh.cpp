@@ -557,25 +557,39 @@ void UMesh::GetFrame
 			Item->Unlock();
 			GCache.Flush( CacheID );
 		}
-		Mem = GCache.Create( CacheID, Item, sizeof(UMesh*) + sizeof(FLOAT) + sizeof(FName) + FrameVerts * sizeof(FVector) );
+		Mem = GCache.Create( CacheID, Item, sizeof(UMesh*) + sizeof(FLOAT) + sizeof(FName) + sizeof(FLOAT) + FrameVerts * sizeof(FVector) );
 		WasCached = 0;
 	}
 	UMesh*& CachedMesh  = *(UMesh**)Mem; Mem += sizeof(UMesh*);
 	FLOAT&  CachedFrame = *(FLOAT *)Mem; Mem += sizeof(FLOAT );
 	FName&  CachedSeq   = *(FName *)Mem; Mem += sizeof(FName);
+	FLOAT&  CachedTime  = *(FLOAT *)Mem; Mem += sizeof(FLOAT );
 	if( !WasCached )
 	{
 		CachedMesh  = this;
 		CachedSeq   = NAME_None;
 		CachedFrame = 0.0;
+		CachedTime  = 0.0;
 	}
 
 	// Get stuff.
 	FLOAT    DrawScale      = AnimOwner->bParticles ? 1.0 : Owner->DrawScale;
 	FVector* CachedVerts    = (FVector*)Mem;
+	FVector  ViewLocation   = Coords.Origin;
 	Coords                  = Coords * (Owner->Location + Owner->PrePivot) * Owner->Rotation * RotOrigin * FScale(Scale * DrawScale,0.0,SHEER_None);
 	const FMeshAnimSeq* Seq = GetAnimSeq( AnimOwner->AnimSequence );
 
+	// Reuse the cached frame of a distant mesh until it's due a resample.
+	if( WasCached && !GMeshAnimLOD.NeedsSample( Owner, ViewLocation, CachedTime ) )
+	{
+		FMeshLerp::Transform( FrameVerts, CachedVerts, Origin, Coords, ResultVerts, Size );
+		GMeshAnimLOD.Reused( FrameVerts );
+		Item->Unlock();
+		return;
+	}
+	CachedTime = Owner->Level ? Owner->Level->TimeSeconds : 0.0;
+	GMeshAnimLOD.Decoded( FrameVerts );
+
 	// Transform all points into screenspace.
 	if( AnimOwner->AnimFrame>=0.0 || !WasCached )
 	{
@@ -592,16 +606,7 @@ void UMesh::GetFrame
 		}
 
 		// Interpolate two frames.
-		FMeshVert* MeshVertex1 = &Verts( iFrameOffset1 );
-		FMeshVert* MeshVertex2 = &Verts( iFrameOffset2 );
-		for( INT i=0; i<FrameVerts; i++ )
-		{
-			FVector V1( MeshVertex1[i].X, MeshVertex1[i].Y, MeshVertex1[i].Z );
-			FVector V2( MeshVertex2[i].X, MeshVertex2[i].Y, MeshVertex2[i].Z );
-			CachedVerts[i] = V1 + (V2-V1)*Alpha;
-			*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-			*(BYTE**)&ResultVerts += Size;
-		}
+		FMeshLerp::Lerp( &Verts(iFrameOffset1), &Verts(iFrameOffset2), Alpha, FrameVerts, CachedVerts, Origin, Coords, ResultVerts, Size );
 	}
 	else
 	{
@@ -617,14 +622,7 @@ void UMesh::GetFrame
 		}
 
 		// Tween all points.
-		FMeshVert* MeshVertex = &Verts( iFrameOffset );
-		for( INT i=0; i<FrameVerts; i++ )
-		{
-			FVector V2( MeshVertex[i].X, MeshVertex[i].Y, MeshVertex[i].Z );
-			CachedVerts[i] += (V2 - CachedVerts[i]) * Alpha;
-			*ResultVerts = (CachedVerts[i] - Origin).TransformPointBy(Coords);
-			*(BYTE**)&ResultVerts += Size;
-		}
+		FMeshLerp::Tween( &Verts(iFrameOffset), Alpha, FrameVerts, CachedVerts, Origin, Coords, ResultVerts, Size );
 
 		// Update cached frame.
 		CachedFrame = AnimOwner->AnimFrame;
@@ -0,0 +1,338 @@
+/*=============================================================================
+	UnMeshLerp.cpp: Batched and level-of-detail mesh frame sampling.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+// The SH4's FTRV and FIPR work on whole vertices, so staging coordinates
+// apart would only add copies there; the Dreamcast keeps the per-vertex loop.
+#ifdef PLATFORM_DREAMCAST
+	#define MESHLERP_BATCHED 0
+#else
+	#define MESHLERP_BATCHED 1
+#endif
+
+// SSE2 unpacking relies on the Intel bitfield layout of FMeshVert.
+#if MESHLERP_BATCHED && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)) && __INTEL_BYTE_ORDER__
+	#define MESHLERP_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define MESHLERP_SSE2 0
+#endif
+
+/*-----------------------------------------------------------------------------
+	Staging.
+-----------------------------------------------------------------------------*/
+
+#if MESHLERP_BATCHED
+
+//
+// A batch of vertices as separate coordinate arrays.
+//
+struct FMeshStage
+{
+	FLOAT X[FMeshLerp::BATCH];
+	FLOAT Y[FMeshLerp::BATCH];
+	FLOAT Z[FMeshLerp::BATCH];
+};
+
+static void UnpackVerts( const FMeshVert* Verts, INT Num, FMeshStage& S )
+{
+	INT i=0;
+#if MESHLERP_SSE2
+	for( ; i+4<=Num; i+=4 )
+	{
+		__m128i D = _mm_loadu_si128( (const __m128i*)&Verts[i] );
+		_mm_storeu_ps( &S.X[i], _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(D,21),21)) );
+		_mm_storeu_ps( &S.Y[i], _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(D,10),21)) );
+		_mm_storeu_ps( &S.Z[i], _mm_cvtepi32_ps(_mm_srai_epi32(D,22)) );
+	}
+#endif
+	for( ; i<Num; i++ )
+	{
+		S.X[i] = Verts[i].X;
+		S.Y[i] = Verts[i].Y;
+		S.Z[i] = Verts[i].Z;
+	}
+}
+
+static void LoadVerts( const FVector* Verts, INT Num, FMeshStage& S )
+{
+	for( INT i=0; i<Num; i++ )
+	{
+		S.X[i] = Verts[i].X;
+		S.Y[i] = Verts[i].Y;
+		S.Z[i] = Verts[i].Z;
+	}
+}
+
+static void StoreVerts( const FMeshStage& S, INT Num, FVector* Verts )
+{
+	for( INT i=0; i<Num; i++ )
+	{
+		Verts[i].X = S.X[i];
+		Verts[i].Y = S.Y[i];
+		Verts[i].Z = S.Z[i];
+	}
+}
+
+//
+// A += (B - A) * Alpha.
+//
+static void LerpVerts( FMeshStage& A, const FMeshStage& B, FLOAT Alpha, INT Num )
+{
+	INT i=0;
+#if MESHLERP_SSE2
+	__m128 Alpha4 = _mm_set1_ps( Alpha );
+	for( ; i+4<=Num; i+=4 )
+	{
+		__m128 AX = _mm_loadu_ps( &A.X[i] );
+		__m128 AY = _mm_loadu_ps( &A.Y[i] );
+		__m128 AZ = _mm_loadu_ps( &A.Z[i] );
+		_mm_storeu_ps( &A.X[i], _mm_add_ps(AX,_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&B.X[i]),AX),Alpha4)) );
+		_mm_storeu_ps( &A.Y[i], _mm_add_ps(AY,_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&B.Y[i]),AY),Alpha4)) );
+		_mm_storeu_ps( &A.Z[i], _mm_add_ps(AZ,_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&B.Z[i]),AZ),Alpha4)) );
+	}
+#endif
+	for( ; i<Num; i++ )
+	{
+		A.X[i] += (B.X[i] - A.X[i]) * Alpha;
+		A.Y[i] += (B.Y[i] - A.Y[i]) * Alpha;
+		A.Z[i] += (B.Z[i] - A.Z[i]) * Alpha;
+	}
+}
+
+//
+// (V - Origin).TransformPointBy(Coords), written Stride bytes apart.
+//
+static void TransformVerts( const FMeshStage& S, INT Num, const FVector& Origin, const FCoords& Coords, FVector* Result, INT Stride )
+{
+	FMeshStage T;
+	INT i=0;
+#if MESHLERP_SSE2
+	__m128 OX  = _mm_set1_ps(Origin.X),        OY  = _mm_set1_ps(Origin.Y),        OZ  = _mm_set1_ps(Origin.Z);
+	__m128 CX  = _mm_set1_ps(Coords.Origin.X), CY  = _mm_set1_ps(Coords.Origin.Y), CZ  = _mm_set1_ps(Coords.Origin.Z);
+	__m128 XX  = _mm_set1_ps(Coords.XAxis.X),  XY  = _mm_set1_ps(Coords.XAxis.Y),  XZ  = _mm_set1_ps(Coords.XAxis.Z);
+	__m128 YX  = _mm_set1_ps(Coords.YAxis.X),  YY  = _mm_set1_ps(Coords.YAxis.Y),  YZ  = _mm_set1_ps(Coords.YAxis.Z);
+	__m128 ZX  = _mm_set1_ps(Coords.ZAxis.X),  ZY  = _mm_set1_ps(Coords.ZAxis.Y),  ZZ  = _mm_set1_ps(Coords.ZAxis.Z);
+	for( ; i+4<=Num; i+=4 )
+	{
+		__m128 PX = _mm_sub_ps( _mm_sub_ps(_mm_loadu_ps(&S.X[i]),OX), CX );
+		__m128 PY = _mm_sub_ps( _mm_sub_ps(_mm_loadu_ps(&S.Y[i]),OY), CY );
+		__m128 PZ = _mm_sub_ps( _mm_sub_ps(_mm_loadu_ps(&S.Z[i]),OZ), CZ );
+		_mm_storeu_ps( &T.X[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(PX,XX),_mm_mul_ps(PY,XY)),_mm_mul_ps(PZ,XZ)) );
+		_mm_storeu_ps( &T.Y[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(PX,YX),_mm_mul_ps(PY,YY)),_mm_mul_ps(PZ,YZ)) );
+		_mm_storeu_ps( &T.Z[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(PX,ZX),_mm_mul_ps(PY,ZY)),_mm_mul_ps(PZ,ZZ)) );
+	}
+#endif
+	for( ; i<Num; i++ )
+	{
+		FVector P = FVector( S.X[i], S.Y[i], S.Z[i] ) - Origin - Coords.Origin;
+		T.X[i] = P | Coords.XAxis;
+		T.Y[i] = P | Coords.YAxis;
+		T.Z[i] = P | Coords.ZAxis;
+	}
+	for( i=0; i<Num; i++ )
+	{
+		Result->X = T.X[i];
+		Result->Y = T.Y[i];
+		Result->Z = T.Z[i];
+		*(BYTE**)&Result += Stride;
+	}
+}
+
+#endif
+
+/*-----------------------------------------------------------------------------
+	FMeshLerp.
+-----------------------------------------------------------------------------*/
+
+void FMeshLerp::Process
+(
+	const FMeshVert*	Verts1,
+	const FMeshVert*	Verts2,
+	FLOAT				Alpha,
+	INT					Num,
+	FVector*			Cached,
+	const FVector&		Origin,
+	const FCoords&		Coords,
+	FVector*			Result,
+	INT					Stride
+)
+{
+	guardSlow(FMeshLerp::Process);
+#if MESHLERP_BATCHED
+	FMeshStage A, B;
+	for( INT Start=0; Start<Num; Start+=BATCH )
+	{
+		INT Count = Min<INT>( BATCH, Num-Start );
+		if( Verts1 )
+			UnpackVerts( Verts1 + Start, Count, A );
+		else
+			LoadVerts( Cached + Start, Count, A );
+		if( Verts2 )
+		{
+			UnpackVerts( Verts2 + Start, Count, B );
+			LerpVerts( A, B, Alpha, Count );
+		}
+		if( Verts1 || Verts2 )
+			StoreVerts( A, Count, Cached + Start );
+		if( Result )
+			TransformVerts( A, Count, Origin, Coords, (FVector*)((BYTE*)Result + Start*Stride), Stride );
+	}
+#else
+	for( INT i=0; i<Num; i++ )
+	{
+		if( Verts1 && Verts2 )
+		{
+			FVector V1( Verts1[i].X, Verts1[i].Y, Verts1[i].Z );
+			FVector V2( Verts2[i].X, Verts2[i].Y, Verts2[i].Z );
+			Cached[i] = V1 + (V2-V1)*Alpha;
+		}
+		else if( Verts1 )
+		{
+			Cached[i] = FVector( Verts1[i].X, Verts1[i].Y, Verts1[i].Z );
+		}
+		else if( Verts2 )
+		{
+			FVector V2( Verts2[i].X, Verts2[i].Y, Verts2[i].Z );
+			Cached[i] += (V2 - Cached[i]) * Alpha;
+		}
+		if( Result )
+		{
+			*Result = (Cached[i] - Origin).TransformPointBy(Coords);
+			*(BYTE**)&Result += Stride;
+		}
+	}
+#endif
+	unguardSlow;
+}
+
+//
+// Time per-vertex and batched interpolation of every loaded mesh.
+//
+void FMeshLerp::Benchmark( FOutputDevice& Ar )
+{
+	guard(FMeshLerp::Benchmark);
+	Ar.Logf( TEXT("Mesh interpolation, %s kernel:"), MESHLERP_SSE2 ? TEXT("SSE2") : MESHLERP_BATCHED ? TEXT("scalar") : TEXT("per vertex") );
+	FVector Origin(0,0,0);
+	FCoords Coords = GMath.UnitCoords * FVector(10,20,30) * FRotator(1000,2000,3000);
+	for( TObjectIterator<UMesh> It; It; ++It )
+	{
+		UMesh* Mesh = *It;
+		Mesh->Verts.Load();
+		if( Mesh->FrameVerts<=0 || Mesh->Verts.Num()<Mesh->FrameVerts )
+			continue;
+		INT              Num    = Mesh->FrameVerts;
+		INT              Reps   = Max( 1, 200000/Num );
+		const FMeshVert* Verts1 = &Mesh->Verts(0);
+		const FMeshVert* Verts2 = &Mesh->Verts( Mesh->Verts.Num()>=2*Num ? Num : 0 );
+		TArray<FVector>  Cached( Num ), Result( Num ), Check( Num );
+
+		// Per vertex, as GetFrame used to.
+		DOUBLE StartTime = appSeconds();
+		for( INT Rep=0; Rep<Reps; Rep++ )
+		{
+			for( INT i=0; i<Num; i++ )
+			{
+				FVector V1( Verts1[i].X, Verts1[i].Y, Verts1[i].Z );
+				FVector V2( Verts2[i].X, Verts2[i].Y, Verts2[i].Z );
+				Cached(i) = V1 + (V2-V1)*0.3f;
+				Check(i)  = (Cached(i) - Origin).TransformPointBy(Coords);
+			}
+		}
+		DOUBLE VertexTime = appSeconds() - StartTime;
+
+		// Batched.
+		StartTime = appSeconds();
+		for( INT Rep=0; Rep<Reps; Rep++ )
+			Lerp( Verts1, Verts2, 0.3f, Num, &Cached(0), Origin, Coords, &Result(0), sizeof(FVector) );
+		DOUBLE BatchTime = appSeconds() - StartTime;
+
+		FLOAT MaxError = 0.f;
+		for( INT i=0; i<Num; i++ )
+			MaxError = Max( MaxError, (Result(i) - Check(i)).Size() );
+		Ar.Logf
+		(
+			TEXT("   %-24s %5i verts: per vertex %6.1f Mverts/sec, batched %6.1f Mverts/sec, max error %f"),
+			Mesh->GetName(),
+			Num,
+			Num * Reps / Max(VertexTime,0.000001) / 1000000.0,
+			Num * Reps / Max(BatchTime, 0.000001) / 1000000.0,
+			MaxError
+		);
+	}
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FMeshAnimLOD.
+-----------------------------------------------------------------------------*/
+
+ENGINE_API FMeshAnimLOD GMeshAnimLOD;
+
+FMeshAnimLOD::FMeshAnimLOD()
+:	Enabled			( 1 )
+,	Distance		( 2048.f )
+,	MaxInterval		( 0.2f )
+,	FrameDecoded	( 0 )
+,	FrameReused		( 0 )
+,	TotalDecoded	( 0.0 )
+,	TotalReused		( 0.0 )
+{}
+
+//
+// Whether a mesh last sampled at SampleTime should be sampled again now.
+//
+UBOOL FMeshAnimLOD::NeedsSample( AActor* Owner, const FVector& ViewLocation, FLOAT SampleTime )
+{
+	guardSlow(FMeshAnimLOD::NeedsSample);
+	if( !Enabled || GIsEditor || !Owner->Level )
+		return 1;
+	FLOAT Dist = (Owner->Location - ViewLocation).Size() / Max( Owner->DrawScale, 0.1f );
+	if( Dist <= Distance )
+		return 1;
+	FLOAT Now      = Owner->Level->TimeSeconds;
+	FLOAT Interval = MaxInterval * Min( Dist/Distance - 1.f, 1.f );
+	return Now-SampleTime >= Interval || Now < SampleTime;
+	unguardSlow;
+}
+
+//
+// ANIMLOD [ON|OFF] [DISTANCE=d] [INTERVAL=s].
+//
+UBOOL FMeshAnimLOD::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
+{
+	guard(FMeshAnimLOD::Exec);
+	if( !ParseCommand(&Cmd,TEXT("ANIMLOD")) )
+		return 0;
+	static DOUBLE LastTime = appSeconds();
+	if( ParseCommand(&Cmd,TEXT("ON")) )
+		Enabled = 1;
+	else if( ParseCommand(&Cmd,TEXT("OFF")) )
+		Enabled = 0;
+	Parse( Cmd, TEXT("DISTANCE="), Distance );
+	Parse( Cmd, TEXT("INTERVAL="), MaxInterval );
+	DOUBLE Time    = appSeconds();
+	DOUBLE Seconds = Max( Time-LastTime, 0.001 );
+	Ar.Logf
+	(
+		TEXT("Animation LOD %s, distance %.0f, interval %.2f: last frame %i verts decoded, %i reused; %.0f decoded and %.0f reused per second"),
+		Enabled ? TEXT("on") : TEXT("off"),
+		Distance,
+		MaxInterval,
+		FrameDecoded,
+		FrameReused,
+		TotalDecoded / Seconds,
+		TotalReused / Seconds
+	);
+	TotalDecoded = TotalReused = 0.0;
+	LastTime     = Time;
+	return 1;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
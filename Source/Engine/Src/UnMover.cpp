@@ -108,6 +108,7 @@ void AMover::SetWorldRaytraceKey()
 		Location = BasePos + KeyPos[WorldRaytraceKey];
 		Rotation = BaseRot + KeyRot[WorldRaytraceKey];
 		if( bCollideActors && GetLevel()->Hash ) GetLevel()->Hash->AddActor( this );
+		if( GetLevel()->Broadphase ) GetLevel()->Broadphase->MoveActor( this );
 		if( GetLevel()->BrushTracker )
 			GetLevel()->BrushTracker->Update( this );
 	}
@@ -127,6 +128,7 @@ void AMover::SetBrushRaytraceKey()
 	Location = BasePos + KeyPos[BrushRaytraceKey];
 	Rotation = BaseRot + KeyRot[BrushRaytraceKey];
 	if( bCollideActors && GetLevel()->Hash ) GetLevel()->Hash->AddActor( this );
+	if( GetLevel()->Broadphase ) GetLevel()->Broadphase->MoveActor( this );
 	if( GetLevel()->BrushTracker )
 		GetLevel()->BrushTracker->Update( this );
 
@@ -142,6 +144,7 @@ void AMover::PostRaytrace()
 	Location = BasePos + KeyPos[KeyNum];
 	Rotation = BaseRot + KeyRot[KeyNum];
 	if( bCollideActors && GetLevel()->Hash ) GetLevel()->Hash->AddActor( this );
+	if( GetLevel()->Broadphase ) GetLevel()->Broadphase->MoveActor( this );
 	SavedPos = FVector(0,0,0);
 	SavedRot = FRotator(0,0,0);
 	if( GetLevel()->BrushTracker )
@@ -0,0 +1,573 @@
+/*=============================================================================
+	UnNavGraph.cpp: Compact navigation graph for route searches.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	FNavGraph building.
+-----------------------------------------------------------------------------*/
+
+FNavGraph::FNavGraph()
+:	FirstNav		( NULL )
+,	NumSpecs		( 0 )
+,	Flow			( NULL )
+,	FlowSeed		( 0 )
+,	Generation		( 0 )
+,	Searcher		( NULL )
+,	bPresetCosts	( 0 )
+,	Goal			( 0, 0, 0 )
+,	GoalSlack		( 0 )
+,	HeuristicScale	( 0.f )
+,	NumSearches		( 0 )
+,	NumExpanded		( 0 )
+,	NumSpecialCosts	( 0 )
+,	NumBuilds		( 0 )
+,	NumFlowHits		( 0 )
+,	NumFlowBuilds	( 0 )
+,	NumFlowExpanded	( 0 )
+{}
+FNavGraph::~FNavGraph()
+{
+	FlushFlows();
+}
+
+//
+// Whether the graph still matches the level's paths.  Paths are only
+// rebuilt in the editor, which changes them while searching.
+//
+UBOOL FNavGraph::IsValid( ULevel* Level ) const
+{
+	return !GIsEditor && FirstNav==Level->GetLevelInfo()->NavigationPointList && NumSpecs==Level->ReachSpecs.Num();
+}
+
+void FNavGraph::Build( ULevel* Level )
+{
+	guard(FNavGraph::Build);
+	Nodes.Empty();
+	InEdges.Empty();
+	OutEdges.Empty();
+	NodeMap.Empty();
+	SpecialNodes.Empty();
+	FlushFlows();
+	FirstNav = Level->GetLevelInfo()->NavigationPointList;
+	NumSpecs = Level->ReachSpecs.Num();
+	NumBuilds++;
+
+	// Number the nodes.
+	for( ANavigationPoint* Nav=FirstNav; Nav; Nav=Nav->nextNavigationPoint )
+	{
+		NodeMap.Set( Nav, Nodes.Num() );
+		FNavNode* Node       = new(Nodes)FNavNode;
+		Node->Nav            = Nav;
+		Node->Location       = Nav->Location;
+		Node->bPlayerOnly    = Nav->bPlayerOnly;
+		Node->bInventorySpot = Nav->IsA(AInventorySpot::StaticClass());
+		if( Nav->bSpecialCost )
+			SpecialNodes.AddItem( Nodes.Num()-1 );
+	}
+
+	// Gather each node's edges, in the order the navigation point lists them.
+	for( INT i=0; i<Nodes.Num(); i++ )
+	{
+		FNavNode&         Node = Nodes(i);
+		ANavigationPoint* Nav  = Node.Nav;
+		Node.FirstIn = InEdges.Num();
+		for( INT j=0; j<16 && Nav->upstreamPaths[j]!=-1; j++ )
+		{
+			if( Nav->upstreamPaths[j]>=NumSpecs )
+				continue;
+			FReachSpec& Spec  = Level->ReachSpecs(Nav->upstreamPaths[j]);
+			INT         Other = FindNode( Spec.Start );
+			if( Other!=INDEX_NONE )
+			{
+				FNavEdge* Edge        = new(InEdges)FNavEdge;
+				Edge->Node            = Other;
+				Edge->Distance        = Spec.distance;
+				Edge->CollisionRadius = Spec.CollisionRadius;
+				Edge->CollisionHeight = Spec.CollisionHeight;
+				Edge->ReachFlags      = Spec.reachFlags;
+			}
+		}
+		Node.NumIn    = InEdges.Num() - Node.FirstIn;
+		Node.FirstOut = OutEdges.Num();
+		for( INT j=0; j<16 && Nav->Paths[j]!=-1; j++ )
+		{
+			if( Nav->Paths[j]>=NumSpecs )
+				continue;
+			FReachSpec& Spec  = Level->ReachSpecs(Nav->Paths[j]);
+			INT         Other = FindNode( Spec.End );
+			if( Other!=INDEX_NONE )
+			{
+				FNavEdge* Edge        = new(OutEdges)FNavEdge;
+				Edge->Node            = Other;
+				Edge->Distance        = Spec.distance;
+				Edge->CollisionRadius = Spec.CollisionRadius;
+				Edge->CollisionHeight = Spec.CollisionHeight;
+				Edge->ReachFlags      = Spec.reachFlags;
+			}
+		}
+		Node.NumOut = OutEdges.Num() - Node.FirstOut;
+	}
+	InEdges.Shrink();
+	OutEdges.Shrink();
+
+	// Scale the straight-line heuristic by the shortest any path is relative
+	// to the distance it spans.  Teleporters and lifts are given short
+	// distances, so on maps with them this approaches zero and searches are
+	// plain Dijkstra.  Slightly scaled down to allow for rounding in the
+	// reach spec distances.
+	HeuristicScale = 1.f;
+	for( INT i=0; i<Nodes.Num(); i++ )
+	{
+		FNavNode& Node = Nodes(i);
+		for( INT e=0; e<Node.NumOut; e++ )
+		{
+			FNavEdge& Edge = OutEdges(Node.FirstOut + e);
+			FLOAT     Span = FDist( Node.Location, Nodes(Edge.Node).Location );
+			if( Span>1.f )
+				HeuristicScale = Min( HeuristicScale, Max(Edge.Distance,0) / Span );
+		}
+	}
+	HeuristicScale *= 0.98f;
+
+	// Reset search state.
+	INT Num = Nodes.Num();
+	Generation = 0;
+	Visited  .Empty( Num ); Visited  .AddZeroed( Num );
+	Closed   .Empty( Num ); Closed   .AddZeroed( Num );
+	Weight   .Empty( Num ); Weight   .AddZeroed( Num );
+	Previous .Empty( Num ); Previous .AddZeroed( Num );
+	StartNode.Empty( Num ); StartNode.AddZeroed( Num );
+	CostStamp.Empty( Num ); CostStamp.AddZeroed( Num );
+	Cost     .Empty( Num ); Cost     .AddZeroed( Num );
+	EndStamp .Empty( Num ); EndStamp .AddZeroed( Num );
+	EndWeight.Empty( Num ); EndWeight.AddZeroed( Num );
+	Open.Empty( Num );
+
+	debugf( NAME_DevPath, TEXT("Built navigation graph: %i nodes, %i edges"), Nodes.Num(), InEdges.Num() );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FNavGraph search state.
+-----------------------------------------------------------------------------*/
+
+//
+// Start a new search, forgetting everything about the previous one.  If
+// bClearPaths is false, costs are taken from the navigation points, where
+// script may have preset them after ClearPaths.
+//
+void FNavGraph::BeginSearch( APawn* InSearcher, UBOOL bClearPaths )
+{
+	guardSlow(FNavGraph::BeginSearch);
+	if( ++Generation==0 )
+	{
+		// Wrapped; stamps from four billion searches ago would look current.
+		for( INT i=0; i<Nodes.Num(); i++ )
+			Visited(i) = Closed(i) = CostStamp(i) = EndStamp(i) = 0;
+		Generation = 1;
+	}
+	Searcher     = InSearcher;
+	bPresetCosts = !bClearPaths;
+	Goal         = InSearcher->Location;
+	GoalSlack    = 0;
+	Flow         = NULL;
+	FlowSeed     = 0;
+	Open.Empty( Open.Num() );
+	EndPoints.Empty( EndPoints.Num() );
+	CostOverrides.Empty( CostOverrides.Num() );
+	NumSearches++;
+	unguardSlow;
+}
+
+//
+// Cost of routing through a node, evaluated on first use in each search.
+//
+INT FNavGraph::GetCost( INT i )
+{
+	guardSlow(FNavGraph::GetCost);
+	if( CostStamp(i)!=Generation )
+	{
+		ANavigationPoint* Nav = Nodes(i).Nav;
+		CostStamp(i) = Generation;
+		if( bPresetCosts )
+			Cost(i) = Nav->cost;
+		else if( Nav->bSpecialCost )
+		{
+			Cost(i) = Nav->eventSpecialCost( Searcher );
+			NumSpecialCosts++;
+		}
+		else Cost(i) = Nav->ExtraCost;
+	}
+	return Cost(i);
+	unguardSlow;
+}
+
+void FNavGraph::MarkEndPoint( INT i, INT InWeight )
+{
+	guardSlow(FNavGraph::MarkEndPoint);
+	if( EndStamp(i)!=Generation )
+		EndPoints.AddItem( i );
+	EndStamp (i) = Generation;
+	EndWeight(i) = InWeight;
+	GoalSlack    = Max( GoalSlack, appCeil( FDist(Nodes(i).Location, Goal) ) );
+	unguardSlow;
+}
+
+//
+// Lower bound on the weight from a node to the nearest end point.  No path
+// is shorter than HeuristicScale times the distance it spans, node costs
+// are never negative, and every end point is within GoalSlack of Goal.  The
+// bound is also consistent, so closed nodes never need reopening.
+//
+INT FNavGraph::Heuristic( INT i ) const
+{
+	return appFloor( HeuristicScale * Max(FDist(Nodes(i).Location, Goal) - GoalSlack, 0.f) );
+}
+
+/*-----------------------------------------------------------------------------
+	FNavGraph open list.
+-----------------------------------------------------------------------------*/
+
+//
+// Nodes aren't moved when their weight improves; they are pushed again and
+// the stale entry is skipped when popped.
+//
+void FNavGraph::PushOpen( INT Key, INT Node )
+{
+	guardSlow(FNavGraph::PushOpen);
+	INT i = Open.Add();
+	while( i>0 )
+	{
+		INT Parent = (i-1)/2;
+		if( Open(Parent).Key<=Key )
+			break;
+		Open(i) = Open(Parent);
+		i       = Parent;
+	}
+	Open(i).Key  = Key;
+	Open(i).Node = Node;
+	unguardSlow;
+}
+
+//
+// Remove and return the node with the lowest key, or INDEX_NONE if empty.
+//
+INT FNavGraph::PopOpen()
+{
+	guardSlow(FNavGraph::PopOpen);
+	if( !Open.Num() )
+		return INDEX_NONE;
+	INT      Result = Open(0).Node;
+	FNavOpen Last   = Open(Open.Num()-1);
+	Open.Remove( Open.Num()-1 );
+	INT Num = Open.Num(), i = 0;
+	if( Num )
+	{
+		for( ; ; )
+		{
+			INT Child = 2*i+1;
+			if( Child>=Num )
+				break;
+			if( Child+1<Num && Open(Child+1).Key<Open(Child).Key )
+				Child++;
+			if( Last.Key<=Open(Child).Key )
+				break;
+			Open(i) = Open(Child);
+			i       = Child;
+		}
+		Open(i) = Last;
+	}
+	return Result;
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	FNavGraph flow fields.
+-----------------------------------------------------------------------------*/
+
+//
+// SpecialCost of a special node as the current searcher sees it, ignoring
+// any cost set for this search only.
+//
+INT FNavGraph::GetFlowSpecialCost( INT i )
+{
+	guardSlow(FNavGraph::GetFlowSpecialCost);
+	if( CostOverrides.FindItemIndex(i)==INDEX_NONE )
+		return GetCost( i );
+	NumSpecialCosts++;
+	return Nodes(i).Nav->eventSpecialCost( Searcher );
+	unguardSlow;
+}
+
+//
+// Find the flow field toward a goal node for the current searcher, or build
+// one if a search toward the same goal was made within NAV_FLOW_LIFETIME.
+// Fields are matched on the searcher's size and movement, then on the
+// current SpecialCost of each special node, compared one at a time so a
+// mismatch stops evaluating the rest; a door or lift changing state gives a
+// new field.  Other costs are trusted for NAV_FLOW_LIFETIME seconds.
+//
+FNavFlowField* FNavGraph::GetFlowField( INT GoalNode, INT iRadius, INT iHeight, INT MoveFlags, DOUBLE Time )
+{
+	guard(FNavGraph::GetFlowField);
+	if( GIsEditor || GoalNode==INDEX_NONE )
+		return NULL;
+
+	// Find a matching field, or the least recently used one to replace.
+	UBOOL bPlayer = Searcher->bIsPlayer;
+	FNavFlowField* Field = NULL;
+	INT f, i;
+	for( f=0; f<Flows.Num(); f++ )
+	{
+		FNavFlowField* Other = Flows(f);
+		if
+		(	Other->Goal==GoalNode
+		&&	Other->Radius==iRadius
+		&&	Other->Height==iHeight
+		&&	Other->MoveFlags==MoveFlags
+		&&	Other->bPlayer==bPlayer
+		&&	Time>=Other->Time
+		&&	Time-Other->Time<=NAV_FLOW_LIFETIME )
+		{
+			for( i=0; i<SpecialNodes.Num(); i++ )
+				if( GetFlowSpecialCost(SpecialNodes(i))!=Other->SpecialCosts(i) )
+					break;
+			if( i==SpecialNodes.Num() )
+			{
+				Other->LastUsed = Time;
+				NumFlowHits++;
+				return Other;
+			}
+		}
+		if( !Field || Other->LastUsed<Field->LastUsed )
+			Field = Other;
+	}
+
+	// Only build a field for a goal that was searched for recently.
+	FNavFlowRequest* Request   = NULL;
+	UBOOL            bRepeated = 0;
+	for( f=0; f<FlowRequests.Num() && !bRepeated; f++ )
+	{
+		FNavFlowRequest& Other = FlowRequests(f);
+		if
+		(	Other.Goal==GoalNode
+		&&	Other.Radius==iRadius
+		&&	Other.Height==iHeight
+		&&	Other.MoveFlags==MoveFlags
+		&&	Other.bPlayer==bPlayer
+		&&	Time>=Other.Time
+		&&	Time-Other.Time<=NAV_FLOW_LIFETIME )
+		{
+			FlowRequests.Remove( f );
+			bRepeated = 1;
+		}
+		else if( !Request || Other.Time<Request->Time )
+			Request = &Other;
+	}
+	if( !bRepeated )
+	{
+		if( FlowRequests.Num()<NAV_MAX_FLOWS )
+			Request = &FlowRequests(FlowRequests.Add());
+		Request->Goal      = GoalNode;
+		Request->Radius    = iRadius;
+		Request->Height    = iHeight;
+		Request->MoveFlags = MoveFlags;
+		Request->bPlayer   = bPlayer;
+		Request->Time      = Time;
+		return NULL;
+	}
+
+	if( Flows.Num()<NAV_MAX_FLOWS )
+		Flows.AddItem( Field = new FNavFlowField );
+	Field->Goal      = GoalNode;
+	Field->Radius    = iRadius;
+	Field->Height    = iHeight;
+	Field->MoveFlags = MoveFlags;
+	Field->bPlayer   = bPlayer;
+	BuildFlowField( Field, Time );
+	return Field;
+	unguard;
+}
+
+//
+// Search out from a field's goal over every node.  Its expansions are
+// counted apart from those of route searches.
+//
+void FNavGraph::BuildFlowField( FNavFlowField* Field, DOUBLE Time )
+{
+	guard(FNavGraph::BuildFlowField);
+	INT Num = Nodes.Num(), i;
+	Field->SpecialCosts.Empty( SpecialNodes.Num() );
+	Field->SpecialCosts.Add( SpecialNodes.Num() );
+	for( i=0; i<SpecialNodes.Num(); i++ )
+		Field->SpecialCosts(i) = GetFlowSpecialCost( SpecialNodes(i) );
+	Field->Time     = Time;
+	Field->LastUsed = Time;
+	NumFlowBuilds++;
+
+	TArray<INT>  NodeCost( Num );
+	TArray<BYTE> Done( Num );
+	Field->Weight.Empty( Num ); Field->Weight.Add( Num );
+	Field->Next  .Empty( Num ); Field->Next  .Add( Num );
+	for( i=0; i<Num; i++ )
+	{
+		NodeCost     (i) = Nodes(i).Nav->ExtraCost;
+		Done         (i) = 0;
+		Field->Weight(i) = NAV_UNVISITED;
+		Field->Next  (i) = INDEX_NONE;
+	}
+	for( i=0; i<SpecialNodes.Num(); i++ )
+		NodeCost(SpecialNodes(i)) = Field->SpecialCosts(i);
+
+	Open.Empty( Open.Num() );
+	Field->Weight(Field->Goal) = 0;
+	PushOpen( 0, Field->Goal );
+	INT Current;
+	while( (Current=PopOpen())!=INDEX_NONE )
+	{
+		if( Done(Current) )
+			continue;
+		Done(Current) = 1;
+		NumFlowExpanded++;
+		FNavNode& Node = Nodes(Current);
+		if( Node.bPlayerOnly && !Field->bPlayer && Current!=Field->Goal )
+			continue;
+		for( INT e=0; e<Node.NumIn; e++ )
+		{
+			FNavEdge& Edge = InEdges(Node.FirstIn + e);
+			if( Edge.Supports(Field->Radius, Field->Height, Field->MoveFlags) )
+			{
+				INT NewWeight = Field->Weight(Current) + Edge.Distance + NodeCost(Edge.Node);
+				if( NewWeight<Field->Weight(Edge.Node) )
+				{
+					Field->Weight(Edge.Node) = NewWeight;
+					Field->Next  (Edge.Node) = Current;
+					PushOpen( NewWeight, Edge.Node );
+				}
+			}
+		}
+	}
+	unguard;
+}
+
+//
+// Pick the end point the current search would have found, from a flow field
+// whose goal has weight Seed.  Returns INDEX_NONE if the field can't answer
+// for this search, because its route crosses a node whose cost was set for
+// this search only or another end point.
+//
+INT FNavGraph::FindFlowEndPoint( FNavFlowField* Field, INT Seed )
+{
+	guard(FNavGraph::FindFlowEndPoint);
+	if( !Field )
+		return INDEX_NONE;
+	INT Best=INDEX_NONE, BestWeight=0;
+	for( INT i=0; i<EndPoints.Num(); i++ )
+	{
+		INT End = EndPoints(i);
+		if( Field->Weight(End)!=NAV_UNVISITED && (Best==INDEX_NONE || Field->Weight(End)+EndWeight(End)<BestWeight) )
+		{
+			Best       = End;
+			BestWeight = Field->Weight(End) + EndWeight(End);
+		}
+	}
+	if( Best==INDEX_NONE || CostOverrides.FindItemIndex(Best)!=INDEX_NONE )
+		return INDEX_NONE;
+	for( INT Node=Field->Next(Best), n=0; Node!=INDEX_NONE && n<Nodes.Num(); Node=Field->Next(Node), n++ )
+		if( IsEndPoint(Node) || CostOverrides.FindItemIndex(Node)!=INDEX_NONE )
+			return INDEX_NONE;
+
+	Flow     = Field;
+	FlowSeed = Seed;
+	SetWeight( Best, Seed + BestWeight, Field->Next(Best) );
+	return Best;
+	unguard;
+}
+
+void FNavGraph::FlushFlows()
+{
+	guard(FNavGraph::FlushFlows);
+	for( INT i=0; i<Flows.Num(); i++ )
+		delete Flows(i);
+	Flows.Empty();
+	FlowRequests.Empty();
+	Flow = NULL;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	FNavGraph results.
+-----------------------------------------------------------------------------*/
+
+//
+// Copy the route from a node through its Previous links into the
+// navigation points' previousPath and visitedWeight, for the route cache.
+// Nodes the search didn't reach itself are taken from its flow field.
+//
+void FNavGraph::LinkRoute( INT i )
+{
+	guard(FNavGraph::LinkRoute);
+	for( INT n=0; i!=INDEX_NONE && n<Nodes.Num(); n++ )
+	{
+		if( Visited(i)!=Generation && Flow && Flow->Weight(i)!=NAV_UNVISITED )
+			SetWeight( i, FlowSeed + Flow->Weight(i), Flow->Next(i) );
+		ANavigationPoint* Nav = Nodes(i).Nav;
+		Nav->visitedWeight = GetWeight( i );
+		if( Visited(i)!=Generation )
+		{
+			Nav->previousPath = NULL;
+			break;
+		}
+		Nav->previousPath = Previous(i)!=INDEX_NONE ? Nodes(Previous(i)).Nav : NULL;
+		i = Previous(i);
+	}
+	unguard;
+}
+
+//
+// Same, but linking the route from its first node toward i, for routes found
+// by searching forward.
+//
+void FNavGraph::LinkRouteReversed( INT i )
+{
+	guard(FNavGraph::LinkRouteReversed);
+	ANavigationPoint* Next = NULL;
+	for( INT n=0; i!=INDEX_NONE && n<Nodes.Num(); n++ )
+	{
+		ANavigationPoint* Nav = Nodes(i).Nav;
+		Nav->visitedWeight = GetWeight( i );
+		Nav->previousPath  = Next;
+		Next = Nav;
+		if( Visited(i)!=Generation )
+			break;
+		i = Previous(i);
+	}
+	unguard;
+}
+
+FString FNavGraph::Describe() const
+{
+	guard(FNavGraph::Describe);
+	return FString::Printf
+	(
+		TEXT("%i nodes, %i edges, heuristic scale %.2f, built %i times, %i searches, %.1f nodes expanded per search, %i SpecialCost calls, %i flow field hits, %i flow fields built, %i nodes expanded building them"),
+		Nodes.Num(),
+		InEdges.Num(),
+		HeuristicScale,
+		NumBuilds,
+		NumSearches,
+		NumSearches ? (FLOAT)NumExpanded / NumSearches : 0.f,
+		NumSpecialCosts,
+		NumFlowHits,
+		NumFlowBuilds,
+		NumFlowExpanded
+	);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
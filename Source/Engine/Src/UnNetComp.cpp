@@ -0,0 +1,344 @@
+/*=============================================================================
+	UnNetComp.cpp: Static-model packet compression.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+#include "UnNet.h"
+
+// Model file signature.
+#define NETMODEL_TAG 0x4C444D4E
+
+ENGINE_API FNetPacketModel GNetPacketModel;
+
+/*-----------------------------------------------------------------------------
+	FNetPacketModel.
+-----------------------------------------------------------------------------*/
+
+FNetPacketModel::FNetPacketModel()
+:	Loaded		( 0 )
+,	Checksum	( 0 )
+{}
+
+//
+// Build the code from byte frequencies.  Every byte value gets a code, and
+// frequencies are flattened until no code is longer than NETMODEL_MAX_BITS.
+//
+void FNetPacketModel::Build( const DWORD* Counts )
+{
+	guard(FNetPacketModel::Build);
+	INT i, n, L;
+
+	// Smooth and scale frequencies so the tree weights can't overflow.
+	DWORD Freq[256];
+	for( i=0; i<256; i++ )
+		Freq[i] = Clamp<DWORD>( Counts[i], 1, 0xFFFFFF );
+
+	for( ; ; )
+	{
+		// Build the Huffman tree bottom-up; nodes 256..510 are internal.
+		DWORD Weight[511];
+		INT   Parent[511];
+		UBOOL Used[511];
+		for( i=0; i<256; i++ )
+		{
+			Weight[i] = Freq[i];
+			Parent[i] = -1;
+			Used  [i] = 0;
+		}
+		for( n=256; n<511; n++ )
+		{
+			INT A=-1, B=-1;
+			for( i=0; i<n; i++ )
+			{
+				if( Used[i] )
+					continue;
+				if( A<0 || Weight[i]<Weight[A] )
+					{B = A; A = i;}
+				else if( B<0 || Weight[i]<Weight[B] )
+					B = i;
+			}
+			Used  [A] = Used[B] = 1;
+			Parent[A] = Parent[B] = n;
+			Weight[n] = Weight[A] + Weight[B];
+			Parent[n] = -1;
+			Used  [n] = 0;
+		}
+
+		// Code lengths are leaf depths.
+		INT MaxLen = 0;
+		for( i=0; i<256; i++ )
+		{
+			for( L=0, n=i; Parent[n]>=0; n=Parent[n] )
+				L++;
+			Len[i] = L;
+			MaxLen = Max( MaxLen, L );
+		}
+		if( MaxLen<=NETMODEL_MAX_BITS )
+			break;
+		for( i=0; i<256; i++ )
+			Freq[i] = (Freq[i]+1)/2;
+	}
+
+	// Assign canonical codes.
+	appMemzero( Count, sizeof(Count) );
+	for( i=0; i<256; i++ )
+		Count[Len[i]]++;
+	INT Code=0, Index=0;
+	Count[0] = 0;
+	for( L=1; L<=NETMODEL_MAX_BITS; L++ )
+	{
+		Code      = (Code + Count[L-1]) << 1;
+		First [L] = Code;
+		Offset[L] = Index;
+		for( i=0; i<256; i++ )
+		{
+			if( Len[i]==L )
+			{
+				DWORD C = First[L] + Index - Offset[L], R = 0;
+				for( n=0; n<L; n++ )
+					R = (R << 1) | ((C >> n) & 1);
+				RevCode[i]       = R;
+				Symbols[Index++] = i;
+			}
+		}
+	}
+	check(Index==256);
+	Checksum = appMemCrc( Len, sizeof(Len) );
+	Loaded   = 1;
+
+	unguard;
+}
+
+//
+// Load a model file written by the NetModel commandlet.
+//
+UBOOL FNetPacketModel::Load( const TCHAR* Filename )
+{
+	guard(FNetPacketModel::Load);
+	FArchive* Ar = GFileManager->CreateFileReader( Filename );
+	if( !Ar )
+	{
+		debugf( NAME_DevNet, TEXT("Packet model %s not found"), Filename );
+		return 0;
+	}
+	DWORD Tag=0, Counts[256];
+	*Ar << Tag;
+	for( INT i=0; i<256; i++ )
+		*Ar << Counts[i];
+	UBOOL Ok = Tag==NETMODEL_TAG && !Ar->IsError();
+	delete Ar;
+	if( !Ok )
+	{
+		debugf( NAME_DevNet, TEXT("Packet model %s is invalid"), Filename );
+		return 0;
+	}
+	Build( Counts );
+	debugf( NAME_DevNet, TEXT("Loaded packet model %s (%08X)"), Filename, Checksum );
+	return 1;
+	unguard;
+}
+UBOOL FNetPacketModel::Save( const TCHAR* Filename, const DWORD* Counts )
+{
+	guard(FNetPacketModel::Save);
+	FArchive* Ar = GFileManager->CreateFileWriter( Filename );
+	if( !Ar )
+		return 0;
+	DWORD Tag=NETMODEL_TAG;
+	*Ar << Tag;
+	for( INT i=0; i<256; i++ )
+	{
+		DWORD Count = Counts[i];
+		*Ar << Count;
+	}
+	UBOOL Ok = !Ar->IsError();
+	delete Ar;
+	return Ok;
+	unguard;
+}
+
+//
+// Compress a raw packet into Out, which must hold InCount bytes.  Returns the
+// compressed size, or 0 if compression wouldn't save anything.
+//
+INT FNetPacketModel::Encode( const BYTE* In, INT InCount, BYTE* Out )
+{
+	guardSlow(FNetPacketModel::Encode);
+	if( InCount>NETMODEL_MAX_PACKET )
+		return 0;
+
+	// Fast path: size it up before doing any work.
+	INT Bits=0, i;
+	for( i=0; i<InCount; i++ )
+		Bits += Len[In[i]];
+	INT OutCount = (Bits+8)/8 + 1;
+	if( OutCount>=InCount )
+		return 0;
+
+	// Pack codes, first bit lowest, matching FBitWriter.
+	DWORD Acc=0;
+	INT   AccBits=0;
+	BYTE* P=Out;
+	for( i=0; i<InCount; i++ )
+	{
+		Acc     |= RevCode[In[i]] << AccBits;
+		AccBits += Len[In[i]];
+		while( AccBits>=8 )
+		{
+			*P++      = (BYTE)Acc;
+			Acc     >>= 8;
+			AccBits  -= 8;
+		}
+	}
+
+	// Trailing 1 bit, then the zero byte marking a compressed packet.
+	Acc |= 1 << AccBits;
+	*P++ = (BYTE)Acc;
+	*P++ = 0;
+	checkSlow(P-Out==OutCount);
+	return OutCount;
+	unguardSlow;
+}
+
+//
+// Decompress a packet.  Returns the raw size, or -1 if it is malformed.
+//
+INT FNetPacketModel::Decode( const BYTE* In, INT InCount, BYTE* Out, INT MaxOut )
+{
+	guardSlow(FNetPacketModel::Decode);
+	if( InCount<2 || In[InCount-1]!=0 || In[InCount-2]==0 )
+		return -1;
+
+	// Find the trailing bit.
+	BYTE LastByte = In[InCount-2];
+	INT  BitSize  = (InCount-1)*8-1;
+	while( !(LastByte & 0x80) )
+	{
+		LastByte *= 2;
+		BitSize--;
+	}
+
+	// Decode canonically, one bit at a time.
+	INT Pos=0, OutCount=0;
+	while( Pos<BitSize )
+	{
+		INT Code=0;
+		for( INT L=1; ; L++ )
+		{
+			if( L>NETMODEL_MAX_BITS || Pos>=BitSize )
+				return -1;
+			Code = (Code << 1) | ((In[Pos>>3] >> (Pos&7)) & 1);
+			Pos++;
+			if( Code>=First[L] && Code-First[L]<Count[L] )
+			{
+				if( OutCount>=MaxOut )
+					return -1;
+				Out[OutCount++] = Symbols[Offset[L] + Code - First[L]];
+				break;
+			}
+		}
+	}
+	return OutCount;
+	unguardSlow;
+}
+
+/*-----------------------------------------------------------------------------
+	UNetModelCommandlet.
+-----------------------------------------------------------------------------*/
+
+//
+// Trains a packet model from recorded demos:
+// ucc Engine.NetModel OUT=NetModel.bin Demo1.dem [Demo2.dem...]
+//
+class UNetModelCommandlet : public UCommandlet
+{
+	DECLARE_CLASS(UNetModelCommandlet,UCommandlet,CLASS_Transient);
+	void StaticConstructor()
+	{
+		guard(UNetModelCommandlet::StaticConstructor);
+
+		LogToStdout = 1;
+		IsClient    = 0;
+		IsEditor    = 0;
+		IsServer    = 0;
+		LazyLoad    = 1;
+
+		unguard;
+	}
+	INT Main( const TCHAR* Parms )
+	{
+		guard(UNetModelCommandlet::Main);
+		FString OutFile = TEXT("NetModel.bin");
+		Parse( Parms, TEXT("OUT="), OutFile );
+
+		DWORD Counts[256];
+		appMemzero( Counts, sizeof(Counts) );
+		INT NumPackets=0, NumBytes=0, NumFiles=0;
+		FString Token;
+		while( ParseToken(Parms,Token,0) )
+		{
+			if( Token.Left(4)==TEXT("OUT=") )
+				continue;
+			FArchive* Ar = GFileManager->CreateFileReader( *Token );
+			if( !Ar )
+			{
+				GWarn->Logf( TEXT("Can't open %s"), *Token );
+				continue;
+			}
+
+			// Count byte frequencies over every recorded packet.
+			TArray<FDemoKeyframe> Keyframes;
+			INT  Version;
+			INT  End = UDemoRecDriver::ReadIndex( *Ar, Keyframes, Version );
+			BYTE Data[NETMODEL_MAX_PACKET];
+			while( Ar->Tell()<End && !Ar->IsError() )
+			{
+				INT    FrameNum, Count;
+				DOUBLE Time;
+				*Ar << FrameNum << Time << Count;
+				if( Count==DEMO_KEYFRAME && Version )
+				{
+					FDemoKeyframeState State;
+					*Ar << State;
+					continue;
+				}
+				if( Count<0 || Count>NETMODEL_MAX_PACKET )
+					break;
+				Ar->Serialize( Data, Count );
+				if( Ar->IsError() )
+					break;
+				for( INT i=0; i<Count; i++ )
+					Counts[Data[i]]++;
+				NumPackets++;
+				NumBytes += Count;
+			}
+			delete Ar;
+			NumFiles++;
+		}
+		if( !NumBytes )
+		{
+			GWarn->Logf( TEXT("No packets found") );
+			return 1;
+		}
+
+		// Build it and measure how well it does on the training set.
+		FNetPacketModel Model;
+		Model.Build( Counts );
+		DOUBLE Bits=0;
+		for( INT i=0; i<256; i++ )
+			Bits += (DOUBLE)Counts[i] * Model.Len[i];
+		if( !FNetPacketModel::Save( *OutFile, Counts ) )
+		{
+			GWarn->Logf( TEXT("Can't write %s"), *OutFile );
+			return 1;
+		}
+		GWarn->Logf( TEXT("Trained %s (%08X) on %i packets, %i bytes from %i demos: %.1f%% of original size"), *OutFile, Model.Checksum, NumPackets, NumBytes, NumFiles, 100.0 * Bits / 8 / NumBytes );
+		return 0;
+		unguard;
+	}
+};
+IMPLEMENT_CLASS(UNetModelCommandlet)
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
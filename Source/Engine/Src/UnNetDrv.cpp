@@ -114,6 +114,7 @@ UNetDriver::UNetDriver()
 	RemoteRoleProperty = FindObjectChecked<UProperty>( AActor::StaticClass(), TEXT("RemoteRole") );
 	MasterMap          = new UPackageMap;
 	ProfileStats	   = ParseParam(appCmdLine(),TEXT("profilestats"));
+	Parse( appCmdLine(), TEXT("NETTHREADS="), NetThreads );
 	unguard;
 }
 void UNetDriver::StaticConstructor()
@@ -131,9 +132,18 @@ void UNetDriver::StaticConstructor()
 	new(GetClass(),TEXT("NetServerMaxTickRate"), RF_Public)UIntProperty  (CPP_PROPERTY(NetServerMaxTickRate ), TEXT("Client"), CPF_Config );
 	new(GetClass(),TEXT("LanServerMaxTickRate"), RF_Public)UIntProperty  (CPP_PROPERTY(LanServerMaxTickRate ), TEXT("Client"), CPF_Config );
 	new(GetClass(),TEXT("AllowDownloads"),       RF_Public)UBoolProperty (CPP_PROPERTY(AllowDownloads       ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("CompressPackets"),      RF_Public)UBoolProperty (CPP_PROPERTY(CompressPackets      ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("PacketModel"),          RF_Public)UStrProperty  (CPP_PROPERTY(PacketModel          ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("CompressDownloads"),    RF_Public)UBoolProperty (CPP_PROPERTY(CompressDownloads    ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("MaxDownloadRate"),      RF_Public)UIntProperty  (CPP_PROPERTY(MaxDownloadRate      ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("NetThreads"),           RF_Public)UIntProperty  (CPP_PROPERTY(NetThreads           ), TEXT("Client"), CPF_Config );
+	new(GetClass(),TEXT("AdaptiveRate"),         RF_Public)UBoolProperty (CPP_PROPERTY(AdaptiveRate         ), TEXT("Client"), CPF_Config );
 
 	// Default values.
-	MaxClientRate = 25000;
+	MaxClientRate     = 25000;
+	CompressDownloads = 1;
+	NetThreads        = 0;
+	AdaptiveRate      = 1;
 
 	unguard;
 }
@@ -158,6 +168,8 @@ UBOOL UNetDriver::InitConnect( FNetworkNotify* InNotify, FURL& URL, FString& Err
 {
 	guard(UNetDriver::Init);
 	Notify = InNotify;
+	if( CompressPackets && !GNetPacketModel.Loaded )
+		CompressPackets = GNetPacketModel.Load( *PacketModel );
 	return 1;
 	unguard;
 }
@@ -165,6 +177,8 @@ UBOOL UNetDriver::InitListen( FNetworkNotify* InNotify, FURL& URL, FString& Erro
 {
 	guard(UNetDriver::Init);
 	Notify = InNotify;
+	if( CompressPackets && !GNetPacketModel.Loaded )
+		CompressPackets = GNetPacketModel.Load( *PacketModel );
 	return 1;
 	unguard;
 }
@@ -176,6 +190,14 @@ void UNetDriver::TickDispatch( FLOAT DeltaTime )
 	// Get new time.
 	Time += DeltaTime;
 
+	// Refill the download budget and split it among last tick's downloads.
+	if( MaxDownloadRate>0 )
+	{
+		DownloadAllowance = Min( DownloadAllowance + DeltaTime*MaxDownloadRate, 0.1f*MaxDownloadRate );
+		DownloadShare     = DownloadAllowance / Max(NumDownloads,1);
+	}
+	NumDownloads = 0;
+
 	// Delete any straggler connections.
 	if( !ServerConnection )
 		for( INT i=ClientConnections.Num()-1; i>=0; i-- )
@@ -210,6 +232,16 @@ void UNetDriver::Destroy()
 		delete ClientConnections( 0 );
 	unguard;
 
+	// Delete shared replication state.
+	for( TMap<AActor*,FRepSnapshot*>::TIterator It(RepSnapshots); It; ++It )
+		delete It.Value();
+	RepSnapshots.Empty();
+
+	// Stop packet assembly threads.
+	if( Workers )
+		delete Workers;
+	Workers = NULL;
+
 	// Low level destroy.
 	LowLevelDestroy();
 
@@ -241,12 +273,77 @@ UBOOL UNetDriver::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
 		}
 		return 1;
 	}
+	else if( ParseCommand(&Cmd,TEXT("NETCOMPRESS")) )
+	{
+		// Print compression ratio of each connection.
+		Ar.Logf( TEXT("Packet model: %s"), GNetPacketModel.Loaded ? *FString::Printf(TEXT("%s (%08X)"),*PacketModel,GNetPacketModel.Checksum) : TEXT("none") );
+		if( ServerConnection )
+			Ar.Logf( TEXT("   Server %s"), *ServerConnection->DescribeCompression() );
+		for( INT i=0; i<ClientConnections.Num(); i++ )
+			Ar.Logf( TEXT("   Client %s: %s"), *ClientConnections(i)->LowLevelGetRemoteAddress(), *ClientConnections(i)->DescribeCompression() );
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("DOWNLOADS")) )
+	{
+		// Print progress of each file being sent or received.
+		Ar.Logf( TEXT("Downloads: limit %s"), MaxDownloadRate>0 ? *FString::Printf(TEXT("%i bytes/sec"),MaxDownloadRate) : TEXT("none") );
+		TArray<UNetConnection*> Connections = ClientConnections;
+		if( ServerConnection )
+			Connections.AddItem( ServerConnection );
+		for( INT i=0; i<Connections.Num(); i++ )
+			for( INT j=0; j<Connections(i)->OpenChannels.Num(); j++ )
+				if( Connections(i)->OpenChannels(j)->ChType==CHTYPE_File )
+					Ar.Logf( TEXT("   %s: %s"), *Connections(i)->LowLevelGetRemoteAddress(), *Connections(i)->OpenChannels(j)->Describe() );
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("NETTHREADS")) )
+	{
+		// Show or change the number of packet assembly threads: 0 for none, -1 for one per extra processor.
+		if( *Cmd )
+		{
+			NetThreads = appAtoi( Cmd );
+			if( Workers )
+				delete Workers;
+			Workers = NULL;
+		}
+		Ar.Logf( TEXT("Net threads: %i"), GetWorkers()->NumThreads() );
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("NETRATE")) )
+	{
+		// NETRATE [ON|OFF|RESET]: show adaptive rate control of each connection,
+		// switch it against the fixed CurrentNetSpeed budget, or restart the stats.
+		TArray<UNetConnection*> Connections = ClientConnections;
+		if( ServerConnection )
+			Connections.AddItem( ServerConnection );
+		if( ParseCommand(&Cmd,TEXT("ON")) )
+			AdaptiveRate = 1;
+		else if( ParseCommand(&Cmd,TEXT("OFF")) )
+			AdaptiveRate = 0;
+		if( ParseCommand(&Cmd,TEXT("RESET")) )
+			for( INT i=0; i<Connections.Num(); i++ )
+				Connections(i)->RateControl.Reset();
+		Ar.Logf( TEXT("Rate control: %s"), AdaptiveRate ? TEXT("adaptive") : TEXT("fixed") );
+		for( INT i=0; i<Connections.Num(); i++ )
+			Ar.Logf( TEXT("   %s: %s"), *Connections(i)->LowLevelGetRemoteAddress(), *Connections(i)->RateControl.Describe(Connections(i)->CurrentNetSpeed) );
+		return 1;
+	}
+	else if( Notify && Notify->NotifyGetLevel() && GNetLoad.Exec(Notify->NotifyGetLevel(),Cmd,Ar) )
+	{
+		return 1;
+	}
 	else return 0;
 	unguard;
 }
 void UNetDriver::NotifyActorDestroyed( AActor* ThisActor )
 {
 	guard(UNetDriver::NotifyActorDestroyed);
+	FRepSnapshot* Snapshot = RepSnapshots.FindRef(ThisActor);
+	if( Snapshot )
+	{
+		RepSnapshots.Remove( ThisActor );
+		delete Snapshot;
+	}
 	for( INT i=ClientConnections.Num()-1; i>=0; i-- )
 	{
 		UNetConnection* Connection = ClientConnections(i);
@@ -261,6 +358,41 @@ void UNetDriver::NotifyActorDestroyed( AActor* ThisActor )
 	}
 	unguard;
 }
+
+//
+// Get the replication state shared by the channels replicating an actor
+// this tick, or NULL if only one channel is expected to.
+//
+FRepSnapshot* UNetDriver::GetRepSnapshot( AActor* Actor )
+{
+	guard(UNetDriver::GetRepSnapshot);
+	FRepSnapshot* Snapshot = RepSnapshots.FindRef(Actor);
+	if( Snapshot && Snapshot->Class!=Actor->GetClass() )
+	{
+		// Actor memory was reused.
+		delete Snapshot;
+		Snapshot = NULL;
+	}
+	if( !Snapshot )
+		Snapshot = RepSnapshots.Set( Actor, new FRepSnapshot(Actor->GetClass()) );
+	return Snapshot->Begin( Actor, Time ) ? Snapshot : NULL;
+	unguard;
+}
+
+//
+// Get the threads which assemble packets for client connections, starting
+// them on first use.  NetThreads is 0 by default, so packets are assembled
+// on the game thread unless workers are asked for; -1 starts one per extra
+// processor.
+//
+FNetWorkerPool* UNetDriver::GetWorkers()
+{
+	guard(UNetDriver::GetWorkers);
+	if( !Workers )
+		Workers = new FNetWorkerPool( NetThreads>=0 ? NetThreads : FNetWorkerPool::DefaultThreads() );
+	return Workers;
+	unguard;
+}
 IMPLEMENT_CLASS(UNetDriver);
 
 /*-----------------------------------------------------------------------------
@@ -0,0 +1,240 @@
+/*=============================================================================
+	UnNetFile.cpp: Shared file images for package downloads.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+#include "UnNet.h"
+#include "FCodec.h"
+
+#if defined(PLATFORM_POSIX) && !defined(PLATFORM_DREAMCAST)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#define NETFILE_MMAP 1
+#else
+	#define NETFILE_MMAP 0
+#endif
+
+// Images by filename, kept while the server runs so later clients get
+// the compressed stream for free.
+static TMap<FString,FNetFileImage*> GNetFileImages;
+
+// The codecs used by compressed streams, as used for .uz files.
+static void InitCodec( FCodecFull& Codec )
+{
+	Codec.AddCodec( new FCodecRLE );
+	Codec.AddCodec( new FCodecBWT );
+	Codec.AddCodec( new FCodecMTF );
+	Codec.AddCodec( new FCodecRLE );
+	Codec.AddCodec( new FCodecHuffman );
+}
+
+/*-----------------------------------------------------------------------------
+	FNetFileImage.
+-----------------------------------------------------------------------------*/
+
+FNetFileImage::FNetFileImage()
+:	FileTime	( 0 )
+,	Size		( 0 )
+,	Data		( NULL )
+,	Mapped		( 0 )
+,	RefCount	( 0 )
+,	PackedRaw	( 0 )
+{}
+FNetFileImage::~FNetFileImage()
+{
+	Unload();
+}
+
+//
+// Get the image of a file, loading it if nobody is sending it.
+//
+FNetFileImage* FNetFileImage::Acquire( const TCHAR* Filename )
+{
+	guard(FNetFileImage::Acquire);
+	SQWORD FileTime = GFileManager->GetGlobalTime( Filename );
+	FNetFileImage** Found = GNetFileImages.Find( Filename );
+	FNetFileImage* Image = Found ? *Found : NULL;
+	if( Image && !Image->RefCount && Image->FileTime!=FileTime )
+	{
+		// Changed on disk since it was last sent.
+		GNetFileImages.Remove( Filename );
+		delete Image;
+		Image = NULL;
+	}
+	if( !Image )
+	{
+		Image           = new FNetFileImage;
+		Image->Filename = Filename;
+		Image->FileTime = FileTime;
+		GNetFileImages.Set( Filename, Image );
+	}
+	if( !Image->Data && !Image->Load() )
+		return NULL;
+	Image->RefCount++;
+	return Image;
+	unguard;
+}
+
+//
+// Stop using an image.  The file is let go once nobody is sending it,
+// but the compressed stream is kept.
+//
+void FNetFileImage::Release()
+{
+	guard(FNetFileImage::Release);
+	check(RefCount>0);
+	if( --RefCount==0 )
+		Unload();
+	unguard;
+}
+
+UBOOL FNetFileImage::Load()
+{
+	guard(FNetFileImage::Load);
+#if NETFILE_MMAP
+	INT Handle = open( appToAnsi(*Filename), O_RDONLY );
+	if( Handle>=0 )
+	{
+		struct stat Stat;
+		if( fstat( Handle, &Stat )==0 && Stat.st_size>0 )
+		{
+			void* Map = mmap( NULL, Stat.st_size, PROT_READ, MAP_SHARED, Handle, 0 );
+			if( Map!=MAP_FAILED )
+			{
+				madvise( Map, Stat.st_size, MADV_SEQUENTIAL );
+				Data   = (BYTE*)Map;
+				Size   = Stat.st_size;
+				Mapped = 1;
+			}
+		}
+		close( Handle );
+		if( Mapped )
+			return 1;
+	}
+#endif
+
+	// Load it instead.
+	FArchive* Ar = GFileManager->CreateFileReader( *Filename );
+	if( !Ar )
+		return 0;
+	Size = Ar->TotalSize();
+	Data = (BYTE*)appMalloc( Max(Size,1), TEXT("NetFileImage") );
+	Ar->Serialize( Data, Size );
+	UBOOL Ok = !Ar->IsError();
+	delete Ar;
+	if( !Ok )
+		Unload();
+	return Ok;
+	unguard;
+}
+void FNetFileImage::Unload()
+{
+	guard(FNetFileImage::Unload);
+	if( Data )
+	{
+#if NETFILE_MMAP
+		if( Mapped )
+			munmap( Data, Size );
+		else
+#endif
+		appFree( Data );
+	}
+	Data   = NULL;
+	Mapped = 0;
+	unguard;
+}
+
+//
+// Compress the next chunk onto the end of Packed.
+//
+void FNetFileImage::PackNextChunk()
+{
+	guard(FNetFileImage::PackNextChunk);
+	check(Data);
+	FBufferWriter Out( Packed );
+	Out.Seek( Packed.Num() );
+	if( !Packed.Num() )
+	{
+		BYTE Tag[4] = { NETFILE_PACKED_TAG & 255, (NETFILE_PACKED_TAG>>8) & 255, (NETFILE_PACKED_TAG>>16) & 255, (NETFILE_PACKED_TAG>>24) & 255 };
+		Out.Serialize( Tag, 4 );
+	}
+	if( PackedComplete() )
+		return;
+
+	INT RawSize = Min<INT>( NETFILE_CHUNK, Size-PackedRaw );
+	TArray<BYTE> Raw, Chunk;
+	Raw.Add( RawSize );
+	appMemcpy( &Raw(0), Data+PackedRaw, RawSize );
+	FCodecFull Codec;
+	InitCodec( Codec );
+	FBufferReader Reader( Raw );
+	FBufferWriter Writer( Chunk );
+	Codec.Encode( Reader, Writer );
+
+	// Store chunks that don't shrink.
+	INT PackedSize = Min( Chunk.Num(), RawSize );
+	Out << RawSize << PackedSize;
+	Out.Serialize( PackedSize<RawSize ? &Chunk(0) : &Raw(0), PackedSize );
+	PackedRaw += RawSize;
+	unguard;
+}
+
+//
+// Whether data received starts a compressed stream.
+//
+UBOOL FNetFileImage::IsPacked( const BYTE* Data, INT Count )
+{
+	return Count>=4 && (Data[0] | (Data[1]<<8) | (Data[2]<<16) | ((DWORD)Data[3]<<24))==(DWORD)NETFILE_PACKED_TAG;
+}
+
+//
+// Decompress every whole chunk at the start of In to Out and remove it.
+// Returns the raw bytes written, or -1 if the stream is malformed.
+//
+INT FNetFileImage::Unpack( TArray<BYTE>& In, FArchive& Out )
+{
+	guard(FNetFileImage::Unpack);
+	INT Pos=0, Written=0;
+	FBufferReader Reader( In );
+	while( In.Num()-Pos>=8 )
+	{
+		INT RawSize, PackedSize;
+		Reader.Seek( Pos );
+		Reader << RawSize << PackedSize;
+		if( RawSize<0 || RawSize>NETFILE_CHUNK || PackedSize<0 || PackedSize>RawSize )
+			return -1;
+		if( In.Num()-Pos-8 < PackedSize )
+			break;
+		if( PackedSize==RawSize )
+		{
+			Out.Serialize( &In(Pos+8), RawSize );
+		}
+		else
+		{
+			TArray<BYTE> Chunk, Raw;
+			Chunk.Add( PackedSize );
+			appMemcpy( &Chunk(0), &In(Pos+8), PackedSize );
+			FCodecFull Codec;
+			InitCodec( Codec );
+			FBufferReader ChunkReader( Chunk );
+			FBufferWriter RawWriter( Raw );
+			Codec.Decode( ChunkReader, RawWriter );
+			if( Raw.Num()!=RawSize )
+				return -1;
+			Out.Serialize( &Raw(0), RawSize );
+		}
+		Pos     += 8 + PackedSize;
+		Written += RawSize;
+	}
+	if( Pos )
+		In.Remove( 0, Pos );
+	return Written;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,348 @@
+/*=============================================================================
+	UnNetPool.cpp: Worker threads for server packet assembly.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#if _MSC_VER
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <semaphore.h>
+	#include <unistd.h>
+#endif
+
+#include "EnginePrivate.h"
+#include "UnNet.h"
+
+// Most workers worth starting.
+#define MAX_NET_WORKERS 7
+
+/*-----------------------------------------------------------------------------
+	Platform primitives.
+-----------------------------------------------------------------------------*/
+
+static void* CreateNetSemaphore()
+{
+#if _MSC_VER
+	return CreateSemaphore( NULL, 0, 0x7FFFFFFF, NULL );
+#else
+	sem_t* Sem = (sem_t*)appMalloc( sizeof(sem_t), TEXT("NetSemaphore") );
+	sem_init( Sem, 0, 0 );
+	return Sem;
+#endif
+}
+static void DestroyNetSemaphore( void* Sem )
+{
+#if _MSC_VER
+	CloseHandle( (HANDLE)Sem );
+#else
+	sem_destroy( (sem_t*)Sem );
+	appFree( Sem );
+#endif
+}
+static void PostNetSemaphore( void* Sem )
+{
+#if _MSC_VER
+	ReleaseSemaphore( (HANDLE)Sem, 1, NULL );
+#else
+	sem_post( (sem_t*)Sem );
+#endif
+}
+static void WaitNetSemaphore( void* Sem )
+{
+#if _MSC_VER
+	WaitForSingleObject( (HANDLE)Sem, INFINITE );
+#else
+	while( sem_wait( (sem_t*)Sem )!=0 );
+#endif
+}
+static void* CreateNetLock()
+{
+#if _MSC_VER
+	CRITICAL_SECTION* Lock = (CRITICAL_SECTION*)appMalloc( sizeof(CRITICAL_SECTION), TEXT("NetLock") );
+	InitializeCriticalSection( Lock );
+#else
+	pthread_mutex_t* Lock = (pthread_mutex_t*)appMalloc( sizeof(pthread_mutex_t), TEXT("NetLock") );
+	pthread_mutexattr_t Attr;
+	pthread_mutexattr_init( &Attr );
+	pthread_mutexattr_settype( &Attr, PTHREAD_MUTEX_RECURSIVE );
+	pthread_mutex_init( Lock, &Attr );
+	pthread_mutexattr_destroy( &Attr );
+#endif
+	return Lock;
+}
+static void DestroyNetLock( void* Lock )
+{
+#if _MSC_VER
+	DeleteCriticalSection( (CRITICAL_SECTION*)Lock );
+#else
+	pthread_mutex_destroy( (pthread_mutex_t*)Lock );
+#endif
+	appFree( Lock );
+}
+static INT NetAtomicIncrement( volatile INT* Value )
+{
+#if _MSC_VER
+	return InterlockedIncrement( (LONG*)Value );
+#else
+	return __sync_add_and_fetch( Value, 1 );
+#endif
+}
+
+//
+// Holds a lock for the life of a scope, releasing it if an error unwinds.
+// The lock is recursive, since an allocation failure raises an error while
+// the allocator still holds it.
+//
+struct FNetLockScope
+{
+	void* Lock;
+	FNetLockScope( void* InLock )
+	:	Lock( InLock )
+	{
+#if _MSC_VER
+		EnterCriticalSection( (CRITICAL_SECTION*)Lock );
+#else
+		pthread_mutex_lock( (pthread_mutex_t*)Lock );
+#endif
+	}
+	~FNetLockScope()
+	{
+#if _MSC_VER
+		LeaveCriticalSection( (CRITICAL_SECTION*)Lock );
+#else
+		pthread_mutex_unlock( (pthread_mutex_t*)Lock );
+#endif
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	FNetWorkerMalloc and FNetWorkerError.
+-----------------------------------------------------------------------------*/
+
+//
+// Stands in for GMalloc while a pool runs.  The engine's allocators take no
+// lock of their own, so every call is passed on behind the pool's lock.
+//
+class FNetWorkerMalloc : public FMalloc
+{
+public:
+	FNetWorkerPool*	Pool;
+	FMalloc*		Inner;
+	void* Malloc( DWORD Count, const TCHAR* Tag )
+	{
+		FNetLockScope Scope( Pool->Lock );
+		return Inner->Malloc( Count, Tag );
+	}
+	void* Realloc( void* Original, DWORD Count, const TCHAR* Tag )
+	{
+		FNetLockScope Scope( Pool->Lock );
+		return Inner->Realloc( Original, Count, Tag );
+	}
+	void Free( void* Original )
+	{
+		FNetLockScope Scope( Pool->Lock );
+		Inner->Free( Original );
+	}
+	void DumpAllocs()
+	{
+		FNetLockScope Scope( Pool->Lock );
+		Inner->DumpAllocs();
+	}
+	void HeapCheck()
+	{
+		FNetLockScope Scope( Pool->Lock );
+		Inner->HeapCheck();
+	}
+	void Init()
+	{}
+	void Exit()
+	{}
+};
+static FNetWorkerMalloc NetWorkerMalloc;
+
+//
+// Stands in for GError while a pool runs.  The first message is kept for
+// Run to raise on the calling thread, and the task is unwound by throwing
+// it, which guard/unguard pass on without touching the error history.
+//
+class FNetWorkerError : public FOutputDeviceError
+{
+public:
+	FNetWorkerPool* Pool;
+	void Serialize( const TCHAR* Msg, enum EName Event )
+	{
+		FNetLockScope Scope( Pool->Lock );
+		if( !*Pool->Error )
+			appStrncpy( Pool->Error, Msg, ARRAY_COUNT(Pool->Error) );
+		throw Pool->Error;
+	}
+	void HandleError()
+	{}
+};
+static FNetWorkerError NetWorkerError;
+
+/*-----------------------------------------------------------------------------
+	FNetWorkerThread.
+-----------------------------------------------------------------------------*/
+
+struct FNetWorkerThread
+{
+#if _MSC_VER
+	static DWORD STDCALL Entry( void* Arg )
+#else
+	static void* Entry( void* Arg )
+#endif
+	{
+		FNetWorkerPool* Pool = (FNetWorkerPool*)Arg;
+		for( ; ; )
+		{
+			WaitNetSemaphore( Pool->Wake );
+			if( Pool->Exiting )
+				break;
+			Pool->Work();
+			PostNetSemaphore( Pool->Done );
+		}
+		return 0;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	FNetWorkerPool.
+-----------------------------------------------------------------------------*/
+
+FNetWorkerPool::FNetWorkerPool( INT InNumThreads )
+:	Wake	( CreateNetSemaphore() )
+,	Done	( CreateNetSemaphore() )
+,	Lock	( CreateNetLock() )
+,	Task	( NULL )
+,	Context	( NULL )
+,	Count	( 0 )
+,	Next	( 0 )
+,	Exiting	( 0 )
+{
+	guard(FNetWorkerPool::FNetWorkerPool);
+	*Error = 0;
+	for( INT i=0; i<InNumThreads; i++ )
+	{
+#if _MSC_VER
+		DWORD  ThreadId;
+		HANDLE Thread = CreateThread( NULL, 0, FNetWorkerThread::Entry, this, 0, &ThreadId );
+		if( !Thread )
+			break;
+		Threads.AddItem( Thread );
+#else
+		pthread_t* Thread = (pthread_t*)appMalloc( sizeof(pthread_t), TEXT("NetWorker") );
+		if( pthread_create( Thread, NULL, FNetWorkerThread::Entry, this )!=0 )
+		{
+			appFree( Thread );
+			break;
+		}
+		Threads.AddItem( Thread );
+#endif
+	}
+	debugf( NAME_DevNet, TEXT("Started %i net worker threads"), Threads.Num() );
+	unguard;
+}
+FNetWorkerPool::~FNetWorkerPool()
+{
+	guard(FNetWorkerPool::~FNetWorkerPool);
+	Exiting = 1;
+	for( INT i=0; i<Threads.Num(); i++ )
+		PostNetSemaphore( Wake );
+	for( INT i=0; i<Threads.Num(); i++ )
+	{
+#if _MSC_VER
+		WaitForSingleObject( (HANDLE)Threads(i), INFINITE );
+		CloseHandle( (HANDLE)Threads(i) );
+#else
+		pthread_join( *(pthread_t*)Threads(i), NULL );
+		appFree( Threads(i) );
+#endif
+	}
+	DestroyNetSemaphore( Wake );
+	DestroyNetSemaphore( Done );
+	DestroyNetLock( Lock );
+	unguard;
+}
+
+//
+// Run Task for every index below Count, on this thread and as many
+// workers as can help, and return once all have finished.
+//
+void FNetWorkerPool::Run( FNetWorkerTask InTask, void* InContext, INT InCount )
+{
+	guard(FNetWorkerPool::Run);
+	Task    = InTask;
+	Context = InContext;
+	Count   = InCount;
+	Next    = 0;
+	*Error  = 0;
+
+	// Serialize allocation and defer errors until every task is done.
+	FMalloc*             OldMalloc = GMalloc;
+	FOutputDeviceError*  OldError  = GError;
+	NetWorkerMalloc.Pool  = this;
+	NetWorkerMalloc.Inner = OldMalloc;
+	NetWorkerError.Pool   = this;
+	GMalloc = &NetWorkerMalloc;
+	GError  = &NetWorkerError;
+
+	INT Helpers = Min( Threads.Num(), InCount-1 );
+	for( INT i=0; i<Helpers; i++ )
+		PostNetSemaphore( Wake );
+	Work();
+	for( INT i=0; i<Helpers; i++ )
+		WaitNetSemaphore( Done );
+
+	GMalloc = OldMalloc;
+	GError  = OldError;
+
+	// Errors can only be reported from this thread.
+	if( *Error )
+		appErrorf( TEXT("Net worker failed: %s"), Error );
+	unguard;
+}
+void FNetWorkerPool::Work()
+{
+	for( INT i=NetAtomicIncrement(&Next)-1; i<Count; i=NetAtomicIncrement(&Next)-1 )
+	{
+		try
+		{
+			Task( Context, i );
+		}
+		catch( TCHAR* )
+		{
+			// Already recorded by NetWorkerError.
+		}
+		catch( ... )
+		{
+			FNetLockScope Scope( Lock );
+			if( !*Error )
+				appStrncpy( Error, TEXT("Unknown exception"), ARRAY_COUNT(Error) );
+		}
+	}
+}
+
+//
+// Workers to start for a NetThreads of -1: one per extra processor.
+//
+INT FNetWorkerPool::DefaultThreads()
+{
+	guard(FNetWorkerPool::DefaultThreads);
+#if _MSC_VER
+	SYSTEM_INFO Info;
+	GetSystemInfo( &Info );
+	INT NumProcessors = Info.dwNumberOfProcessors;
+#elif defined(PLATFORM_DREAMCAST)
+	INT NumProcessors = 1;
+#else
+	INT NumProcessors = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	return Clamp( NumProcessors-1, 0, MAX_NET_WORKERS );
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
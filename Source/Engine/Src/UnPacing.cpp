@@ -0,0 +1,177 @@
+/*=============================================================================
+	UnPacing.cpp: Main loop tick rate pacing.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#if defined(PLATFORM_POSIX) && !defined(PLATFORM_DREAMCAST)
+	#include <time.h>
+	#include <errno.h>
+#endif
+
+#include "EnginePrivate.h"
+
+ENGINE_API FTickPacer GTickPacer;
+
+// Upper bounds of the lateness histogram buckets, in msec.
+static const FLOAT GTickPaceBuckets[TICKPACE_BUCKETS-1] = { 0.1f, 0.25f, 0.5f, 1.f, 2.f, 4.f, 8.f, 16.f };
+
+/*-----------------------------------------------------------------------------
+	Sleeping.
+-----------------------------------------------------------------------------*/
+
+//
+// Sleep until appSeconds() reaches Target, or a little past it.
+//
+static void SleepUntil( DOUBLE Target )
+{
+	DOUBLE Delta = Target - appSeconds();
+	if( Delta<=0.0 )
+		return;
+#if defined(PLATFORM_POSIX) && !defined(PLATFORM_DREAMCAST)
+	// Sleep to an absolute time so interruptions don't add up.
+	timespec Wake;
+	clock_gettime( CLOCK_MONOTONIC, &Wake );
+	QWORD Nsec   = (QWORD)Wake.tv_nsec + (QWORD)(Delta * 1000000000.0);
+	Wake.tv_sec += Nsec / 1000000000;
+	Wake.tv_nsec = Nsec % 1000000000;
+	while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &Wake, NULL )==EINTR );
+#else
+	appSleep( Delta );
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+	FTickPacer.
+-----------------------------------------------------------------------------*/
+
+FTickPacer::FTickPacer()
+:	Mode		( 1 )
+,	SpinTime	( 0.00025f )
+,	Deadline	( 0.0 )
+{
+	ResetStats();
+}
+
+//
+// Read settings from the [TickPacing] section and -TICKPACING=.
+//
+void FTickPacer::Init()
+{
+	guard(FTickPacer::Init);
+	FLOAT SpinMsec = SpinTime * 1000.f;
+	GConfig->GetInt  ( TEXT("TickPacing"), TEXT("Mode"),     Mode     );
+	GConfig->GetFloat( TEXT("TickPacing"), TEXT("SpinMsec"), SpinMsec );
+	Parse( appCmdLine(), TEXT("TICKPACING="), Mode );
+	SpinTime = Clamp( SpinMsec, 0.f, 10.f ) / 1000.f;
+	Deadline = 0.0;
+	ResetStats();
+	debugf( NAME_Init, TEXT("Tick pacing mode %i, spin %.2f msec"), Mode, SpinMsec );
+	unguard;
+}
+
+//
+// Wait for the next tick, given when the one just finished started.
+//
+void FTickPacer::Wait( FLOAT MaxTickRate, DOUBLE TickStart )
+{
+	guard(FTickPacer::Wait);
+	if( MaxTickRate<=0.0 )
+	{
+		Deadline = 0.0;
+		return;
+	}
+	DOUBLE Period = 1.0 / MaxTickRate;
+	DOUBLE Now    = appSeconds();
+
+	// Find the deadline.  Absolute deadlines follow on from the last one,
+	// unless the loop fell a whole tick behind or the rate changed.
+	if( Mode && Deadline!=0.0 && Deadline+Period>=Now-Period && Deadline+Period<=Now+Period )
+		Deadline += Period;
+	else
+		Deadline  = TickStart + Period;
+
+	// Wait for it.
+	if( Now<Deadline )
+	{
+		if( Mode )
+		{
+			SleepUntil( Deadline - SpinTime );
+			while( appSeconds()<Deadline );
+		}
+		else appSleep( Deadline - Now );
+	}
+	else Missed++;
+
+	// Note how late this tick starts.
+	FLOAT Late = Max( appSeconds()-Deadline, 0.0 ) * 1000.0;
+	INT   i;
+	for( i=0; i<TICKPACE_BUCKETS-1 && Late>=GTickPaceBuckets[i]; i++ );
+	Histogram[i]++;
+	Ticks++;
+	TotalLate += Late;
+	MaxLate    = ::Max( MaxLate, Late );
+	unguard;
+}
+void FTickPacer::ResetStats()
+{
+	StatsStart = appSeconds();
+	Ticks      = 0;
+	Missed     = 0;
+	TotalLate  = 0.0;
+	MaxLate    = 0.f;
+	appMemzero( Histogram, sizeof(Histogram) );
+}
+
+//
+// TICKSTATS [RESET]: show how closely ticks kept to their deadlines.
+// TICKPACING [mode]: show or change the pacing mode.
+//
+UBOOL FTickPacer::Exec( const TCHAR* Cmd, FOutputDevice& Ar )
+{
+	guard(FTickPacer::Exec);
+	if( ParseCommand(&Cmd,TEXT("TICKSTATS")) )
+	{
+		if( ParseCommand(&Cmd,TEXT("RESET")) )
+		{
+			ResetStats();
+			return 1;
+		}
+		DOUBLE Elapsed = appSeconds() - StatsStart;
+		Ar.Logf
+		(
+			TEXT("Tick pacing mode %i: %i ticks in %.1f sec (%.2f/sec), %i overran, late avg=%.3f max=%.3f msec"),
+			Mode,
+			Ticks,
+			Elapsed,
+			Elapsed>0.0 ? Ticks/Elapsed : 0.0,
+			Missed,
+			Ticks ? TotalLate/Ticks : 0.0,
+			MaxLate
+		);
+		for( INT i=0; i<TICKPACE_BUCKETS; i++ )
+		{
+			FString Range
+			=	i<TICKPACE_BUCKETS-1
+			?	FString::Printf( TEXT("< %5.2f"), GTickPaceBuckets[i] )
+			:	FString::Printf( TEXT(">=%5.2f"), GTickPaceBuckets[i-1] );
+			Ar.Logf( TEXT("   %s msec: %7i (%5.1f%%)"), *Range, Histogram[i], Ticks ? 100.0*Histogram[i]/Ticks : 0.0 );
+		}
+		return 1;
+	}
+	else if( ParseCommand(&Cmd,TEXT("TICKPACING")) )
+	{
+		if( *Cmd )
+		{
+			Mode     = appAtoi( Cmd );
+			Deadline = 0.0;
+		}
+		Ar.Logf( TEXT("Tick pacing mode %i"), Mode );
+		return 1;
+	}
+	else return 0;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -44,7 +44,10 @@ UNetPendingLevel::UNetPendingLevel( UEngine* InEngine, const FURL& InURL )
 	if( NetDriver->InitConnect( this, URL, Error ) )
 	{
 		// Send initial message.
-		NetDriver->ServerConnection->Logf( TEXT("HELLO REVISION=0 MINVER=%i VER=%i"), ENGINE_MIN_NET_VERSION, ENGINE_VERSION );
+		if( NetDriver->CompressPackets )
+			NetDriver->ServerConnection->Logf( TEXT("HELLO REVISION=0 MINVER=%i VER=%i COMPRESS=%u"), ENGINE_MIN_NET_VERSION, ENGINE_VERSION, GNetPacketModel.Checksum );
+		else
+			NetDriver->ServerConnection->Logf( TEXT("HELLO REVISION=0 MINVER=%i VER=%i"), ENGINE_MIN_NET_VERSION, ENGINE_VERSION );
 		NetDriver->ServerConnection->FlushNet();
 	}
 	else
@@ -149,6 +152,10 @@ void UNetPendingLevel::NotifyReceivedText( UNetConnection* Connection, const TCH
 		Parse( Text, TEXT("VER="), Connection->NegotiatedVer );
 		Parse( Text, TEXT("CHALLENGE="), Connection->Challenge );
 
+		// Server has our packet model.
+		DWORD RemoteModel=0;
+		Connection->CompressOut = Parse(Text,TEXT("COMPRESS="),RemoteModel) && NetDriver->CompressPackets && RemoteModel==GNetPacketModel.Checksum;
+
 		Parse( Text, TEXT("STATS="), RemoteStats );
 		if (RemoteStats == 1)
 		{
@@ -102,6 +102,8 @@ void AActor::setPhysics(BYTE NewPhysics, AActor *NewFloor)
 	if (Physics == NewPhysics)
 		return;
 	Physics = NewPhysics;
+	if( GetLevel()->TickScheduler )
+		GetLevel()->TickScheduler->Wake( this );
 
 	if ((Physics == PHYS_Walking) || (Physics == PHYS_None) || (Physics == PHYS_Rolling) 
 			|| (Physics == PHYS_Rotating) || (Physics == PHYS_Spider) )
@@ -69,26 +69,24 @@ void FSortedPathList::FindVisiblePaths(APawn *Searcher, FVector Dest, FSortedPat
 		}
 	}
 
-	FCheckResult Hit(1.0);
-	ANavigationPoint *Nav = Searcher->GetLevel()->GetLevelInfo()->NavigationPointList;
+	FNavGraph& Graph = Searcher->GetLevel()->GetNavGraph(1);
+	Graph.BeginSearch(Searcher, bClearPaths);
 	int dist;
-	while (Nav)
+	for ( INT i=0; i<Graph.Nodes.Num(); i++ )
 	{
-		if (bClearPaths)
-			Searcher->clearPath(Nav);
+		FNavNode& Node = Graph.Nodes(i);
 		if ( !startanchor )
 		{
-			dist = (int)(Searcher->Location - Nav->Location).SizeSquared();
+			dist = (int)(Searcher->Location - Node.Location).SizeSquared();
 			if ( dist < 640000 )
-				addPath(Nav, dist);
+				addPath(Node.Nav, dist);
 		}
 		if ( !endanchor )
 		{
-			dist = (int)(Dest - Nav->Location).SizeSquared();
+			dist = (int)(Dest - Node.Location).SizeSquared();
 			if ( dist < 640000 )
-				DestPoints->addPath(Nav, dist);
+				DestPoints->addPath(Node.Nav, dist);
 		}
-		Nav = Nav->nextNavigationPoint;
 	}
 
 	//unclock(GetLevel()->FindPathCycles);
@@ -120,8 +118,8 @@ int FSortedPathList::findEndPoint(APawn *Searcher, INT &startanchor)
 				startanchor = 1;
 			else
 			{
-				((ANavigationPoint *)Path[0])->bEndPoint = 1;
-				((ANavigationPoint *)Path[0])->bestPathWeight = Dist[0];
+				FNavGraph& Graph = MyLevel->GetNavGraph();
+				Graph.MarkEndPoint(Graph.FindNode(Path[0]), Dist[0]);
 			}
 			return 1;
 		}
@@ -160,8 +158,11 @@ void FSortedPathList::expandAnchor(APawn *Searcher)
 	guard(FSortedPathList::expandAnchor);
 
 	ULevel *MyLevel = Searcher->GetLevel();
+	FNavGraph& Graph = MyLevel->GetNavGraph();
 	ANavigationPoint *anchor = (ANavigationPoint *)Path[0];
-	anchor->cost = 1000000; //paths shouldn't go through anchor
+	INT Anchor = Graph.FindNode(anchor);
+	if ( Anchor != INDEX_NONE )
+		Graph.SetCost(Anchor, 1000000); //paths shouldn't go through anchor
 	INT j = 0;
 	FReachSpec *spec;
 	FCheckResult Hit;
@@ -179,12 +180,13 @@ void FSortedPathList::expandAnchor(APawn *Searcher)
 			if ( spec->supports(iRadius, iHeight, moveFlags) )
 			{
 				MyLevel->SingleLineCheck(Hit, Searcher, spec->End->Location, spec->Start->Location, TRACE_VisBlocking);
-				if ( !Hit.Actor || !Hit.Actor->IsA(AMover::StaticClass()) 
-					|| (Searcher->bCanOpenDoors && (Searcher->bIsPlayer || !((AMover *)Hit.Actor)->bPlayerOnly)) )
+				INT End = Graph.FindNode(spec->End);
+				if ( (End != INDEX_NONE)
+					&& (!Hit.Actor || !Hit.Actor->IsA(AMover::StaticClass()) 
+					|| (Searcher->bCanOpenDoors && (Searcher->bIsPlayer || !((AMover *)Hit.Actor)->bPlayerOnly))) )
 				{
 					//debugf("Expansion to %s successful",spec->End->GetName()); 
-					((ANavigationPoint *)spec->End)->bEndPoint = 1;
-					((ANavigationPoint *)spec->End)->bestPathWeight = spec->distance;
+					Graph.MarkEndPoint(End, spec->distance);
 				}
 			}
 			j++;
@@ -255,13 +257,14 @@ void FSortedPathList::findAltEndPoint(APawn *Searcher, AActor *&bestPath)
 	guard(FSortedPathList::findAltEndPoint);
 
 	//check if other paths (beyond Path[0]) might be better destinations
-	int bestDist = ((ANavigationPoint *)Path[0])->visitedWeight + Dist[0]; 
+	FNavGraph& Graph = Searcher->GetLevel()->GetNavGraph();
+	int bestDist = Graph.GetRouteWeight(Graph.FindNode(Path[0])) + Dist[0]; 
 	FSortedPathList AltEndPoints;
 	AltEndPoints.numPoints = 0;
 	for (int j=1; j<numPoints; j++)
 	{
 		int newDist = (INT) appSqrt(Dist[j]);
-		newDist += ((ANavigationPoint *)Path[j])->visitedWeight;
+		newDist += Graph.GetRouteWeight(Graph.FindNode(Path[j]));
 		if ( (newDist < bestDist) && (Abs(Path[j]->Location.Z - Searcher->Location.Z) < 120)
 			&& ((((Path[j]->Location - Searcher->Location) | (bestPath->Location - Searcher->Location)) < 0)
 			|| (newDist < ::Max((int)(0.85 * bestDist), bestDist - 150))) )
@@ -277,6 +280,7 @@ void FSortedPathList::findAltEndPoint(APawn *Searcher, AActor *&bestPath)
 			&& Searcher->pointReachable(AltEndPoints.Path[j]->Location, 1) )
 		{
 			bestPath = AltEndPoints.Path[j];
+			Graph.LinkRoute(Graph.FindNode(bestPath));
 			return;
 		}
 	}
@@ -393,7 +397,7 @@ int APawn::findPathToward(AActor *goal, INT bSinglePath, AActor *&bestPath, INT
 	{
 		AActor *newPath = NULL;
 		int moveFlags = calcMoveFlags();
-		((ANavigationPoint *)DestPoints.Path[0])->visitedWeight = DestPoints.Dist[0];
+		GetLevel()->GetNavGraph().SetWeight(DestPoints.Path[0], DestPoints.Dist[0]);
 		if (breadthPathFrom(DestPoints.Path[0], newPath, bSinglePath, moveFlags))
 		{
 			bestPath = newPath;
@@ -467,7 +471,7 @@ FLOAT APawn::findPathTowardBestInventory(AActor *&bestPath, INT bClearPaths, FLO
 
 	AActor *newPath = NULL;
 	int moveFlags = calcMoveFlags();
-	((ANavigationPoint *)EndPoints.Path[0])->visitedWeight = ::Max<INT>(10, EndPoints.Dist[0]);
+	GetLevel()->GetNavGraph().SetWeight(EndPoints.Path[0], ::Max<INT>(10, EndPoints.Dist[0]));
 	FLOAT bestInventoryWeight = breadthPathToInventory(EndPoints.Path[0], newPath, moveFlags, MinWeight, bPredictRespawns);
 	//debugf(NAME_DevPath,"BestInv is %f compared to weight %f", bestInventoryWeight, MinWeight);
 	if ( bestInventoryWeight > MinWeight)
@@ -559,7 +563,7 @@ int APawn::findPathTo(FVector Dest, INT bSinglePath, AActor *&bestPath, INT bCle
 	{
 		AActor *newPath = NULL;
 		int moveFlags = calcMoveFlags(); 
-		((ANavigationPoint *)DestPoints.Path[0])->visitedWeight = DestPoints.Dist[0];
+		GetLevel()->GetNavGraph().SetWeight(DestPoints.Path[0], DestPoints.Dist[0]);
 		if (breadthPathFrom(DestPoints.Path[0], newPath, bSinglePath, moveFlags))
 		{
 			//unclock(GetLevel()->FindPathCycles);
@@ -685,114 +689,67 @@ int APawn::TraverseFrom(AActor *start, int moveFlags)
 }
 
 /* breadthPathFrom()
-Breadth First Search through navigation network
-startnode is the starting path
-end when we find a pathnode marked as an end point (bEndpoint == 1)
+Best first search through the navigation graph, from startnode toward the end points
+(marked with MarkEndPoint), ordered by weight plus FNavGraph::Heuristic's lower bound on
+the weight remaining; end when we reach an end point.  startnode's weight must have been set.
 */
 int APawn::breadthPathFrom(AActor *start, AActor *&bestPath, int bSinglePath, int moveFlags)
 {
 	guard(APawn::breadthPathFrom);
-	//FIXME - perhaps track and bound number of edges to search or max depth?
-	ANavigationPoint* currentnode = (ANavigationPoint *)start;
-	ANavigationPoint* nextnode;
-	ANavigationPoint* BinTree = currentnode;
+	FNavGraph& Graph = GetLevel()->GetNavGraph();
+	INT startnode = Graph.FindNode(start);
+	if ( startnode == INDEX_NONE )
+		return 0;
 
 	int iRadius = (int)CollisionRadius;
 	int iHeight = (int)CollisionHeight;
-	int p = 0;
 	int n = 0;
-	int realSplit = 1;
-	FReachSpec *spec;
-	while ( currentnode )
+
+	// Another pawn of this size may have routed to the same place recently.
+	if ( !bSinglePath && !Graph.bPresetCosts )
 	{
-		if ( currentnode->bEndPoint )
+		FNavFlowField* Field = Graph.GetFlowField(startnode, iRadius, iHeight, moveFlags, GetLevel()->TimeSeconds);
+		INT endnode = Graph.FindFlowEndPoint(Field, Graph.GetWeight(startnode));
+		if ( endnode != INDEX_NONE )
 		{
-			//debugf("best path is %s", currentnode->GetName());
-			((ANavigationPoint *)start)->previousPath = NULL;
-			bestPath = currentnode;
+			Graph.LinkRoute(endnode);
+			bestPath = Graph.Nodes(endnode).Nav;
 			return 1;
 		}
-		if ( (!currentnode->bPlayerOnly || bIsPlayer) || (currentnode == start) )
+	}
+
+	Graph.PushOpen(Graph.GetWeight(startnode) + Graph.Heuristic(startnode), startnode);
+	INT currentnode;
+	while ( (currentnode = Graph.PopOpen()) != INDEX_NONE )
+	{
+		if ( !Graph.Close(currentnode) )
+			continue; //already reached with a lower weight
+		Graph.NumExpanded++;
+		if ( Graph.IsEndPoint(currentnode) )
 		{
-			int i = 0;
-			while ( i<16 )
+			//debugf("best path is %s", Graph.Nodes(currentnode).Nav->GetName());
+			Graph.LinkRoute(currentnode);
+			bestPath = Graph.Nodes(currentnode).Nav;
+			return 1;
+		}
+		FNavNode& Node = Graph.Nodes(currentnode);
+		if ( (!Node.bPlayerOnly || bIsPlayer) || (currentnode == startnode) )
+		{
+			INT currentWeight = Graph.GetWeight(currentnode);
+			for ( INT i=0; i<Node.NumIn; i++ )
 			{
-				if (currentnode->upstreamPaths[i] == -1)
-					i = 16;
-				else
+				FNavEdge& Edge = Graph.InEdges(Node.FirstIn + i);
+				if ( Edge.Supports(iRadius, iHeight, moveFlags) )
 				{
-					spec = &GetLevel()->ReachSpecs(currentnode->upstreamPaths[i]);
-					//debugf("check path from %s to %s with %d, %d",spec->Start->GetName(), spec->End->GetName(), spec->CollisionRadius, spec->CollisionHeight);
-					if (spec->supports(iRadius, iHeight, moveFlags))
+					INT prevnode = Edge.Node;
+					int newVisit = Edge.Distance + Graph.GetCost(prevnode) + currentWeight + Graph.GetEndWeight(prevnode);
+					if ( Graph.GetWeight(prevnode) > newVisit )
 					{
-						ANavigationPoint* startnode = (ANavigationPoint* )spec->Start;
-						int nextweight = spec->distance + startnode->cost;
-						int newVisit = nextweight + currentnode->visitedWeight + startnode->bEndPoint * startnode->bestPathWeight; 
-						//debugf("Path from %s to %s costs %d total %d versus %d", spec->Start->GetName(), spec->End->GetName(), nextweight, newVisit, startnode->visitedWeight);
-						if ( startnode->visitedWeight > newVisit )
-						{
-							if ( startnode->prevOrdered ) //remove from old position
-							{
-								startnode->prevOrdered->nextOrdered = startnode->nextOrdered;
-								if (startnode->nextOrdered)
-									startnode->nextOrdered->prevOrdered = startnode->prevOrdered;
-								if ( BinTree == startnode )
-								{
-									if ( startnode->prevOrdered->visitedWeight > newVisit )
-										BinTree = startnode->prevOrdered;
-								}
-								else if ( (startnode->visitedWeight > BinTree->visitedWeight)
-									&& (newVisit < BinTree->visitedWeight) )
-									realSplit--;	
-							}
-							else if ( newVisit > BinTree->visitedWeight )
-								realSplit++;
-							else
-								realSplit--;
-							//debugf("find spot for %s with BinTree = %s",startnode->GetName(), BinTree->GetName());
-							startnode->previousPath = currentnode;
-							startnode->visitedWeight = newVisit;
-							if (  BinTree->visitedWeight < startnode->visitedWeight )
-								nextnode = BinTree;
-							else
-								nextnode = currentnode;
-							//debugf(" start at %s with %d to place %s with %d",nextnode->GetName(),nextnode->visitedWeight, startnode->GetName(), startnode->visitedWeight);
-							int numList = 0; //TEMP FIXME
-							while ( nextnode->nextOrdered && (nextnode->nextOrdered->visitedWeight < startnode->visitedWeight) )
-							{
-								numList++;
-								if ( numList > 500 )
-								{
-									debugf( TEXT("Breadth path list overflow from %s"), start->GetName() );
-									return 0;
-								}
-								nextnode = nextnode->nextOrdered;
-							}
-							if (nextnode->nextOrdered != startnode)
-							{
-								if (nextnode->nextOrdered)
-									nextnode->nextOrdered->prevOrdered = startnode;
-								startnode->nextOrdered = nextnode->nextOrdered;
-								nextnode->nextOrdered = startnode;
-								startnode->prevOrdered = nextnode;
-							}
-							//if (startnode->nextOrdered)
-							//	debugf(" place %s after %s before %s ", startnode->GetName(), nextnode->GetName(), startnode->nextOrdered->GetName());
-							//else
-							//	debugf(" place %s after %s at end ", startnode->GetName(), nextnode->GetName());
-						}
+						Graph.SetWeight(prevnode, newVisit, currentnode);
+						Graph.PushOpen(newVisit + Graph.Heuristic(prevnode), prevnode);
 					}
-					i++;
 				}
 			}
-			realSplit++;
-			int move = (int)(0.5 * realSplit);
-			while ( p < move )
-			{
-				p++;
-				if (BinTree->nextOrdered)
-					BinTree = BinTree->nextOrdered;
-			}
 		}
 		n++;
 		if ( bSinglePath && ( n > 4) )
@@ -802,16 +759,6 @@ int APawn::breadthPathFrom(AActor *start, AActor *&bestPath, int bSinglePath, in
 			debugf(NAME_DevPath, TEXT("1000 navigation nodes searched from %s!"), start->GetName() );
 			return 0;
 		}
-		//debugf("Done with %s",currentnode->GetName());
-		currentnode = currentnode->nextOrdered;
-		/*
-		nextnode = currentnode;
-		while (nextnode)
-		{
-			debugf("Next %s",nextnode->GetName());
-			nextnode = nextnode->nextOrdered;
-		}
-		*/
 	}
 	//debugf("No path found");
 	return 0;
@@ -875,7 +822,7 @@ inline void FSortedPathList::removePath(int p)
 }
 
 /* breadthPathToInventory()
-Breadth First Search through navigation network
+Lowest weight first search through the navigation graph
 starting from path bot is on.
 When encounter inventoryspot, query its item's botdesireability
 keep track of best weight and the nextpath associated with it
@@ -884,148 +831,82 @@ FLOAT APawn::breadthPathToInventory(AActor *start, AActor *&bestPath, int moveFl
 {
 	guard(APawn::breadthPathToInventory);
 
-	ANavigationPoint* currentnode = (ANavigationPoint *)start;
-	ANavigationPoint* nextnode;
-	ANavigationPoint* BinTree = currentnode;
-	ANavigationPoint* BestDest = NULL;
+	FNavGraph& Graph = GetLevel()->GetNavGraph();
+	INT startnode = Graph.FindNode(start);
+	if ( startnode == INDEX_NONE )
+		return 0;
+	INT BestDest = INDEX_NONE;
 
 	int iRadius = (int)CollisionRadius;
 	int iHeight = (int)CollisionHeight;
-	int p = 0;
 	int n = 0;
-	int realSplit = 1;
 
-	FReachSpec *spec;
-	while ( currentnode )
-	{
-		//debugf(NAME_DevPath,"Distance to %s is %d", currentnode->GetName(), currentnode->visitedWeight);
-		if ( currentnode->bEndPoint )
+	Graph.StartNode(startnode) = startnode;
+	Graph.PushOpen(Graph.GetWeight(startnode), startnode);
+	INT currentnode;
+	while ( (currentnode = Graph.PopOpen()) != INDEX_NONE )
+	{
+		if ( !Graph.Close(currentnode) )
+			continue; //already reached with a lower weight
+		Graph.NumExpanded++;
+		FNavNode& Node = Graph.Nodes(currentnode);
+		INT currentWeight = Graph.GetWeight(currentnode);
+		//debugf(NAME_DevPath,"Distance to %s is %d", Node.Nav->GetName(), currentWeight);
+		if ( Graph.IsEndPoint(currentnode) )
 		{
-			//debugf("start path is %s",currentnode->GetName());
-			currentnode->startPath = currentnode;
-			currentnode->previousPath = NULL;
+			//debugf("start path is %s",Node.Nav->GetName());
+			Graph.StartNode(currentnode) = currentnode;
+			Graph.Previous(currentnode) = INDEX_NONE;
 		}
 
-		if ( currentnode->IsA(AInventorySpot::StaticClass()) )
+		if ( Node.bInventorySpot )
 		{
-			AInventory* item = ((AInventorySpot *)currentnode)->markedItem;
-			//if ( item )
-			//	debugf(NAME_DevPath,"looking at %s with weight %f (dist %d) (and touch %d with latent %f)", item->GetName(), item->eventBotDesireability(this)/currentnode->visitedWeight, currentnode->visitedWeight, item->IsProbing(NAME_Touch), item->LatentFloat );
+			AInventory* item = ((AInventorySpot *)Node.Nav)->markedItem;
 			if ( item && (item->IsProbing(NAME_Touch) || (bPredictRespawns && (item->LatentFloat < 5.0))) 
-					&& (item->MaxDesireability/currentnode->visitedWeight > bestInventoryWeight) )
+					&& (item->MaxDesireability/currentWeight > bestInventoryWeight) )
 			{
-				FLOAT thisItemWeight = item->eventBotDesireability(this)/currentnode->visitedWeight;
-				// debugf(NAME_DevPath,"looking at %s with weight %f (dist %d) (and touch %d with latent %f)", item->GetName(), thisItemWeight, currentnode->visitedWeight, item->IsProbing(NAME_Touch), item->LatentFloat );
+				FLOAT thisItemWeight = item->eventBotDesireability(this)/currentWeight;
+				// debugf(NAME_DevPath,"looking at %s with weight %f (dist %d) (and touch %d with latent %f)", item->GetName(), thisItemWeight, currentWeight, item->IsProbing(NAME_Touch), item->LatentFloat );
 				if ( thisItemWeight > bestInventoryWeight )
 				{
 					bestInventoryWeight = thisItemWeight;
-					bestPath = currentnode->startPath;
 					BestDest = currentnode;
 				}
 			} 
 		}
 
-		int i = 0;
-		int nextweight = 0;
-		while ( i<16 )
+		for ( INT i=0; i<Node.NumOut; i++ )
 		{
-			ANavigationPoint* endnode = NULL;
-			if ( currentnode->Paths[i] == -1 )
-				i = 16;
-			else
+			FNavEdge& Edge = Graph.OutEdges(Node.FirstOut + i);
+			if ( Edge.Supports(iRadius, iHeight, moveFlags) )
 			{
-				spec = &GetLevel()->ReachSpecs(currentnode->Paths[i]);
-				//debugf(NAME_DevPath,"check path from %s to %s with %d, %d",spec->Start->GetName(), spec->End->GetName(), spec->CollisionRadius, spec->CollisionHeight);
-				if (spec->supports(iRadius, iHeight, moveFlags))
+				INT endnode = Edge.Node;
+				int newVisit = Edge.Distance + Graph.GetCost(endnode) + currentWeight;
+				//debugf(NAME_DevPath,"Path from %s to %s costs %d", Node.Nav->GetName(), Graph.Nodes(endnode).Nav->GetName(), newVisit);
+				if ( Graph.GetWeight(endnode) > newVisit )
 				{
-					endnode = (ANavigationPoint* )spec->End;
-					nextweight = spec->distance;
-				}
-				i++;
-			}
-			if ( endnode )
-			{
-				nextweight += endnode->cost;
-				int newVisit = nextweight + currentnode->visitedWeight; // + endnode->bEndPoint * endnode->bestPathWeight; 
-				//debugf(NAME_DevPath,"Path from %s to %s costs %d total %d", spec->Start->GetName(), spec->End->GetName(), nextweight, newVisit);
-				if ( endnode->visitedWeight > newVisit )
-				{
-					endnode->startPath = currentnode->startPath;
-					endnode->previousPath = currentnode;
-					if ( endnode->prevOrdered ) //remove from old position
-					{
-						endnode->prevOrdered->nextOrdered = endnode->nextOrdered;
-						if (endnode->nextOrdered)
-							endnode->nextOrdered->prevOrdered = endnode->prevOrdered;
-						if ( BinTree == endnode )
-						{
-							if ( endnode->prevOrdered->visitedWeight > newVisit )
-								BinTree = endnode->prevOrdered;
-						}
-						else if ( (endnode->visitedWeight > BinTree->visitedWeight)
-							&& (newVisit < BinTree->visitedWeight) )
-							realSplit--;	
-					}
-					else if ( newVisit > BinTree->visitedWeight )
-						realSplit++;
-					else
-						realSplit--;
-					//debugf(NAME_DevPath,"find spot for %s with BinTree = %s",endnode->GetName(), BinTree->GetName());
-					endnode->visitedWeight = newVisit;
-					if (  BinTree->visitedWeight < endnode->visitedWeight )
-						nextnode = BinTree;
-					else
-						nextnode = currentnode;
-					//debugf(NAME_DevPath," start at %s with %d to place %s with %d",nextnode->GetName(),nextnode->visitedWeight, endnode->GetName(), endnode->visitedWeight);
-					int numList = 0; //TEMP FIXME
-					while ( nextnode->nextOrdered && (nextnode->nextOrdered->visitedWeight < endnode->visitedWeight) )
-					{
-						numList++;
-						if ( numList > 500 )
-						{
-							//debugf("Breadth path list %d", numList);
-							return 0;
-						}
-						nextnode = nextnode->nextOrdered;
-					}
-					if (nextnode->nextOrdered != endnode)
-					{
-						if (nextnode->nextOrdered)
-							nextnode->nextOrdered->prevOrdered = endnode;
-						endnode->nextOrdered = nextnode->nextOrdered;
-						nextnode->nextOrdered = endnode;
-						endnode->prevOrdered = nextnode;
-					}
+					Graph.SetWeight(endnode, newVisit, currentnode);
+					Graph.StartNode(endnode) = Graph.StartNode(currentnode);
+					Graph.PushOpen(newVisit, endnode);
 				}
 			}
 		}
-		realSplit++;
-		int move = (int)(0.5 * realSplit);
-		while ( p < move )
-		{
-			p++;
-			if (BinTree->nextOrdered)
-				BinTree = BinTree->nextOrdered;
-		}
 
 		n++;
 		if ( n > 250 )
 		{
 			// debugf("exceeded 250 nodes!");
 			if ( bestInventoryWeight > 0 )
-			{
-				ReverseRouteFor(BestDest);
-				return bestInventoryWeight;
-			}
+				break;
 			else
 				n = 200;
 		}
-
-		//}
-		//debugf(NAME_DevPath,"Done with %s",currentnode->GetName());
-		currentnode = currentnode->nextOrdered;
 	}
-	ReverseRouteFor(BestDest);
+	if ( BestDest != INDEX_NONE )
+	{
+		Graph.LinkRouteReversed(BestDest);
+		bestPath = Graph.Nodes(Graph.StartNode(BestDest)).Nav;
+	}
 	return bestInventoryWeight;
 	
 	unguard;
@@ -526,6 +526,8 @@ void AActor::execPlayAnim( FFrame& Stack, RESULT_DECL )
 		}
 		else Stack.Logf( TEXT("PlayAnim: Sequence '%s' not found in Mesh '%s'"), *SequenceName, Mesh->GetName() );
 	} else Stack.Logf( TEXT("PlayAnim: No mesh") );
+	if( GetLevel()->TickScheduler )
+		GetLevel()->TickScheduler->Wake( this );
 	unguardexecSlow;
 }
 
@@ -610,6 +612,8 @@ void AActor::execLoopAnim( FFrame& Stack, RESULT_DECL )
 		}
 		else Stack.Logf( TEXT("LoopAnim: Sequence '%s' not found in Mesh '%s'"), *SequenceName, Mesh->GetName() );
 	} else Stack.Logf( TEXT("LoopAnim: No mesh") );
+	if( GetLevel()->TickScheduler )
+		GetLevel()->TickScheduler->Wake( this );
 	unguardexecSlow;
 }
 
@@ -655,6 +659,8 @@ void AActor::execTweenAnim( FFrame& Stack, RESULT_DECL )
 		}
 		else Stack.Logf( TEXT("TweenAnim: Sequence '%s' not found in Mesh '%s'"), *SequenceName, Mesh->GetName() );
 	} else Stack.Logf( TEXT("TweenAnim: No mesh") );
+	if( GetLevel()->TickScheduler )
+		GetLevel()->TickScheduler->Wake( this );
 	unguardexecSlow;
 }
 
@@ -1124,6 +1130,8 @@ void AActor::execSetTimer( FFrame& Stack, RESULT_DECL )
 	TimerCounter = 0.0;
 	TimerRate    = NewTimerRate;
 	bTimerLoop   = bLoop;
+	if( GetLevel()->TickScheduler )
+		GetLevel()->TickScheduler->Wake( this );
 
 	unguardexecSlow;
 }
@@ -1181,11 +1189,24 @@ void AActor::execAllActors( FFrame& Stack, RESULT_DECL )
 	P_FINISH;
 
 	BaseClass = BaseClass ? BaseClass : AActor::StaticClass();
-	INT iActor=0;
+	INT iActor=0, iCandidate=0;
+
+	// Visit only indexed actors of the class, then any spawned during the loop.
+	TArray<INT> Candidates;
+	FActorClassIndex* Index = GetLevel()->GetClassIndex();
+	if( Index && Index->Gather( GetLevel(), BaseClass, Candidates ) )
+		iActor = GetLevel()->Actors.Num();
 
 	PRE_ITERATOR;
 		// Fetch next actor in the iteration.
 		*OutActor = NULL;
+		while( iCandidate<Candidates.Num() && *OutActor==NULL )
+		{
+			INT i = Candidates(iCandidate++);
+			AActor* TestActor = i<GetLevel()->Actors.Num() ? GetLevel()->Actors(i) : NULL;
+			if(	TestActor && TestActor->IsA(BaseClass) && (TagName==NAME_None || TestActor->Tag==TagName) )
+				*OutActor = TestActor;
+		}
 		while( iActor<GetLevel()->Actors.Num() && *OutActor==NULL )
 		{
 			AActor* TestActor = GetLevel()->Actors(iActor++);
@@ -1211,11 +1232,24 @@ void AActor::execChildActors( FFrame& Stack, RESULT_DECL )
 	P_FINISH;
 
 	BaseClass = BaseClass ? BaseClass : AActor::StaticClass();
-	INT iActor=0;
+	INT iActor=0, iCandidate=0;
+
+	// Visit only indexed actors of the class, then any spawned during the loop.
+	TArray<INT> Candidates;
+	FActorClassIndex* Index = GetLevel()->GetClassIndex();
+	if( Index && Index->Gather( GetLevel(), BaseClass, Candidates ) )
+		iActor = GetLevel()->Actors.Num();
 
 	PRE_ITERATOR;
 		// Fetch next actor in the iteration.
 		*OutActor = NULL;
+		while( iCandidate<Candidates.Num() && *OutActor==NULL )
+		{
+			INT i = Candidates(iCandidate++);
+			AActor* TestActor = i<GetLevel()->Actors.Num() ? GetLevel()->Actors(i) : NULL;
+			if(	TestActor && TestActor->IsA(BaseClass) && TestActor->IsOwnedBy( this ) )
+				*OutActor = TestActor;
+		}
 		while( iActor<GetLevel()->Actors.Num() && *OutActor==NULL )
 		{
 			AActor* TestActor = GetLevel()->Actors(iActor++);
@@ -1340,11 +1374,26 @@ void AActor::execRadiusActors( FFrame& Stack, RESULT_DECL )
 	P_FINISH;
 
 	BaseClass = BaseClass ? BaseClass : AActor::StaticClass();
-	INT iActor=0;
+	INT iActor=0, iCandidate=0;
+
+	// Visit only actors near the location, then any spawned during the loop.
+	TArray<AActor*> Candidates;
+	FActorBroadphase* Broadphase = GetLevel()->GetBroadphase();
+	if( Broadphase && Broadphase->Gather( GetLevel(), TraceLocation, Radius, 1, Candidates ) )
+		iActor = GetLevel()->Actors.Num();
 
 	PRE_ITERATOR;
 		// Fetch next actor in the iteration.
 		*OutActor = NULL;
+		while( iCandidate<Candidates.Num() && *OutActor==NULL )
+		{
+			AActor* TestActor = Candidates(iCandidate++);
+			if
+			(	!TestActor->bDeleteMe
+			&&	TestActor->IsA(BaseClass) 
+			&&	(TestActor->Location - TraceLocation).SizeSquared() < Square(Radius + TestActor->CollisionRadius) )
+				*OutActor = TestActor;
+		}
 		while( iActor<GetLevel()->Actors.Num() && *OutActor==NULL )
 		{
 			AActor* TestActor = GetLevel()->Actors(iActor++);
@@ -1375,11 +1424,28 @@ void AActor::execVisibleActors( FFrame& Stack, RESULT_DECL )
 	P_FINISH;
 
 	BaseClass = BaseClass ? BaseClass : AActor::StaticClass();
-	INT iActor=0;
+	INT iActor=0, iCandidate=0;
+
+	// Visit only actors within the radius, if there is one, then any spawned during the loop.
+	TArray<AActor*> Candidates;
+	FActorBroadphase* Broadphase = Radius!=0.0 ? GetLevel()->GetBroadphase() : NULL;
+	if( Broadphase && Broadphase->Gather( GetLevel(), TraceLocation, Radius, 0, Candidates ) )
+		iActor = GetLevel()->Actors.Num();
 
 	PRE_ITERATOR;
 		// Fetch next actor in the iteration.
 		*OutActor = NULL;
+		while( iCandidate<Candidates.Num() && *OutActor==NULL )
+		{
+			AActor* TestActor = Candidates(iCandidate++);
+			if
+			(	!TestActor->bDeleteMe
+			&& !TestActor->bHidden
+			&&	TestActor->IsA(BaseClass)
+			&&	(TestActor->Location-TraceLocation).SizeSquared() < Square(Radius)
+			&&	GetLevel()->Model->FastLineCheck(TestActor->Location, TraceLocation) )
+				*OutActor = TestActor;
+		}
 		while( iActor<GetLevel()->Actors.Num() && *OutActor==NULL )
 		{
 			AActor* TestActor = GetLevel()->Actors(iActor++);
@@ -1415,7 +1481,7 @@ void AActor::execVisibleCollidingActors( FFrame& Stack, RESULT_DECL )
 	Radius = Radius ? Radius : 1000;
 	BaseClass = BaseClass ? BaseClass : AActor::StaticClass();
 	FMemMark Mark(GMem);
-	FCheckResult* Link=GetLevel()->Hash->ActorRadiusCheck( GMem, TraceLocation, Radius, 0 );
+	FCheckResult* Link = GetLevel()->Hash ? GetLevel()->Hash->ActorRadiusCheck( GMem, TraceLocation, Radius, 0 ) : NULL;
 	
 	PRE_ITERATOR;
 		// Fetch next actor in the iteration.
@@ -1499,6 +1565,8 @@ void AActor::ProcessState( FLOAT DeltaSeconds )
 		guard(AActor::ProcessState);
 		if( ++GScriptEntryTag==1 )
 			clock(GScriptCycles);
+		if( GScriptProfiler )
+			GScriptProfiler->Enter( this, OldStateNode );
 
 		// If a latent action is in progress, update it.
 		if( GetStateFrame()->LatentAction )
@@ -1520,12 +1588,36 @@ void AActor::ProcessState( FLOAT DeltaSeconds )
 				}
 			}
 		}
+		if( GScriptProfiler )
+			GScriptProfiler->Exit();
 		if( --GScriptEntryTag==0 )
 			unclock(GScriptCycles);
 		unguardf(( TEXT("Object %s, Old State %s, New State %s"), GetFullName(), OldStateNode->GetFullName(), GetStateFrame()->StateNode->GetFullName() ));
 	}
 }
 
+//
+// Changing state or label can give a dormant actor work to do.
+//
+EGotoState AActor::GotoState( FName NewState )
+{
+	guardSlow(AActor::GotoState);
+	EGotoState Result = UObject::GotoState( NewState );
+	if( XLevel && XLevel->TickScheduler )
+		XLevel->TickScheduler->Wake( this );
+	return Result;
+	unguardSlow;
+}
+INT AActor::GotoLabel( FName Label )
+{
+	guardSlow(AActor::GotoLabel);
+	INT Result = UObject::GotoLabel( Label );
+	if( XLevel && XLevel->TickScheduler )
+		XLevel->TickScheduler->Wake( this );
+	return Result;
+	unguardSlow;
+}
+
 //
 // Internal RPC calling.
 //
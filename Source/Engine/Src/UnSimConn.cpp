@@ -0,0 +1,425 @@
+/*=============================================================================
+	UnSimConn.cpp: Simulated client connections for server load testing.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+#include "UnNet.h"
+
+// Size of a UDP header, for byte accounting.
+#define SIM_PACKET_OVERHEAD (28)
+#define SIM_MAX_PACKET      (512)
+
+// Seconds a simulated client dwells at one viewpoint.
+#define SIM_VIEW_DWELL      (4.0)
+
+ENGINE_API FNetLoadTest GNetLoad;
+
+/*-----------------------------------------------------------------------------
+	USimClientConnection.
+-----------------------------------------------------------------------------*/
+
+USimClientConnection::USimClientConnection( UNetDriver* InDriver, INT InSimIndex, UBOOL InScripted )
+:	UNetConnection	( InDriver, FURL() )
+,	SimIndex		( InSimIndex )
+,	Scripted		( InScripted )
+,	Stage			( SIM_Hello )
+,	ClientPacketId	( 0 )
+,	ClientReliable	( 0 )
+,	ViewPoint		( NULL )
+,	ViewTime		( 0.0 )
+,	ReceivedBytes	( 0 )
+,	ReceivedPackets	( 0 )
+{
+	guard(USimClientConnection::USimClientConnection);
+
+	State			= USOCK_Open;
+	MaxPacket		= SIM_MAX_PACKET;
+	PacketOverhead	= SIM_PACKET_OVERHEAD;
+	URL.Host		= FString::Printf( TEXT("sim%i"), SimIndex );
+	InitOut();
+
+	unguard;
+}
+FString USimClientConnection::LowLevelGetRemoteAddress()
+{
+	guard(USimClientConnection::LowLevelGetRemoteAddress);
+	return FString::Printf( TEXT("127.0.0.%i:%i"), 1 + SimIndex/256, 7777 + SimIndex%256 );
+	unguard;
+}
+FString USimClientConnection::LowLevelDescribe()
+{
+	guard(USimClientConnection::LowLevelDescribe);
+	return FString::Printf
+	(
+		TEXT("%s simulated stage %i recv %i bytes %i packets"),
+		*URL.Host,
+		Stage,
+		ReceivedBytes,
+		ReceivedPackets
+	);
+	unguard;
+}
+
+//
+// A packet sent by the server to this client: note it for acknowledgement.
+//
+void USimClientConnection::LowLevelSend( void* InData, INT Count )
+{
+	guard(USimClientConnection::LowLevelSend);
+	BYTE* Data = (BYTE*)InData;
+	ReceivedBytes += Count + PacketOverhead;
+	ReceivedPackets++;
+
+	// Strip the trailing bit, as UNetConnection::ReceivedRawPacket does.
+	if( Count>0 && Data[Count-1] )
+	{
+		BYTE LastByte = Data[Count-1];
+		INT  BitSize  = Count*8-1;
+		while( !(LastByte & 0x80) )
+		{
+			LastByte *= 2;
+			BitSize--;
+		}
+		FBitReader Reader( Data, BitSize );
+		INT PacketId = Reader.ReadInt( MAX_PACKETID );
+		if( !Reader.IsError() )
+			ClientAcks.AddItem( PacketId );
+	}
+
+	unguard;
+}
+
+//
+// Poll the server side, then run the simulated client.
+//
+void USimClientConnection::Tick()
+{
+	guard(USimClientConnection::Tick);
+	FLOAT DeltaSeconds = Driver->Time - LastTickTime;
+	UNetConnection::Tick();
+	if( State!=USOCK_Closed )
+		ClientTick( DeltaSeconds );
+	unguard;
+}
+
+//
+// Advance the client's handshake, move its viewpoint and send its packet.
+//
+void USimClientConnection::ClientTick( FLOAT DeltaSeconds )
+{
+	guard(USimClientConnection::ClientTick);
+	ULevel* Level = Driver->Notify->NotifyGetLevel();
+	check(Level);
+
+	switch( Stage )
+	{
+		case SIM_Hello:
+		{
+			ClientSendText( *FString::Printf(TEXT("HELLO MINVER=%i VER=%i"), ENGINE_MIN_NET_VERSION, ENGINE_VERSION) );
+			Stage = SIM_Login;
+			break;
+		}
+		case SIM_Login:
+		{
+			// The challenge is issued in response to HELLO.
+			if( Challenge )
+			{
+				ClientSendText( *FString::Printf(TEXT("NETSPEED %i"), GetDefault<UPlayer>()->ConfiguredInternetSpeed) );
+				ClientSendText( *FString::Printf(TEXT("LOGIN RESPONSE=%i URL=%s?Name=SimClient%i"), Level->Engine->ChallengeResponse(Challenge), *Level->URL.Map, SimIndex) );
+				ClientSendText( TEXT("JOIN") );
+				Stage = SIM_Joining;
+			}
+			break;
+		}
+		case SIM_Joining:
+		{
+			if( Actor )
+				Stage = SIM_Playing;
+			break;
+		}
+		case SIM_Playing:
+		{
+			if( Actor )
+				ClientMoveView( DeltaSeconds );
+			break;
+		}
+	}
+
+	// Acknowledge what the server sent and send any queued text.
+	ClientFlush();
+
+	unguard;
+}
+
+//
+// Queue text for the client's control channel.
+//
+void USimClientConnection::ClientSendText( const TCHAR* Text )
+{
+	guard(USimClientConnection::ClientSendText);
+	new(ClientText)FString( Text );
+	unguard;
+}
+
+//
+// Build client packets exactly as UNetConnection::SendRawBunch and SendAck
+// would, and deliver them to the server connection, until every pending ack
+// and text string has been sent.  Nothing is sent when nothing is pending;
+// the server's own keepalives are acked, which keeps the connection alive.
+//
+void USimClientConnection::ClientFlush()
+{
+	guard(USimClientConnection::ClientFlush);
+	while( ClientAcks.Num() || ClientText.Num() )
+	{
+		FBitWriter Packet( MaxPacket*8 );
+		Packet.WriteInt( ClientPacketId, MAX_PACKETID );
+		ClientPacketId = (ClientPacketId + 1) % MAX_PACKETID;
+
+		// Acknowledge everything the server sent.
+		INT AckBits = appCeilLogTwo(MAX_PACKETID)+1;
+		while( ClientAcks.Num() && Packet.GetNumBits()+AckBits+MAX_PACKET_TRAILER_BITS<=MaxPacket*8 )
+		{
+			Packet.WriteBit( 1 );
+			Packet.WriteInt( ClientAcks(0), MAX_PACKETID );
+			ClientAcks.Remove( 0 );
+		}
+
+		// Send control text, one reliable bunch per string.
+		while( ClientText.Num() )
+		{
+			FBitWriter Data( MaxPacket*8 );
+			Data << ClientText(0);
+			check(!Data.IsError());
+
+			UBOOL bOpen = (ClientReliable==0);
+			FBitWriter Header( MAX_BUNCH_HEADER_BITS );
+			Header.WriteBit( 0 );
+			Header.WriteBit( bOpen );
+			if( bOpen )
+			{
+				Header.WriteBit( 1 );
+				Header.WriteBit( 0 );
+			}
+			Header.WriteBit( 1 );
+			Header.WriteInt( 0, MAX_CHANNELS );
+			Header.WriteInt( (ClientReliable+1) % MAX_CHSEQUENCE, MAX_CHSEQUENCE );
+			Header.WriteInt( CHTYPE_Control, CHTYPE_MAX );
+			Header.WriteInt( Data.GetNumBits(), MaxPacket*8 );
+			check(!Header.IsError());
+			if( Packet.GetNumBits()+Header.GetNumBits()+Data.GetNumBits()+MAX_PACKET_TRAILER_BITS > MaxPacket*8 )
+				break;
+
+			Packet.SerializeBits( Header.GetData(), Header.GetNumBits() );
+			Packet.SerializeBits( Data.GetData(), Data.GetNumBits() );
+			ClientReliable++;
+			ClientText.Remove( 0 );
+		}
+
+		// Terminate and deliver.
+		Packet.WriteBit( 1 );
+		while( Packet.GetNumBits() & 7 )
+			Packet.WriteBit( 0 );
+		check(!Packet.IsError());
+		ReceivedRawPacket( Packet.GetData(), Packet.GetNumBytes() );
+		if( State==USOCK_Closed )
+			break;
+	}
+	unguard;
+}
+
+//
+// Move the player's viewpoint between navigation points.
+//
+void USimClientConnection::ClientMoveView( FLOAT DeltaSeconds )
+{
+	guard(USimClientConnection::ClientMoveView);
+	ALevelInfo* Info = Actor->Level;
+
+	// Pick a new anchor every few seconds.
+	ViewTime -= DeltaSeconds;
+	if( ViewTime<=0.0 && Info->NavigationPointList )
+	{
+		if( Scripted )
+		{
+			// Walk the navigation point list in order, staggered per client.
+			if( !ViewPoint )
+			{
+				ViewPoint = Info->NavigationPointList;
+				for( INT i=0; i<SimIndex && ViewPoint; i++ )
+					ViewPoint = ViewPoint->nextNavigationPoint;
+			}
+			else ViewPoint = ViewPoint->nextNavigationPoint;
+			if( !ViewPoint )
+				ViewPoint = Info->NavigationPointList;
+		}
+		else
+		{
+			// Random walk.
+			INT Count=0;
+			for( ANavigationPoint* N=Info->NavigationPointList; N; N=N->nextNavigationPoint )
+				Count++;
+			INT Pick = appRand() % Count;
+			for( ViewPoint=Info->NavigationPointList; Pick-- > 0; ViewPoint=ViewPoint->nextNavigationPoint );
+		}
+		Actor->GetLevel()->FarMoveActor( Actor, ViewPoint->Location );
+		ViewTime = SIM_VIEW_DWELL;
+	}
+
+	// Keep looking around.
+	Actor->ViewRotation.Yaw += appRound( 16384.0 * DeltaSeconds );
+	if( !Scripted )
+		Actor->ViewRotation.Pitch = appRound( 2048.0 * appSin(Driver->Time + SimIndex) );
+	Actor->Rotation.Yaw = Actor->ViewRotation.Yaw;
+
+	unguard;
+}
+IMPLEMENT_CLASS(USimClientConnection);
+
+/*-----------------------------------------------------------------------------
+	FNetLoadTest.
+-----------------------------------------------------------------------------*/
+
+FNetLoadTest::FNetLoadTest()
+:	Active		( 0 )
+,	NumClients	( 0 )
+,	Duration	( 0.0 )
+{}
+
+//
+// Add simulated clients to the level's net driver.
+//
+void FNetLoadTest::Start( ULevel* Level, INT Count, UBOOL Scripted, FLOAT Seconds, FOutputDevice& Ar )
+{
+	guard(FNetLoadTest::Start);
+	UNetDriver* Driver = Level->NetDriver;
+	if( !Driver || Driver->ServerConnection )
+	{
+		Ar.Log( TEXT("NETLOAD requires a listening server") );
+		return;
+	}
+	if( Active )
+		Stop( Level, Ar );
+
+	for( INT i=0; i<Count; i++ )
+	{
+		USimClientConnection* Connection = new USimClientConnection( Driver, i, Scripted );
+		Driver->Notify->NotifyAcceptedConnection( Connection );
+		Driver->ClientConnections.AddItem( Connection );
+	}
+
+	Active					= 1;
+	NumClients				= Count;
+	Duration				= Seconds;
+	StartTime				= appSeconds();
+	LastTickTime			= StartTime;
+	ActorsReplicated		= 0;
+	PropertiesReplicated	= 0;
+	FrameTimes.Empty();
+	ActorTimes.Empty();
+	NetTimes.Empty();
+	Ar.Logf( TEXT("NETLOAD started %i %s clients on %s"), Count, Scripted ? TEXT("scripted") : TEXT("random"), *Level->URL.Map );
+
+	unguard;
+}
+
+//
+// Report and disconnect all simulated clients.
+//
+void FNetLoadTest::Stop( ULevel* Level, FOutputDevice& Ar )
+{
+	guard(FNetLoadTest::Stop);
+	if( !Active )
+		return;
+	Report( Level, Ar );
+	if( Level->NetDriver )
+		for( INT i=0; i<Level->NetDriver->ClientConnections.Num(); i++ )
+			if( Level->NetDriver->ClientConnections(i)->IsA(USimClientConnection::StaticClass()) )
+				Level->NetDriver->ClientConnections(i)->State = USOCK_Closed;
+	Active = 0;
+	unguard;
+}
+
+//
+// Called from ULevel::TickNetServer after all clients were updated.
+//
+void FNetLoadTest::Tick( ULevel* Level, INT Updated )
+{
+	guard(FNetLoadTest::Tick);
+	DOUBLE Now = appSeconds();
+	FrameTimes.Add( 1000.0 * (Now - LastTickTime) );
+	ActorTimes.Add( 1000.0 * GSecondsPerCycle * Level->ActorTickCycles );
+	NetTimes.Add( 1000.0 * GSecondsPerCycle * Level->NetTickCycles );
+	ActorsReplicated     += Updated;
+	PropertiesReplicated += Level->NumReps;
+	LastTickTime          = Now;
+	if( Duration>0.0 && Now-StartTime>Duration )
+		Stop( Level, *GLog );
+	unguard;
+}
+
+//
+// Print the statistics gathered so far.
+//
+void FNetLoadTest::Report( ULevel* Level, FOutputDevice& Ar )
+{
+	guard(FNetLoadTest::Report);
+	FLOAT Seconds = Max( appSeconds() - StartTime, 0.001 );
+
+	INT Joined=0, TotalBytes=0;
+	if( Level->NetDriver )
+	{
+		for( INT i=0; i<Level->NetDriver->ClientConnections.Num(); i++ )
+		{
+			USimClientConnection* Connection = Cast<USimClientConnection>( Level->NetDriver->ClientConnections(i) );
+			if( Connection )
+			{
+				Joined     += Connection->Stage==USimClientConnection::SIM_Playing;
+				TotalBytes += Connection->ReceivedBytes;
+			}
+		}
+	}
+
+	Ar.Logf( TEXT("NETLOAD %s: %i/%i clients in game, %.1f seconds"), *Level->URL.Map, Joined, NumClients, Seconds );
+	Ar.Logf( TEXT("   Frame ms: %s"), *FrameTimes.Describe() );
+	Ar.Logf( TEXT("   Actor ms: %s"), *ActorTimes.Describe() );
+	Ar.Logf( TEXT("   Net ms:   %s"), *NetTimes.Describe() );
+	Ar.Logf( TEXT("   Bytes/client/sec: %.1f"), NumClients ? TotalBytes / Seconds / NumClients : 0.f );
+	Ar.Logf( TEXT("   Actors replicated/sec: %.1f  Properties replicated/sec: %.1f"), ActorsReplicated / Seconds, PropertiesReplicated / Seconds );
+
+	unguard;
+}
+
+//
+// Console interface: NETLOAD START [COUNT=n] [SECONDS=n] [SCRIPTED], NETLOAD STOP, NETLOAD REPORT.
+//
+UBOOL FNetLoadTest::Exec( ULevel* Level, const TCHAR* Cmd, FOutputDevice& Ar )
+{
+	guard(FNetLoadTest::Exec);
+	if( !ParseCommand(&Cmd,TEXT("NETLOAD")) )
+		return 0;
+	if( ParseCommand(&Cmd,TEXT("START")) )
+	{
+		INT   Count   = 16;
+		FLOAT Seconds = 0.0;
+		Parse( Cmd, TEXT("COUNT="), Count );
+		Parse( Cmd, TEXT("SECONDS="), Seconds );
+		Start( Level, Clamp(Count,1,256), ParseParam(Cmd,TEXT("SCRIPTED")), Seconds, Ar );
+	}
+	else if( ParseCommand(&Cmd,TEXT("STOP")) )
+	{
+		Stop( Level, Ar );
+	}
+	else if( Active )
+	{
+		Report( Level, Ar );
+	}
+	else Ar.Log( TEXT("NETLOAD not running") );
+	return 1;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
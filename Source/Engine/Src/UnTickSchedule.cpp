@@ -0,0 +1,211 @@
+/*=============================================================================
+	UnTickSchedule.cpp: Scheduling of actor ticks.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "EnginePrivate.h"
+
+/*-----------------------------------------------------------------------------
+	FTickScheduler.
+-----------------------------------------------------------------------------*/
+
+FTickScheduler::FTickScheduler()
+:	iRecheck		( 0 )
+,	bTickedActors	( 0 )
+,	NumTicked		( 0 )
+,	NumSkipped		( 0 )
+,	NumSleeps		( 0 )
+,	NumWakes		( 0 )
+,	NumRechecks		( 0 )
+{}
+
+//
+// Schedule every dynamic actor to be ticked, in actor list order.  They go
+// to sleep the first time they come up with nothing to do.
+//
+void FTickScheduler::Build( ULevel* Level )
+{
+	guard(FTickScheduler::Build);
+	Active.Empty();
+	Dormant.Empty();
+	iRecheck = 0;
+	for( INT iActor=0; iActor<Level->Actors.Num(); iActor++ )
+	{
+		AActor* Actor = Level->Actors(iActor);
+		if( !Actor )
+			continue;
+		Actor->OtherTag = TICKSCHED_None;
+		if( iActor>=Level->iFirstDynamicActor && !Actor->bDeleteMe )
+			AddActor( Actor );
+	}
+	unguard;
+}
+
+void FTickScheduler::AddActor( AActor* Actor )
+{
+	guardSlow(FTickScheduler::AddActor);
+	Actor->OtherTag = TICKSCHED_Active;
+	Active.AddItem( Actor );
+	unguardSlow;
+}
+
+//
+// Unschedule a destroyed actor.  It's dropped from the active list when the
+// tick loop next reaches it.
+//
+void FTickScheduler::RemoveActor( AActor* Actor )
+{
+	guardSlow(FTickScheduler::RemoveActor);
+	if( IsDormant(Actor) )
+		Unsleep( Actor );
+	Actor->OtherTag = TICKSCHED_None;
+	unguardSlow;
+}
+
+//
+// Put a dormant actor back in the tick loop.  It's ticked this frame if the
+// loop hasn't finished yet.
+//
+void FTickScheduler::Wake( AActor* Actor )
+{
+	guardSlow(FTickScheduler::Wake);
+	if( IsDormant(Actor) )
+	{
+		Unsleep( Actor );
+		AddActor( Actor );
+		NumWakes++;
+
+		// Actors it owns wait for it to be ticked first.
+		Actor->bTicked = bTickedActors ? Actor->GetLevel()->Ticked : !Actor->GetLevel()->Ticked;
+	}
+	unguardSlow;
+}
+
+void FTickScheduler::Sleep( AActor* Actor )
+{
+	guardSlow(FTickScheduler::Sleep);
+	Actor->OtherTag = TICKSCHED_Dormant + Dormant.Num();
+	Dormant.AddItem( Actor );
+	NumSleeps++;
+	unguardSlow;
+}
+
+void FTickScheduler::Unsleep( AActor* Actor )
+{
+	guardSlow(FTickScheduler::Unsleep);
+	INT     i    = Actor->OtherTag - TICKSCHED_Dormant;
+	AActor* Last = Dormant( Dormant.Num()-1 );
+	check(Dormant(i)==Actor);
+	Dormant(i)      = Last;
+	Last->OtherTag  = TICKSCHED_Dormant + i;
+	Dormant.Remove( Dormant.Num()-1 );
+	Actor->OtherTag = TICKSCHED_None;
+	unguardSlow;
+}
+
+//
+// Whether ticking an actor would do nothing.  Pawns always have work.
+//
+UBOOL FTickScheduler::CanSleep( AActor* Actor )
+{
+	return
+		!Actor->bIsPawn
+	&&	!Actor->bAlwaysTick
+	&&	Actor->Physics==PHYS_None
+	&&	Actor->TimerRate<=0.0
+	&&	Actor->LifeSpan==0.0
+	&&	Actor->RemoteRole!=ROLE_AutonomousProxy
+	&&	!Actor->IsAnimating()
+	&&	(!Actor->GetStateFrame() || (!Actor->GetStateFrame()->Code && !Actor->GetStateFrame()->LatentAction))
+	&&	!Actor->IsProbing( NAME_Tick );
+}
+
+//
+// Wake the next few dormant actors if they've been given work by script,
+// so every one is looked at within sixteen frames.
+//
+void FTickScheduler::Recheck()
+{
+	guardSlow(FTickScheduler::Recheck);
+	INT Count = Min( Dormant.Num(), 8 + Dormant.Num()/16 );
+	for( INT n=0; n<Count; n++ )
+	{
+		if( iRecheck>=Dormant.Num() )
+			iRecheck = 0;
+		AActor* Actor = Dormant(iRecheck);
+		NumRechecks++;
+		if( CanSleep(Actor) )
+			iRecheck++;
+		else
+			Wake( Actor );
+	}
+	unguardSlow;
+}
+
+//
+// Tick the active actors, putting to sleep any with nothing to do.
+//
+INT FTickScheduler::TickActors( ULevel* Level, FLOAT DeltaSeconds, ELevelTick TickType )
+{
+	guard(FTickScheduler::TickActors);
+	bTickedActors = 0;
+	Recheck();
+
+	// Actors woken during the loop are appended and ticked this frame.
+	INT Updated=0, Kept=0;
+	NumTicked = 0;
+	for( INT i=0; i<Active.Num(); i++ )
+	{
+		AActor* Actor = Active(i);
+		if( Actor->OtherTag!=TICKSCHED_Active || Actor->bDeleteMe )
+			continue;
+		if( CanSleep(Actor) )
+		{
+			Sleep( Actor );
+			continue;
+		}
+		Active(Kept++) = Actor;
+		Updated += Actor->Tick( DeltaSeconds, TickType );
+		NumTicked++;
+	}
+	Active.Remove( Kept, Active.Num()-Kept );
+	NumSkipped    = Dormant.Num();
+	bTickedActors = 1;
+	return Updated;
+	unguard;
+}
+
+//
+// Drop destroyed actors before they are deleted.
+//
+void FTickScheduler::Purge()
+{
+	guard(FTickScheduler::Purge);
+	INT Kept=0;
+	for( INT i=0; i<Active.Num(); i++ )
+		if( Active(i)->OtherTag==TICKSCHED_Active && !Active(i)->bDeleteMe )
+			Active(Kept++) = Active(i);
+	Active.Remove( Kept, Active.Num()-Kept );
+	unguard;
+}
+
+FString FTickScheduler::Describe() const
+{
+	guard(FTickScheduler::Describe);
+	return FString::Printf
+	(
+		TEXT("%i active, %i dormant, last frame ticked %i and skipped %i, %i sleeps, %i wakes, %i rechecks"),
+		Active.Num(),
+		Dormant.Num(),
+		NumTicked,
+		NumSkipped,
+		NumSleeps,
+		NumWakes,
+		NumRechecks
+	);
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
@@ -30,6 +30,7 @@ var IpAddr	  RemoteAddr;	// Contains address of peer connected to from a Listen(
 // events to track your children.
 var class<TcpLink> AcceptClass;
 var const Array<byte> SendFIFO; // send fifo
+var const int SendFileBytes;    // bytes of SendFIFO up to the end of the last SendFile
 //-----------------------------------------------------------------------------
 // natives.
 
@@ -56,6 +57,11 @@ native function int SendText( coerce string Str );
 // SendBinary: Send data as a byte array.
 native function int SendBinary( int Count, byte B[255] );
 
+// SendFile: Queues a whole file to be sent, as fast as the connection
+// will take it.  Returns the number of bytes queued, or -1 if the file
+// couldn't be read.  SentFile() is called once it has all gone.
+native function int SendFile( string Filename );
+
 // ReadText: Reads text string.
 // Returns number of bytes read.  
 native function int ReadText( out string Str );
@@ -84,6 +90,9 @@ event ReceivedLine( string Line );
 // ReceivedBinary: Called when data is received and connection mode is MODE_Binary.
 event ReceivedBinary( int Count, byte B[255] );
 
+// SentFile: Called when everything queued by SendFile has been sent.
+event SentFile();
+
 defaultproperties
 {
      bAlwaysTick=True
@@ -10,6 +10,15 @@ class UdpLink extends InternetLink
 
 var() const int BroadcastAddr;
 
+// Server query cache.  Responses captured between BeginQueryCache and
+// EndQueryCache are sent again natively, without calling ReceivedText,
+// when the same query arrives before they expire.
+var bool  bCacheQueries;		// Answer repeated queries from the cache.
+var int   QueryGeneration;		// Increment to invalidate all cached responses.
+var float QueryCacheLifetime;	// Seconds a cached response stays valid.
+var int   QueryRateLimit;		// Queries per second accepted from one address, 0 for no limit.
+var private native const int PrivateQueryCache;
+
 //-----------------------------------------------------------------------------
 // Natives.
 
@@ -30,6 +39,12 @@ native function int ReadText( out IpAddr Addr, out string Str );
 // ReadBinary: Read data as a byte array.
 native function int ReadBinary( out IpAddr Addr, int Count, out byte B[255] );
 
+// BeginQueryCache: Capture text sent from now on as the response to Query.
+native function BeginQueryCache( string Query );
+
+// EndQueryCache: Store the captured response in the query cache.
+native function EndQueryCache();
+
 //-----------------------------------------------------------------------------
 // Events.
 
@@ -46,4 +61,5 @@ defaultproperties
 {
      bAlwaysTick=True
 	 BroadcastAddr=-1;
+	 QueryCacheLifetime=1.0
 }
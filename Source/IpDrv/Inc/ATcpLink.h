@@ -11,6 +11,12 @@
 	void CheckConnectionQueue();
 	void PollConnections();
 	UBOOL FlushSendBuffer();
+	static UBOOL HasSendFile();
+	TArray<BYTE>& SendTail();
+	void RefillSendBuffer();
+	void EmptySendBuffer();
+	INT QueuedBytes();
+	INT QueueFile( const TCHAR* Filename );
 	void ShutdownConnection();
 
 /*-----------------------------------------------------------------------------
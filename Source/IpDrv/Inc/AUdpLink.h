@@ -7,6 +7,10 @@
 	void Destroy();
 	UBOOL Tick( FLOAT DeltaTime, enum ELevelTick TickType );	
 
+	static UBOOL HasQueryCache();
+	class FUdpQueryCache& GetQueryCache();
+	UBOOL FilterQuery( FIpAddr Addr, const FString& Query );
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
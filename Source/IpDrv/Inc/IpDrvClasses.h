@@ -24,6 +24,7 @@ AUTOGENERATE_NAME(ReceivedBinary)
 AUTOGENERATE_NAME(Accepted)
 AUTOGENERATE_NAME(Opened)
 AUTOGENERATE_NAME(Closed)
+AUTOGENERATE_NAME(SentFile)
 
 #ifndef NAMES_ONLY
 
@@ -101,6 +102,13 @@ class IPDRV_API AUdpLink : public AInternetLink
 {
 public:
     INT BroadcastAddr;
+    BITFIELD bCacheQueries:1 GCC_PACK(4);
+    INT QueryGeneration GCC_PACK(4);
+    FLOAT QueryCacheLifetime;
+    INT QueryRateLimit;
+    INT PrivateQueryCache;
+    DECLARE_FUNCTION(execEndQueryCache);
+    DECLARE_FUNCTION(execBeginQueryCache);
     DECLARE_FUNCTION(execReadBinary);
     DECLARE_FUNCTION(execReadText);
     DECLARE_FUNCTION(execSendBinary);
@@ -159,6 +167,9 @@ struct ATcpLink_eventReceivedText_Parms
 {
     FString Text;
 };
+struct ATcpLink_eventSentFile_Parms
+{
+};
 struct ATcpLink_eventClosed_Parms
 {
 };
@@ -175,6 +186,8 @@ public:
     FIpAddr RemoteAddr;
     class UClass* AcceptClass;
     TArray<BYTE> SendFIFO;
+    INT SendFileBytes;
+    DECLARE_FUNCTION(execSendFile);
     DECLARE_FUNCTION(execReadBinary);
     DECLARE_FUNCTION(execReadText);
     DECLARE_FUNCTION(execSendBinary);
@@ -203,6 +216,10 @@ public:
         Parms.Text=Text;
         ProcessEvent(FindFunctionChecked(IPDRV_ReceivedText),&Parms);
     }
+    void eventSentFile()
+    {
+        ProcessEvent(FindFunctionChecked(IPDRV_SentFile),NULL);
+    }
     void eventClosed()
     {
         ProcessEvent(FindFunctionChecked(IPDRV_Closed),NULL);
@@ -221,6 +238,8 @@ public:
 
 #endif
 
+AUTOGENERATE_FUNCTION(AUdpLink,-1,execEndQueryCache);
+AUTOGENERATE_FUNCTION(AUdpLink,-1,execBeginQueryCache);
 AUTOGENERATE_FUNCTION(AUdpLink,-1,execReadBinary);
 AUTOGENERATE_FUNCTION(AUdpLink,-1,execReadText);
 AUTOGENERATE_FUNCTION(AUdpLink,-1,execSendBinary);
@@ -234,6 +253,7 @@ AUTOGENERATE_FUNCTION(AInternetLink,-1,execGetLastError);
 AUTOGENERATE_FUNCTION(AInternetLink,-1,execResolve);
 AUTOGENERATE_FUNCTION(AInternetLink,-1,execParseURL);
 AUTOGENERATE_FUNCTION(AInternetLink,-1,execIsDataPending);
+AUTOGENERATE_FUNCTION(ATcpLink,-1,execSendFile);
 AUTOGENERATE_FUNCTION(ATcpLink,-1,execReadBinary);
 AUTOGENERATE_FUNCTION(ATcpLink,-1,execReadText);
 AUTOGENERATE_FUNCTION(ATcpLink,-1,execSendBinary);
@@ -46,6 +46,7 @@ Revision history:
 #include "Engine.h"
 #include "UnNet.h"
 #include "UnSocket.h"
+#include "UnReactor.h"
 
 /*-----------------------------------------------------------------------------
 	Definitions.
@@ -74,8 +75,23 @@ struct FOperationStats
 	INT BytesSent;
 };
 
+// Server query cache statistics, shared by all UdpLinks.
+struct FUdpQueryStats
+{
+	INT		Hits;			// Queries answered from the cache.
+	INT		Misses;			// Queries passed on to script.
+	INT		Dropped;		// Queries dropped by the rate limit.
+	INT		WindowHits;		// Hits in the current second.
+	DOUBLE	WindowStart;	// Start of the current second.
+	FLOAT	HitsPerSec;		// Hits in the last complete second.
+
+	void Hit( DOUBLE Now );
+	FString Describe();
+};
+
 // Globals.
 extern UBOOL GInitialized;
+extern FUdpQueryStats GUdpQueryStats;
 
 /*-----------------------------------------------------------------------------
 	Host resolution thread.
@@ -17,6 +17,52 @@ Revision history:
 
 IMPLEMENT_CLASS(ATcpLink);
 
+// Small files kept in memory by SendFile.
+#define SENDFILE_CACHE_MAX		65536		// Largest file cached.
+#define SENDFILE_CACHE_TOTAL	4194304		// Most memory the cache may use.
+
+struct FSendFileCache
+{
+	SQWORD			FileTime;
+	TArray<BYTE>	Data;
+};
+static TMap<FString,FSendFileCache*> GSendFileCache;
+static INT GSendFileCacheBytes = 0;
+
+// Larger files are read from disk a chunk at a time as the socket drains.
+// Anything queued behind a streamed file waits in its segment's After.
+#define SENDFILE_CHUNK			65536		// Most of a streamed file buffered at once.
+
+struct FSendFileSegment
+{
+	FArchive*		Ar;			// File being streamed, or NULL once read.
+	INT				Remaining;	// Bytes of it still to read.
+	TArray<BYTE>	After;		// Data queued behind it.
+	~FSendFileSegment()
+	{
+		if( Ar )
+			delete Ar;
+	}
+};
+static TMap<ATcpLink*,TArray<FSendFileSegment*> > GSendFileStreams;
+
+//
+// Whether the loaded TcpLink class has SendFileBytes.  Links are allocated
+// at the script class's size, so with an IpDrv.u built before SendFile the
+// field lies past the end of the object and must not be touched.
+//
+UBOOL ATcpLink::HasSendFile()
+{
+	static INT Result = -1;
+	if( Result<0 )
+	{
+		Result = ATcpLink::StaticClass()->GetPropertiesSize()>=sizeof(ATcpLink);
+		if( !Result )
+			debugf( NAME_Warning, TEXT("IpDrv.u predates TcpLink.SendFile, rebuild it") );
+	}
+	return Result;
+}
+
 //
 // Constructor.
 //
@@ -34,9 +80,16 @@ void ATcpLink::Destroy()
 {
 	guard(ATcpLink::Destroy);
 	if( GetSocket() )
+	{
+		GetSocketReactor().Forget(GetSocket());
 		closesocket(GetSocket());
+	}
 	if( RemoteSocket != INVALID_SOCKET )
+	{
+		GetSocketReactor().Forget(RemoteSocket);
 		closesocket(RemoteSocket);
+	}
+	EmptySendBuffer();
 	Super::Destroy();
 	unguard;
 }
@@ -182,7 +235,7 @@ void ATcpLink::execListen( FFrame& Stack, RESULT_DECL )
 			}
 		}
 		LinkState = STATE_Listening;
-		SendFIFO.Empty();
+		EmptySendBuffer();
 		*(DWORD*)Result = 1;
 		return;
 	}
@@ -200,6 +253,14 @@ UBOOL ATcpLink::Tick( FLOAT DeltaTime, enum ELevelTick TickType )
 	guard(ATcpLink::Tick);
 	UBOOL Result = Super::Tick( DeltaTime, TickType );
 
+	// Have the reactor poll our sockets; they are only ever tested for
+	// readiness through it.
+	FSocketReactor& Reactor = GetSocketReactor();
+	if( GetSocket() && LinkState!=STATE_Initialized && LinkState!=STATE_Ready )
+		Reactor.Watch( GetSocket(), LinkState==STATE_Connecting ? SOCKREADY_Read|SOCKREADY_Write : SOCKREADY_Read );
+	if( RemoteSocket != INVALID_SOCKET )
+		Reactor.Watch( RemoteSocket, SOCKREADY_Read );
+
 	if( GetSocket() )
 	{
 		switch( LinkState )
@@ -234,6 +295,13 @@ UBOOL ATcpLink::Tick( FLOAT DeltaTime, enum ELevelTick TickType )
 		}
 	}
 
+	// Tell script when a SendFile has gone.
+	if( HasSendFile() && SendFileBytes < 0 )
+	{
+		SendFileBytes = 0;
+		eventSentFile();
+	}
+
 	INT* CheckSocket;
 	switch( LinkState )
 	{
@@ -255,21 +323,17 @@ UBOOL ATcpLink::Tick( FLOAT DeltaTime, enum ELevelTick TickType )
 	if (*CheckSocket != INVALID_SOCKET)
 	{
 		// See if the socket needs to be closed.
-		TIMEVAL SelectTime = {0, 0};
-		SOCKET s;
 		int numbytes;
 		char TempBuf[256];
-		fd_set SocketSet;
-		FD_ZERO(&SocketSet);
-		FD_SET( *CheckSocket, &SocketSet );
-		s = select( *CheckSocket + 1, &SocketSet, 0, 0, &SelectTime );
-		if (( s != SOCKET_ERROR ) && ( s != 0 )) {
+		if( Reactor.Ready(*CheckSocket) & SOCKREADY_Read ) {
+			Reactor.CountSyscall();
 			numbytes = recv( *CheckSocket, TempBuf, 1, MSG_PEEK );
 			if (numbytes == 0)
 			{
 				// Disconnect
 				if (LinkState != STATE_Listening)
 					LinkState = STATE_Initialized;
+				Reactor.Forget(*CheckSocket);
 				closesocket(*CheckSocket);
 				*CheckSocket = INVALID_SOCKET;
 				eventClosed();
@@ -280,6 +344,7 @@ UBOOL ATcpLink::Tick( FLOAT DeltaTime, enum ELevelTick TickType )
 					// Socket error, disconnect.
 					if (LinkState != STATE_Listening)
 						LinkState = STATE_Initialized;
+					Reactor.Forget(*CheckSocket);
 					closesocket(*CheckSocket);
 					*CheckSocket = INVALID_SOCKET;
 					eventClosed();
@@ -302,31 +367,29 @@ ATcpLink::CheckConnectionQueue()
 {
 	guard(ATcpLink::CheckConnectionQueue);
 
-	fd_set SocketSet;
-	TIMEVAL SelectTime = {0, 0};
-	INT Error;
 	INT NewSocket;
 	SOCKADDR_IN ForeignHost;
 
-	FD_ZERO( &SocketSet );
-	FD_SET( GetSocket(), &SocketSet );
 	// If listening, check for a queued connection to accept.
-	Error = select( GetSocket() + 1, &SocketSet, 0, 0, &SelectTime);
-	if ( Error == SOCKET_ERROR ) {
-		debugf( NAME_Log, TEXT("CheckConnectionQueue: Error while checking socket status. %i"), WSAGetLastError());
-		return;
-	}
-	if ( Error == 0 ) {
+	FSocketReactor& Reactor = GetSocketReactor();
+	if ( !(Reactor.Ready(GetSocket()) & SOCKREADY_Read) ) {
 		// debugf( NAME_Log, "CheckConnectionQueue: No connections waiting." );
 		return;
 	}
 	socklen_t i = sizeof(SOCKADDR_IN);
+	Reactor.CountSyscall();
 	NewSocket = accept( Socket, (SOCKADDR*) &ForeignHost, &i );
 	if ( NewSocket == INVALID_SOCKET ) {
 		debugf( NAME_Log, TEXT("CheckConnectionQueue: Failed to accept queued connection: %i"), WSAGetLastError() );
 		return;
 	}
 
+	if ( !Reactor.CanWatch(NewSocket) ) {
+		debugf( NAME_Log, TEXT("CheckConnectionQueue: Refusing connection, %s can't poll socket %i"), Reactor.GetName(), NewSocket );
+		closesocket( NewSocket );
+		return;
+	}
+
 	if ( !AcceptClass && RemoteSocket != INVALID_SOCKET ) {
 		debugf( NAME_Log, TEXT("Discarding redundant connection attempt.") );
 		debugf( NAME_Log, TEXT("Current socket handle is %i"), RemoteSocket);
@@ -374,30 +437,19 @@ ATcpLink::PollConnections()
 {
 	guard(ATcpLink::PollConnections);
 
+	FSocketReactor& Reactor = GetSocketReactor();
+	INT S = RemoteSocket != INVALID_SOCKET ? RemoteSocket : Socket;
+	DWORD Ready = Reactor.Ready( S );
+
 	if ( ReceiveMode == RMODE_Manual )
 	{
-		INT S;
-		fd_set SocketSet;
-		TIMEVAL SelectTime = {0, 0};
-		INT Error;
-
-		FD_ZERO( &SocketSet );
-		if ( RemoteSocket == INVALID_SOCKET ) {
-			S = Socket;
-			FD_SET( Socket, &SocketSet );
-		} else {
-			S = RemoteSocket;
-			FD_SET( RemoteSocket, &SocketSet );
-		}
-
-		Error = select( S + 1, &SocketSet, 0, 0, &SelectTime);
-
-		if (( Error == 0 ) || ( Error == SOCKET_ERROR )) {
-			DataPending = 0;
-		} else {
-			DataPending = 1;
-		}
+		DataPending = (Ready & SOCKREADY_Read) != 0;
 	} else if ( ReceiveMode == RMODE_Event ) {
+		// Only links with something to read get an event.  A readable
+		// listen socket means a connection to accept, not data.
+		if ( !(Ready & SOCKREADY_Read) || (LinkState == STATE_Listening && RemoteSocket == INVALID_SOCKET) )
+			return;
+		Reactor.CountSyscall();
 		if ( LinkMode == MODE_Text ) {
 			char Str[1000];
 			INT BytesReceived;
@@ -405,10 +457,7 @@ ATcpLink::PollConnections()
 			for ( INT i=0; i<1000; i++ )
 				Str[i] = 0;
 
-			if ( RemoteSocket != INVALID_SOCKET )
-				BytesReceived = recv( (SOCKET) RemoteSocket, Str, sizeof(Str) - 1, 0 );
-			else
-				BytesReceived = recv( (SOCKET) Socket, Str, sizeof(Str) - 1, 0 );
+			BytesReceived = recv( (SOCKET) S, Str, sizeof(Str) - 1, 0 );
 
 			if( BytesReceived != SOCKET_ERROR )
 			{
@@ -422,10 +471,7 @@ ATcpLink::PollConnections()
 			for ( INT i=0; i<1000; i++ )
 				Str[i] = 0;
 
-			if ( RemoteSocket != INVALID_SOCKET )
-				BytesReceived = recv( (SOCKET) RemoteSocket, Str, sizeof(Str) - 1, 0 );
-			else
-				BytesReceived = recv( (SOCKET) Socket, Str, sizeof(Str) - 1, 0 );
+			BytesReceived = recv( (SOCKET) S, Str, sizeof(Str) - 1, 0 );
 
 			if( BytesReceived != SOCKET_ERROR )
 			{
@@ -439,10 +485,7 @@ ATcpLink::PollConnections()
 			for ( INT i=0; i<1000; i++ )
 				Str[i] = 0;
 
-			if ( RemoteSocket != INVALID_SOCKET )
-				BytesReceived = recv( (SOCKET) RemoteSocket, (char*) Str, sizeof(Str) - 1, 0 );
-			else
-				BytesReceived = recv( (SOCKET) Socket, (char*) Str, sizeof(Str) - 1, 0 );
+			BytesReceived = recv( (SOCKET) S, (char*) Str, sizeof(Str) - 1, 0 );
 
 			if( BytesReceived != SOCKET_ERROR )
 				eventReceivedBinary( BytesReceived, Str );
@@ -479,7 +522,7 @@ void ATcpLink::execOpen( FFrame& Stack, RESULT_DECL )
 		}
 				
 		LinkState = STATE_Connecting;
-		SendFIFO.Empty();
+		EmptySendBuffer();
 	}
 
 	*(DWORD*) Result = 1;
@@ -496,23 +539,12 @@ ATcpLink::CheckConnectionAttempt()
 {
 	guard(ATcpLink::CheckConnectionAttempt);
 
-	fd_set SocketSet;
-	TIMEVAL SelectTime = {0, 0};
-	INT Error;
-
 	if (GetSocket() == INVALID_SOCKET)
 		return;
 
-	FD_ZERO( &SocketSet );
-	FD_SET( GetSocket(), &SocketSet );
 	// Check for writability.  If the socket is writable, the
 	// connection attempt succeeded.
-	Error = select( GetSocket() + 1, 0, &SocketSet, 0, &SelectTime);
-
-	if ( Error == SOCKET_ERROR ) {
-		debugf( NAME_Log, TEXT("CheckConnectionAttempt: Error while checking socket status.") );
-		return;
-	} else if ( Error == 0 ) {
+	if ( !(GetSocketReactor().Ready(GetSocket()) & SOCKREADY_Write) ) {
 		//debugf( NAME_Log, "CheckConnectionAttempt: Connection attempt has not yet completed." );
 		return;
 	}
@@ -601,6 +633,7 @@ void ATcpLink::execReadText( FFrame& Stack, RESULT_DECL )
 		{
 			BYTE Buffer[MAX_STRING_CONST_SIZE];
 			appMemset( Buffer, 0, sizeof(Buffer) );
+			GetSocketReactor().CountSyscall();
 			if( RemoteSocket != INVALID_SOCKET )
 				BytesReceived = recv( (SOCKET)RemoteSocket, (char*)Buffer, sizeof(Buffer) - 1, 0 );
 			else
@@ -632,24 +665,235 @@ UBOOL ATcpLink::FlushSendBuffer()
 		 (LinkState == STATE_ConnectClosePending) ||
 		 (LinkState == STATE_ListenClosePending))
 	{
-		INT Count = Min<INT>(SendFIFO.Num(), 512);
-		INT BytesSent;
-		while(Count > 0)
+		// Send as much as the socket will take, then drop it from the
+		// queue in one go, topping the queue up from streamed files.
+		UBOOL Blocked = 0;
+		RefillSendBuffer();
+		while( !Blocked && SendFIFO.Num() )
 		{
-			if ( RemoteSocket != INVALID_SOCKET )
-				BytesSent = send( (SOCKET) RemoteSocket, (char*)&SendFIFO(0), Count, 0 );
-			else
-				BytesSent = send( (SOCKET) Socket, (char*)&SendFIFO(0), Count, 0 );
-			if ( BytesSent == SOCKET_ERROR )
-				return 1;
-			SendFIFO.Remove(0, BytesSent);
-			Count = Min<INT>(SendFIFO.Num(), 512);
+			INT Sent = 0;
+			while( Sent < SendFIFO.Num() )
+			{
+				INT BytesSent;
+				GetSocketReactor().CountSyscall();
+				if ( RemoteSocket != INVALID_SOCKET )
+					BytesSent = send( (SOCKET) RemoteSocket, (char*)&SendFIFO(Sent), SendFIFO.Num() - Sent, 0 );
+				else
+					BytesSent = send( (SOCKET) Socket, (char*)&SendFIFO(Sent), SendFIFO.Num() - Sent, 0 );
+				if ( BytesSent == SOCKET_ERROR || BytesSent == 0 )
+				{
+					Blocked = 1;
+					break;
+				}
+				Sent += BytesSent;
+			}
+			if( !Sent )
+				break;
+			SendFIFO.Remove(0, Sent);
+
+			// Flag a finished SendFile for Tick to report.
+			if( HasSendFile() && SendFileBytes > 0 && (SendFileBytes -= Sent) <= 0 )
+				SendFileBytes = -1;
+			RefillSendBuffer();
 		}
+		return SendFIFO.Num() > 0;
 	}
 	return 0;
 	unguard;
 }
 
+//
+// The array new outgoing data should be appended to: SendFIFO, or the
+// back of the last streamed file while one is queued.
+//
+TArray<BYTE>& ATcpLink::SendTail()
+{
+	guardSlow(ATcpLink::SendTail);
+	TArray<FSendFileSegment*>* Segments = GSendFileStreams.Find( this );
+	return Segments ? Segments->Last()->After : SendFIFO;
+	unguardSlow;
+}
+
+//
+// Top SendFIFO up to a chunk from the streamed files queued behind it.
+//
+void ATcpLink::RefillSendBuffer()
+{
+	guard(ATcpLink::RefillSendBuffer);
+	TArray<FSendFileSegment*>* Segments = GSendFileStreams.Find( this );
+	while( Segments && SendFIFO.Num() < SENDFILE_CHUNK )
+	{
+		FSendFileSegment* Segment = (*Segments)(0);
+		if( Segment->Ar )
+		{
+			INT Count = Min( Segment->Remaining, SENDFILE_CHUNK - SendFIFO.Num() );
+			INT Index = SendFIFO.Add( Count );
+			Segment->Ar->Serialize( &SendFIFO(Index), Count );
+			Segment->Remaining -= Count;
+			if( Segment->Ar->IsError() )
+			{
+				// Drop the rest of the file, and don't wait on it for SentFile.
+				debugf( NAME_Log, TEXT("SendFile: Error reading file, %i bytes not sent"), Segment->Remaining + Count );
+				SendFIFO.Remove( Index, Count );
+				if( HasSendFile() && SendFileBytes > 0 && (SendFileBytes -= Segment->Remaining + Count) <= 0 )
+					SendFileBytes = -1;
+				Segment->Remaining = 0;
+			}
+			if( Segment->Remaining > 0 )
+				continue;
+			delete Segment->Ar;
+			Segment->Ar = NULL;
+		}
+
+		// File done, so move what was queued behind it up.
+		if( Segment->After.Num() )
+			appMemcpy( &SendFIFO(SendFIFO.Add(Segment->After.Num())), &Segment->After(0), Segment->After.Num() );
+		delete Segment;
+		Segments->Remove( 0 );
+		if( !Segments->Num() )
+		{
+			GSendFileStreams.Remove( this );
+			Segments = NULL;
+		}
+	}
+	unguard;
+}
+
+//
+// Drop everything queued to send.
+//
+void ATcpLink::EmptySendBuffer()
+{
+	guard(ATcpLink::EmptySendBuffer);
+	SendFIFO.Empty();
+	TArray<FSendFileSegment*>* Segments = GSendFileStreams.Find( this );
+	if( Segments )
+	{
+		for( INT i=0; i<Segments->Num(); i++ )
+			delete (*Segments)(i);
+		GSendFileStreams.Remove( this );
+	}
+	if( HasSendFile() )
+		SendFileBytes = 0;
+	unguard;
+}
+
+//
+// Number of bytes queued to send, including streamed files not yet read.
+//
+INT ATcpLink::QueuedBytes()
+{
+	guard(ATcpLink::QueuedBytes);
+	INT Count = SendFIFO.Num();
+	TArray<FSendFileSegment*>* Segments = GSendFileStreams.Find( this );
+	if( Segments )
+		for( INT i=0; i<Segments->Num(); i++ )
+			Count += (*Segments)(i)->Remaining + (*Segments)(i)->After.Num();
+	return Count;
+	unguard;
+}
+
+//
+// Append a file to the send queue, from memory if it was sent recently.
+// Large files are streamed from disk as the socket drains.  Returns the
+// number of bytes queued, or -1 on failure.
+//
+INT ATcpLink::QueueFile( const TCHAR* Filename )
+{
+	guard(ATcpLink::QueueFile);
+	INT    FileSize = GFileManager->FileSize( Filename );
+	SQWORD FileTime = GFileManager->GetGlobalTime( Filename );
+	if( FileSize < 0 )
+		return -1;
+
+	// Cached?
+	TArray<BYTE>&    Tail  = SendTail();
+	FSendFileCache** Found = GSendFileCache.Find( Filename );
+	if( Found && (*Found)->FileTime==FileTime && (*Found)->Data.Num()==FileSize )
+	{
+		if( FileSize )
+			appMemcpy( &Tail(Tail.Add(FileSize)), &(*Found)->Data(0), FileSize );
+		return FileSize;
+	}
+
+	FArchive* Ar = GFileManager->CreateFileReader( Filename );
+	if( !Ar )
+		return -1;
+
+	// Too big to hold at once?
+	if( FileSize>SENDFILE_CACHE_MAX )
+	{
+		TArray<FSendFileSegment*>* Segments = GSendFileStreams.Find( this );
+		if( !Segments )
+			Segments = &GSendFileStreams.Set( this, TArray<FSendFileSegment*>() );
+		FSendFileSegment* Segment = new FSendFileSegment;
+		Segment->Ar        = Ar;
+		Segment->Remaining = FileSize;
+		Segments->AddItem( Segment );
+		return FileSize;
+	}
+
+	// Read it straight into the queue.
+	INT Index = Tail.Add( FileSize );
+	if( FileSize )
+		Ar->Serialize( &Tail(Index), FileSize );
+	UBOOL Ok = !Ar->IsError();
+	delete Ar;
+	if( !Ok )
+	{
+		Tail.Remove( Index, FileSize );
+		return -1;
+	}
+
+	// Keep small files for next time.
+	if( FileSize<=SENDFILE_CACHE_MAX )
+	{
+		FSendFileCache* Entry = Found ? *Found : NULL;
+		INT OldSize = Entry ? Entry->Data.Num() : 0;
+		if( GSendFileCacheBytes - OldSize + FileSize <= SENDFILE_CACHE_TOTAL )
+		{
+			if( !Entry )
+			{
+				Entry = new FSendFileCache;
+				GSendFileCache.Set( Filename, Entry );
+			}
+			Entry->FileTime = FileTime;
+			Entry->Data.Empty( FileSize );
+			Entry->Data.Add( FileSize );
+			if( FileSize )
+				appMemcpy( &Entry->Data(0), &Tail(Index), FileSize );
+			GSendFileCacheBytes += FileSize - OldSize;
+		}
+	}
+	return FileSize;
+	unguard;
+}
+
+//
+// SendFile: Queue a file to be sent natively.
+//
+void ATcpLink::execSendFile( FFrame& Stack, RESULT_DECL )
+{
+	guard(ATcpLink::execSendFile);
+	P_GET_STR(Filename);
+	P_FINISH;
+
+	*(INT*)Result = -1;
+	if ( GInitialized && GetSocket() )
+	{
+		INT Count = QueueFile( *Filename );
+		if( Count >= 0 )
+		{
+			INT Queued = QueuedBytes();
+			SendFileBytes = Queued ? Queued : -1;
+			FlushSendBuffer();
+		}
+		else debugf( NAME_Log, TEXT("SendFile: Unable to read %s"), *Filename );
+		*(INT*)Result = Count;
+	}
+	unguardexec;
+}
+
 //
 // Send raw binary data.
 //
@@ -662,9 +906,10 @@ void ATcpLink::execSendBinary( FFrame& Stack, RESULT_DECL )
 
 	if ( GInitialized && GetSocket() )
 	{
-		INT Index = SendFIFO.Add( Count );
+		TArray<BYTE>& Tail = SendTail();
+		INT Index = Tail.Add( Count );
 		for(INT i=0; i < Count; i++)
-			SendFIFO(i+Index) = B[i];	
+			Tail(i+Index) = B[i];	
 
 		*(DWORD*)Result = Count;
 		FlushSendBuffer();
@@ -691,11 +936,13 @@ void ATcpLink::execSendText( FFrame& Stack, RESULT_DECL )
 		if( LinkMode == MODE_Line )
 			Str += TEXT("\r\n");
 	
-		const char* p = appToAnsi(*Str);
+		// Convert directly, since appToAnsi truncates long strings.
+		const TCHAR* p = *Str;
 		INT Count = Str.Len();
-		INT Index = SendFIFO.Add( Count );
+		TArray<BYTE>& Tail = SendTail();
+		INT Index = Tail.Add( Count );
 		for(INT i=0; i < Count; i++)
-			SendFIFO(i+Index) = p[i];
+			Tail(i+Index) = ToAnsi(p[i]);
 	
 		*(DWORD*)Result = Count;
 		FlushSendBuffer();
@@ -721,6 +968,7 @@ void ATcpLink::execReadBinary( FFrame& Stack, RESULT_DECL )
 	{
 		if ( (LinkState == STATE_Listening) || (LinkState == STATE_Connected) )
 		{
+			GetSocketReactor().CountSyscall();
 			if ( RemoteSocket != INVALID_SOCKET )
 				BytesReceived = recv( (SOCKET) RemoteSocket, (char *) B, Count, 0 );
 			else
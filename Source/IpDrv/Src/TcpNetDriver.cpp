@@ -243,7 +243,7 @@ class DLL_EXPORT_CLASS UTcpNetDriver : public UNetDriver
 			if( GetServerConnection() && IpMatches(GetServerConnection()->RemoteAddr,FromAddr) )
 				Connection = GetServerConnection();
 			for( INT i=0; i<ClientConnections.Num() && !Connection; i++ )
-				if( IpMatches( ((UTcpipConnection*)ClientConnections(i))->RemoteAddr, FromAddr ) )
+				if( ClientConnections(i)->IsA(UTcpipConnection::StaticClass()) && IpMatches( ((UTcpipConnection*)ClientConnections(i))->RemoteAddr, FromAddr ) )
 					Connection = (UTcpipConnection*)ClientConnections(i);
 
 			if( !Connection && Notify->NotifyAcceptingConnection()==ACCEPTC_Accept )
@@ -296,7 +296,7 @@ class DLL_EXPORT_CLASS UTcpNetDriver : public UNetDriver
 			if( GetServerConnection() && IpMatches(GetServerConnection()->RemoteAddr,FromAddr) )
 				Connection = GetServerConnection();
 			for( INT i=0; i<ClientConnections.Num() && !Connection; i++ )
-				if( IpMatches( ((UTcpipConnection*)ClientConnections(i))->RemoteAddr, FromAddr ) )
+				if( ClientConnections(i)->IsA(UTcpipConnection::StaticClass()) && IpMatches( ((UTcpipConnection*)ClientConnections(i))->RemoteAddr, FromAddr ) )
 					Connection = (UTcpipConnection*)ClientConnections(i);
 
 			// If we didn't find a client connection, maybe create a new one.
@@ -337,6 +337,26 @@ class DLL_EXPORT_CLASS UTcpNetDriver : public UNetDriver
 		unguard;
 	}
 
+	// FExec interface.
+	UBOOL Exec( const TCHAR* Cmd, FOutputDevice& Ar=*GLog )
+	{
+		guard(UTcpNetDriver::Exec);
+		if( ParseCommand(&Cmd,TEXT("SOCKETSTAT")) )
+		{
+			// Socket polling done for TcpLink and UdpLink actors.
+			Ar.Logf( TEXT("Internet links: %s"), *GetSocketReactor().Describe() );
+			return 1;
+		}
+		else if( ParseCommand(&Cmd,TEXT("QUERYSTAT")) )
+		{
+			// Server queries answered from UdpLink response caches.
+			Ar.Logf( TEXT("Query cache: %s"), *GUdpQueryStats.Describe() );
+			return 1;
+		}
+		else return Super::Exec( Cmd, Ar );
+		unguard;
+	}
+
 	// UTcpNetDriver interface.
 	UBOOL InitBase( UBOOL Connect, FNetworkNotify* InNotify, FURL& URL, FString& Error )
 	{
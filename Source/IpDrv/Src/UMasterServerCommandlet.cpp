@@ -13,14 +13,161 @@ Todo:
 
 #include "IpDrvPrivate.h"
 
-/*-----------------------------------------------------------------------------
-	UMasterServerCommandlet.
------------------------------------------------------------------------------*/
+#ifndef MSG_NOSIGNAL
+	#define MSG_NOSIGNAL 0
+#endif
+
+// Seconds before entries are dropped.
+#define MASTER_VALIDATION_TIMEOUT	60		// Unanswered validation challenges.
+#define MASTER_CLIENT_TIMEOUT		20		// TCP clients, from when they connect.
+#define MASTER_MAX_REQUEST			4096	// Longest TCP request text allowed.
 
 extern void GenerateSecretKey( BYTE* key, const TCHAR *GameName );
 extern void gs_encrypt(BYTE *buffer_ptr, INT buffer_len, BYTE *key);
 extern void gs_encode(BYTE *ins, INT size, BYTE *result);
 
+/*-----------------------------------------------------------------------------
+	Helpers.
+-----------------------------------------------------------------------------*/
+
+//
+// Compute the response a server gives to a validation challenge.
+//
+static void GSValidate( FString* ValidationString, FString* const ValidationResult, FString* ValidateGameName )
+{
+	guard(GSValidate);
+
+	const INT ValidateSize = 6;
+	BYTE SecretKey[7];
+	GenerateSecretKey( SecretKey, **ValidateGameName );
+	BYTE EncryptedString[ValidateSize];
+	BYTE EncodedString[(ValidateSize * 4) / 3 + 1];
+
+	BYTE* Pos = EncryptedString;
+	const TCHAR* Tmp = **ValidationString;
+	while( *Tmp && Pos<EncryptedString+ValidateSize )
+		*Pos++ = *Tmp++;
+
+	gs_encrypt( EncryptedString, ValidateSize, SecretKey );
+	gs_encode( EncryptedString, ValidateSize, EncodedString );
+	*(FString*)ValidationResult = appFromAnsi((ANSICHAR*)EncodedString);
+
+	unguard;
+}
+
+static void AppendAnsi( TArray<BYTE>& Out, const TCHAR* Str )
+{
+	INT Len   = appStrlen( Str );
+	INT Start = Out.Add( Len );
+	for( INT i=0; i<Len; i++ )
+		Out(Start+i) = ToAnsi( Str[i] );
+}
+
+//
+// Send what the socket will take without blocking.  Returns the number
+// of bytes sent, or -1 if the connection failed.
+//
+static INT SendSome( INT Socket, const BYTE* Data, INT Count )
+{
+	INT Sent = 0;
+	while( Sent < Count )
+	{
+		INT BytesSent = send( Socket, (char*)Data + Sent, Count - Sent, MSG_NOSIGNAL );
+		if( BytesSent == SOCKET_ERROR )
+			return WSAGetLastError()==WSAEWOULDBLOCK ? Sent : -1;
+		if( BytesSent == 0 )
+			break;
+		Sent += BytesSent;
+	}
+	return Sent;
+}
+
+/*-----------------------------------------------------------------------------
+	TTimingWheel.
+-----------------------------------------------------------------------------*/
+
+//
+// Items bucketed by the second they fall due, so that expiring them only
+// touches the ones that are due.  Delays are limited to the wheel size.
+// Owners keep the real deadline with each entry and re-add items that
+// turn out to have been extended, rather than removing them early.
+//
+template< class T > class TTimingWheel
+{
+public:
+	INT Count;		// Items in the wheel.
+
+	TTimingWheel()
+	:	Count( 0 )
+	,	Now( 0 )
+	{}
+	void Init( INT NumSeconds )
+	{
+		Slots.Empty();
+		Slots.AddZeroed( NumSeconds + 1 );
+		Count = Now = 0;
+	}
+	void Add( INT Delay, const T& Item )
+	{
+		Delay = Clamp( Delay, 1, Slots.Num()-1 );
+		new(Slots((Now + Delay) % Slots.Num()))T(Item);
+		Count++;
+	}
+	// Move on a second, returning the items due in Due.
+	void Advance( TArray<T>& Due )
+	{
+		Now++;
+		TArray<T>& Slot = Slots(Now % Slots.Num());
+		ExchangeArray( Due, Slot );
+		Slot.Empty();
+		Count -= Due.Num();
+	}
+private:
+	INT Now;
+	TArray< TArray<T> > Slots;
+};
+
+/*-----------------------------------------------------------------------------
+	UMasterServerCommandlet.
+-----------------------------------------------------------------------------*/
+
+// A validated server in the master list.
+struct FMasterServerEntry
+{
+	FString PortID;				// Query port it reported.
+	INT		Expires;			// Second it drops out unless it heartbeats.
+};
+
+// A server which has been sent a validation challenge.
+struct FMasterValidation
+{
+	FString Challenge;			// Key it must encrypt.
+	FString PortID;				// Query port from its heartbeat.
+	INT		Expires;			// Second the challenge lapses.
+};
+
+// A TCP client.
+struct FMasterClient
+{
+	FString			Request;	// Received text not yet serviced.
+	TArray<BYTE>	Reply;		// Output the socket hasn't taken yet.
+	INT				Expires;	// Second it is disconnected.
+	UBOOL			Done;		// Whether to close once Reply is sent.
+	FMasterClient()
+	:	Expires( 0 )
+	,	Done( 0 )
+	{}
+};
+
+//
+// Collects server heartbeats over UDP, validates them, and hands the list
+// to clients over TCP.  Everything runs off one FSocketReactor wait, so
+// idle time costs nothing and any number of clients can be connected.
+// The list is serialized once each time it changes and sent to clients
+// straight from that buffer, with only what a socket won't take queued
+// per client.  Timeouts are kept in timing wheels instead of being found
+// by scanning the maps.
+//
 class UMasterServerCommandlet : public UCommandlet
 {
 	DECLARE_CLASS(UMasterServerCommandlet, UCommandlet, CLASS_Transient);
@@ -40,18 +187,31 @@ class UMasterServerCommandlet : public UCommandlet
 	// TCPLink Mode
 	INT TCPPort;
 	FSocketData TCPSocket;
-	SOCKET Connections[100];
-	INT ConnectionTimer[100];
-	INT ConnectionCount;
+	TMap<INT, FMasterClient> Clients;			// Connected clients by socket.
+	INT NumClients;
+	INT ListQueries;
 
 	// Server Map
-	TMap<FString, FString> ValidationMap;		// Servers awaiting validation.
-	TMap<FString, FString> MasterMap;			// Servers in the master list.
+	TMap<FString, FMasterValidation> ValidationMap;		// Servers awaiting validation.
+	TMap<FString, FMasterServerEntry> MasterMap;		// Servers in the master list.
 	INT NumServers;
-	DOUBLE Last10Seconds, Last300Seconds;
+	INT NumPending;
 	INT IgnoredValidations;
 	INT RejectedValidations;
 
+	// Serialized list, rebuilt when MasterMap changes.
+	TArray<BYTE> ServerList;
+	UBOOL ServerListDirty;
+	UBOOL ServerFileDirty;
+
+	// Timing.
+	FSocketReactor* Reactor;
+	INT Seconds;								// Whole seconds since startup.
+	DOUBLE NextSecond, LastReport;
+	TTimingWheel<FString> ServerTimers;
+	TTimingWheel<FString> ValidationTimers;
+	TTimingWheel<INT> ClientTimers;
+
 	void InitSockets( const TCHAR* ConfigFileName )
 	{
 		guard(InitSockets);
@@ -60,17 +220,19 @@ class UMasterServerCommandlet : public UCommandlet
 
 		IgnoredValidations = 0;
 		RejectedValidations = 0;
-
-		ConnectionCount = 0;
-		for (INT i=0; i<100; i++)
-			ConnectionTimer[i] = 0;
+		NumClients = 0;
+		ListQueries = 0;
+		NumPending = 0;
 
 		GConfig->GetInt( TEXT("MasterServer"), TEXT("ListenPort"), ListenSocket.Port, ConfigFileName );
 		ListenSocket.Socket = INVALID_SOCKET;
+		TCPSocket.Socket = INVALID_SOCKET;
 
 		// Initialize sockets.
 		FString Error;
 		::InitSockets( Error );
+		Reactor = CreateSocketReactor();
+		GWarn->Logf( TEXT("   Polling with %s."), Reactor->GetName() );
 
 		// Create a UDP socket.
 		ListenSocket.Socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
@@ -88,13 +250,15 @@ class UMasterServerCommandlet : public UCommandlet
 			ListenSocket.Socket = INVALID_SOCKET;
 			return;
 		}
+		DWORD NoBlock = 1;
+		ioctlsocket( ListenSocket.Socket, FIONBIO, &NoBlock );
+		Reactor->Watch( ListenSocket.Socket, SOCKREADY_Read );
 
 		GWarn->Logf( TEXT("   UDP socket bound at port %i"), ListenSocket.Port );
 
 		if ( OpMode == TEXT("TCPLink") )
 		{
 			// Init the socket.
-			TCPSocket.Socket = INVALID_SOCKET;
 			TCPSocket.Port = TCPPort;
 
 			// Create a TCP socket.
@@ -120,13 +284,15 @@ class UMasterServerCommandlet : public UCommandlet
 				TCPSocket.Socket = INVALID_SOCKET;
 				return;
 			}
+			ioctlsocket( TCPSocket.Socket, FIONBIO, &NoBlock );
+			Reactor->Watch( TCPSocket.Socket, SOCKREADY_Read );
 			GWarn->Logf( TEXT("   Listening on TCP socket.") );
 		}
 
 		unguard;
 	}
 
-	UBOOL ConsoleReadInput() 
+	UBOOL ConsoleReadInput()
 	{
 		guard(ConsoleReadInput);
 
@@ -150,100 +316,96 @@ class UMasterServerCommandlet : public UCommandlet
 		unguard;
 	}
 
-	void ListenSockets()
+	//
+	// Wait up to TimeoutMS for socket events and service them.
+	//
+	void ListenSockets( INT TimeoutMS )
 	{
 		guard(ListenSockets);
 
-		// Check for heartbeats...
-		INT SocketStatus = 1;
-		while ( SocketStatus == 1 )
+		// Copy the ready list, since servicing watches and forgets sockets.
+		Reactor->Wait( TimeoutMS );
+		TArray<INT> Ready = Reactor->ReadySockets();
+		for( INT i=0; i<Ready.Num(); i++ )
+		{
+			INT S = Ready(i);
+			if( S == ListenSocket.Socket )
+				ReceiveHeartbeats();
+			else if( S == TCPSocket.Socket )
+				AcceptClients();
+			else
+				ServiceClient( S, Reactor->Ready(S) );
+		}
+
+		unguard;
+	}
+
+	void ReceiveHeartbeats()
+	{
+		guard(ReceiveHeartbeats);
+
+		// Drain the socket, but give TCP clients a turn now and then.
+		for( INT n=0; n<256; n++ )
 		{
 			ANSICHAR Buffer[1024];
 			sockaddr_in FromAddr;
 			socklen_t FromSize = sizeof(FromAddr);
-			fd_set SocketSet;
-			TIMEVAL SelectTime = {0, 0};
-			FD_ZERO( &SocketSet );
-			FD_SET( ListenSocket.Socket, &SocketSet );
-			SocketStatus = select(0, &SocketSet, 0, 0, &SelectTime );
-			if (SocketStatus == 1)
-			{
-				INT BytesReceived = recvfrom( ListenSocket.Socket, Buffer, sizeof(Buffer), 0, (LPSOCKADDR)&FromAddr, &FromSize );
-				if( BytesReceived != SOCKET_ERROR ) {
-					// Received data.
-					OpStats.BytesReceived += BytesReceived;
-					Buffer[BytesReceived] = 0;
-					FString Message = FString(appFromAnsi((ANSICHAR*)Buffer));
-					ServiceMessage( Message, &FromAddr );
-				} else {
+			INT BytesReceived = recvfrom( ListenSocket.Socket, Buffer, sizeof(Buffer) - 1, 0, (LPSOCKADDR)&FromAddr, &FromSize );
+			if( BytesReceived == SOCKET_ERROR ) {
+				if( WSAGetLastError() != WSAEWOULDBLOCK )
 					GWarn->Logf( TEXT("!! Error while polling socket: %i"), WSAGetLastError() );
-				}
+				break;
 			}
+			// Received data.
+			OpStats.BytesReceived += BytesReceived;
+			Buffer[BytesReceived] = 0;
+			FString Message = FString(appFromAnsi((ANSICHAR*)Buffer));
+			ServiceMessage( Message, &FromAddr );
 		}
 
-		// Check for queued connections...
-		if ( OpMode == TEXT("TCPLink") )
+		unguard;
+	}
+
+	void AcceptClients()
+	{
+		guard(AcceptClients);
+
+		static const ANSICHAR HelloMessage[] = "\\basic\\\\secure\\wookie";
+		for( ;; )
 		{
-			TIMEVAL SelectTime = {1, 0};
-			fd_set SocketSet;
-			FD_ZERO( &SocketSet );
-			FD_SET( TCPSocket.Socket, &SocketSet );
-			SocketStatus = select( 0, &SocketSet, 0, 0, &SelectTime );
-			if ( SocketStatus == SOCKET_ERROR )
-			{
-				GWarn->Logf( TEXT("!! Error checking socket status: %i"), WSAGetLastError());
-				return;
-			} else if ( SocketStatus == 0 ) {
-				// Nothing waiting.
-				return;
-			}
 			socklen_t i = sizeof(SOCKADDR);
 			SOCKADDR_IN ForeignHost;
 			INT IncomingSocket = accept( TCPSocket.Socket, (LPSOCKADDR) &ForeignHost, &i );
 			if ( IncomingSocket == INVALID_SOCKET )
 			{
-				GWarn->Logf( TEXT("!! Failed to accept queued connection: %i"), WSAGetLastError() );
+				if( WSAGetLastError() != WSAEWOULDBLOCK )
+					GWarn->Logf( TEXT("!! Failed to accept queued connection: %i"), WSAGetLastError() );
 				return;
 			}
-			INT MapCount = 0;
-			for ( TMap<FString, FString>::TIterator It(MasterMap); It; ++It )
-				MapCount++;
-			INT SendSize = 30*MapCount + 1024, SizeSize=sizeof(SendSize);
-			setsockopt( IncomingSocket, SOL_SOCKET, SO_SNDBUF, (char*)&SendSize, SizeSize );
-			Connections[ConnectionCount++] = IncomingSocket;
-			if (ConnectionCount > 100)
-				ConnectionCount = 0;
+			if( !Reactor->CanWatch( IncomingSocket ) )
+			{
+				GWarn->Logf( TEXT("!! Refusing connection, %s can't poll socket %i"), Reactor->GetName(), IncomingSocket );
+				closesocket( IncomingSocket );
+				continue;
+			}
+			DWORD NoBlock = 1;
+			ioctlsocket( IncomingSocket, FIONBIO, &NoBlock );
+
+			FMasterClient& Client = Clients.Set( IncomingSocket, FMasterClient() );
+			Client.Expires = Seconds + MASTER_CLIENT_TIMEOUT;
+			ClientTimers.Add( MASTER_CLIENT_TIMEOUT, IncomingSocket );
+			NumClients++;
 
 			// We have a new connection, so lets send it an initial message.
-			FString HelloMessage = FString::Printf( TEXT("\\basic\\\\secure\\wookie") );
-			send( IncomingSocket, appToAnsi(*HelloMessage), HelloMessage.Len(), 0 );
+			if( SendClient( IncomingSocket, Client, (const BYTE*)HelloMessage, ARRAY_COUNT(HelloMessage) - 1 ) )
+				UpdateClient( IncomingSocket, Client );
+			else
+				CloseClient( IncomingSocket );
 		}
 
 		unguard;
 	}
 
-	void GSValidate( FString* ValidationString, FString* const ValidationResult, FString* ValidateGameName )
-	{
-		guard(GSValidate);
-
-		const INT ValidateSize = 6;
-		BYTE SecretKey[7];
-		GenerateSecretKey( SecretKey, **ValidateGameName );
-		BYTE EncryptedString[ValidateSize];
-		BYTE EncodedString[(ValidateSize * 4) / 3 + 1];
-
-		BYTE* Pos = EncryptedString;
-		const TCHAR* Tmp = **ValidationString;
-		while( *Tmp )
-			*Pos++ = *Tmp++;
-
-		gs_encrypt( EncryptedString, ValidateSize, SecretKey );
-		gs_encode( EncryptedString, ValidateSize, EncodedString );
-		*(FString*)ValidationResult = appFromAnsi((ANSICHAR*)EncodedString);
-
-		unguard;
-	}
-
 	UBOOL GetNextKey( FString* Message, FString* Result )
 	{
 		guard(GetNextKey);
@@ -314,11 +476,16 @@ class UMasterServerCommandlet : public UCommandlet
 		FString FromAddrString = IpString(FromAddr->sin_addr) + TEXT(":") + FString::Printf( TEXT("%i"), PortNum );
 
 		// Find out if this guy is already in the MasterMap.
-		if ( MasterMap.Find( FromAddrString ) != NULL )
+		FMasterServerEntry* Entry = MasterMap.Find( FromAddrString );
+		if ( Entry != NULL )
 		{
 			// Yeah, he's there.  Let's reset his timer.
-			FString StoreString = FString::Printf( TEXT("%s\\%i"), *PortID, MASTER_TIMEOUT );
-			MasterMap.Set( *FromAddrString, *StoreString );
+			Entry->Expires = Seconds + MASTER_TIMEOUT;
+			if( Entry->PortID != PortID )
+			{
+				Entry->PortID = PortID;
+				ServerListDirty = ServerFileDirty = 1;
+			}
 			return;
 		}
 
@@ -358,11 +525,20 @@ class UMasterServerCommandlet : public UCommandlet
 		INT BytesSent = sendto( ListenSocket.Socket, appToAnsi(*ValidationChallenge), ValidationChallenge.Len(), 0, (sockaddr*)&ToAddr, sizeof(ToAddr) );
 		if (BytesSent == SOCKET_ERROR)
 			GWarn->Logf( TEXT("ServiceMessage: Failed to send ValidationChallenge.") );
-		OpStats.BytesSent += BytesSent;
+		else
+			OpStats.BytesSent += BytesSent;
 
 		// Store this dude in the validation map.
-		FString StoreString = FString::Printf( TEXT("%s\\%s"), *ValidationKey, *PortID );
-		ValidationMap.Set( *FromAddrString, *StoreString );
+		FMasterValidation* Pending = ValidationMap.Find( FromAddrString );
+		if( !Pending )
+		{
+			Pending = &ValidationMap.Set( *FromAddrString, FMasterValidation() );
+			ValidationTimers.Add( MASTER_VALIDATION_TIMEOUT, FromAddrString );
+			NumPending++;
+		}
+		Pending->Challenge = ValidationKey;
+		Pending->PortID    = PortID;
+		Pending->Expires   = Seconds + MASTER_VALIDATION_TIMEOUT;
 
 		unguard;
 	}
@@ -378,184 +554,267 @@ class UMasterServerCommandlet : public UCommandlet
 		INT PortNum = FromAddr->sin_port;
 		FString FromAddrString = IpString(FromAddr->sin_addr) + TEXT(":") + FString::Printf( TEXT("%i"), PortNum );
 
-		FString* ValidationKey = ValidationMap.Find( FromAddrString );
-		if (( ValidationKey == NULL ) || ( ValidationKey->Len() == 0 ))
+		FMasterValidation* Pending = ValidationMap.Find( FromAddrString );
+		if ( Pending == NULL )
 		{
 			// This guy is asking for validation, but never sent a heartbeat.  Just ignore.
 			IgnoredValidations++;
 			return;
 		}
 
-		// Split the key.
-		FString ValidationChallenge = ValidationKey->Left(6);
-		FString PortID = ValidationKey->Right(ValidationKey->Len() - 7);
-
 		FString ValidationResult;
-		GSValidate( &ValidationChallenge, &ValidationResult, &GameName );
+		GSValidate( &Pending->Challenge, &ValidationResult, &GameName );
 		if (  ValidationResult != ChallengeResponse )
 		{
 			FString OldVer(TEXT("oldver"));
-			GSValidate( &ValidationChallenge, &ValidationResult, &OldVer );
+			GSValidate( &Pending->Challenge, &ValidationResult, &OldVer );
 		}
 		if (  ValidationResult == ChallengeResponse )
 		{
 			// This guy is legit.  Add him to the MasterMap.
-			FString StoreString = FString::Printf( TEXT("%s\\%i"), *PortID, MASTER_TIMEOUT );
-			if( MasterMap.Find( FromAddrString ) == NULL )
+			FMasterServerEntry* Entry = MasterMap.Find( FromAddrString );
+			if( Entry == NULL )
+			{
+				Entry = &MasterMap.Set( *FromAddrString, FMasterServerEntry() );
+				ServerTimers.Add( MASTER_TIMEOUT, FromAddrString );
 				NumServers++;
-			MasterMap.Set( *FromAddrString, *StoreString );
+			}
+			Entry->PortID  = Pending->PortID;
+			Entry->Expires = Seconds + MASTER_TIMEOUT;
+			ServerListDirty = ServerFileDirty = 1;
 		} else
 			RejectedValidations++;
+
+		// The challenge's timer is left to lapse harmlessly.
 		ValidationMap.Remove( *FromAddrString );
+		NumPending--;
 
 		unguard;
 	}
 
-	void PollConnections()
+	//
+	// Service a client's socket events.
+	//
+	void ServiceClient( INT Socket, DWORD Ready )
 	{
-		guard(PollConnections);
+		guard(ServiceClient);
 
-		INT DeadSockets[100];
-		INT SocketCount = 0;
-
-		INT i;
-		for ( i=0; i<100; i++ )
-			DeadSockets[i] = 0;
+		FMasterClient* Client = Clients.Find( Socket );
+		if( !Client )
+			return;
 
-		for ( i=0; i<100; i++ )
+		UBOOL Dead = 0;
+		if( Ready & SOCKREADY_Read )
 		{
-			if (Connections[i] != 0)
+			for( ;; )
 			{
-				char Buf[240];
-
-				appMemset(Buf, 0, sizeof(Buf));
-
-				// Check for a message...
-				fd_set SocketSet;
-				TIMEVAL SelectTime = {0, 0};
-				FD_ZERO( &SocketSet );
-				FD_SET( Connections[i], &SocketSet );
-				INT SocketStatus = select( 0, &SocketSet, 0, 0, &SelectTime );
-				if (SocketStatus == 1)
+				ANSICHAR Buf[1024];
+				INT BytesReceived = recv( Socket, Buf, sizeof(Buf), 0 );
+				if( BytesReceived == 0 || (BytesReceived == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK) )
 				{
-					INT BytesReceived = recv( Connections[i], Buf, sizeof(Buf), 0 );
-					if ( BytesReceived == 0 )
-					{
-						// Disconnect condition met.
-						closesocket(Connections[i]);
-						DeadSockets[SocketCount++] = i;
-					} else if ( BytesReceived != SOCKET_ERROR )	{
-						// Real message.  Service.
-						OpStats.BytesReceived += BytesReceived;
-						Buf[BytesReceived] = 0;
-						TCHAR TBuf[240];
-						for ( INT j=0; j<240; j++ )
-							TBuf[j] = FromAnsi(Buf[j]);
-						FString Message = FString::Printf( TEXT("%s"), TBuf );
-						ServiceTCPMessage( Message, i );
-					} else {
-						// Socket error, sever the socket.
-						closesocket(Connections[i]);
-						DeadSockets[SocketCount++] = i;
-					}
-				}			
+					// Disconnect condition met.
+					Dead = 1;
+					break;
+				}
+				if( BytesReceived == SOCKET_ERROR )
+					break;
+				OpStats.BytesReceived += BytesReceived;
+				TCHAR TBuf[ARRAY_COUNT(Buf)+1];
+				for( INT j=0; j<BytesReceived; j++ )
+					TBuf[j] = FromAnsi(Buf[j]);
+				TBuf[BytesReceived] = 0;
+				Client->Request += TBuf;
+				if( Client->Request.Len() > MASTER_MAX_REQUEST )
+				{
+					Dead = 1;
+					break;
+				}
+			}
+			if( !Dead )
+				Dead = !ServiceTCPMessage( Socket, *Client );
+		}
+		if( !Dead && (Ready & SOCKREADY_Write) && Client->Reply.Num() )
+		{
+			INT Sent = SendSome( Socket, &Client->Reply(0), Client->Reply.Num() );
+			if( Sent > 0 )
+			{
+				OpStats.BytesSent += Sent;
+				Client->Reply.Remove( 0, Sent );
 			}
+			Dead = Sent < 0;
 		}
 
-		// Remove all dead sockets.
-		for ( i=0; i<100; i++ )
-			if (DeadSockets[i] > 0)
-				Connections[DeadSockets[i]] = 0;
+		if( Dead )
+			CloseClient( Socket );
+		else
+			UpdateClient( Socket, *Client );
 
 		unguard;
 	}
 
-	void ServiceTCPMessage( FString& Message, INT Index )
+	//
+	// Service any complete keys in a client's request.  Returns 0 if the
+	// connection failed.
+	//
+	UBOOL ServiceTCPMessage( INT Socket, FMasterClient& Client )
 	{
 		guard(ServiceTCPMessage);
 
 		OpStats.MessagesServiced++;
 
 		FString Key;
-		while ( GetNextKey( &Message, &Key ) )
+		while ( !Client.Done && GetNextKey( &Client.Request, &Key ) )
 		{
-			if (Key.Len() > 0)
+			if (Key == TEXT("list"))
 			{
-				if (Key == TEXT("list"))
-				{
-					// Ah, they want a list of servers.
-					for ( TMap<FString, FString>::TIterator It(MasterMap); It; ++It )
-					{
-						FString ListEntry = FString::Printf( TEXT("\\ip\\") );
-
-						// Get the port.
-						INT Pos = It.Value().InStr( TEXT("\\") );
-						FString PortID = It.Value().Left(Pos);
-
-						// Get the IP address.
-						Pos = It.Key().InStr( TEXT(":") );
-						FString IPAddr = It.Key().Left(Pos);
-
-						ListEntry = ListEntry + IPAddr + FString::Printf(TEXT(":")) + PortID;
-
-						INT BytesSent = send( Connections[Index], appToAnsi(*ListEntry), ListEntry.Len(), 0 );
-						if ( BytesSent != SOCKET_ERROR )
-							OpStats.BytesSent += BytesSent;
-					}
-					// Terminate the list.
-					FString Final = FString::Printf( TEXT("\\final\\") );
-					send( Connections[Index], appToAnsi(*Final), Final.Len(), 0 );
-					closesocket( Connections[Index] );
-					Connections[Index] = 0;
-				}
+				// Ah, they want a list of servers.
+				if( ServerListDirty )
+					BuildServerList();
+				ListQueries++;
+				Client.Done = 1;
+				Client.Request.Empty();
+				return SendClient( Socket, Client, &ServerList(0), ServerList.Num() );
 			}
-
 			Key.Empty();
 		}
+		return 1;
+
+		unguard;
+	}
+
+	//
+	// Send to a client, straight from Data as far as the socket allows.
+	// Returns 0 if the connection failed.
+	//
+	UBOOL SendClient( INT Socket, FMasterClient& Client, const BYTE* Data, INT Count )
+	{
+		guard(SendClient);
+
+		INT Sent = 0;
+		if( !Client.Reply.Num() )
+		{
+			Sent = SendSome( Socket, Data, Count );
+			if( Sent < 0 )
+				return 0;
+			OpStats.BytesSent += Sent;
+		}
+		if( Sent < Count )
+		{
+			INT Start = Client.Reply.Add( Count - Sent );
+			appMemcpy( &Client.Reply(Start), Data + Sent, Count - Sent );
+		}
+		return 1;
 
 		unguard;
 	}
 
-	void PurgeValidationMap()
+	//
+	// Close a client that is finished, otherwise poll it for what it needs.
+	//
+	void UpdateClient( INT Socket, FMasterClient& Client )
 	{
-		guard(PurgeValidationMap);
+		guard(UpdateClient);
 
-		ValidationMap.Empty();
+		if( Client.Done && !Client.Reply.Num() )
+			CloseClient( Socket );
+		else
+			Reactor->Watch( Socket, Client.Reply.Num() ? SOCKREADY_Read|SOCKREADY_Write : SOCKREADY_Read );
 
 		unguard;
 	}
 
-	void PurgeMasterMap()
+	void CloseClient( INT Socket )
 	{
-		guard(PurgeMasterMap);
+		guard(CloseClient);
+
+		Reactor->Forget( Socket );
+		closesocket( Socket );
+		Clients.Remove( Socket );
+		NumClients--;
 
-		TArray<FString> PurgeKeys;
+		unguard;
+	}
 
-		// First pass, update times and note elements that need to be removed.
-		for ( TMap<FString, FString>::TIterator It(MasterMap); It; ++It )
+	//
+	// Serialize the server list as sent to clients.
+	//
+	void BuildServerList()
+	{
+		guard(BuildServerList);
+
+		ServerList.Empty();
+		for ( TMap<FString, FMasterServerEntry>::TIterator It(MasterMap); It; ++It )
 		{
-			// Split the value.
-			INT     Pos    = It.Value().InStr( TEXT("\\") );
-			FString PortID = It.Value().Left(Pos);
-			FString Time   = It.Value().Right( It.Value().Len() - (PortID.Len() + 1) );
+			// Get the IP address.
+			INT Pos = It.Key().InStr( TEXT(":") );
+			FString IPAddr = It.Key().Left(Pos);
+
+			AppendAnsi( ServerList, *FString::Printf( TEXT("\\ip\\%s:%s"), *IPAddr, *It.Value().PortID ) );
+		}
+		// Terminate the list.
+		AppendAnsi( ServerList, TEXT("\\final\\") );
+		ServerListDirty = 0;
+
+		unguard;
+	}
+
+	//
+	// Advance the clock a second and expire whatever has fallen due.
+	//
+	void ExpireTimers()
+	{
+		guard(ExpireTimers);
+
+		Seconds++;
+		INT i;
 
-			// Decrement the time.
-			INT DecayTime = appAtoi(*Time);
-			DecayTime -= 10;
-			
-			// Now update the entry.
-			It.Value() = FString::Printf( TEXT("%s\\%i"), *PortID, DecayTime );
+		// Servers which stopped sending heartbeats.
+		TArray<FString> Due;
+		ServerTimers.Advance( Due );
+		for( i=0; i<Due.Num(); i++ )
+		{
+			FMasterServerEntry* Entry = MasterMap.Find( Due(i) );
+			if( !Entry )
+				continue;
+			if( Entry->Expires > Seconds )
+				ServerTimers.Add( Entry->Expires - Seconds, Due(i) );
+			else
+			{
+				MasterMap.Remove( *Due(i) );
+				NumServers--;
+				ServerListDirty = ServerFileDirty = 1;
+			}
+		}
 
-			// Check to see if this one needs to be removed.
-			if (DecayTime <= 0)
-				new(PurgeKeys)FString( It.Key() );
+		// Challenges that were never answered.
+		ValidationTimers.Advance( Due );
+		for( i=0; i<Due.Num(); i++ )
+		{
+			FMasterValidation* Pending = ValidationMap.Find( Due(i) );
+			if( !Pending )
+				continue;
+			if( Pending->Expires > Seconds )
+				ValidationTimers.Add( Pending->Expires - Seconds, Due(i) );
+			else
+			{
+				ValidationMap.Remove( *Due(i) );
+				NumPending--;
+			}
 		}
 
-		// Second pass, outside of the TIterator, remove all marked keys.
-		for ( INT i=0; i<PurgeKeys.Num(); i++ )
+		// Clients which have been connected too long.  A socket handle may
+		// have been reused by a newer client, which the deadline tells apart.
+		TArray<INT> DueClients;
+		ClientTimers.Advance( DueClients );
+		for( i=0; i<DueClients.Num(); i++ )
 		{
-			MasterMap.Remove( *PurgeKeys(i) );
-			NumServers--;
+			FMasterClient* Client = Clients.Find( DueClients(i) );
+			if( !Client )
+				continue;
+			if( Client->Expires > Seconds )
+				ClientTimers.Add( Client->Expires - Seconds, DueClients(i) );
+			else
+				CloseClient( DueClients(i) );
 		}
 
 		unguard;
@@ -567,15 +826,13 @@ class UMasterServerCommandlet : public UCommandlet
 
 		GFileManager->Delete( *OutputFileName );
 		FString OutputString = FString::Printf( TEXT("") );
-		for ( TMap<FString, FString>::TIterator It(MasterMap); It; ++It )
+		for ( TMap<FString, FMasterServerEntry>::TIterator It(MasterMap); It; ++It )
 		{
-			INT     Pos    = It.Value().InStr( TEXT("\\") );
-			FString PortID = It.Value().Left(Pos);
-			INT     Port   = appAtoi(*PortID);
-
-			OutputString = FString::Printf( TEXT("%s%s %i %i\r\n"), *OutputString, *It.Key(), Port, Port+1 );
+			INT Port = appAtoi(*It.Value().PortID);
+			OutputString += FString::Printf( TEXT("%s %i %i\r\n"), *It.Key(), Port, Port+1 );
 		}
 		appSaveStringToFile( OutputString, *OutputFileName );
+		ServerFileDirty = 0;
 
 		unguard;
 	}
@@ -585,9 +842,19 @@ class UMasterServerCommandlet : public UCommandlet
 		guard(CleanUp);
 
 		GWarn->Logf( TEXT("!! Cleaning up and exiting.") );
+		TArray<INT> Sockets;
+		for( TMap<INT, FMasterClient>::TIterator It(Clients); It; ++It )
+			Sockets.AddItem( It.Key() );
+		for( INT i=0; i<Sockets.Num(); i++ )
+			CloseClient( Sockets(i) );
+		if( TCPSocket.Socket != INVALID_SOCKET )
+			closesocket(TCPSocket.Socket);
 		closesocket(ListenSocket.Socket);
+		delete Reactor;
+		Reactor = NULL;
 		GWarn->Logf( TEXT("!! Session statistics.") );
 		GWarn->Logf( TEXT("   Messages Serviced: %i"), OpStats.MessagesServiced );
+		GWarn->Logf( TEXT("   List Queries:      %i"), ListQueries );
 		GWarn->Logf( TEXT("   Bytes Received:    %i"), OpStats.BytesReceived );
 		GWarn->Logf( TEXT("   Bytes Sent:        %i"), OpStats.BytesSent );
 
@@ -630,62 +897,51 @@ class UMasterServerCommandlet : public UCommandlet
 		GConfig->GetInt( TEXT("TCPLink"), TEXT("TCPPort"), TCPPort, *ConfigFileName );
 		GWarn->Logf( TEXT("   TCPLink Mode Service Port: %i"), TCPPort );
 
+		MASTER_TIMEOUT = 600;
+		Seconds = 0;
+		NumServers = 0;
+		ServerListDirty = 1;
+		ServerFileDirty = 1;
+		ServerTimers.Init( MASTER_TIMEOUT );
+		ValidationTimers.Init( MASTER_VALIDATION_TIMEOUT );
+		ClientTimers.Init( MASTER_CLIENT_TIMEOUT );
+
 		// Initialize sockets.
 		InitSockets(*ConfigFileName);
+		if( ListenSocket.Socket == INVALID_SOCKET || (OpMode == TEXT("TCPLink") && TCPSocket.Socket == INVALID_SOCKET) )
+		{
+			delete Reactor;
+			return 1;
+		}
 
 		// Get the time.
-		Last10Seconds  = appSeconds();
-		Last300Seconds = appSeconds();
-
-		MASTER_TIMEOUT = 600;
+		NextSecond = appSeconds() + 1.0;
+		LastReport = appSeconds();
 
 		// Listen and service.
 		GWarn->Logf( TEXT("!! Listening for and servicing messages.") );
-		NumServers = 0;
 		while (ConsoleReadInput()) {
-			ListenSockets();
+			// Sleep until there is socket activity or a timer is due.
+			ListenSockets( Clamp( appFloor( (NextSecond - appSeconds()) * 1000.0 ), 0, 1000 ) );
 
 			DOUBLE CurrentTime = appSeconds();
-			if ( CurrentTime - Last300Seconds > 300 )
+			while( CurrentTime >= NextSecond )
 			{
-				// Every 300 seconds, purge the ValdiationMap.
-				// This ensures memory doesn't fill up with stale validation attempts in the long run.
-				PurgeValidationMap();
-				Last300Seconds = CurrentTime;
+				ExpireTimers();
+				NextSecond += 1.0;
 			}
 
-			if ( CurrentTime - Last10Seconds > 10 )
+			if ( CurrentTime - LastReport > 10 )
 			{
-				// Every 10 seconds, purge the MasterMap.
-				PurgeMasterMap();
-				Last10Seconds = CurrentTime;
+				LastReport = CurrentTime;
 
 				// Print report.
-				INT VMapCount = 0;
-				for ( TMap<FString, FString>::TIterator It(ValidationMap); It; ++It )
-					VMapCount++;
-				GWarn->Serialize( *FString::Printf( TEXT("Approved: %i Pending: %i Ignored: %i Rejected: %i        "), NumServers, VMapCount, IgnoredValidations, RejectedValidations ), NAME_Progress );
+				GWarn->Serialize( *FString::Printf( TEXT("Approved: %i Pending: %i Ignored: %i Rejected: %i Clients: %i Lists: %i        "), NumServers, NumPending, IgnoredValidations, RejectedValidations, NumClients, ListQueries ), NAME_Progress );
 
-				// Write out the server list.
-				if ( OpMode == TEXT("TextFile") )
+				// Write out the server list if it changed.
+				if ( OpMode == TEXT("TextFile") && ServerFileDirty )
 					WriteMasterMap();
-
-				// Check a connection to see if its timed out.
-				for (INT i=0; i<100; i++)
-					if (Connections[i] != 0)
-					{
-						ConnectionTimer[i] += 10;
-						if (ConnectionTimer[i] > 20)
-						{
-							closesocket(Connections[i]);
-							Connections[i] = 0;
-							ConnectionTimer[i] = 0;
-						}
-					}
 			}
-
-			if ( OpMode == TEXT("TCPLink") )
-				PollConnections();
 		}
 
 		// Clean up.
@@ -697,6 +953,288 @@ class UMasterServerCommandlet : public UCommandlet
 };
 IMPLEMENT_CLASS(UMasterServerCommandlet)
 
+/*-----------------------------------------------------------------------------
+	UMasterLoadCommandlet.
+-----------------------------------------------------------------------------*/
+
+// A simulated browser client.
+struct FMasterLoadClient
+{
+	INT		Socket;				// Connection, or INVALID_SOCKET.
+	UBOOL	Sent;				// Whether the list request has been sent.
+	DOUBLE	StartTime;			// When the connection was opened.
+	INT		Received;			// List bytes received.
+	ANSICHAR Tail[8];			// Last bytes received, to spot the terminator.
+};
+
+//
+// Load test for the master server.  Optionally registers SERVERS= fake
+// servers by heartbeat and validation, then keeps CLIENTS= connections
+// querying the list for SECONDS= and reports queries per second:
+// ucc IpDrv.MasterLoad HOST=127.0.0.1 PORT=28900 UDPPORT=27900 CLIENTS=64 SECONDS=10 SERVERS=0 GAMENAME=ut
+//
+class UMasterLoadCommandlet : public UCommandlet
+{
+	DECLARE_CLASS(UMasterLoadCommandlet, UCommandlet, CLASS_Transient);
+
+	FSocketReactor* Reactor;
+	SOCKADDR_IN ListAddr, HeartbeatAddr;
+	FString GameName;
+	TArray<FMasterLoadClient> Clients;
+	TMap<INT, INT> ClientIndex;				// Client by socket.
+	INT Queries, Failures;
+	DOUBLE Bytes, TotalLatency;
+
+	void StaticConstructor()
+	{
+		guard(UMasterLoadCommandlet::StaticConstructor);
+
+		LogToStdout = 1;
+		IsClient    = 0;
+		IsEditor    = 0;
+		IsServer    = 0;
+		LazyLoad    = 1;
+
+		unguard;
+	}
+
+	//
+	// Register fake servers, each heartbeating from its own UDP socket.
+	// Returns how many were validated.
+	//
+	INT RegisterServers( INT NumServers )
+	{
+		guard(UMasterLoadCommandlet::RegisterServers);
+
+		TArray<INT> Sockets;
+		INT i, Validated=0;
+		for( i=0; i<NumServers; i++ )
+		{
+			INT S = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+			if( S == INVALID_SOCKET )
+				break;
+			if( !Reactor->CanWatch( S ) )
+			{
+				closesocket( S );
+				break;
+			}
+			DWORD NoBlock = 1;
+			ioctlsocket( S, FIONBIO, &NoBlock );
+			FString Heartbeat = FString::Printf( TEXT("\\heartbeat\\%i\\gamename\\%s\\"), 7778 + i, *GameName );
+			sendto( S, appToAnsi(*Heartbeat), Heartbeat.Len(), 0, (sockaddr*)&HeartbeatAddr, sizeof(HeartbeatAddr) );
+			Reactor->Watch( S, SOCKREADY_Read );
+			Sockets.AddItem( S );
+		}
+
+		// Answer challenges for a few seconds.
+		DOUBLE EndTime = appSeconds() + 5.0;
+		while( Validated < Sockets.Num() && appSeconds() < EndTime )
+		{
+			Reactor->Wait( 100 );
+			TArray<INT> Ready = Reactor->ReadySockets();
+			for( i=0; i<Ready.Num(); i++ )
+			{
+				ANSICHAR Buffer[256];
+				INT BytesReceived = recv( Ready(i), Buffer, sizeof(Buffer) - 1, 0 );
+				if( BytesReceived < 6 )
+					continue;
+				Buffer[BytesReceived] = 0;
+				FString Challenge = FString(appFromAnsi(Buffer)).Right( 6 ), Response;
+				GSValidate( &Challenge, &Response, &GameName );
+				FString Validate = FString::Printf( TEXT("\\validate\\%s\\"), *Response );
+				sendto( Ready(i), appToAnsi(*Validate), Validate.Len(), 0, (sockaddr*)&HeartbeatAddr, sizeof(HeartbeatAddr) );
+				Validated++;
+			}
+		}
+		for( i=0; i<Sockets.Num(); i++ )
+		{
+			Reactor->Forget( Sockets(i) );
+			closesocket( Sockets(i) );
+		}
+		return Validated;
+
+		unguard;
+	}
+
+	//
+	// Open a new query connection in slot Index.
+	//
+	void OpenClient( INT Index )
+	{
+		guard(UMasterLoadCommandlet::OpenClient);
+
+		FMasterLoadClient& Client = Clients(Index);
+		appMemzero( &Client, sizeof(Client) );
+		Client.Socket    = INVALID_SOCKET;
+		Client.StartTime = appSeconds();
+
+		INT S = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+		if( S == INVALID_SOCKET )
+		{
+			Failures++;
+			return;
+		}
+		DWORD NoBlock = 1;
+		ioctlsocket( S, FIONBIO, &NoBlock );
+		if( connect( S, (sockaddr*)&ListAddr, sizeof(ListAddr) ) == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK && WSAGetLastError() != EINPROGRESS )
+		{
+			closesocket( S );
+			Failures++;
+			return;
+		}
+		if( !Reactor->Watch( S, SOCKREADY_Read|SOCKREADY_Write ) )
+		{
+			closesocket( S );
+			Failures++;
+			return;
+		}
+		Client.Socket = S;
+		ClientIndex.Set( S, Index );
+
+		unguard;
+	}
+
+	//
+	// Finish a query, counting it if the whole list arrived.
+	//
+	void CloseClient( INT Index, UBOOL Success )
+	{
+		guard(UMasterLoadCommandlet::CloseClient);
+
+		FMasterLoadClient& Client = Clients(Index);
+		if( Success )
+		{
+			Queries++;
+			Bytes        += Client.Received;
+			TotalLatency += appSeconds() - Client.StartTime;
+		}
+		else Failures++;
+		Reactor->Forget( Client.Socket );
+		ClientIndex.Remove( Client.Socket );
+		closesocket( Client.Socket );
+		Client.Socket = INVALID_SOCKET;
+
+		unguard;
+	}
+
+	void ServiceClient( INT Index, DWORD Ready )
+	{
+		guard(UMasterLoadCommandlet::ServiceClient);
+
+		FMasterLoadClient& Client = Clients(Index);
+		if( !Client.Sent && (Ready & SOCKREADY_Write) )
+		{
+			static const ANSICHAR Request[] = "\\list\\\\gamename\\ut\\final\\";
+			if( send( Client.Socket, Request, ARRAY_COUNT(Request) - 1, MSG_NOSIGNAL ) != ARRAY_COUNT(Request) - 1 )
+			{
+				CloseClient( Index, 0 );
+				return;
+			}
+			Client.Sent = 1;
+			Reactor->Watch( Client.Socket, SOCKREADY_Read );
+		}
+		if( Ready & SOCKREADY_Read )
+		{
+			for( ;; )
+			{
+				ANSICHAR Buffer[4096];
+				INT BytesReceived = recv( Client.Socket, Buffer, sizeof(Buffer), 0 );
+				if( BytesReceived == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK )
+					break;
+				if( BytesReceived <= 0 )
+				{
+					// The server closes once the list is sent.
+					CloseClient( Index, BytesReceived == 0 && Client.Sent && appStrcmp( appFromAnsi(Client.Tail), TEXT("\\final\\") ) == 0 );
+					return;
+				}
+				if( Client.Sent )
+					Client.Received += BytesReceived;
+				for( INT i=Max(0,BytesReceived-7); i<BytesReceived; i++ )
+				{
+					appMemmove( Client.Tail, Client.Tail + 1, 6 );
+					Client.Tail[6] = Buffer[i];
+				}
+			}
+		}
+
+		unguard;
+	}
+
+	INT Main( const TCHAR* Parms )
+	{
+		guard(UMasterLoadCommandlet::Main);
+
+		FString Host = TEXT("127.0.0.1");
+		INT Port=28900, UDPPort=27900, NumClients=64, NumServers=0;
+		FLOAT Duration=10.f;
+		GameName = TEXT("ut");
+		Parse( Parms, TEXT("HOST="), Host );
+		Parse( Parms, TEXT("PORT="), Port );
+		Parse( Parms, TEXT("UDPPORT="), UDPPort );
+		Parse( Parms, TEXT("CLIENTS="), NumClients );
+		Parse( Parms, TEXT("SERVERS="), NumServers );
+		Parse( Parms, TEXT("SECONDS="), Duration );
+		Parse( Parms, TEXT("GAMENAME="), GameName );
+		NumClients = Max( NumClients, 1 );
+
+		FString Error;
+		if( !::InitSockets( Error ) )
+		{
+			GWarn->Logf( TEXT("%s"), *Error );
+			return 1;
+		}
+		in_addr HostAddr;
+		HostAddr.s_addr = inet_addr( appToAnsi(*Host) );
+		ListAddr.sin_family      = AF_INET;
+		ListAddr.sin_addr        = HostAddr;
+		ListAddr.sin_port        = htons( Port );
+		HeartbeatAddr            = ListAddr;
+		HeartbeatAddr.sin_port   = htons( UDPPort );
+		Reactor = CreateSocketReactor();
+
+		if( NumServers > 0 )
+			GWarn->Logf( TEXT("Registered %i of %i servers"), RegisterServers( NumServers ), NumServers );
+
+		// Keep every client busy querying.
+		Queries = Failures = 0;
+		Bytes = TotalLatency = 0.0;
+		Clients.AddZeroed( NumClients );
+		INT i;
+		for( i=0; i<NumClients; i++ )
+			OpenClient( i );
+		DOUBLE StartTime = appSeconds(), EndTime = StartTime + Duration;
+		while( appSeconds() < EndTime )
+		{
+			Reactor->Wait( 100 );
+			TArray<INT> Ready = Reactor->ReadySockets();
+			for( i=0; i<Ready.Num(); i++ )
+			{
+				INT* Index = ClientIndex.Find( Ready(i) );
+				if( Index )
+					ServiceClient( *Index, Reactor->Ready(Ready(i)) );
+			}
+			for( i=0; i<NumClients; i++ )
+				if( Clients(i).Socket == INVALID_SOCKET )
+					OpenClient( i );
+		}
+		DOUBLE Elapsed = appSeconds() - StartTime;
+		for( i=0; i<NumClients; i++ )
+			if( Clients(i).Socket != INVALID_SOCKET )
+			{
+				Reactor->Forget( Clients(i).Socket );
+				closesocket( Clients(i).Socket );
+			}
+		delete Reactor;
+
+		GWarn->Logf( TEXT("%i clients, %.1f seconds: %i lists, %i failed"), NumClients, Elapsed, Queries, Failures );
+		GWarn->Logf( TEXT("%.1f lists/sec, %.2f msec average, %.0f bytes/list"), Queries / Elapsed, Queries ? 1000.0 * TotalLatency / Queries : 0.0, Queries ? Bytes / Queries : 0.0 );
+		return 0;
+
+		unguard;
+	}
+};
+IMPLEMENT_CLASS(UMasterLoadCommandlet)
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -17,6 +17,226 @@ IMPLEMENT_CLASS(AUdpLink);
 
 #define MAXRECVDATASIZE 4096
 
+/*-----------------------------------------------------------------------------
+	Server query cache.
+-----------------------------------------------------------------------------*/
+
+#define MAX_QUERY_RESPONSES  32		// Distinct queries cached per link.
+#define MAX_QUERY_SOURCES    4096	// Addresses tracked for rate limiting.
+#define MAX_QUERIES_PER_TICK 64		// Packets read per tick while caching.
+#define QUERY_SOURCE_IDLE    10.0	// Seconds before an idle address is forgotten.
+
+FUdpQueryStats GUdpQueryStats;
+
+void FUdpQueryStats::Hit( DOUBLE Now )
+{
+	Hits++;
+	if( Now-WindowStart>=1.0 )
+	{
+		HitsPerSec  = Now-WindowStart<2.0 ? WindowHits / (Now-WindowStart) : 0.f;
+		WindowHits  = 0;
+		WindowStart = Now;
+	}
+	WindowHits++;
+}
+FString FUdpQueryStats::Describe()
+{
+	return FString::Printf
+	(
+		TEXT("%.1f hits/sec, %i hits, %i misses, %i dropped by rate limit"),
+		HitsPerSec,
+		Hits,
+		Misses,
+		Dropped
+	);
+}
+
+// Packets sent in answer to one query, without their queryid.
+struct FQueryResponse
+{
+	INT				Generation;
+	DOUBLE			Time;
+	TArray<FString>	Packets;
+};
+
+// Rate limiting state of one remote address.
+struct FQuerySource
+{
+	FLOAT			Tokens;
+	DOUBLE			Time;
+};
+
+//
+// Responses captured from script, and per-address query budgets.
+//
+class FUdpQueryCache
+{
+public:
+	TMap<FString,FQueryResponse>	Responses;
+	INT								NumResponses;
+	TMap<DWORD,FQuerySource>		Sources;
+	INT								NumSources;
+	FString							CaptureQuery;	// Query being captured.
+	FQueryResponse					Capture;		// Packets captured so far.
+	UBOOL							bCapturing;
+	INT								QueryNum;		// Last queryid used for a cached response.
+
+	FUdpQueryCache()
+	:	NumResponses( 0 )
+	,	NumSources	( 0 )
+	,	bCapturing	( 0 )
+	,	QueryNum	( 0 )
+	{}
+	void PruneSources( DOUBLE Now )
+	{
+		TMap<DWORD,FQuerySource> Active;
+		NumSources = 0;
+		for( TMap<DWORD,FQuerySource>::TIterator It(Sources); It; ++It )
+			if( Now-It.Value().Time<=QUERY_SOURCE_IDLE )
+				{Active.Set( It.Key(), It.Value() ); NumSources++;}
+		if( NumSources>=MAX_QUERY_SOURCES )
+		{
+			// Flooded from many addresses; start over rather than grow.
+			Active.Empty();
+			NumSources = 0;
+		}
+		Sources = Active;
+	}
+};
+
+//
+// Whether the loaded UdpLink class has the query cache variables.  Links
+// are allocated at the script class's size, so with an IpDrv.u built before
+// the cache they lie past the end of the object and must not be touched.
+//
+UBOOL AUdpLink::HasQueryCache()
+{
+	static INT Result = -1;
+	if( Result<0 )
+	{
+		Result = AUdpLink::StaticClass()->GetPropertiesSize()>=sizeof(AUdpLink);
+		if( !Result )
+			debugf( NAME_Warning, TEXT("IpDrv.u predates the UdpLink query cache, rebuild it") );
+	}
+	return Result;
+}
+
+FUdpQueryCache& AUdpLink::GetQueryCache()
+{
+	guard(AUdpLink::GetQueryCache);
+	FUdpQueryCache*& Cache = *(FUdpQueryCache**)&PrivateQueryCache;
+	if( !Cache )
+		Cache = new FUdpQueryCache;
+	return *Cache;
+	unguard;
+}
+
+//
+// Rate limit and answer a query natively if possible.  Returns 1 if it was
+// handled, 0 if it should be passed to ReceivedText.
+//
+UBOOL AUdpLink::FilterQuery( FIpAddr Addr, const FString& Query )
+{
+	guard(AUdpLink::FilterQuery);
+	FUdpQueryCache& Cache = GetQueryCache();
+	DOUBLE Now = appSeconds();
+
+	// Token bucket per address, holding up to one second of queries.
+	if( QueryRateLimit>0 )
+	{
+		FQuerySource* Source = Cache.Sources.Find( Addr.Addr );
+		if( !Source )
+		{
+			if( Cache.NumSources>=MAX_QUERY_SOURCES )
+				Cache.PruneSources( Now );
+			Source         = &Cache.Sources.Set( Addr.Addr, FQuerySource() );
+			Source->Tokens = QueryRateLimit;
+			Source->Time   = Now;
+			Cache.NumSources++;
+		}
+		Source->Tokens = Min<FLOAT>( Source->Tokens + (Now-Source->Time) * QueryRateLimit, QueryRateLimit );
+		Source->Time   = Now;
+		if( Source->Tokens<1.f )
+		{
+			GUdpQueryStats.Dropped++;
+			return 1;
+		}
+		Source->Tokens -= 1.f;
+	}
+
+	// Resend a cached response under a fresh queryid.
+	FQueryResponse* Response = Cache.Responses.Find( Query );
+	if( !Response || Response->Generation!=QueryGeneration || Now-Response->Time>QueryCacheLifetime )
+	{
+		GUdpQueryStats.Misses++;
+		return 0;
+	}
+	if( ++Cache.QueryNum>100 )
+		Cache.QueryNum = 1;
+	sockaddr_in To;
+	To.sin_family      = AF_INET;
+	To.sin_port        = htons(Addr.Port);
+	To.sin_addr.s_addr = htonl(Addr.Addr);
+	for( INT i=0; i<Response->Packets.Num(); i++ )
+	{
+		FString Packet = Response->Packets(i) + FString::Printf( TEXT("\\queryid\\%i.%i"), Cache.QueryNum, i+1 );
+		sendto( GetSocket(), (char*)appToAnsi(*Packet), Packet.Len(), 0, (sockaddr*)&To, sizeof(To) );
+	}
+	GUdpQueryStats.Hit( Now );
+	return 1;
+	unguard;
+}
+
+//
+// BeginQueryCache: Capture text sent from now on as the response to Query.
+//
+void AUdpLink::execBeginQueryCache( FFrame& Stack, RESULT_DECL )
+{
+	guard(AUdpLink::execBeginQueryCache);
+	P_GET_STR(Query);
+	P_FINISH;
+	FUdpQueryCache& Cache = GetQueryCache();
+	Cache.CaptureQuery = Query;
+	Cache.Capture.Packets.Empty();
+	Cache.bCapturing   = 1;
+	unguardexec;
+}
+
+//
+// EndQueryCache: Store the captured response.
+//
+void AUdpLink::execEndQueryCache( FFrame& Stack, RESULT_DECL )
+{
+	guard(AUdpLink::execEndQueryCache);
+	P_FINISH;
+	FUdpQueryCache& Cache = GetQueryCache();
+	if( !Cache.bCapturing )
+		return;
+	Cache.bCapturing = 0;
+	if( !Cache.Capture.Packets.Num() )
+		return;
+	FQueryResponse* Response = Cache.Responses.Find( Cache.CaptureQuery );
+	if( !Response )
+	{
+		if( Cache.NumResponses>=MAX_QUERY_RESPONSES )
+		{
+			Cache.Responses.Empty();
+			Cache.NumResponses = 0;
+		}
+		Response = &Cache.Responses.Set( *Cache.CaptureQuery, FQueryResponse() );
+		Cache.NumResponses++;
+	}
+	Response->Generation = QueryGeneration;
+	Response->Time       = appSeconds();
+	Response->Packets    = Cache.Capture.Packets;
+	Cache.Capture.Packets.Empty();
+	unguardexec;
+}
+
+/*-----------------------------------------------------------------------------
+	AUdpLink.
+-----------------------------------------------------------------------------*/
+
 //
 // Constructor.
 //
@@ -33,7 +253,15 @@ void AUdpLink::Destroy()
 {
 	guard(AUdpLink::Destroy);
 	if( GetSocket() )
+	{
+		GetSocketReactor().Forget(GetSocket());
 		closesocket(GetSocket());
+	}
+	if( HasQueryCache() )
+	{
+		delete *(FUdpQueryCache**)&PrivateQueryCache;
+		PrivateQueryCache = 0;
+	}
 	Super::Destroy();
 	unguard;
 }
@@ -109,6 +337,14 @@ void AUdpLink::execSendText( FFrame& Stack, RESULT_DECL )
 	P_GET_STRUCT(FIpAddr,IpAddr);
 	P_GET_STR(Str);
 	P_FINISH;
+
+	// Keep a copy of responses being captured for the query cache.
+	FUdpQueryCache* Cache = HasQueryCache() ? *(FUdpQueryCache**)&PrivateQueryCache : NULL;
+	if( Cache && Cache->bCapturing )
+	{
+		INT Pos = Str.InStr( TEXT("\\queryid\\"), 1 );
+		new(Cache->Capture.Packets)FString( Pos>=0 ? Str.Left(Pos) : Str );
+	}
 	if( GetSocket() )
 	{
 		sockaddr_in Addr;
@@ -167,21 +403,34 @@ UBOOL AUdpLink::Tick( FLOAT DeltaTime, enum ELevelTick TickType )
 	UBOOL Result = Super::Tick( DeltaTime, TickType );
 	if( GetSocket() )
 	{
-		if( ReceiveMode == RMODE_Event )
+		// Poll through the reactor, and only read when something arrived.
+		FSocketReactor& Reactor = GetSocketReactor();
+		Reactor.Watch( GetSocket(), SOCKREADY_Read );
+		DWORD Ready = Reactor.Ready( GetSocket() );
+		if( ReceiveMode == RMODE_Event && (Ready & SOCKREADY_Read) )
 		{
-			BYTE Buffer[MAXRECVDATASIZE];
-			sockaddr_in FromAddr;
-			socklen_t FromSize = sizeof(FromAddr);
-			INT Count = recvfrom( GetSocket(), (char*)Buffer, ARRAY_COUNT(Buffer)-1, 0, (sockaddr*)&FromAddr, &FromSize );
-			if( Count!=SOCKET_ERROR )
+			// With the query cache on, drain a burst of queries at once since
+			// most are answered without calling script.
+			UBOOL Caching    = HasQueryCache() && bCacheQueries;
+			INT   MaxPackets = Caching ? MAX_QUERIES_PER_TICK : 1;
+			for( INT i=0; i<MaxPackets && GetSocket() && !bDeleteMe; i++ )
 			{
+				Reactor.CountSyscall();
+				BYTE Buffer[MAXRECVDATASIZE];
+				sockaddr_in FromAddr;
+				socklen_t FromSize = sizeof(FromAddr);
+				INT Count = recvfrom( GetSocket(), (char*)Buffer, ARRAY_COUNT(Buffer)-1, 0, (sockaddr*)&FromAddr, &FromSize );
+				if( Count==SOCKET_ERROR )
+					break;
 				FIpAddr Addr;
 				Addr.Addr = ntohl( FromAddr.sin_addr.s_addr );
 				Addr.Port = ntohs( FromAddr.sin_port );
 				if( LinkMode == MODE_Text )
 				{
 					Buffer[Count]=0;
-					eventReceivedText( Addr, appFromAnsi((ANSICHAR*)Buffer) );
+					FString Text = appFromAnsi((ANSICHAR*)Buffer);
+					if( !Caching || !FilterQuery( Addr, Text ) )
+						eventReceivedText( Addr, Text );
 				}
 				else if ( LinkMode == MODE_Line )
 				{
@@ -196,21 +445,7 @@ UBOOL AUdpLink::Tick( FLOAT DeltaTime, enum ELevelTick TickType )
 		}
 		else if( ReceiveMode == RMODE_Manual )
 		{
-			fd_set SocketSet;
-			TIMEVAL SelectTime = {0, 0};
-			INT Error;
-
-			FD_ZERO( &SocketSet );
-			FD_SET( Socket, &SocketSet );
-			Error = select( Socket + 1, &SocketSet, 0, 0, &SelectTime);
-			if( Error==0 || Error==SOCKET_ERROR )
-			{
-				DataPending = 0;
-			}
-			else
-			{
-				DataPending = 1;
-			}
+			DataPending = (Ready & SOCKREADY_Read) != 0;
 		}
 	}
 
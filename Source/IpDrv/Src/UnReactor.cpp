@@ -0,0 +1,359 @@
+/*=============================================================================
+	UnReactor.cpp: Socket readiness polling for internet links.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+#include "IpDrvPrivate.h"
+
+#if defined(__linux__) && !defined(PLATFORM_DREAMCAST)
+	#include <sys/epoll.h>
+	#define USE_EPOLL 1
+#else
+	#define USE_EPOLL 0
+#endif
+
+/*-----------------------------------------------------------------------------
+	FSocketReactor.
+-----------------------------------------------------------------------------*/
+
+FSocketReactor::FSocketReactor()
+:	Syscalls		( 0 )
+,	LastSyscalls	( 0 )
+,	LastReady		( 0 )
+,	NumTicks		( 0 )
+,	TotalSyscalls	( 0.0 )
+,	NumWatches		( 0 )
+,	PollTick		( -1 )
+{}
+
+//
+// Poll the socket S on this tick, with Events being the readiness wanted.
+// Returns 0 if this backend can't poll the socket.
+//
+UBOOL FSocketReactor::Watch( SOCKET S, DWORD Events )
+{
+	guard(FSocketReactor::Watch);
+	FWatch* Found = Watches.Find( S );
+	if( !Found )
+	{
+		if( !CanWatch(S) )
+			return 0;
+		FWatch NewWatch;
+		NewWatch.Events   = Events;
+		NewWatch.Ready    = 0;
+		NewWatch.LastTick = GTicks;
+		Watches.Set( S, NewWatch );
+		NumWatches++;
+		Register( S, Events, 1 );
+	}
+	else
+	{
+		if( Found->Events!=Events )
+		{
+			Found->Events = Events;
+			Register( S, Events, 0 );
+		}
+		Found->LastTick = GTicks;
+	}
+	return 1;
+	unguard;
+}
+
+//
+// Stop polling a socket; call before closing it.
+//
+void FSocketReactor::Forget( SOCKET S )
+{
+	guard(FSocketReactor::Forget);
+	if( S!=INVALID_SOCKET && Watches.Find(S) )
+	{
+		Unregister( S );
+		Watches.Remove( S );
+		NumWatches--;
+		ReadyList.RemoveItem( S );
+	}
+	unguard;
+}
+
+//
+// Return the readiness of a socket this tick, polling all sockets first
+// if nobody has yet.
+//
+DWORD FSocketReactor::Ready( SOCKET S )
+{
+	guard(FSocketReactor::Ready);
+	if( PollTick!=GTicks )
+		BeginTick();
+	FWatch* Found = Watches.Find( S );
+	return Found ? Found->Ready : 0;
+	unguard;
+}
+void FSocketReactor::SetReady( SOCKET S, DWORD Events )
+{
+	FWatch* Found = Watches.Find( S );
+	if( Found && Events )
+	{
+		Found->Ready = Events;
+		ReadyList.AddItem( S );
+	}
+}
+
+//
+// Poll all watched sockets, waiting up to TimeoutMS for one to become
+// ready.  Returns the number of ready sockets.
+//
+INT FSocketReactor::Wait( INT TimeoutMS )
+{
+	guard(FSocketReactor::Wait);
+	LastSyscalls   = Syscalls;
+	TotalSyscalls += Syscalls;
+	Syscalls       = 0;
+	NumTicks++;
+
+	for( INT i=0; i<ReadyList.Num(); i++ )
+	{
+		FWatch* Found = Watches.Find( ReadyList(i) );
+		if( Found )
+			Found->Ready = 0;
+	}
+	ReadyList.Empty();
+
+	PollTick = GTicks;
+	if( NumWatches )
+		Poll( TimeoutMS );
+	else if( TimeoutMS > 0 )
+		appSleep( TimeoutMS / 1000.f );
+	LastReady = ReadyList.Num();
+	return LastReady;
+	unguard;
+}
+
+//
+// Drop sockets nobody watches any more, then poll without waiting.
+//
+void FSocketReactor::BeginTick()
+{
+	guard(FSocketReactor::BeginTick);
+	TArray<INT> Stale;
+	for( TMap<INT,FWatch>::TIterator It(Watches); It; ++It )
+		if( It.Value().LastTick < GTicks-1 )
+			Stale.AddItem( It.Key() );
+	for( INT i=0; i<Stale.Num(); i++ )
+		Forget( Stale(i) );
+
+	Wait( 0 );
+	unguard;
+}
+FString FSocketReactor::Describe()
+{
+	return FString::Printf
+	(
+		TEXT("%s: %i sockets, %i ready and %i syscalls last tick, %.2f syscalls/tick average"),
+		GetName(),
+		NumWatches,
+		LastReady,
+		LastSyscalls,
+		NumTicks ? TotalSyscalls / NumTicks : 0.0
+	);
+}
+
+/*-----------------------------------------------------------------------------
+	FSelectReactor.
+-----------------------------------------------------------------------------*/
+
+// Longest a select reactor with more than one fd_set sleeps between polls.
+#define SELECT_SLICE_MS 5
+
+//
+// Portable reactor making one select call per tick.  A Winsock fd_set
+// holds at most FD_SETSIZE (64) sockets, so beyond that the sockets are
+// polled one set at a time.  A POSIX fd_set is a bitmap indexed by the
+// descriptor and can't hold one of FD_SETSIZE or more at all, so those
+// are refused.
+//
+class FSelectReactor : public FSocketReactor
+{
+public:
+	const TCHAR* GetName()
+	{
+		return TEXT("select");
+	}
+	UBOOL CanWatch( SOCKET S )
+	{
+#if __WINSOCK__
+		return 1;
+#else
+		return S>=0 && S<FD_SETSIZE;
+#endif
+	}
+protected:
+	void Poll( INT TimeoutMS )
+	{
+		guard(FSelectReactor::Poll);
+		TArray<INT> Sockets;
+		for( TMap<INT,FWatch>::TIterator It(Watches); It; ++It )
+			Sockets.AddItem( It.Key() );
+
+		// With one set, block in select; with more, poll them all without
+		// waiting and sleep in short slices, so no set goes unpolled for long.
+		if( Sockets.Num()<=FD_SETSIZE )
+		{
+			PollSet( Sockets, 0, Sockets.Num(), TimeoutMS );
+			return;
+		}
+		DOUBLE EndTime = appSeconds() + TimeoutMS / 1000.0;
+		for( ; ; )
+		{
+			for( INT First=0; First<Sockets.Num(); First+=FD_SETSIZE )
+				PollSet( Sockets, First, Min<INT>(Sockets.Num()-First, FD_SETSIZE), 0 );
+			DOUBLE Remaining = EndTime - appSeconds();
+			if( ReadyList.Num() || Remaining<=0.0 )
+				break;
+			appSleep( Min( Remaining, SELECT_SLICE_MS / 1000.0 ) );
+		}
+		unguard;
+	}
+	void PollSet( TArray<INT>& Sockets, INT First, INT Count, INT TimeoutMS )
+	{
+		guard(FSelectReactor::PollSet);
+		fd_set ReadSet, WriteSet;
+		FD_ZERO( &ReadSet );
+		FD_ZERO( &WriteSet );
+		INT MaxSocket = 0;
+		for( INT i=First; i<First+Count; i++ )
+		{
+			FWatch* Watch = Watches.Find( Sockets(i) );
+			if( Watch->Events & SOCKREADY_Read )
+				FD_SET( (SOCKET)Sockets(i), &ReadSet );
+			if( Watch->Events & SOCKREADY_Write )
+				FD_SET( (SOCKET)Sockets(i), &WriteSet );
+			MaxSocket = Max( MaxSocket, Sockets(i) );
+		}
+		TIMEVAL SelectTime = {TimeoutMS / 1000, (TimeoutMS % 1000) * 1000};
+		CountSyscall();
+		INT Ready = select( MaxSocket + 1, &ReadSet, &WriteSet, 0, &SelectTime );
+		if( Ready==0 || Ready==SOCKET_ERROR )
+			return;
+		for( INT i=First; i<First+Count; i++ )
+			SetReady
+			(
+				Sockets(i),
+					(FD_ISSET( (SOCKET)Sockets(i), &ReadSet  ) ? SOCKREADY_Read  : 0)
+				|	(FD_ISSET( (SOCKET)Sockets(i), &WriteSet ) ? SOCKREADY_Write : 0)
+			);
+		unguard;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+	FEpollReactor.
+-----------------------------------------------------------------------------*/
+
+#if USE_EPOLL
+
+//
+// Linux reactor.  Sockets stay registered with the kernel, so a tick with
+// no changes costs one epoll_wait however many links there are.
+//
+class FEpollReactor : public FSocketReactor
+{
+public:
+	INT Epoll;
+	TArray<epoll_event> Events;
+
+	FEpollReactor()
+	:	Epoll( epoll_create(64) )
+	{}
+	~FEpollReactor()
+	{
+		if( Epoll>=0 )
+			close( Epoll );
+	}
+	const TCHAR* GetName()
+	{
+		return TEXT("epoll");
+	}
+protected:
+	void Register( SOCKET S, DWORD Wanted, UBOOL New )
+	{
+		guard(FEpollReactor::Register);
+		epoll_event Event;
+		appMemzero( &Event, sizeof(Event) );
+		Event.events  = ((Wanted & SOCKREADY_Read) ? EPOLLIN : 0) | ((Wanted & SOCKREADY_Write) ? EPOLLOUT : 0);
+		Event.data.fd = S;
+		CountSyscall();
+		if( epoll_ctl( Epoll, New ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, S, &Event )!=0 && (errno==EEXIST || errno==ENOENT) )
+		{
+			// The kernel's view differs from ours, e.g. the socket was closed
+			// and its handle reused without being forgotten.
+			CountSyscall();
+			epoll_ctl( Epoll, New ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, S, &Event );
+		}
+		unguard;
+	}
+	void Unregister( SOCKET S )
+	{
+		guard(FEpollReactor::Unregister);
+		epoll_event Event;
+		CountSyscall();
+		epoll_ctl( Epoll, EPOLL_CTL_DEL, S, &Event );
+		unguard;
+	}
+	void Poll( INT TimeoutMS )
+	{
+		guard(FEpollReactor::Poll);
+		if( Events.Num() < NumWatches )
+			Events.Add( NumWatches - Events.Num() );
+		CountSyscall();
+		INT Count = epoll_wait( Epoll, &Events(0), Events.Num(), TimeoutMS );
+		for( INT i=0; i<Count; i++ )
+		{
+			DWORD Got = Events(i).events;
+			SetReady
+			(
+				Events(i).data.fd,
+					((Got & (EPOLLIN|EPOLLHUP|EPOLLERR)) ? SOCKREADY_Read  : 0)
+				|	((Got & (EPOLLOUT|EPOLLERR))         ? SOCKREADY_Write : 0)
+			);
+		}
+		unguard;
+	}
+};
+
+#endif
+
+/*-----------------------------------------------------------------------------
+	Reactor selection.
+-----------------------------------------------------------------------------*/
+
+FSocketReactor* CreateSocketReactor()
+{
+	guard(CreateSocketReactor);
+#if USE_EPOLL
+	if( !ParseParam( appCmdLine(), TEXT("NOEPOLL") ) )
+	{
+		FEpollReactor* EpollReactor = new FEpollReactor;
+		if( EpollReactor->Epoll>=0 )
+			return EpollReactor;
+		delete EpollReactor;
+	}
+#endif
+	return new FSelectReactor;
+	unguard;
+}
+FSocketReactor& GetSocketReactor()
+{
+	guard(GetSocketReactor);
+	static FSocketReactor* Reactor = NULL;
+	if( !Reactor )
+	{
+		Reactor = CreateSocketReactor();
+		debugf( NAME_Init, TEXT("Internet links polled with %s"), Reactor->GetName() );
+	}
+	return *Reactor;
+	unguard;
+}
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
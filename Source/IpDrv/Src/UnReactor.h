@@ -0,0 +1,97 @@
+/*=============================================================================
+	UnReactor.h: Socket readiness polling for internet links.
+	Copyright 1997-1999 Epic Games, Inc. All Rights Reserved.
+=============================================================================*/
+
+/*-----------------------------------------------------------------------------
+	FSocketReactor.
+-----------------------------------------------------------------------------*/
+
+// Socket readiness flags.
+enum ESocketReady
+{
+	SOCKREADY_Read		= 1,	// Data, a pending accept, or a close to read.
+	SOCKREADY_Write		= 2,	// Room to send, or a connect has completed.
+};
+
+//
+// Polls the sockets of every internet link once per tick, instead of each
+// link making its own select calls.  Links declare the sockets they want
+// polled with Watch, then ask for what was found with Ready.  Sockets must
+// be forgotten before they are closed.  A backend may be unable to poll
+// some sockets, in which case Watch fails and they should be closed.
+// Syscalls made on behalf of links are counted for the SOCKETSTAT command.
+//
+// Standalone servers without a level tick create their own reactor and
+// drive it with Wait, then walk ReadySockets.
+//
+class FSocketReactor
+{
+public:
+	// Stats.
+	INT		Syscalls;			// Syscalls made so far this tick.
+	INT		LastSyscalls;		// Syscalls made last tick.
+	INT		LastReady;			// Sockets found ready last tick.
+	INT		NumTicks;			// Ticks polled.
+	DOUBLE	TotalSyscalls;		// Syscalls made over all ticks.
+
+	// Constructor/destructor.
+	FSocketReactor();
+	virtual ~FSocketReactor() {}
+
+	// FSocketReactor interface.
+	UBOOL Watch( SOCKET S, DWORD Events );
+	void Forget( SOCKET S );
+	DWORD Ready( SOCKET S );
+	INT Wait( INT TimeoutMS );
+	const TArray<INT>& ReadySockets()
+	{
+		return ReadyList;
+	}
+	void CountSyscall()
+	{
+		Syscalls++;
+	}
+	INT NumSockets()
+	{
+		return NumWatches;
+	}
+	FString Describe();
+	virtual const TCHAR* GetName()=0;
+	virtual UBOOL CanWatch( SOCKET S )
+	{
+		return 1;
+	}
+
+protected:
+	// A watched socket.
+	struct FWatch
+	{
+		DWORD	Events;			// Events wanted.
+		DWORD	Ready;			// Events found by the last poll.
+		SQWORD	LastTick;		// Last tick it was watched in.
+	};
+	TMap<INT,FWatch>	Watches;
+	INT					NumWatches;		// Entries in Watches.
+	TArray<INT>			ReadyList;		// Sockets with Ready set.
+	SQWORD				PollTick;		// Tick of the last poll.
+
+	// Backend interface.
+	virtual void Poll( INT TimeoutMS )=0;
+	virtual void Register( SOCKET S, DWORD Events, UBOOL New ) {}
+	virtual void Unregister( SOCKET S ) {}
+
+	// Internal.
+	void SetReady( SOCKET S, DWORD Events );
+	void BeginTick();
+};
+
+// The reactor used by internet links, created on first use.
+FSocketReactor& GetSocketReactor();
+
+// Create a new reactor using the best backend available.
+FSocketReactor* CreateSocketReactor();
+
+/*-----------------------------------------------------------------------------
+	The End.
+-----------------------------------------------------------------------------*/
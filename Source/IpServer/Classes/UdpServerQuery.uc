@@ -19,6 +19,7 @@ class UdpServerQuery extends UdpLink config;
 var() name					QueryName;			// Name to set this object's Tag to.
 var int					    CurrentQueryNum;	// Query ID Number.
 var globalconfig string		GameName;
+var int						LastNumPlayers;		// Player count the cached responses were built with.
 
 // Initialize.
 function PreBeginPlay()
@@ -49,6 +50,23 @@ function PostBeginPlay()
 	Super.PostBeginPlay();
 }
 
+// Invalidate cached query responses when players join or leave.
+function Tick( float DeltaTime )
+{
+	if( Level.Game.NumPlayers != LastNumPlayers )
+	{
+		LastNumPlayers = Level.Game.NumPlayers;
+		QueryGeneration++;
+	}
+}
+
+// Whether a query's response is the same for everyone and may be cached.
+function bool IsCacheableQuery( string Query )
+{
+	return Query=="\\basic\\" || Query=="\\info\\" || Query=="\\rules\\"
+		|| Query=="\\players\\" || Query=="\\status\\";
+}
+
 // Received a query request.
 event ReceivedText( IpAddr Addr, string Text )
 {
@@ -62,6 +80,9 @@ event ReceivedText( IpAddr Addr, string Text )
 		CurrentQueryNum = 1;
 	QueryNum = CurrentQueryNum;
 
+	if( IsCacheableQuery(Text) )
+		BeginQueryCache(Text);
+
 	Query = Text;
 	if (Query == "")		// If the string is empty, don't parse it
 		QueryRemaining = false;
@@ -75,6 +96,7 @@ event ReceivedText( IpAddr Addr, string Text )
 		else
 			QueryRemaining = true;
 	}
+	EndQueryCache();
 }
 
 function bool ParseNextQuery( string Query, out string QueryType, out string QueryValue, out string QueryRest, out string FinalPacket )
@@ -405,5 +427,8 @@ defaultproperties
 {
      QueryName=MasterUplink
 	 GameName="unreal"
+	 bCacheQueries=True
+	 QueryCacheLifetime=2.0
+	 QueryRateLimit=10
 	 RemoteRole=ROLE_None
 }
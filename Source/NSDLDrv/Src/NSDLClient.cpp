@@ -371,8 +371,11 @@ void UNSDLClient::TryRenderDevice( UViewport* Viewport, const char* ClassName, U
 		Viewport->RenDev = NULL;
 	}
 
-	// Find device driver.
+	// Find device driver; GAMERENDERDEVICE= on the command line overrides the
+	// configured one, e.g. Engine.NullRenderDevice for headless benchmarks.
 	FString ClassNameStr = appFromAnsi(ClassName);
+	if( ClassNameStr==TEXT("ini:Engine.Engine.GameRenderDevice") )
+		Parse( appCmdLine(), TEXT("GAMERENDERDEVICE="), ClassNameStr );
 	UClass* RenderClass = UObject::StaticLoadClass( URenderDevice::StaticClass(), NULL, *ClassNameStr, NULL, LOAD_NoWarn, NULL );
 	if( RenderClass )
 	{
@@ -371,6 +371,13 @@ void URender::DrawStats( FSceneNode* Frame )
 			GStat.MeshVtricCount,
 			GStat.MeshVertLightCount
 		);
+		ShowStat
+		(
+			Frame,
+			TEXT("  AnimLOD VertsDecoded=%i VertsReused=%i"),
+			GMeshAnimLOD.FrameDecoded,
+			GMeshAnimLOD.FrameReused
+		);
 		ShowStat( Frame, TEXT(" ") );
 #if defined(LEGEND) //LEGEND
 		// actor mesh lighting stats (LOD actor lighting)
@@ -500,6 +507,7 @@ void URender::PreRender( FSceneNode* Frame )
 
 	// Init stats.
 	STAT(appMemzero(&GStat,sizeof(GStat)));
+	GMeshAnimLOD.ResetFrame();
 	LastEndTime = EndTime;
 	StartTime   = appSeconds();
 
@@ -33,6 +33,11 @@ event SendBinary(int Count, byte B[255])
 	Connection.SendBinary(Count, B);
 }
 
+event bool SendFile(string Filename)
+{
+	return Connection.SendFile(Filename) >= 0;
+}
+
 function FailAuthentication(string Realm)
 {
 	HTTPError(401, Realm);
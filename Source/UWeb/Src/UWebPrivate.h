@@ -26,10 +26,13 @@ struct UWebResponse_eventSendBinary_Parms
 	INT Count;
 	BYTE B[255];
 };
+struct UWebResponse_eventSendFile_Parms
+{
+	FString Filename;
+	BITFIELD ReturnValue;
+};
 class UWEB_API UWebResponse : public UObject
 {
-private:
-	void SendInParts(const FString &S);
 public:
 	TMap<FString, FString>	ReplacementMap;
 	FStringNoInit			IncludePath;
@@ -54,6 +57,14 @@ public:
         appMemcpy(&Parms.B[0], B, Count);
         ProcessEvent(FindFunctionChecked(NAME_SendBinary),&Parms);
     }
+    BITFIELD eventSendFile(const FString& Filename)
+    {
+        UWebResponse_eventSendFile_Parms Parms;
+        Parms.Filename=Filename;
+        Parms.ReturnValue=0;
+        ProcessEvent(FindFunctionChecked(NAME_SendFile),&Parms);
+        return Parms.ReturnValue;
+    }
     DECLARE_CLASS(UWebResponse,UObject,0)
     NO_DEFAULT_CONSTRUCTOR(UWebResponse)
 };
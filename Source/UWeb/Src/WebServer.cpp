@@ -12,6 +12,21 @@ Revision history:
 	Declarations.
 -----------------------------------------------------------------------------*/
 
+//
+// A UHTM template parsed into alternating literal text and substitution
+// keys.  Segment i is a key when i is odd.
+//
+struct FUHTMTemplate
+{
+	SQWORD			FileTime;		// File modification time when parsed.
+	INT				FileSize;		// File size when parsed.
+	INT				LiteralLen;		// Total length of the literal segments.
+	TArray<FString>	Segments;		// Literal, key, literal, key ... literal.
+};
+
+// Parsed templates by path.
+static TMap<FString,FUHTMTemplate*> GUHTMCache;
+
 /*-----------------------------------------------------------------------------
 	UWebRequest functions.
 -----------------------------------------------------------------------------*/
@@ -149,26 +164,118 @@ IMPLEMENT_FUNCTION( UWebRequest, INDEX_NONE, execGetVariableNumber );
 -----------------------------------------------------------------------------*/
 IMPLEMENT_CLASS(UWebResponse);
 
-#define UHTMPACKETSIZE 512
-void UWebResponse::SendInParts( const FString &S )
+//
+// Append Count characters to a string.
+//
+static void AppendChars( FString& S, const TCHAR* Chars, INT Count )
 {
-	guard(UWebResponse::SendInParts);
-	INT Pos = 0, L;
-	L = S.Len();
+	if( Count<=0 )
+		return;
+	TArray<TCHAR>& Array = S.GetCharArray();
+	INT Index = Array.Num() ? Array.Num()-1 : 0;
+	Array.Add( Array.Num() ? Count : Count+1 );
+	appMemcpy( &Array(Index), Chars, Count*sizeof(TCHAR) );
+	Array(Index+Count) = 0;
+}
 
-	if(L <= UHTMPACKETSIZE)
+//
+// Split template text into literal and key segments.  %% is a literal
+// percent sign, and an unmatched % is dropped.
+//
+static void ParseUHTM( const TCHAR* Text, FUHTMTemplate& Template )
+{
+	guard(ParseUHTM);
+	FString Literal;
+	Template.Segments.Empty();
+	Template.LiteralLen = 0;
+	const TCHAR* T = Text;
+	const TCHAR* P;
+	while( (P = appStrchr(T, '%')) != NULL )
 	{
-		if(L > 0)
-			eventSendText(S, 1);
-		return;
+		AppendChars( Literal, T, P - T );
+		const TCHAR* PEnd = appStrchr(P+1, '%');
+		if( !PEnd )
+		{
+			T = P + 1;
+			break;
+		}
+		if( PEnd == P + 1 )
+			Literal += TEXT("%");
+		else
+		{
+			Template.LiteralLen += Literal.Len();
+			new(Template.Segments)FString( Literal );
+			AppendChars( *new(Template.Segments)FString, P+1, PEnd - P - 1 );
+			Literal = TEXT("");
+		}
+		T = PEnd + 1;
 	}
-	while( L - Pos > UHTMPACKETSIZE )
+	Literal += T;
+	Template.LiteralLen += Literal.Len();
+	new(Template.Segments)FString( Literal );
+	unguard;
+}
+
+//
+// Find a parsed template, loading it if it isn't cached or the file has
+// changed since.
+//
+static FUHTMTemplate* FindUHTM( const FString& Path )
+{
+	guard(FindUHTM);
+	SQWORD FileTime = GFileManager->GetGlobalTime( *Path );
+	INT    FileSize = GFileManager->FileSize( *Path );
+	FUHTMTemplate** Found = GUHTMCache.Find( Path );
+	if( Found && (*Found)->FileTime==FileTime && (*Found)->FileSize==FileSize )
+		return *Found;
+
+	FString Text;
+	if( FileSize<0 || !appLoadFileToString( Text, *Path ) )
+		return NULL;
+	FUHTMTemplate* Template = Found ? *Found : new FUHTMTemplate;
+	Template->FileTime = FileTime;
+	Template->FileSize = FileSize;
+	ParseUHTM( *Text, *Template );
+	if( !Found )
+		GUHTMCache.Set( *Path, Template );
+	return Template;
+	unguard;
+}
+
+//
+// Render a template into one contiguous string.
+//
+static void RenderUHTM( FUHTMTemplate& Template, TMap<FString,FString>& ReplacementMap, FString& Result )
+{
+	guard(RenderUHTM);
+
+	// Size it all up first so the result is only allocated once.
+	INT Len = Template.LiteralLen, i;
+	for( i=1; i<Template.Segments.Num(); i+=2 )
+	{
+		FString* Value = ReplacementMap.Find( Template.Segments(i) );
+		if( Value )
+			Len += Value->Len();
+	}
+	Result.Empty();
+	if( !Len )
+		return;
+	TArray<TCHAR>& Chars = Result.GetCharArray();
+	Chars.Add( Len+1 );
+
+	TCHAR* Dest = &Chars(0);
+	for( i=0; i<Template.Segments.Num(); i++ )
 	{
-		eventSendText(S.Mid(Pos, UHTMPACKETSIZE), 1);
-		Pos += UHTMPACKETSIZE;
+		FString* Value = (i&1) ? ReplacementMap.Find( Template.Segments(i) ) : &Template.Segments(i);
+		if( Value && Value->Len() )
+		{
+			appMemcpy( Dest, **Value, Value->Len()*sizeof(TCHAR) );
+			Dest += Value->Len();
+		}
 	}
-	if(Pos > 0)
-		eventSendText(S.Mid(Pos), 1);
+	*Dest = 0;
+	check(Dest==&Chars(Len));
+
 	unguard;
 }
 
@@ -188,6 +295,16 @@ void UWebResponse::execIncludeBinaryFile( FFrame& Stack, RESULT_DECL )
 		debugf( NAME_Log, TEXT("WebServer: Bad IncludePath: %s"), *IncludePath);//!!localize!!
 		return;
 	}
+
+	// The connection queues and sends the file natively.
+	if( FindFunction( NAME_SendFile ) )
+	{
+		if( !eventSendFile( IncludePath + PATH_SEPARATOR + Filename ) )
+			debugf( NAME_Log, TEXT("WebServer: Unable to open include file %s%s%s"), *IncludePath, PATH_SEPARATOR, *Filename );//!!localize!!
+		return;
+	}
+
+	// UWeb.u predates SendFile, so pass the file through script.
 	TArray<BYTE> Data;
 	if( !appLoadFileToArray( Data, *(IncludePath + PATH_SEPARATOR + Filename)) )
 	{
@@ -218,54 +335,18 @@ void UWebResponse::execIncludeUHTM( FFrame& Stack, RESULT_DECL )
 		debugf( NAME_Log, TEXT("WebServer: Bad IncludePath: %s"), *IncludePath);//!!localize!!
 		return;
 	}
-	FString Text;
-	if( !appLoadFileToString( Text, *(IncludePath + PATH_SEPARATOR + Filename)) )
+	FUHTMTemplate* Template = FindUHTM( IncludePath + PATH_SEPARATOR + Filename );
+	if( !Template )
 	{
 		debugf( NAME_Log, TEXT("WebServer: Unable to open include file %s%s%s"), *IncludePath, PATH_SEPARATOR, *Filename );//!!localize!!
 		return;
 	}
 
-	INT Pos = 0;
-	TCHAR* T = const_cast<TCHAR*>( *Text );
-	TCHAR* P;
-	while( (P = appStrchr(T, '%')) != NULL)
-	{
-		SendInParts( Text.Mid(Pos, (P - T)) );
-		Pos += (P - T);
-		T = P;
-
-		guard(FindClosing);
-		// Find the close percentage
-		TCHAR *PEnd = appStrchr(P+1, '%');
-		if(PEnd)
-		{
-			guard(PerformReplacement);
-			FString Key = Text.Mid(Pos + (P - T) + 1, (PEnd - P) - 1);
-			FString *V, Value;
-			if(Key.Len() == 0)
-				Value = TEXT("%");
-			else
-			{
-				V = ReplacementMap.Find(Key);
-				if(V)
-					Value = *V;
-				else
-					Value = TEXT("");
-			}
-			
-			SendInParts(Value);
-			Pos += (PEnd - P) + 1;
-			T = PEnd + 1;
-			unguard;
-		}
-		else
-		{
-			Pos++;
-			T++;
-		}
-		unguard;
-	}	
-	SendInParts(Text.Mid(Pos));
+	// Send the whole page in one go.
+	FString Text;
+	RenderUHTM( *Template, ReplacementMap, Text );
+	if( Text.Len() )
+		eventSendText( Text, 1 );
 
 	unguard;
 }
@@ -295,6 +376,88 @@ void UWebResponse::execSubst( FFrame& Stack, RESULT_DECL )
 }
 IMPLEMENT_FUNCTION( UWebResponse, INDEX_NONE, execSubst );
 
+/*-----------------------------------------------------------------------------
+	UUHTMBenchCommandlet.
+-----------------------------------------------------------------------------*/
+
+//
+// Measures how many pages per second the UHTM templates in a directory can
+// be produced, uncached and cached:
+// ucc UWeb.UHTMBench [PATH=../Web] [COUNT=1000]
+//
+class UUHTMBenchCommandlet : public UCommandlet
+{
+	DECLARE_CLASS(UUHTMBenchCommandlet,UCommandlet,CLASS_Transient);
+	void StaticConstructor()
+	{
+		guard(UUHTMBenchCommandlet::StaticConstructor);
+
+		LogToStdout = 1;
+		IsClient    = 0;
+		IsEditor    = 0;
+		IsServer    = 0;
+		LazyLoad    = 1;
+
+		unguard;
+	}
+	INT Main( const TCHAR* Parms )
+	{
+		guard(UUHTMBenchCommandlet::Main);
+		FString Path  = TEXT("../Web");
+		INT     Count = 1000;
+		Parse( Parms, TEXT("PATH="), Path );
+		Parse( Parms, TEXT("COUNT="), Count );
+		Count = Max( Count, 1 );
+
+		TArray<FString> Files = GFileManager->FindFiles( *(Path + PATH_SEPARATOR + TEXT("*.uhtm")), 1, 0 );
+		if( !Files.Num() )
+		{
+			GWarn->Logf( TEXT("No templates found in %s"), *Path );
+			return 1;
+		}
+
+		// Every key renders as a short value, like a typical admin page.
+		TMap<FString,FString> ReplacementMap;
+		FString Text;
+		DOUBLE  TotalCold=0.0, TotalWarm=0.0;
+		for( INT i=0; i<Files.Num(); i++ )
+		{
+			FString Filename = Path + PATH_SEPARATOR + Files(i);
+			FUHTMTemplate* Template = FindUHTM( Filename );
+			if( !Template )
+				continue;
+			for( INT j=1; j<Template->Segments.Num(); j+=2 )
+				ReplacementMap.Set( *Template->Segments(j), TEXT("Value") );
+
+			// Loaded and parsed on every request.
+			DOUBLE StartTime = appSeconds();
+			for( INT j=0; j<Count; j++ )
+			{
+				FUHTMTemplate Cold;
+				FString       File;
+				appLoadFileToString( File, *Filename );
+				ParseUHTM( *File, Cold );
+				RenderUHTM( Cold, ReplacementMap, Text );
+			}
+			DOUBLE Cold = appSeconds() - StartTime;
+
+			// Cached.
+			StartTime = appSeconds();
+			for( INT j=0; j<Count; j++ )
+				RenderUHTM( *FindUHTM(Filename), ReplacementMap, Text );
+			DOUBLE Warm = appSeconds() - StartTime;
+
+			GWarn->Logf( TEXT("%-24s %6i bytes %5i keys: %9.0f pages/sec uncached, %9.0f cached"), *Files(i), Text.Len(), Template->Segments.Num()/2, Count/Max(Cold,0.000001), Count/Max(Warm,0.000001) );
+			TotalCold += Cold;
+			TotalWarm += Warm;
+		}
+		GWarn->Logf( TEXT("All %i templates: %.0f pages/sec uncached, %.0f cached"), Files.Num(), Files.Num()*Count/Max(TotalCold,0.000001), Files.Num()*Count/Max(TotalWarm,0.000001) );
+		return 0;
+		unguard;
+	}
+};
+IMPLEMENT_CLASS(UUHTMBenchCommandlet)
+
 /*-----------------------------------------------------------------------------
 	The End.
 -----------------------------------------------------------------------------*/
@@ -189,6 +189,7 @@ static void MainLoop( UEngine* Engine )
 	check(Engine);
 
 	// Loop while running.
+	GTickPacer.Init();
 	GIsRunning = 1;
 	DOUBLE OldTime = appSeconds();
 	DOUBLE SecondStartTime = OldTime;
@@ -214,12 +215,7 @@ static void MainLoop( UEngine* Engine )
 
 		// Enforce optional maximum tick rate.
 		guard(EnforceTickRate);
-		FLOAT MaxTickRate = Engine->GetMaxTickRate();
-		if( MaxTickRate>0.0 )
-		{
-			FLOAT Delta = (1.0/MaxTickRate) - (appSeconds()-OldTime);
-			appSleep( Max(0.f,Delta) );
-		}
+		GTickPacer.Wait( Engine->GetMaxTickRate(), OldTime );
 		unguard;
 	}
 	GIsRunning = 0;